@@ -32,9 +32,11 @@
 #include "BR_Envelope.h"
 #include "BR_Loudness.h"
 #include "BR_MidiEditor.h"
+#include "BR_MidiUtil.h"
 #include "BR_Misc.h"
 #include "BR_ProjState.h"
 #include "BR_Tempo.h"
+#include "BR_TempoMap.h"
 #include "BR_Update.h"
 #include "BR_Util.h"
 #include "../SnM/SnM.h"
@@ -69,6 +71,8 @@ static void DeferRefreshToolbar()
 
 bool BR_GlobalActionHook (int cmd, int val, int valhw, int relmode, HWND hwnd)
 {
+	InvalidateMidiEditorViewStates(); // any action could change MIDI editor view settings
+	InvalidateTempoMap();             // or tempo markers, scripts and actions don't always create undo point first
 	if (cmd == 40153) // Item: Open in built-in MIDI editor (set default behavior in preferences)
 	{
 		g_deferRefreshToolbar = true;
@@ -159,6 +163,11 @@ int BR_CSurf_Extended(int call, void* parm1, void* parm2, void* parm3)
 	if (call == CSURF_EXT_RESET)
 	{
 		LoudnessUpdate();
+		InvalidateTempoMap();
+	}
+	else if (call == CSURF_EXT_SETBPMANDPLAYRATE)
+	{
+		InvalidateTempoMap();
 	}
 	else if (call == CSURF_EXT_SETSENDVOLUME || call == CSURF_EXT_SETSENDPAN)
 	{
@@ -1021,6 +1030,13 @@ static COMMAND_T g_commandTable[] =
 	{ { DEFACCEL, "SWS/BR: Restore tracks' solo and mute state to all tracks, slot 15" },                                                                  "BR_RESTORE_SOLO_MUTE_ALL_TRACKS_SLOT_15", RestoreTrackSoloMuteStateSlot, NULL, -15},
 	{ { DEFACCEL, "SWS/BR: Restore tracks' solo and mute state to all tracks, slot 16" },                                                                  "BR_RESTORE_SOLO_MUTE_ALL_TRACKS_SLOT_16", RestoreTrackSoloMuteStateSlot, NULL, -16},
 
+	/******************************************************************************
+	* Misc - Action latency profiler                                              *
+	******************************************************************************/
+	{ { DEFACCEL, "SWS/BR: Toggle action latency profiling" },              "BR_ACTION_PROFILER_TOGGLE", ToggleActionProfiler, NULL, 0, IsActionProfilerOn},
+	{ { DEFACCEL, "SWS/BR: Reset action latency statistics" },              "BR_ACTION_PROFILER_RESET",  ResetActionProfiler},
+	{ { DEFACCEL, "SWS/BR: Write action latency statistics to file" },      "BR_ACTION_PROFILER_DUMP",   DumpActionProfiler},
+
 	/******************************************************************************
 	* Misc - REAPER preferences                                                   *
 	******************************************************************************/
@@ -1239,6 +1255,7 @@ int BR_Init ()
 	SWSRegisterCommands(g_commandTable);
 
 	// Run various init functions
+	BenchmarkInitExit(true);
 	ContextualToolbarsInitExit(true);
 	ContinuousActionsInitExit(true);
 	LoudnessInitExit(true);
@@ -1282,6 +1299,7 @@ void BR_Exit ()
 	WritePrivateProfileString("common", "autoStretchMarkersTempo", tmp, GetIniFileBR());
 
 	// Run various exit functions
+	BenchmarkInitExit(false);
 	ContextualToolbarsInitExit(false);
 	ContinuousActionsInitExit(false);
 	LoudnessInitExit(false);
@@ -27,10 +27,22 @@
 ******************************************************************************/
 #include "stdafx.h"
 #include "BR_EnvelopeUtil.h"
+#include "BR_TempoMap.h"
 #include "BR_Util.h"
 #include "WDL/lice/lice_bezier.h"
 #include "../reaper/localize.h"
 
+/******************************************************************************
+* Globals                                                                     *
+******************************************************************************/
+struct BR_EnvCommitStats
+{
+	int full, partial, pointsWritten;
+	double time;
+	BR_EnvCommitStats () : full(0), partial(0), pointsWritten(0), time(0) {}
+};
+static BR_EnvCommitStats g_commitStats;
+
 /******************************************************************************
 * BR_Envelope                                                                 *
 ******************************************************************************/
@@ -45,6 +57,10 @@ m_pointsEdited  (false),
 m_takeEnvOffset (0),
 m_sampleRate    (-1),
 m_rebuildConseq (true),
+m_committedCount (0),
+m_committedState (-1),
+m_editStart     (0),
+m_editTail      (0),
 m_height        (-1),
 m_yOffset       (-1),
 m_takeEnvType   (UNKNOWN),
@@ -63,6 +79,10 @@ m_pointsEdited  (false),
 m_takeEnvOffset (0),
 m_sampleRate    (-1),
 m_rebuildConseq (true),
+m_committedCount (0),
+m_committedState (-1),
+m_editStart     (0),
+m_editTail      (0),
 m_height        (-1),
 m_yOffset       (-1),
 m_takeEnvType   (UNKNOWN),
@@ -84,6 +104,10 @@ m_pointsEdited  (false),
 m_takeEnvOffset (0),
 m_sampleRate    (-1),
 m_rebuildConseq (true),
+m_committedCount (0),
+m_committedState (-1),
+m_editStart     (0),
+m_editTail      (0),
 m_height        (-1),
 m_yOffset       (-1),
 m_takeEnvType   (UNKNOWN),
@@ -103,6 +127,10 @@ m_pointsEdited  (false),
 m_takeEnvOffset (0),
 m_sampleRate    (-1),
 m_rebuildConseq (true),
+m_committedCount (0),
+m_committedState (-1),
+m_editStart     (0),
+m_editTail      (0),
 m_height        (-1),
 m_yOffset       (-1),
 m_takeEnvType   (m_envelope ? envType : UNKNOWN),
@@ -122,6 +150,10 @@ m_pointsEdited    (envelope.m_pointsEdited),
 m_takeEnvOffset   (envelope.m_takeEnvOffset),
 m_sampleRate      (envelope.m_sampleRate),
 m_rebuildConseq   (true),
+m_committedCount  (envelope.m_committedCount),
+m_committedState  (envelope.m_committedState),
+m_editStart       (envelope.m_editStart),
+m_editTail        (envelope.m_editTail),
 m_height          (envelope.m_height),
 m_yOffset         (envelope.m_yOffset),
 m_takeEnvType     (envelope.m_takeEnvType),
@@ -154,6 +186,10 @@ BR_Envelope& BR_Envelope::operator= (const BR_Envelope& envelope)
 	m_takeEnvOffset = envelope.m_takeEnvOffset;
 	m_sampleRate    = envelope.m_sampleRate;
 	m_rebuildConseq = envelope.m_rebuildConseq;
+	m_committedCount = envelope.m_committedCount;
+	m_committedState = envelope.m_committedState;
+	m_editStart     = envelope.m_editStart;
+	m_editTail      = envelope.m_editTail;
 	m_height        = envelope.m_height;
 	m_yOffset       = envelope.m_yOffset;
 	m_takeEnvType   = envelope.m_takeEnvType;
@@ -222,6 +258,7 @@ bool BR_Envelope::SetPoint (int id, double* position, double* value, int* shape,
 		ReadPtr(shape,  m_points[id].shape);
 		ReadPtr(bezier, m_points[id].bezier);
 
+		this->MarkEdited(id, m_points.size() - id - 1);
 		m_update = true;
 		if (position) m_sorted = false;
 		m_pointsEdited = true;
@@ -246,6 +283,7 @@ bool BR_Envelope::SetSelection (int id, bool selected)
 		if (m_points[id].selected != selected)
 		{
 			m_points[id].selected = selected;
+			this->MarkEdited(id, m_points.size() - id - 1);
 			m_update = true;
 		}
 		return true;
@@ -267,6 +305,7 @@ bool BR_Envelope::CreatePoint (int id, double position, double value, int shape,
 			return false;
 
 		BR_Envelope::EnvPoint newPoint(position, (snapValue) ? (this->SnapValue(value)) : (value), shape, 0, selected, 0, bezier);
+		this->MarkEdited(id, m_points.size() - id);
 		m_points.insert(m_points.begin() + id, newPoint);
 
 		m_update       = true;
@@ -282,6 +321,7 @@ bool BR_Envelope::DeletePoint (int id)
 {
 	if (this->ValidateId(id))
 	{
+		this->MarkEdited(id, m_points.size() - id - 1);
 		m_points.erase(m_points.begin() + id);
 
 		m_update       = true;
@@ -346,6 +386,7 @@ bool BR_Envelope::SetTimeSig (int id, bool sig, bool partial, int num, int den)
 		m_points[id].partial = SetBit(m_points[id].partial, 0, sig);
 		m_points[id].partial = SetBit(m_points[id].partial, 2, partial);
 
+		this->MarkEdited(id, m_points.size() - id - 1);
 		m_update       = true;
 		m_pointsEdited = true;
 		return true;
@@ -367,6 +408,7 @@ bool BR_Envelope::SetCreatePoint (int id, double position, double value, int sha
 			m_sorted = false;
 
 		BR_Envelope::EnvPoint newPoint(position, value, (shape < MIN_SHAPE || shape > MAX_SHAPE) ? this->GetDefaultShape() : shape, 0, selected, 0, (shape == 5) ? bezier : 0);
+		this->MarkEdited(m_points.size(), 0);
 		m_points.push_back(newPoint);
 
 		return true;
@@ -387,6 +429,7 @@ bool BR_Envelope::SetCreatePoint (int id, double position, double value, int sha
 		m_points[id].bezier   = (m_points[id].shape == BEZIER) ? bezier : 0;
 		m_points[id].selected = selected;
 
+		this->MarkEdited(id, m_points.size() - id - 1);
 		m_update       = true;
 		m_pointsEdited = true;
 		return true;
@@ -407,6 +450,7 @@ int BR_Envelope::DeletePoints (int startId, int endId)
 	if (!this->ValidateId(startId) || !this->ValidateId(endId))
 		return 0;
 
+	this->MarkEdited(startId, m_points.size() - endId - 1);
 	m_points.erase(m_points.begin() + startId, m_points.begin() + endId+1);
 
 	m_update       = true;
@@ -454,6 +498,7 @@ int BR_Envelope::DeletePointsInRange (double start, double end)
 		{
 			if (i->position >= start && i->position <= end)
 			{
+				this->MarkEdited(i - m_points.begin(), m_points.end() - i - 1);
 				i = m_points.erase(i);
 				m_update       = true;
 				m_pointsEdited = true;
@@ -470,7 +515,13 @@ int BR_Envelope::DeletePointsInRange (double start, double end)
 void BR_Envelope::UnselectAll ()
 {
 	for (size_t i = 0; i < m_points.size(); ++i)
-		m_points[i].selected = 0;
+	{
+		if (m_points[i].selected)
+		{
+			m_points[i].selected = 0;
+			this->MarkEdited(i, m_points.size() - i - 1);
+		}
+	}
 	m_update = true;
 }
 
@@ -527,6 +578,7 @@ bool BR_Envelope::ValidateId (int id)
 
 void BR_Envelope::DeleteAllPoints ()
 {
+	this->MarkEdited(0, 0);
 	m_points.clear();
 	m_sorted = true;
 	m_update = true;
@@ -536,6 +588,26 @@ void BR_Envelope::Sort ()
 {
 	if (!m_sorted)
 	{
+		// Points outside the edited range are sorted already, so the ones that keep their ids after sorting are
+		// those positioned before/after all edited points - shrink the unchanged range to them prior to sorting
+		int editEnd = max(m_editStart, (int)m_points.size() - m_editTail);
+		if (m_editStart < editEnd)
+		{
+			double minPos = m_points[m_editStart].position;
+			double maxPos = minPos;
+			for (int i = m_editStart + 1; i < editEnd; ++i)
+			{
+				minPos = min(minPos, m_points[i].position);
+				maxPos = max(maxPos, m_points[i].position);
+			}
+
+			BR_Envelope::EnvPoint::ComparePoints compare;
+			vector<BR_Envelope::EnvPoint>::iterator start = m_points.begin() + m_editStart;
+			vector<BR_Envelope::EnvPoint>::iterator end   = m_points.begin() + editEnd;
+			m_editStart = lower_bound(m_points.begin(), start, BR_Envelope::EnvPoint(minPos), compare) - m_points.begin();
+			m_editTail  = m_points.end() - upper_bound(end, m_points.end(), BR_Envelope::EnvPoint(maxPos), compare);
+		}
+
 		stable_sort(m_points.begin(), m_points.end(), BR_Envelope::EnvPoint::ComparePoints());
 		m_sorted = true;
 	}
@@ -1439,6 +1511,8 @@ bool BR_Envelope::Commit (bool force /*=false*/)
 {
 	if ((force || (m_update && !this->IsLocked())) && m_envelope)
 	{
+		double commitStart = time_precise();
+
 		// Prevents reselection of points in time selection
 		const ConfigVar<int> envClickSegMode("envclicksegmode");
 		ConfigVarOverride<int> tempEnvClickSegMode(envClickSegMode,
@@ -1447,6 +1521,8 @@ bool BR_Envelope::Commit (bool force /*=false*/)
 		const ConfigVar<int> pooledenvs("pooledenvs");
 		ConfigVarOverride<int> tempPooledEnvs(pooledenvs, pooledenvs.value_or(0) & (~12));
 
+		bool idsMatch = false;
+
 		// Need to commit whole chunk
 		if (m_tempoMap)
 		{
@@ -1456,70 +1532,102 @@ bool BR_Envelope::Commit (bool force /*=false*/)
 			chunkStart.Append(">");
 			GetSetObjectState(m_envelope, chunkStart.Get());
 			UpdateTempoTimeline();
+			InvalidateTempoMap();
+
+			++g_commitStats.full;
+			g_commitStats.pointsWritten += m_points.size();
 		}
 		// We can update through API (faster)
 		else
 		{
 			PreventUIRefresh(1);
+			const double playrate = m_take ? GetMediaItemTakeInfo_Value(m_take, "D_PLAYRATE") : 1;
 
-			// If properties were changed, first commit chunk with properties only and one point (one point prevents REAPER
-			// from removing envelope completely) (creating points later using API instead of supplying full chunk is faster)
-			bool firstPointDone = false;
-			if (m_properties.changed || force)
+			// If only points were edited, try writing just the edited range
+			if (force || m_properties.changed || !this->CommitEditedRange(playrate, &idsMatch))
 			{
-				WDL_FastString chunkStart = this->GetProperties();
-				if (!m_points.empty())
+				// If properties were changed, first commit chunk with properties only and one point (one point prevents REAPER
+				// from removing envelope completely) (creating points later using API instead of supplying full chunk is faster)
+				bool firstPointDone = false;
+				if (m_properties.changed || force)
 				{
-					m_points[0].Append(chunkStart, false);
-					firstPointDone = true;
+					WDL_FastString chunkStart = this->GetProperties();
+					if (!m_points.empty())
+					{
+						m_points[0].Append(chunkStart, false);
+						firstPointDone = true;
+					}
+					chunkStart.Append(">");
+					GetSetObjectState(m_envelope, chunkStart.Get());
 				}
-				chunkStart.Append(">");
-				GetSetObjectState(m_envelope, chunkStart.Get());
-			}
 
-			// Delete excess points
-			size_t currentCount = CountEnvelopePoints(m_envelope);
-			if (currentCount > m_points.size())
-			{
-				double startTime, endTime;
-				if (m_points.size() > 0) GetEnvelopePoint(m_envelope, m_points.size() - 1, &startTime, NULL, NULL, NULL, NULL);
-				else                  startTime = 0;
-				if (currentCount    > 0) GetEnvelopePoint(m_envelope, currentCount - 1, &endTime,   NULL, NULL, NULL, NULL);
-				else                  endTime = 0;
-
-				startTime -= 1;
-				endTime   += 1;
-				DeleteEnvelopePointRange(m_envelope, startTime, endTime);
-			}
+				// Delete excess points
+				size_t currentCount = CountEnvelopePoints(m_envelope);
+				if (currentCount > m_points.size())
+				{
+					double startTime, endTime;
+					if (m_points.size() > 0) GetEnvelopePoint(m_envelope, m_points.size() - 1, &startTime, NULL, NULL, NULL, NULL);
+					else                  startTime = 0;
+					if (currentCount    > 0) GetEnvelopePoint(m_envelope, currentCount - 1, &endTime,   NULL, NULL, NULL, NULL);
+					else                  endTime = 0;
+
+					startTime -= 1;
+					endTime   += 1;
+					DeleteEnvelopePointRange(m_envelope, startTime, endTime);
+				}
 
-			// Edit/insert cached points
-			currentCount = CountEnvelopePoints(m_envelope);
-			const double playrate = m_take ? GetMediaItemTakeInfo_Value(m_take, "D_PLAYRATE") : 1;
-			for (size_t i = firstPointDone; i < currentCount; ++i)
-			{
-				double value = (m_properties.faderMode != 0) ? ScaleToEnvelopeMode(m_properties.faderMode, m_points[i].value) : m_points[i].value;
-				double position = m_points[i].position * playrate;
-				SetEnvelopePoint(m_envelope, i, &position, &value, &m_points[i].shape, &m_points[i].bezier, &m_points[i].selected, &g_bTrue);
-			}
-			for (size_t i = currentCount; i < m_points.size(); ++i)
-			{
-				double value = (m_properties.faderMode != 0) ? ScaleToEnvelopeMode(m_properties.faderMode, m_points[i].value) : m_points[i].value;
-				double position = m_points[i].position * playrate;
-				InsertEnvelopePoint(m_envelope, position, value, m_points[i].shape, m_points[i].bezier, m_points[i].selected, &g_bTrue);
+				// Edit/insert cached points
+				currentCount = CountEnvelopePoints(m_envelope);
+				for (size_t i = firstPointDone; i < currentCount; ++i)
+				{
+					double value = (m_properties.faderMode != 0) ? ScaleToEnvelopeMode(m_properties.faderMode, m_points[i].value) : m_points[i].value;
+					double position = m_points[i].position * playrate;
+					SetEnvelopePoint(m_envelope, i, &position, &value, &m_points[i].shape, &m_points[i].bezier, &m_points[i].selected, &g_bTrue);
+				}
+				for (size_t i = currentCount; i < m_points.size(); ++i)
+				{
+					double value = (m_properties.faderMode != 0) ? ScaleToEnvelopeMode(m_properties.faderMode, m_points[i].value) : m_points[i].value;
+					double position = m_points[i].position * playrate;
+					InsertEnvelopePoint(m_envelope, position, value, m_points[i].shape, m_points[i].bezier, m_points[i].selected, &g_bTrue);
+				}
+				Envelope_SortPoints(m_envelope);
+
+				// Sorting in REAPER leaves point ids as they are here only if our points are sorted (and there are no points at the same position)
+				idsMatch = m_sorted;
+				for (size_t i = 1; idsMatch && i < m_points.size(); ++i)
+					idsMatch = m_points[i-1].position < m_points[i].position;
+
+				++g_commitStats.full;
+				g_commitStats.pointsWritten += m_points.size();
 			}
-			Envelope_SortPoints(m_envelope);
 
 			PreventUIRefresh(-1);
 		}
 
+		this->MarkCommitted(idsMatch);
 		UpdateArrange();
 		m_update       = false;
 		m_pointsEdited = false;
+
+		g_commitStats.time += time_precise() - commitStart;
 		return true;
 	}
 	return false;
 }
 
+void BR_Envelope::GetCommitStats (int* fullCommits, int* partialCommits, int* pointsWritten, double* commitTime)
+{
+	WritePtr(fullCommits,    g_commitStats.full);
+	WritePtr(partialCommits, g_commitStats.partial);
+	WritePtr(pointsWritten,  g_commitStats.pointsWritten);
+	WritePtr(commitTime,     g_commitStats.time);
+}
+
+void BR_Envelope::ResetCommitStats ()
+{
+	g_commitStats = BR_EnvCommitStats();
+}
+
 int BR_Envelope::FindFirstPoint ()
 {
 	if (m_points.empty())
@@ -1697,6 +1805,93 @@ void BR_Envelope::Build (bool takeEnvelopesUseProjectTime)
 
 	if (takeEnvelopesUseProjectTime && m_take)
 		m_takeEnvOffset = GetMediaItemInfo_Value(GetMediaItemTake_Item(m_take), "D_POSITION");
+
+	this->MarkCommitted(true);
+}
+
+void BR_Envelope::MarkEdited (int startId, int unchangedTail)
+{
+	m_editStart = min(m_editStart, startId);
+	m_editTail  = min(m_editTail, max(0, unchangedTail));
+}
+
+void BR_Envelope::MarkCommitted (bool idsMatch)
+{
+	// When ids in the envelope don't match ours, next commit has to write all points
+	m_committedCount = m_points.size();
+	m_committedState = GetProjectStateChangeCount(NULL); // called after our own commits too, so only other changes are caught
+	m_editStart      = (idsMatch) ? m_committedCount : 0;
+	m_editTail       = (idsMatch) ? m_committedCount : 0;
+}
+
+bool BR_Envelope::CommitEditedRange (double playrate, bool* idsMatch)
+{
+	// Edited points are in [start, end) and replace envelope points in [start, committedEnd)
+	int count = m_points.size();
+	int start = min(m_editStart, min(count, m_committedCount));
+	int tail  = min(m_editTail, min(count, m_committedCount) - start);
+	if ((start == 0 && tail == 0) || !m_sorted || CountEnvelopePoints(m_envelope) != m_committedCount)
+		return false;
+
+	// Envelope could have been edited elsewhere with the same point count (e.g. undo, other actions or scripts)
+	if (GetProjectStateChangeCount(NULL) != m_committedState)
+		return false;
+
+	int end          = count - tail;
+	int committedEnd = m_committedCount - tail;
+	int setEnd       = min(end, committedEnd);
+
+	// Delete surplus envelope points - API can only delete by time so bail out if the range would catch neighboring points
+	if (committedEnd > setEnd)
+	{
+		double first, last, previous, next;
+		GetEnvelopePoint(m_envelope, setEnd,           &first, NULL, NULL, NULL, NULL);
+		GetEnvelopePoint(m_envelope, committedEnd - 1, &last,  NULL, NULL, NULL, NULL);
+		if (setEnd > 0)                      GetEnvelopePoint(m_envelope, setEnd - 1,   &previous, NULL, NULL, NULL, NULL);
+		else                                 previous = first - 2;
+		if (committedEnd < m_committedCount) GetEnvelopePoint(m_envelope, committedEnd, &next,     NULL, NULL, NULL, NULL);
+		else                                 next = last + 2;
+
+		if (previous >= first || next <= last)
+			return false;
+
+		DeleteEnvelopePointRange(m_envelope, (previous + first) / 2, (last + next) / 2);
+		if (CountEnvelopePoints(m_envelope) != m_committedCount - (committedEnd - setEnd))
+			return false;
+	}
+
+	// Edit/insert edited points
+	for (int i = start; i < setEnd; ++i)
+	{
+		double value = (m_properties.faderMode != 0) ? ScaleToEnvelopeMode(m_properties.faderMode, m_points[i].value) : m_points[i].value;
+		double position = m_points[i].position * playrate;
+		SetEnvelopePoint(m_envelope, i, &position, &value, &m_points[i].shape, &m_points[i].bezier, &m_points[i].selected, &g_bTrue);
+	}
+	for (int i = setEnd; i < end; ++i)
+	{
+		double value = (m_properties.faderMode != 0) ? ScaleToEnvelopeMode(m_properties.faderMode, m_points[i].value) : m_points[i].value;
+		double position = m_points[i].position * playrate;
+		InsertEnvelopePoint(m_envelope, position, value, m_points[i].shape, m_points[i].bezier, m_points[i].selected, &g_bTrue);
+	}
+
+	// Our points are sorted so REAPER needs sorting only for inserted points (after which points at the same position could end up in different order)
+	WritePtr(idsMatch, true);
+	if (end > setEnd)
+	{
+		Envelope_SortPoints(m_envelope);
+		for (int i = 1; i < count; ++i)
+		{
+			if (m_points[i-1].position >= m_points[i].position)
+			{
+				WritePtr(idsMatch, false);
+				break;
+			}
+		}
+	}
+
+	++g_commitStats.partial;
+	g_commitStats.pointsWritten += end - start;
+	return true;
 }
 
 void BR_Envelope::UpdateConsequential ()
@@ -2972,3 +3167,48 @@ void UnselectAllTempoMarkers ()
 	for (int i = 0; i < CountEnvelopePoints(tempoEnv); ++i)
 		SetEnvelopePoint(tempoEnv, i, NULL, NULL, NULL, NULL, &g_bFalse, &g_bFalse);
 }
+
+#ifdef BR_DEBUG_PERFORMANCE_BENCHMARK
+// Edit a few points in the middle of first track's volume envelope and commit it through BR_Envelope, once forced (whole envelope gets written) and once normally (only edited points get written)
+// Runs only when "Envelope points per track" is set in the benchmark dialog, compare BR_Envelope/full and BR_Envelope/partial in SWS_benchmark.json
+static void BenchmarkEnvelopeCommit (const BR_BenchmarkConfig& cfg, vector<BR_BenchmarkResult>& results)
+{
+	const int edits = 8;
+	TrackEnvelope* envelope = GetTrackEnvelopeByName(GetTrack(NULL, 0), "Volume");
+	if (!envelope || cfg.envPoints < edits * 2)
+		return;
+
+	BR_BenchmarkResult full("BR_Envelope/full"), partial("BR_Envelope/partial");
+	full.name.SetFormatted(256, "Commit of %d edited points in envelope with %d points (whole envelope)", edits, cfg.envPoints);
+	partial.name.SetFormatted(256, "Commit of %d edited points in envelope with %d points (edited range)", edits, cfg.envPoints);
+
+	BR_Envelope::ResetCommitStats();
+	for (int i = 0; i < cfg.iterations; ++i)
+	{
+		for (int j = 0; j < 2; ++j)
+		{
+			BR_Envelope env(envelope);
+			int id = env.CountPoints() / 2;
+			double value = 0.75, previous, next;
+			for (int k = 0; k < edits - 2; ++k)
+				env.SetPoint(id + k, NULL, &value, NULL, NULL);
+			env.DeletePoint(id + edits);
+			env.GetPoint(id + edits, &previous, NULL, NULL, NULL);
+			env.GetPoint(id + edits + 1, &next, NULL, NULL, NULL);
+			env.CreatePoint(id + edits + 1, (previous + next) / 2, value, 0, 0, false);
+			env.Sort();
+
+			double start = time_precise();
+			env.Commit(j == 0);
+			((j == 0) ? full : partial).AddTime(start);
+		}
+	}
+
+	int fullCommits, partialCommits, pointsWritten;
+	BR_Envelope::GetCommitStats(&fullCommits, &partialCommits, &pointsWritten, NULL);
+	partial.name.AppendFormatted(256, " - %d whole and %d partial commits wrote %d points", fullCommits, partialCommits, pointsWritten);
+	results.push_back(full);
+	results.push_back(partial);
+}
+static BR_BenchmarkRegistration s_envelopeCommitBenchmark(BenchmarkEnvelopeCommit);
+#endif
@@ -163,7 +163,11 @@ public:
 	void SetScalingToFader (bool faderScaling);
 
 	/* Committing - does absolutely nothing if there are no edits or locking is turned on (unless forced) */
-	bool Commit (bool force = false);
+	bool Commit (bool force = false); // only the range of points edited since Build()/last Commit() is written if possible (see MarkEdited())
+
+	/* Commit counters for all envelopes since startup or last reset (used by benchmarks) */
+	static void GetCommitStats (int* fullCommits, int* partialCommits, int* pointsWritten, double* commitTime); // commitTime is in seconds
+	static void ResetCommitStats ();
 
 private:
 	struct IdPair
@@ -237,6 +241,9 @@ private:
 	int FindNext (double position, double offset);     // used for internal stuff since position
 	int FindPrevious (double position, double offset); // offset of take envelopes has to be tracked
 	void Build (bool takeEnvelopesUseProjectTime);
+	void MarkEdited (int startId, int unchangedTail);
+	void MarkCommitted (bool idsMatch);
+	bool CommitEditedRange (double playrate, bool* idsMatch);
 	void UpdateConsequential ();
 	void FillFxInfo ();
 	bool FillProperties () const; // to make operator== const (yes, m_properties does get modified but only if not cached already)
@@ -256,6 +263,10 @@ private:
 	BR_EnvType m_takeEnvType;
 	void* m_data;
 	vector<BR_Envelope::EnvPoint> m_points;
+	int m_committedCount; // point count in the envelope at the time of Build() or last Commit()
+	int m_committedState; // project state change count at the time of Build() or last Commit(), edited range is written only if unchanged
+	int m_editStart;      // points before this id and last m_editTail points are the same as in the envelope (at
+	int m_editTail;       // the same ids counting from start/end) - the rest is written by Commit() (see MarkEdited())
 	bool m_rebuildConseq;
 	vector<size_t> m_pointsSel;
 	vector<IdPair> m_pointsConseq;
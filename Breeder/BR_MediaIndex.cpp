@@ -0,0 +1,247 @@
+/******************************************************************************
+/ BR_MediaIndex.cpp
+/
+/ Copyright (c) 2026 and later SWS
+/
+/
+/
+/ Permission is hereby granted, free of charge, to any person obtaining a copy
+/ of this software and associated documentation files (the "Software"), to deal
+/ in the Software without restriction, including without limitation the rights to
+/ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+/ of the Software, and to permit persons to whom the Software is furnished to
+/ do so, subject to the following conditions:
+/
+/ The above copyright notice and this permission notice shall be included in all
+/ copies or substantial portions of the Software.
+/
+/ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+/ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+/ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+/ HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+/ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/ OTHER DEALINGS IN THE SOFTWARE.
+/
+******************************************************************************/
+#include "stdafx.h"
+#include "BR_MediaIndex.h"
+
+BR_MediaIndex g_mediaIndex;
+
+/******************************************************************************
+* Media source index                                                          *
+******************************************************************************/
+BR_MediaIndex::BR_MediaIndex () :
+m_proj       (NULL),
+m_stateCount (0),
+m_generation (0)
+{
+}
+
+int BR_MediaIndex::CountTakes (const char* file)
+{
+	vector<MediaItem_Take*>* takes = this->FindTakes(file);
+	return takes ? (int)takes->size() : 0;
+}
+
+MediaItem_Take* BR_MediaIndex::GetTake (const char* file, int idx)
+{
+	vector<MediaItem_Take*>* takes = this->FindTakes(file);
+	if (takes && idx >= 0 && idx < (int)takes->size())
+		return (*takes)[idx];
+	return NULL;
+}
+
+vector<MediaItem_Take*> BR_MediaIndex::GetTakes (const char* file)
+{
+	vector<MediaItem_Take*>* takes = this->FindTakes(file);
+	return takes ? *takes : vector<MediaItem_Take*>();
+}
+
+const char* BR_MediaIndex::GetSourceFile (PCM_source* source)
+{
+	this->Sync();
+	map<PCM_source*, MediaItem_Take*>::iterator it = m_sources.find(BR_MediaIndex::GetFileSource(source));
+	if (it != m_sources.end() && !this->IsTakeValid(it->second))
+	{
+		this->Sync(true);
+		it = m_sources.find(BR_MediaIndex::GetFileSource(source));
+	}
+	return (it != m_sources.end()) ? m_takes[it->second].file.c_str() : NULL;
+}
+
+int BR_MediaIndex::Relink (const char* oldFile, const char* newFile)
+{
+	if (!newFile || !*newFile)
+		return 0;
+
+	vector<MediaItem_Take*> takes = this->GetTakes(oldFile); // copy, UpdateTake() modifies the index
+	for (size_t i = 0; i < takes.size(); ++i)
+	{
+		m_takes[takes[i]].source->SetFileName(newFile);
+		this->UpdateTake(takes[i]);
+	}
+	return (int)takes.size();
+}
+
+void BR_MediaIndex::UpdateTake (MediaItem_Take* take)
+{
+	PCM_source* source = BR_MediaIndex::GetFileSource((PCM_source*)GetSetMediaItemTakeInfo(take, "P_SOURCE", NULL));
+	const char* file   = source ? source->GetFileName() : NULL;
+	if (!file || !*file) // MIDI, empty takes etc.
+	{
+		this->RemoveTake(take);
+		return;
+	}
+
+	// Most takes stay the same between syncs so check before touching any of the maps
+	map<MediaItem_Take*, TakeEntry>::iterator it = m_takes.find(take);
+	if (it != m_takes.end() && it->second.source == source && it->second.file == file)
+	{
+		it->second.generation = m_generation;
+		return;
+	}
+
+	this->RemoveTake(take);
+	TakeEntry& entry = m_takes[take];
+	entry.source     = source;
+	entry.file       = file;
+	entry.key        = BR_MediaIndex::NormalizePath(file);
+	entry.generation = m_generation;
+	m_sources[source] = take;
+	m_files[entry.key].push_back(take);
+}
+
+int BR_MediaIndex::UpdateMissingFiles ()
+{
+	this->Sync();
+	m_missing.clear();
+	for (map<string, vector<MediaItem_Take*> >::iterator it = m_files.begin(); it != m_files.end(); ++it)
+	{
+		const char* file = m_takes[it->second.front()].file.c_str();
+		if (!file_exists(file))
+			m_missing.push_back(file);
+	}
+	return (int)m_missing.size();
+}
+
+const char* BR_MediaIndex::GetMissingFile (int idx)
+{
+	return (idx >= 0 && idx < (int)m_missing.size()) ? m_missing[idx].c_str() : NULL;
+}
+
+PCM_source* BR_MediaIndex::GetFileSource (PCM_source* source)
+{
+	if (source && source->GetType() && !strcmp(source->GetType(), "SECTION"))
+		return source->GetSource();
+	return source;
+}
+
+string BR_MediaIndex::NormalizePath (const char* file)
+{
+	string path(file ? file : "");
+	for (size_t i = 0; i < path.size(); ++i)
+	{
+		if (path[i] == '\\')
+			path[i] = '/';
+		#ifdef _WIN32
+			else if (path[i] >= 'A' && path[i] <= 'Z')
+				path[i] += 'a' - 'A';
+		#endif
+	}
+	return path;
+}
+
+bool BR_MediaIndex::IsTakeValid (MediaItem_Take* take)
+{
+	map<MediaItem_Take*, TakeEntry>::iterator it = m_takes.find(take);
+	return it != m_takes.end()
+	    && ValidatePtr2(m_proj, take, "MediaItem_Take*")
+	    && BR_MediaIndex::GetFileSource((PCM_source*)GetSetMediaItemTakeInfo(take, "P_SOURCE", NULL)) == it->second.source;
+}
+
+vector<MediaItem_Take*>* BR_MediaIndex::FindTakes (const char* file)
+{
+	this->Sync();
+	string key = BR_MediaIndex::NormalizePath(file);
+	map<string, vector<MediaItem_Take*> >::iterator it = m_files.find(key);
+	if (it == m_files.end())
+		return NULL;
+
+	for (size_t i = 0; i < it->second.size(); ++i)
+	{
+		if (!this->IsTakeValid(it->second[i]))
+		{
+			this->Sync(true);
+			it = m_files.find(key);
+			return (it != m_files.end()) ? &it->second : NULL;
+		}
+	}
+	return &it->second;
+}
+
+void BR_MediaIndex::Sync (bool force /*= false*/)
+{
+	ReaProject* proj = EnumProjects(-1, NULL, 0);
+	int stateCount = GetProjectStateChangeCount(proj);
+	if (!force && proj == m_proj && stateCount == m_stateCount)
+		return;
+
+	if (proj != m_proj)
+	{
+		m_takes.clear();
+		m_sources.clear();
+		m_files.clear();
+		m_missing.clear();
+	}
+	m_proj       = proj;
+	m_stateCount = stateCount;
+	++m_generation;
+
+	// No way to tell which items changed so all takes get visited, UpdateTake() only touches the maps for changed ones
+	for (int i = 0; i < CountTracks(proj); ++i)
+	{
+		MediaTrack* track = GetTrack(proj, i);
+		for (int j = 0; j < GetTrackNumMediaItems(track); ++j)
+		{
+			MediaItem* item = GetTrackMediaItem(track, j);
+			for (int k = 0; k < GetMediaItemNumTakes(item); ++k)
+			{
+				if (MediaItem_Take* take = GetMediaItemTake(item, k))
+					this->UpdateTake(take);
+			}
+		}
+	}
+
+	// Whatever wasn't seen in this pass got deleted
+	vector<MediaItem_Take*> deleted;
+	for (map<MediaItem_Take*, TakeEntry>::iterator it = m_takes.begin(); it != m_takes.end(); ++it)
+	{
+		if (it->second.generation != m_generation)
+			deleted.push_back(it->first);
+	}
+	for (size_t i = 0; i < deleted.size(); ++i)
+		this->RemoveTake(deleted[i]);
+}
+
+void BR_MediaIndex::RemoveTake (MediaItem_Take* take)
+{
+	map<MediaItem_Take*, TakeEntry>::iterator it = m_takes.find(take);
+	if (it == m_takes.end())
+		return;
+
+	map<PCM_source*, MediaItem_Take*>::iterator source = m_sources.find(it->second.source);
+	if (source != m_sources.end() && source->second == take)
+		m_sources.erase(source);
+
+	map<string, vector<MediaItem_Take*> >::iterator file = m_files.find(it->second.key);
+	if (file != m_files.end())
+	{
+		file->second.erase(std::remove(file->second.begin(), file->second.end(), take), file->second.end());
+		if (file->second.empty())
+			m_files.erase(file);
+	}
+	m_takes.erase(it);
+}
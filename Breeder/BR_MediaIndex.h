@@ -0,0 +1,86 @@
+/******************************************************************************
+/ BR_MediaIndex.h
+/
+/ Copyright (c) 2026 and later SWS
+/
+/
+/
+/ Permission is hereby granted, free of charge, to any person obtaining a copy
+/ of this software and associated documentation files (the "Software"), to deal
+/ in the Software without restriction, including without limitation the rights to
+/ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+/ of the Software, and to permit persons to whom the Software is furnished to
+/ do so, subject to the following conditions:
+/
+/ The above copyright notice and this permission notice shall be included in all
+/ copies or substantial portions of the Software.
+/
+/ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+/ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+/ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+/ HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+/ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/ OTHER DEALINGS IN THE SOFTWARE.
+/
+******************************************************************************/
+#pragma once
+
+/******************************************************************************
+* Media source index                                                          *
+*                                                                             *
+* Maps media files used in the current project to the takes using them (and   *
+* each take's source to its file) so relinking, renaming or looking up takes  *
+* by file doesn't have to walk every take in the project for every file. The  *
+* index is built on first use and then resynced lazily when project state     *
+* changes. REAPER doesn't report which items changed, so a resync still walks *
+* every take in the project - it's O(takes) per state change, not O(changes). *
+* The walk only compares each take's source and file name against the index,  *
+* path normalization and map updates are done just for takes that changed.    *
+* Code that swaps take sources itself should call UpdateTake() right away     *
+* since project state change count only moves when undo point gets created.   *
+* For the same reason (scripts deleting items without undo point etc.) takes  *
+* are checked with ValidatePtr2 before they're handed out, the index gets     *
+* rebuilt when any of them is gone or uses another source.                    *
+* Section sources are indexed by the file of their parent source. Paths are   *
+* matched with normalized separators (and case-insensitively on Windows).     *
+******************************************************************************/
+class BR_MediaIndex
+{
+public:
+	BR_MediaIndex ();
+	int CountTakes (const char* file);
+	MediaItem_Take* GetTake (const char* file, int idx);
+	vector<MediaItem_Take*> GetTakes (const char* file);
+	const char* GetSourceFile (PCM_source* source);
+	int Relink (const char* oldFile, const char* newFile); // returns number of relinked takes
+	void UpdateTake (MediaItem_Take* take);
+	int UpdateMissingFiles (); // checks every indexed file once, returns number of missing files
+	const char* GetMissingFile (int idx);
+
+private:
+	struct TakeEntry
+	{
+		PCM_source* source;
+		string file;
+		string key;
+		int generation;
+	};
+	static PCM_source* GetFileSource (PCM_source* source);
+	static string NormalizePath (const char* file);
+	bool IsTakeValid (MediaItem_Take* take);
+	vector<MediaItem_Take*>* FindTakes (const char* file);
+	void Sync (bool force = false);
+	void RemoveTake (MediaItem_Take* take);
+
+	ReaProject* m_proj;
+	int m_stateCount;
+	int m_generation;
+	map<MediaItem_Take*, TakeEntry> m_takes;
+	map<PCM_source*, MediaItem_Take*> m_sources;
+	map<string, vector<MediaItem_Take*> > m_files;
+	vector<string> m_missing;
+};
+
+extern BR_MediaIndex g_mediaIndex;
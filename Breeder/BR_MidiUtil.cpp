@@ -329,6 +329,27 @@ bool BR_MidiEditor::IsCCVisible (MediaItem_Take* take, int id)
 	return visible;
 }
 
+bool BR_MidiEditor::IsCCVisible (MediaItem_Take* take, BR_MidiEvents& events, int id)
+{
+	bool visible = false;
+	if (take)
+	{
+		if (!m_filterEnabled)
+		{
+			visible = true;
+		}
+		else
+		{
+			double position;
+			int chanMsg, channel, msg2, msg3;
+			if (events.GetCC(id, NULL, NULL, &position, &chanMsg, &channel, &msg2, &msg3))
+				visible = this->CheckVisibility(take, chanMsg, position, 0, channel, msg2, msg3);
+		}
+	}
+
+	return visible;
+}
+
 bool BR_MidiEditor::IsSysVisible (MediaItem_Take* take, int id)
 {
 	bool visible = false;
@@ -413,116 +434,302 @@ bool BR_MidiEditor::CheckVisibility (MediaItem_Take* take, int chanMsg, double p
 
 }
 
-bool BR_MidiEditor::Build ()
+/* View state cache: BR_MidiEditor gets constructed often (sometimes a few   *
+*  times in the same action or on every mouse move) and view settings always  *
+*  follow MIDI events in the take's source chunk, so only keep the few lines  *
+*  we need. Cached entries expire on any action, undo point, SWS chunk write  *
+*  or the next timer tick: view changes made by user don't touch undo state   *
+*  and CC lane layout or event filter changes can't be read without the      *
+*  chunk. Entries also hold a view signature (editor scroll bars and size, or *
+*  item height in arrange for inline editing) checked on every lookup        */
+static const int MIDI_VIEW_SIGNATURE_SIZE = 8;
+struct BR_MidiViewState
 {
-	m_take = (m_midiEditor) ? MIDIEditor_GetTake(m_midiEditor) : m_take;
+	WDL_FastString sourceChunk;
+	MediaItem* item;
+	int signature[MIDI_VIEW_SIGNATURE_SIZE];
+};
+static map<MediaItem_Take*,BR_MidiViewState> g_midiViewStates;
+static int g_midiViewStatesProjState = -1;
+static unsigned int g_midiViewStatesObjWrites = 0;
+static bool g_midiViewStatesTimer = false;
 
-	if (m_take)
+void InvalidateMidiEditorViewStates ()
+{
+	g_midiViewStates.clear();
+	if (g_midiViewStatesTimer)
 	{
-		MediaItem* item = GetMediaItemTake_Item(m_take);
-		int takeId = GetTakeId(m_take, item);
-		if (takeId >= 0)
+		plugin_register("-timer", (void*)InvalidateMidiEditorViewStates);
+		g_midiViewStatesTimer = false;
+	}
+}
+
+static void GetMidiViewSignature (MediaItem_Take* take, HWND midiEditor, int* signature)
+{
+	memset(signature, 0, MIDI_VIEW_SIGNATURE_SIZE * sizeof(int));
+	if (midiEditor)
+	{
+		if (HWND notesView = GetNotesView(midiEditor))
 		{
-			SNM_TakeParserPatcher p(item, CountTakes(item));
-			WDL_FastString takeChunk;
-			if (p.GetTakeChunk(takeId, &takeChunk))
-			{
-				SNM_ChunkParserPatcher ptk(&takeChunk, false);
-				LineParser lp(false);
+			RECT r;
+			GetClientRect(notesView, &r);
+			signature[0] = r.right - r.left;
+			signature[1] = r.bottom - r.top;
+
+			SCROLLINFO si = { sizeof(SCROLLINFO), };
+			si.fMask = SIF_POS | SIF_PAGE | SIF_RANGE;
+			CoolSB_GetScrollInfo(notesView, SB_HORZ, &si);
+			signature[2] = si.nPos;
+			signature[3] = si.nPage;
+			signature[4] = si.nMax;
+			CoolSB_GetScrollInfo(notesView, SB_VERT, &si);
+			signature[5] = si.nPos;
+			signature[6] = si.nPage;
+			signature[7] = si.nMax;
+		}
+	}
+	else if (MediaItem* item = GetMediaItemTake_Item(take))
+	{
+		signature[0] = (int)GetMediaItemInfo_Value(item, "I_LASTH");
+		signature[1] = (int)GetMediaItemInfo_Value(item, "I_LASTY");
+	}
+}
 
-				int laneId = 0;
-				WDL_FastString lineLane;
-				while (ptk.Parse(SNM_GET_SUBCHUNK_OR_LINE, 1, "SOURCE", "VELLANE", laneId++, -1, &lineLane))
-				{
-					lp.parse(lineLane.Get());
-					m_ccLanes.push_back(lp.gettoken_int(1));
-					m_ccLanesHeight.push_back(lp.gettoken_int(((m_midiEditor) ? 2 : 3)));
-					if (!m_midiEditor && m_ccLanesHeight.back() == 0)
-						m_ccLanesHeight.back() = INLINE_MIDI_LANE_DIVIDER_H; // sometimes REAPER will return 0 when lane is completely hidden, but divider will still be visible
-					lineLane.DeleteSub(0, lineLane.GetLength());
-				}
+static const char* SkipChunkLine (const char* line)
+{
+	const char* next = strchr(line, '\n');
+	return (next) ? (next + 1) : (line + strlen(line));
+}
 
-				WDL_FastString dataLine;
-				if (ptk.Parse(SNM_GET_SUBCHUNK_OR_LINE, 1, "SOURCE", "HASDATA", 0, -1, &dataLine))
-				{
-					lp.parse(dataLine.Get());
-					m_ppq = lp.gettoken_int(2);
-				}
-				else if (ptk.Parse(SNM_GET_SUBCHUNK_OR_LINE, 1, "SOURCE", "FILE", 0, -1, &dataLine))
-				{
-					lp.parse(dataLine.Get());
-					m_ppq = GetMIDIFilePPQ (lp.gettoken_str(1));
-					if (!m_ppq)
-						return false;
-				}
-				else
-					return false;
+static bool IsChunkToken (const char* line, const char* token, size_t tokenLen)
+{
+	return !strncmp(line, token, tokenLen) && (line[tokenLen] == ' ' || line[tokenLen] == '\n' || line[tokenLen] == '\r' || line[tokenLen] == '\0');
+}
 
-				WDL_FastString lineView;
-				if (ptk.Parse(SNM_GET_SUBCHUNK_OR_LINE, 1, "SOURCE", "CFGEDITVIEW", 0, -1, &lineView))
-				{
-					lp.parse(lineView.Get());
-					m_startPos = (m_midiEditor) ? lp.gettoken_float(1) : GetMediaItemInfo_Value(GetMediaItemTake_Item(m_take), "D_POSITION");
-					m_hZoom    = (m_midiEditor) ? lp.gettoken_float(2) : GetHZoomLevel();
-					m_vPos     = (m_midiEditor) ? lp.gettoken_int(3) : lp.gettoken_int(7);
-					m_vZoom    = (m_midiEditor) ? lp.gettoken_int(4) : lp.gettoken_int(6);
-				}
-				else
-					return false;
+static bool ExtractMidiViewState (const char* itemChunk, int takeId, WDL_FastString* sourceChunk)
+{
+	// Take counting follows SNM_TakeParserPatcher: first take starts on the first NAME line (or earlier TAKE line for empty takes)
+	static const char* s_keys[] = {"VELLANE", "HASDATA", "FILE", "CFGEDITVIEW", "EVTFILTER", "CFGEDIT"};
 
-				WDL_FastString lineFilter;
-				if (ptk.Parse(SNM_GET_SUBCHUNK_OR_LINE, 1, "SOURCE", "EVTFILTER", 0, -1, &lineFilter))
-				{
-					lp.parse(lineFilter.Get());
-					m_filterEnabled        = !!GetBit(lp.gettoken_int(7), 0);
-					m_filterInverted       = !!GetBit(lp.gettoken_int(7), 2);
-					m_filterChannel        = lp.gettoken_int(1);
-					m_filterEventType      = lp.gettoken_int(2);
-					m_filterEventParam     = !!lp.gettoken_int(16);
-					m_filterEventVal       = !!lp.gettoken_int(8);
-					m_filterEventPos       = !!lp.gettoken_int(14);
-					m_filterEventLen       = !!lp.gettoken_int(9);
-					m_filterEventParamLo   = lp.gettoken_int(17);
-					m_filterEventParamHi   = lp.gettoken_int(18);
-					m_filterEventValLo     = lp.gettoken_int(4);
-					m_filterEventValHi     = lp.gettoken_int(5);
-					m_filterEventPosRepeat = lp.gettoken_float(15);
-					m_filterEventPosLo     = lp.gettoken_float(12);
-					m_filterEventPosHi     = lp.gettoken_float(13);
-					m_filterEventLenLo     = lp.gettoken_float(10);
-					m_filterEventLenHi     = lp.gettoken_float(11);
-				}
-				else
-					return false;
+	int depth = 0;
+	int currentTake = -1;
+	bool foundName = false;
+	bool inSource = false;
+
+	for (const char* line = itemChunk; *line; )
+	{
+		while (*line == ' ' || *line == '\t')
+			++line;
+
+		// Skip MIDI events as fast as possible, they make most of the chunk
+		if (inSource && depth == 2 && (*line == 'E' || *line == 'e' || *line == 'X' || *line == 'x') && line[1] == ' ')
+		{
+			line = SkipChunkLine(line);
+			continue;
+		}
 
-				WDL_FastString lineProp;
-				if (ptk.Parse(SNM_GET_SUBCHUNK_OR_LINE, 1, "SOURCE", "CFGEDIT", 0, -1, &lineProp))
+		const char* next = SkipChunkLine(line);
+		if (*line == '<')
+		{
+			if (depth == 1 && currentTake == takeId && IsChunkToken(line + 1, "SOURCE", 6))
+			{
+				inSource = true;
+				sourceChunk->Set("<SOURCE\n");
+			}
+			++depth;
+		}
+		else if (*line == '>')
+		{
+			if (--depth == 1 && inSource)
+			{
+				sourceChunk->Append(">\n");
+				return true;
+			}
+		}
+		else if (depth == 1)
+		{
+			if (IsChunkToken(line, "TAKE", 4) || (!foundName && IsChunkToken(line, "NAME", 4)))
+			{
+				foundName |= (*line == 'N');
+				if (++currentTake > takeId)
+					return false;
+			}
+		}
+		else if (depth == 2 && inSource)
+		{
+			for (size_t i = 0; i < sizeof(s_keys) / sizeof(s_keys[0]); ++i)
+			{
+				if (IsChunkToken(line, s_keys[i], strlen(s_keys[i])))
 				{
-					lp.parse(lineProp.Get());
-					m_pianoroll    = (m_midiEditor) ? lp.gettoken_int(6) : 0; // inline midi editor doesn't have piano roll modes
-					m_drawChannel  = lp.gettoken_int(9) - 1;
-					m_noteshow     = lp.gettoken_int(18);
-					m_timebase     = (m_midiEditor) ? lp.gettoken_int(19) : PROJECT_SYNC;
+					int len = (int)(next - line);
+					while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+						--len;
+					sourceChunk->Append(line, len);
+					sourceChunk->Append("\n");
+					break;
 				}
-				else
+			}
+		}
+		line = next;
+	}
+	return false;
+}
+
+static bool GetMidiViewState (MediaItem_Take* take, HWND midiEditor, WDL_FastString* sourceChunk)
+{
+	// Entries of all takes share the same project state (also keeps the map from growing with stale take pointers)
+	int projStateCount = GetProjectStateChangeCount(NULL);
+	unsigned int objStateWrites = SWS_GetObjectStateWriteCount();
+	if (projStateCount != g_midiViewStatesProjState || objStateWrites != g_midiViewStatesObjWrites)
+	{
+		g_midiViewStates.clear();
+		g_midiViewStatesProjState = projStateCount;
+		g_midiViewStatesObjWrites = objStateWrites;
+	}
+
+	MediaItem* item = GetMediaItemTake_Item(take);
+	int signature[MIDI_VIEW_SIGNATURE_SIZE];
+	GetMidiViewSignature(take, midiEditor, signature);
+
+	map<MediaItem_Take*,BR_MidiViewState>::iterator it = g_midiViewStates.find(take);
+	if (it != g_midiViewStates.end() && it->second.item == item && !memcmp(it->second.signature, signature, sizeof(signature)))
+	{
+		sourceChunk->Set(&it->second.sourceChunk);
+		return true;
+	}
+
+	int takeId = GetTakeId(take, item);
+	if (takeId < 0)
+		return false;
+
+	bool found = false;
+	const char* itemChunk = SWS_GetSetObjectState(item, NULL);
+	if (itemChunk)
+	{
+		found = ExtractMidiViewState(itemChunk, takeId, sourceChunk);
+		SWS_FreeHeapPtr(itemChunk);
+	}
+
+	if (found)
+	{
+		if (!g_midiViewStatesTimer)
+		{
+			plugin_register("timer", (void*)InvalidateMidiEditorViewStates);
+			g_midiViewStatesTimer = true;
+		}
+
+		BR_MidiViewState& viewState = g_midiViewStates[take];
+		viewState.sourceChunk.Set(sourceChunk);
+		viewState.item = item;
+		memcpy(viewState.signature, signature, sizeof(signature));
+	}
+	return found;
+}
+
+bool BR_MidiEditor::Build ()
+{
+	m_take = (m_midiEditor) ? MIDIEditor_GetTake(m_midiEditor) : m_take;
+
+	if (m_take)
+	{
+		WDL_FastString takeChunk;
+		if (GetMidiViewState(m_take, m_midiEditor, &takeChunk))
+		{
+			SNM_ChunkParserPatcher ptk(&takeChunk, false);
+			LineParser lp(false);
+
+			int laneId = 0;
+			WDL_FastString lineLane;
+			while (ptk.Parse(SNM_GET_SUBCHUNK_OR_LINE, 1, "SOURCE", "VELLANE", laneId++, -1, &lineLane))
+			{
+				lp.parse(lineLane.Get());
+				m_ccLanes.push_back(lp.gettoken_int(1));
+				m_ccLanesHeight.push_back(lp.gettoken_int(((m_midiEditor) ? 2 : 3)));
+				if (!m_midiEditor && m_ccLanesHeight.back() == 0)
+					m_ccLanesHeight.back() = INLINE_MIDI_LANE_DIVIDER_H; // sometimes REAPER will return 0 when lane is completely hidden, but divider will still be visible
+				lineLane.DeleteSub(0, lineLane.GetLength());
+			}
+
+			WDL_FastString dataLine;
+			if (ptk.Parse(SNM_GET_SUBCHUNK_OR_LINE, 1, "SOURCE", "HASDATA", 0, -1, &dataLine))
+			{
+				lp.parse(dataLine.Get());
+				m_ppq = lp.gettoken_int(2);
+			}
+			else if (ptk.Parse(SNM_GET_SUBCHUNK_OR_LINE, 1, "SOURCE", "FILE", 0, -1, &dataLine))
+			{
+				lp.parse(dataLine.Get());
+				m_ppq = GetMIDIFilePPQ (lp.gettoken_str(1));
+				if (!m_ppq)
 					return false;
+			}
+			else
+				return false;
 
-				// A few "corrections" for easier manipulation afterwards
-				if (m_filterChannel == 0)     m_filterChannel = ~m_filterChannel;
-				if (m_filterEventParamLo < 0) m_filterEventParamLo = 0;
-				if (m_filterEventParamHi < 0) m_filterEventParamHi = INT_MAX;
-				if (m_filterEventValLo   < 0) m_filterEventValLo   = 0;
-				if (m_filterEventValHi   < 0) m_filterEventValHi   = INT_MAX;
-				if (m_filterEventPosLo   < 0) m_filterEventPosLo   = 0;
-				if (m_filterEventPosHi   < 0) m_filterEventPosHi   = INT_MAX;
-				m_filterEventLenLo     = (m_filterEventLenLo     < 0) ? (0)       : (m_ppq * 4 * m_filterEventLenLo);
-				m_filterEventLenHi     = (m_filterEventLenHi     < 0) ? (INT_MAX) : (m_ppq * 4 * m_filterEventLenHi);
-				m_filterEventPosLo     = (m_filterEventPosLo     < 0) ? (0)       : (m_ppq * 4 * m_filterEventPosLo);
-				m_filterEventPosHi     = (m_filterEventPosHi     < 0) ? (INT_MAX) : (m_ppq * 4 * m_filterEventPosHi);
-				m_filterEventPosRepeat = (m_filterEventPosRepeat < 0) ? (0)       : (m_ppq * 4 * m_filterEventPosRepeat);
+			WDL_FastString lineView;
+			if (ptk.Parse(SNM_GET_SUBCHUNK_OR_LINE, 1, "SOURCE", "CFGEDITVIEW", 0, -1, &lineView))
+			{
+				lp.parse(lineView.Get());
+				m_startPos = (m_midiEditor) ? lp.gettoken_float(1) : GetMediaItemInfo_Value(GetMediaItemTake_Item(m_take), "D_POSITION");
+				m_hZoom    = (m_midiEditor) ? lp.gettoken_float(2) : GetHZoomLevel();
+				m_vPos     = (m_midiEditor) ? lp.gettoken_int(3) : lp.gettoken_int(7);
+				m_vZoom    = (m_midiEditor) ? lp.gettoken_int(4) : lp.gettoken_int(6);
+			}
+			else
+				return false;
 
-				return true;
+			WDL_FastString lineFilter;
+			if (ptk.Parse(SNM_GET_SUBCHUNK_OR_LINE, 1, "SOURCE", "EVTFILTER", 0, -1, &lineFilter))
+			{
+				lp.parse(lineFilter.Get());
+				m_filterEnabled        = !!GetBit(lp.gettoken_int(7), 0);
+				m_filterInverted       = !!GetBit(lp.gettoken_int(7), 2);
+				m_filterChannel        = lp.gettoken_int(1);
+				m_filterEventType      = lp.gettoken_int(2);
+				m_filterEventParam     = !!lp.gettoken_int(16);
+				m_filterEventVal       = !!lp.gettoken_int(8);
+				m_filterEventPos       = !!lp.gettoken_int(14);
+				m_filterEventLen       = !!lp.gettoken_int(9);
+				m_filterEventParamLo   = lp.gettoken_int(17);
+				m_filterEventParamHi   = lp.gettoken_int(18);
+				m_filterEventValLo     = lp.gettoken_int(4);
+				m_filterEventValHi     = lp.gettoken_int(5);
+				m_filterEventPosRepeat = lp.gettoken_float(15);
+				m_filterEventPosLo     = lp.gettoken_float(12);
+				m_filterEventPosHi     = lp.gettoken_float(13);
+				m_filterEventLenLo     = lp.gettoken_float(10);
+				m_filterEventLenHi     = lp.gettoken_float(11);
 			}
+			else
+				return false;
+
+			WDL_FastString lineProp;
+			if (ptk.Parse(SNM_GET_SUBCHUNK_OR_LINE, 1, "SOURCE", "CFGEDIT", 0, -1, &lineProp))
+			{
+				lp.parse(lineProp.Get());
+				m_pianoroll    = (m_midiEditor) ? lp.gettoken_int(6) : 0; // inline midi editor doesn't have piano roll modes
+				m_drawChannel  = lp.gettoken_int(9) - 1;
+				m_noteshow     = lp.gettoken_int(18);
+				m_timebase     = (m_midiEditor) ? lp.gettoken_int(19) : PROJECT_SYNC;
+			}
+			else
+				return false;
+
+			// A few "corrections" for easier manipulation afterwards
+			if (m_filterChannel == 0)     m_filterChannel = ~m_filterChannel;
+			if (m_filterEventParamLo < 0) m_filterEventParamLo = 0;
+			if (m_filterEventParamHi < 0) m_filterEventParamHi = INT_MAX;
+			if (m_filterEventValLo   < 0) m_filterEventValLo   = 0;
+			if (m_filterEventValHi   < 0) m_filterEventValHi   = INT_MAX;
+			if (m_filterEventPosLo   < 0) m_filterEventPosLo   = 0;
+			if (m_filterEventPosHi   < 0) m_filterEventPosHi   = INT_MAX;
+			m_filterEventLenLo     = (m_filterEventLenLo     < 0) ? (0)       : (m_ppq * 4 * m_filterEventLenLo);
+			m_filterEventLenHi     = (m_filterEventLenHi     < 0) ? (INT_MAX) : (m_ppq * 4 * m_filterEventLenHi);
+			m_filterEventPosLo     = (m_filterEventPosLo     < 0) ? (0)       : (m_ppq * 4 * m_filterEventPosLo);
+			m_filterEventPosHi     = (m_filterEventPosHi     < 0) ? (INT_MAX) : (m_ppq * 4 * m_filterEventPosHi);
+			m_filterEventPosRepeat = (m_filterEventPosRepeat < 0) ? (0)       : (m_ppq * 4 * m_filterEventPosRepeat);
+
+			return true;
 		}
 	}
 	return false;
@@ -681,6 +888,330 @@ take (take)
 	sysEvents.reserve(sysCount);
 }
 
+/******************************************************************************
+* BR_MidiEvents                                                               *
+******************************************************************************/
+BR_MidiEvents::BR_MidiEvents (MediaItem_Take* take) :
+m_take      (take),
+m_valid     (false),
+m_edited    (false),
+m_deletions (false)
+{
+	m_valid = this->Build();
+}
+
+bool BR_MidiEvents::IsValid ()
+{
+	return m_valid;
+}
+
+bool BR_MidiEvents::Commit ()
+{
+	if (!m_valid || !m_edited)
+		return false;
+
+	// Positions are absolute so deleted events' offsets don't need to be carried over
+	vector<char> buf;
+	buf.reserve(m_msgs.size() + m_pos.size() * 9);
+	double lastPos = 0;
+	for (size_t i = 0; i < m_pos.size(); ++i)
+	{
+		if (m_deleted[i])
+			continue;
+
+		int offset = (int)(m_pos[i] - lastPos);
+		int size   = m_msgSize[i];
+		lastPos = m_pos[i];
+
+		size_t p = buf.size();
+		buf.resize(p + 9 + size);
+		memcpy(&buf[p], &offset, 4);
+		buf[p + 4] = (char)m_flags[i];
+		memcpy(&buf[p + 5], &size, 4);
+		if (size > 0)
+			memcpy(&buf[p + 9], &m_msgs[m_msgOffset[i]], size);
+	}
+
+	bool committed = MIDI_SetAllEvts(m_take, buf.size() ? &buf[0] : "", (int)buf.size());
+	m_edited = false;
+
+	// Ids of events following deleted ones changed
+	if (m_deletions)
+		m_valid = this->Build();
+	return committed;
+}
+
+int BR_MidiEvents::CountEvts (int* noteCount, int* ccCount, int* sysCount)
+{
+	WritePtr(noteCount, (int)m_noteOns.size());
+	WritePtr(ccCount,   (int)m_ccs.size());
+	WritePtr(sysCount,  (int)m_sys.size());
+	return (int)(m_noteOns.size() + m_ccs.size() + m_sys.size());
+}
+
+bool BR_MidiEvents::GetNote (int id, bool* selected, bool* muted, double* startPpq, double* endPpq, int* chan, int* pitch, int* vel)
+{
+	if (!this->IsEvent(m_noteOns, id))
+		return false;
+
+	int evt = m_noteOns[id];
+	int off = m_noteOffs[id];
+	const unsigned char* msg = this->GetMsg(evt);
+	WritePtr(selected, !!(m_flags[evt] & FLAG_SELECTED));
+	WritePtr(muted,    !!(m_flags[evt] & FLAG_MUTED));
+	WritePtr(startPpq, m_pos[evt]);
+	WritePtr(endPpq,   (off >= 0) ? m_pos[off] : m_pos[evt]);
+	WritePtr(chan,     (int)(msg[0] & 0x0F));
+	WritePtr(pitch,    (int)msg[1]);
+	WritePtr(vel,      (int)msg[2]);
+	return true;
+}
+
+bool BR_MidiEvents::GetCC (int id, bool* selected, bool* muted, double* ppqPos, int* chanMsg, int* chan, int* msg2, int* msg3)
+{
+	if (!this->IsEvent(m_ccs, id))
+		return false;
+
+	int evt = m_ccs[id];
+	const unsigned char* msg = this->GetMsg(evt);
+	WritePtr(selected, !!(m_flags[evt] & FLAG_SELECTED));
+	WritePtr(muted,    !!(m_flags[evt] & FLAG_MUTED));
+	WritePtr(ppqPos,   m_pos[evt]);
+	WritePtr(chanMsg,  (int)(msg[0] & 0xF0));
+	WritePtr(chan,     (int)(msg[0] & 0x0F));
+	WritePtr(msg2,     (int)msg[1]);
+	WritePtr(msg3,     (m_msgSize[evt] > 2) ? (int)msg[2] : 0);
+	return true;
+}
+
+bool BR_MidiEvents::GetTextSysexEvt (int id, bool* selected, bool* muted, double* ppqPos, int* type)
+{
+	if (!this->IsEvent(m_sys, id))
+		return false;
+
+	int evt = m_sys[id];
+	const unsigned char* msg = this->GetMsg(evt);
+	WritePtr(selected, !!(m_flags[evt] & FLAG_SELECTED));
+	WritePtr(muted,    !!(m_flags[evt] & FLAG_MUTED));
+	WritePtr(ppqPos,   m_pos[evt]);
+	WritePtr(type,     (msg[0] == 0xFF) ? (int)msg[1] : -1);
+	return true;
+}
+
+int BR_MidiEvents::EnumSelNotes (int id)
+{
+	return this->EnumSel(m_noteOns, id);
+}
+
+int BR_MidiEvents::EnumSelCC (int id)
+{
+	return this->EnumSel(m_ccs, id);
+}
+
+int BR_MidiEvents::EnumSelTextSysexEvts (int id)
+{
+	return this->EnumSel(m_sys, id);
+}
+
+void BR_MidiEvents::SetNoteSelected (int id, bool selected)
+{
+	if (this->IsEvent(m_noteOns, id))
+	{
+		this->SetFlag(m_noteOns[id], FLAG_SELECTED, selected);
+		if (m_noteOffs[id] >= 0)
+			this->SetFlag(m_noteOffs[id], FLAG_SELECTED, selected);
+	}
+}
+
+void BR_MidiEvents::SetNoteMuted (int id, bool muted)
+{
+	if (this->IsEvent(m_noteOns, id))
+	{
+		this->SetFlag(m_noteOns[id], FLAG_MUTED, muted);
+		if (m_noteOffs[id] >= 0)
+			this->SetFlag(m_noteOffs[id], FLAG_MUTED, muted);
+	}
+}
+
+void BR_MidiEvents::SetCCSelected (int id, bool selected)
+{
+	if (this->IsEvent(m_ccs, id))
+	{
+		this->SetFlag(m_ccs[id], FLAG_SELECTED, selected);
+		if (m_ccBeziers[id] >= 0)
+			this->SetFlag(m_ccBeziers[id], FLAG_SELECTED, selected);
+	}
+}
+
+void BR_MidiEvents::SetTextSysexSelected (int id, bool selected)
+{
+	if (this->IsEvent(m_sys, id))
+		this->SetFlag(m_sys[id], FLAG_SELECTED, selected);
+}
+
+void BR_MidiEvents::DeleteCC (int id)
+{
+	if (this->IsEvent(m_ccs, id))
+	{
+		this->Delete(m_ccs[id]);
+		if (m_ccBeziers[id] >= 0) // would end up attached to whatever event precedes the CC otherwise
+			this->Delete(m_ccBeziers[id]);
+	}
+}
+
+void BR_MidiEvents::DeleteTextSysexEvt (int id)
+{
+	if (this->IsEvent(m_sys, id))
+		this->Delete(m_sys[id]);
+}
+
+bool BR_MidiEvents::Build ()
+{
+	m_pos.clear();
+	m_flags.clear();
+	m_msgOffset.clear();
+	m_msgSize.clear();
+	m_deleted.clear();
+	m_msgs.clear();
+	m_noteOns.clear();
+	m_noteOffs.clear();
+	m_ccs.clear();
+	m_ccBeziers.clear();
+	m_sys.clear();
+	m_deletions = false;
+
+	if (!m_take)
+		return false;
+
+	// MIDI_GetAllEvts doesn't tell the required size, grow the buffer until all events fit
+	int noteCount, ccCount, sysCount;
+	int evtCount = MIDI_CountEvts(m_take, &noteCount, &ccCount, &sysCount);
+	vector<char> buf;
+	int bufSz = 0;
+	for (int size = max(65536, (evtCount + noteCount + 1) * 16); size <= 256*1024*1024; size *= 2)
+	{
+		buf.resize(size);
+		bufSz = size;
+		if (MIDI_GetAllEvts(m_take, &buf[0], &bufSz) && bufSz < size)
+			break;
+		bufSz = -1;
+	}
+	if (bufSz < 0)
+		return false;
+
+	// Decode: int offset (ticks since previous event), char flags, int msg size, msg
+	m_msgs.reserve(bufSz);
+	map<int, vector<int> > openNotes; // chan << 7 | pitch -> note ids, closed in order
+	double pos = 0;
+	int p = 0;
+	while (p + 9 <= bufSz)
+	{
+		int offset, size;
+		memcpy(&offset, &buf[p], 4);
+		memcpy(&size, &buf[p + 5], 4);
+		if (size < 0 || p + 9 + size > bufSz)
+			break;
+
+		pos += offset;
+		int evt = (int)m_pos.size();
+		m_pos.push_back(pos);
+		m_flags.push_back((unsigned char)buf[p + 4]);
+		m_msgOffset.push_back((int)m_msgs.size());
+		m_msgSize.push_back(size);
+		m_deleted.push_back(false);
+		m_msgs.insert(m_msgs.end(), (unsigned char*)&buf[p + 9], (unsigned char*)&buf[p + 9] + size);
+		p += 9 + size;
+
+		if (size == 0)
+			continue;
+		const unsigned char* msg = this->GetMsg(evt);
+		int status = msg[0] & 0xF0;
+
+		if (size >= 3 && (status == STATUS_NOTE_ON || status == STATUS_NOTE_OFF))
+		{
+			int key = (msg[0] & 0x0F) << 7 | (msg[1] & 0x7F);
+			if (status == STATUS_NOTE_ON && msg[2] > 0)
+			{
+				openNotes[key].push_back((int)m_noteOns.size());
+				m_noteOns.push_back(evt);
+				m_noteOffs.push_back(-1);
+			}
+			else
+			{
+				vector<int>& open = openNotes[key];
+				if (open.size())
+				{
+					m_noteOffs[open.front()] = evt;
+					open.erase(open.begin());
+				}
+			}
+		}
+		else if (size >= 2 && status >= STATUS_POLY_PRESSURE && status <= STATUS_PITCH)
+		{
+			m_ccs.push_back(evt);
+			m_ccBeziers.push_back(-1);
+		}
+		else if (size >= 2 && msg[0] == 0xFF && msg[1] == 0x0F && offset == 0 && m_ccs.size() && m_ccs.back() == evt - 1)
+		{
+			// Bezier shape of the preceding CC, it's not part of REAPER's text/sysex ids and has to stay right after its CC
+			m_ccBeziers.back() = evt;
+		}
+		else if (msg[0] == 0xF0 || (msg[0] == 0xFF && size >= 2))
+		{
+			m_sys.push_back(evt);
+		}
+	}
+
+	// Last event is the all-notes-off marking the end of the source, it's not part of REAPER's CC ids and must be kept
+	if (m_ccs.size() && m_ccs.back() == (int)m_pos.size() - 1)
+	{
+		const unsigned char* msg = this->GetMsg(m_ccs.back());
+		if ((msg[0] & 0xF0) == STATUS_CC && msg[1] == 123)
+		{
+			m_ccs.pop_back();
+			m_ccBeziers.pop_back();
+		}
+	}
+	return true;
+}
+
+bool BR_MidiEvents::IsEvent (const vector<int>& ids, int id)
+{
+	return id >= 0 && id < (int)ids.size() && !m_deleted[ids[id]];
+}
+
+int BR_MidiEvents::EnumSel (const vector<int>& ids, int id)
+{
+	for (int i = max(id + 1, 0); i < (int)ids.size(); ++i)
+	{
+		if (!m_deleted[ids[i]] && (m_flags[ids[i]] & FLAG_SELECTED))
+			return i;
+	}
+	return -1;
+}
+
+void BR_MidiEvents::SetFlag (int evt, int flag, bool set)
+{
+	unsigned char flags = set ? (m_flags[evt] | flag) : (m_flags[evt] & ~flag);
+	if (flags != m_flags[evt])
+	{
+		m_flags[evt] = flags;
+		m_edited = true;
+	}
+}
+
+void BR_MidiEvents::Delete (int evt)
+{
+	m_deleted[evt] = true;
+	m_edited       = true;
+	m_deletions    = true;
+}
+
+const unsigned char* BR_MidiEvents::GetMsg (int evt)
+{
+	return &m_msgs[m_msgOffset[evt]];
+}
+
 /******************************************************************************
 * Mouse cursor                                                                *
 ******************************************************************************/
@@ -781,8 +1312,9 @@ set<int> GetUsedCCLanes (HWND midiEditor, int detect14bit, bool selectedEventsOn
 	MediaItem_Take* take = MIDIEditor_GetTake(midiEditor);
 	set<int> usedCC;
 
+	BR_MidiEvents events(take);
 	int noteCount, ccCount, sysCount;
-	if (take && MIDI_CountEvts(take, &noteCount, &ccCount, &sysCount))
+	if (take && events.CountEvts(&noteCount, &ccCount, &sysCount))
 	{
 		BR_MidiEditor editor(midiEditor);
 
@@ -791,7 +1323,7 @@ set<int> GetUsedCCLanes (HWND midiEditor, int detect14bit, bool selectedEventsOn
 		{
 			int chanMsg, chan, msg2;
 			bool selected;
-			if (!MIDI_GetCC(take, id, &selected, NULL, NULL, &chanMsg, &chan, &msg2, NULL) || !editor.IsCCVisible(take, id) || (selectedEventsOnly && !selected))
+			if (!events.GetCC(id, &selected, NULL, NULL, &chanMsg, &chan, &msg2, NULL) || !editor.IsCCVisible(take, events, id) || (selectedEventsOnly && !selected))
 				continue;
 
 			if      (chanMsg == STATUS_PROGRAM)          usedCC.insert(CC_PROGRAM);
@@ -810,16 +1342,16 @@ set<int> GetUsedCCLanes (HWND midiEditor, int detect14bit, bool selectedEventsOn
 					if (msg2 <= 31)
 					{
 						int tmpId = id;
-						if (MIDI_GetCC(take, tmpId + 1, NULL, NULL, NULL, NULL, NULL, NULL, NULL))
+						if (events.GetCC(tmpId + 1, NULL, NULL, NULL, NULL, NULL, NULL, NULL))
 						{
 							double pos;
-							MIDI_GetCC(take, id, NULL, NULL, &pos, NULL, NULL, NULL, NULL);
+							events.GetCC(id, NULL, NULL, &pos, NULL, NULL, NULL, NULL);
 
 							while (true)
 							{
 								double nextPos;
 								int nextChanMsg, nextChan, nextMsg2;
-								MIDI_GetCC(take, ++tmpId, NULL, NULL, &nextPos, &nextChanMsg, &nextChan, &nextMsg2, NULL);
+								events.GetCC(++tmpId, NULL, NULL, &nextPos, &nextChanMsg, &nextChan, &nextMsg2, NULL);
 								if (tmpId >= ccCount)
 									break;
 								if (nextPos > pos)
@@ -852,16 +1384,16 @@ set<int> GetUsedCCLanes (HWND midiEditor, int detect14bit, bool selectedEventsOn
 					else if (detect14bit == 2)
 					{
 						int tmpId = id;
-						if (MIDI_GetCC(take, tmpId - 1, NULL, NULL, NULL, NULL, NULL, NULL, NULL))
+						if (events.GetCC(tmpId - 1, NULL, NULL, NULL, NULL, NULL, NULL, NULL))
 						{
 							double pos;
-							MIDI_GetCC(take, id, NULL, NULL, &pos, NULL, NULL, NULL, NULL);
+							events.GetCC(id, NULL, NULL, &pos, NULL, NULL, NULL, NULL);
 
 							while (true)
 							{
 								double prevPos;
 								int prevChanMsg, prevChan, prevMsg2;
-								MIDI_GetCC(take, --tmpId, NULL, NULL, &prevPos, &prevChanMsg, &prevChan, &prevMsg2, NULL);
+								events.GetCC(--tmpId, NULL, NULL, &prevPos, &prevChanMsg, &prevChan, &prevMsg2, NULL);
 								if (prevPos < pos)
 								{
 									if (detect14bit == 2)
@@ -895,7 +1427,7 @@ set<int> GetUsedCCLanes (HWND midiEditor, int detect14bit, bool selectedEventsOn
 		for (int i = 0; i < noteCount; ++i)
 		{
 			bool selected; int chan;
-			MIDI_GetNote(take, i, &selected, NULL, NULL, NULL, &chan, NULL, NULL);
+			events.GetNote(i, &selected, NULL, NULL, NULL, &chan, NULL, NULL);
 			if (editor.IsChannelVisible(chan) && (!selectedEventsOnly || (selectedEventsOnly && selected)))
 			{
 				usedCC.insert(-1);
@@ -908,7 +1440,7 @@ set<int> GetUsedCCLanes (HWND midiEditor, int detect14bit, bool selectedEventsOn
 		{
 			bool selected;
 			int type = 0;
-			MIDI_GetTextSysexEvt(take, i, &selected, NULL, NULL, &type, NULL, NULL);
+			events.GetTextSysexEvt(i, &selected, NULL, NULL, &type);
 
 			if (type == -1)
 			{
@@ -938,8 +1470,9 @@ set<int> GetUsedCCLanes (HWND midiEditor, int detect14bit, bool selectedEventsOn
 
 double EffectiveMidiTakeStart (MediaItem_Take* take, bool ignoreMutedEvents, bool ignoreTextEvents, bool ignoreEventsOutsideItemBoundaries)
 {
+	BR_MidiEvents events(take);
 	int noteCount, ccCount, sysCount;
-	if (take && MIDI_CountEvts(take, &noteCount, &ccCount, &sysCount))
+	if (take && events.CountEvts(&noteCount, &ccCount, &sysCount))
 	{
 		MediaItem* item = GetMediaItemTake_Item(take);
 		double itemStart = GetMediaItemInfo_Value(item, "D_POSITION");
@@ -956,7 +1489,7 @@ double EffectiveMidiTakeStart (MediaItem_Take* take, bool ignoreMutedEvents, boo
 		for (int i = 0; i < noteCount; ++i)
 		{
 			bool muted; double start, end;
-			MIDI_GetNote(take, i, NULL, &muted, &start, &end, NULL, NULL, NULL);
+			events.GetNote(i, NULL, &muted, &start, &end, NULL, NULL, NULL);
 			if ((ignoreMutedEvents && !muted) || !ignoreMutedEvents)
 			{
 				if (!ignoreEventsOutsideItemBoundaries)
@@ -994,7 +1527,7 @@ double EffectiveMidiTakeStart (MediaItem_Take* take, bool ignoreMutedEvents, boo
 		for (int i = 0; i < ccCount; ++i)
 		{
 			bool muted; double pos;
-			MIDI_GetCC(take, i, NULL, &muted, &pos, NULL, NULL, NULL, NULL);
+			events.GetCC(i, NULL, &muted, &pos, NULL, NULL, NULL, NULL);
 			if ((ignoreMutedEvents && !muted) || !ignoreMutedEvents)
 			{
 				if (!ignoreEventsOutsideItemBoundaries)
@@ -1029,7 +1562,7 @@ double EffectiveMidiTakeStart (MediaItem_Take* take, bool ignoreMutedEvents, boo
 		for (int i = 0; i < sysCount; ++i)
 		{
 			bool muted; double pos; int type;
-			MIDI_GetTextSysexEvt(take, i, NULL, &muted, &pos, &type, NULL, NULL);
+			events.GetTextSysexEvt(i, NULL, &muted, &pos, &type);
 			if (((ignoreMutedEvents && !muted) || !ignoreMutedEvents) && ((ignoreTextEvents && type == -1) || !ignoreTextEvents))
 			{
 				if (!ignoreEventsOutsideItemBoundaries)
@@ -1081,8 +1614,9 @@ double EffectiveMidiTakeStart (MediaItem_Take* take, bool ignoreMutedEvents, boo
 
 double EffectiveMidiTakeEnd (MediaItem_Take* take, bool ignoreMutedEvents, bool ignoreTextEvents, bool ignoreEventsOutsideItemBoundaries)
 {
+	BR_MidiEvents events(take);
 	int noteCount, ccCount, sysCount;
-	if (take && MIDI_CountEvts(take, &noteCount, &ccCount, &sysCount))
+	if (take && events.CountEvts(&noteCount, &ccCount, &sysCount))
 	{
 		MediaItem* item = GetMediaItemTake_Item(take);
 		double itemStart = GetMediaItemInfo_Value(item, "D_POSITION");
@@ -1096,7 +1630,7 @@ double EffectiveMidiTakeEnd (MediaItem_Take* take, bool ignoreMutedEvents, bool
 		for (int i = 0; i < noteCount; ++i)
 		{
 			bool muted; double noteStart, noteEnd;
-			MIDI_GetNote(take, i, NULL, &muted, &noteStart, &noteEnd, NULL, NULL, NULL);
+			events.GetNote(i, NULL, &muted, &noteStart, &noteEnd, NULL, NULL, NULL);
 			if (((ignoreMutedEvents && !muted) || !ignoreMutedEvents))
 			{
 				noteEnd += loopCount*sourceLenPPQ;
@@ -1134,7 +1668,7 @@ double EffectiveMidiTakeEnd (MediaItem_Take* take, bool ignoreMutedEvents, bool
 		for (int i = ccCount - 1; i >= 0; --i)
 		{
 			bool muted; double pos;
-			MIDI_GetCC(take, i, NULL, &muted, &pos, NULL, NULL, NULL, NULL);
+			events.GetCC(i, NULL, &muted, &pos, NULL, NULL, NULL, NULL);
 			if ((ignoreMutedEvents && !muted) || !ignoreMutedEvents)
 			{
 				pos += loopCount*sourceLenPPQ;
@@ -1174,7 +1708,7 @@ double EffectiveMidiTakeEnd (MediaItem_Take* take, bool ignoreMutedEvents, bool
 		for (int i = 0; i < sysCount; ++i)
 		{
 			bool muted; double pos; int type;
-			MIDI_GetTextSysexEvt(take, i, NULL, &muted, &pos, &type, NULL, NULL);
+			events.GetTextSysexEvt(i, NULL, &muted, &pos, &type);
 			if (((ignoreMutedEvents && !muted) || !ignoreMutedEvents) && ((ignoreTextEvents && type == -1) || !ignoreTextEvents))
 			{
 				pos += loopCount*sourceLenPPQ;
@@ -1314,8 +1848,9 @@ void SetSelectedNotes (MediaItem_Take* take, const vector<int>& selectedNotes, b
 	int selectedCount = selectedNotes.size();
 	int selectedId = (selectedCount > 0) ? (0) : (1);
 
+	BR_MidiEvents events(take);
 	int noteCount;
-	MIDI_CountEvts(take, &noteCount, NULL, NULL);
+	events.CountEvts(&noteCount, NULL, NULL);
 	for (int i = 0; i < noteCount; ++i)
 	{
 		bool selected = false;
@@ -1325,22 +1860,25 @@ void SetSelectedNotes (MediaItem_Take* take, const vector<int>& selectedNotes, b
 			++selectedId;
 		}
 
-		MIDI_SetNote(take, i, unselectOthers ? &selected : (selected ? &selected : NULL), NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+		if (unselectOthers || selected)
+			events.SetNoteSelected(i, selected);
 	}
+	events.Commit();
 }
 
 void UnselectAllEvents (MediaItem_Take* take, int lane)
 {
 	if (take)
 	{
+		BR_MidiEvents events(take);
 		if ((lane >= 0 && lane <= 127))
 		{
 			int id = -1;
-			while ((id = MIDI_EnumSelCC(take, id)) != -1)
+			while ((id = events.EnumSelCC(id)) != -1)
 			{
 				int cc, chanMsg;
-				if (MIDI_GetCC(take, id, NULL, NULL, NULL, &chanMsg, NULL, &cc, NULL) && chanMsg == STATUS_CC && cc == lane)
-					MIDI_SetCC(take, id, &g_bFalse, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+				if (events.GetCC(id, NULL, NULL, NULL, &chanMsg, NULL, &cc, NULL) && chanMsg == STATUS_CC && cc == lane)
+					events.SetCCSelected(id, false);
 			}
 		}
 		else if (lane == CC_PROGRAM || lane == CC_CHANNEL_PRESSURE || lane == CC_PITCH || lane == CC_BANK_SELECT)
@@ -1350,27 +1888,27 @@ void UnselectAllEvents (MediaItem_Take* take, int lane)
 
 			int type = (lane == CC_PROGRAM) ? (STATUS_PROGRAM) : ((lane == CC_CHANNEL_PRESSURE) ? STATUS_CHANNEL_PRESSURE : STATUS_PITCH);
 			int id = -1;
-			while ((id = MIDI_EnumSelCC(take, id)) != -1)
+			while ((id = events.EnumSelCC(id)) != -1)
 			{
 				int chanMsg;
-				if (MIDI_GetCC(take, id, NULL, NULL, NULL, &chanMsg, NULL, NULL, NULL) && chanMsg == type)
-					MIDI_SetCC(take, id, &g_bFalse, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+				if (events.GetCC(id, NULL, NULL, NULL, &chanMsg, NULL, NULL, NULL) && chanMsg == type)
+					events.SetCCSelected(id, false);
 			}
 		}
 		else if (lane == CC_VELOCITY || lane == CC_VELOCITY_OFF)
 		{
 			int id = -1;
-			while ((id = MIDI_EnumSelNotes(take, id)) != -1)
-				MIDI_SetNote(take, id, &g_bFalse, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+			while ((id = events.EnumSelNotes(id)) != -1)
+				events.SetNoteSelected(id, false);
 		}
 		else if (lane == CC_TEXT_EVENTS || lane == CC_SYSEX)
 		{
 			int id = -1;
-			while ((id = MIDI_EnumSelTextSysexEvts(take, id)) != -1)
+			while ((id = events.EnumSelTextSysexEvts(id)) != -1)
 			{
 				int type = 0;
-				if (MIDI_GetTextSysexEvt(take, id, NULL, NULL, NULL, &type, NULL, NULL) && ((lane == CC_SYSEX && type == -1) || (lane == CC_TEXT_EVENTS && type != -1)))
-					MIDI_SetTextSysexEvt(take, id, &g_bFalse, NULL, NULL, NULL, NULL, 0, NULL);
+				if (events.GetTextSysexEvt(id, NULL, NULL, NULL, &type) && ((lane == CC_SYSEX && type == -1) || (lane == CC_TEXT_EVENTS && type != -1)))
+					events.SetTextSysexSelected(id, false);
 			}
 		}
 		else if (lane >= CC_14BIT_START)
@@ -1379,13 +1917,14 @@ void UnselectAllEvents (MediaItem_Take* take, int lane)
 
 			int cc1 = lane - CC_14BIT_START;
 			int cc2 = cc1 + 32;
-			while ((id = MIDI_EnumSelCC(take, id)) != -1)
+			while ((id = events.EnumSelCC(id)) != -1)
 			{
 				int cc, chanMsg;
-				if (MIDI_GetCC(take, id, NULL, NULL, NULL, &chanMsg, NULL, &cc, NULL) && chanMsg == STATUS_CC && (cc == cc1 || cc == cc2))
-					MIDI_SetCC(take, id, &g_bFalse, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+				if (events.GetCC(id, NULL, NULL, NULL, &chanMsg, NULL, &cc, NULL) && chanMsg == STATUS_CC && (cc == cc1 || cc == cc2))
+					events.SetCCSelected(id, false);
 			}
 		}
+		events.Commit();
 	}
 }
 
@@ -1449,24 +1988,24 @@ bool IsVelLaneValid (int lane)
 
 bool DeleteEventsInLane (MediaItem_Take* take, int lane, bool selectedOnly, double startRangePpq, double endRangePpq, bool doRange)
 {
+	BR_MidiEvents events(take);
 	bool update = false;
 
 	if (lane == CC_SYSEX || lane == CC_TEXT_EVENTS)
 	{
-		int sysCount; MIDI_CountEvts(take, NULL, NULL, &sysCount);
+		int sysCount; events.CountEvts(NULL, NULL, &sysCount);
 		for (int i = 0; i < sysCount; ++i)
 		{
 			bool selected;
 			double position;
 			int type;
-			MIDI_GetTextSysexEvt(take, i, &selected, NULL, &position, &type, NULL, 0);
+			events.GetTextSysexEvt(i, &selected, NULL, &position, &type);
 
 			if ((!doRange || CheckBounds(position, startRangePpq, endRangePpq)) && ((lane == CC_SYSEX && type == -1) || (lane == CC_TEXT_EVENTS && CheckBounds(type, 1, 7))))
 			{
 				if (!selectedOnly || (selectedOnly && selected))
 				{
-					MIDI_DeleteTextSysexEvt(take, i);
-					--i;
+					events.DeleteTextSysexEvt(i);
 					update = true;
 				}
 			}
@@ -1478,25 +2017,26 @@ bool DeleteEventsInLane (MediaItem_Take* take, int lane, bool selectedOnly, doub
 		int lane1     = (lane >= CC_14BIT_START) ? lane - CC_14BIT_START : lane;
 		int lane2     = (lane >= CC_14BIT_START) ? lane + 32             : lane;
 
-		int ccCount; MIDI_CountEvts(take, NULL, &ccCount, NULL);
+		int ccCount; events.CountEvts(NULL, &ccCount, NULL);
 		for (int i = 0; i < ccCount; ++i)
 		{
 			bool selected;
 			double position;
 			int chanMsg, msg2, msg3;
-			MIDI_GetCC(take, i, &selected, NULL, &position, &chanMsg, NULL, &msg2, &msg3);
+			events.GetCC(i, &selected, NULL, &position, &chanMsg, NULL, &msg2, &msg3);
 
 			if ((!doRange || CheckBounds(position, startRangePpq, endRangePpq)) && chanMsg == eventType && (eventType != STATUS_CC || (lane1 == msg2 || lane2 == msg2)))
 			{
 				if (!selectedOnly || (selectedOnly && selected))
 				{
-					MIDI_DeleteCC(take, i);
-					--i;
+					events.DeleteCC(i);
 					update = true;
 				}
 			}
 		}
 	}
+	if (update)
+		events.Commit();
 	return update;
 }
 
@@ -1650,3 +2190,65 @@ int MapReaScriptCCToVelLane (int cc)
 	if (cc >= 0x100 && cc <= 0x11F) return cc - 122;
 	else                            return -2; // because -1 stands for velocity lane
 }
+
+#ifdef BR_DEBUG_PERFORMANCE_BENCHMARK
+// Invert selection of all notes in first generated take, once through MIDI_GetNote/MIDI_SetNote and once through BR_MidiEvents (one MIDI_GetAllEvts/MIDI_SetAllEvts round trip)
+static void BenchmarkMidiEvents (const BR_BenchmarkConfig& cfg, vector<BR_BenchmarkResult>& results)
+{
+	MediaItem* item = (cfg.notes > 0) ? GetTrackMediaItem(GetTrack(NULL, 0), 0) : NULL;
+	MediaItem_Take* take = item ? GetActiveTake(item) : NULL;
+	if (!take)
+		return;
+
+	BR_BenchmarkResult api("BR_MidiEvents/api"), events("BR_MidiEvents/buffer");
+	api.name.SetFormatted(256, "Selection inversion of %d notes (MIDI_GetNote/MIDI_SetNote)", cfg.notes);
+	events.name.SetFormatted(256, "Selection inversion of %d notes (BR_MidiEvents)", cfg.notes);
+
+	double checksum[2] = {0, 0};
+	int selected[2] = {0, 0};
+	for (int i = 0; i < cfg.iterations; ++i)
+	{
+		checksum[0] = checksum[1] = 0;
+		selected[0] = selected[1] = 0;
+
+		double start = time_precise();
+		int noteCount = 0;
+		MIDI_CountEvts(take, &noteCount, NULL, NULL);
+		bool noSort = true;
+		for (int j = 0; j < noteCount; ++j)
+		{
+			bool sel; double startPpq; int pitch, vel;
+			if (!MIDI_GetNote(take, j, &sel, NULL, &startPpq, NULL, NULL, &pitch, &vel))
+				continue;
+			checksum[0] += startPpq + pitch + vel;
+			selected[0] += sel ? 1 : 0;
+			sel = !sel;
+			MIDI_SetNote(take, j, &sel, NULL, NULL, NULL, NULL, NULL, NULL, &noSort);
+		}
+		MIDI_Sort(take);
+		api.AddTime(start);
+
+		start = time_precise();
+		BR_MidiEvents midiEvents(take);
+		int bufferNoteCount = 0;
+		midiEvents.CountEvts(&bufferNoteCount, NULL, NULL);
+		for (int j = 0; j < bufferNoteCount; ++j)
+		{
+			bool sel; double startPpq; int pitch, vel;
+			if (!midiEvents.GetNote(j, &sel, NULL, &startPpq, NULL, NULL, &pitch, &vel))
+				continue;
+			checksum[1] += startPpq + pitch + vel;
+			selected[1] += sel ? 0 : 1; // inverted by the API pass
+			midiEvents.SetNoteSelected(j, !sel);
+		}
+		midiEvents.Commit();
+		events.AddTime(start);
+	}
+
+	if (checksum[0] != checksum[1] || selected[0] != selected[1])
+		events.failure.SetFormatted(256, "notes differ from MIDI_GetNote (checksum %.3f vs %.3f, %d vs %d selected)", checksum[1], checksum[0], selected[1], selected[0]);
+	results.push_back(api);
+	results.push_back(events);
+}
+static BR_BenchmarkRegistration s_midiEventsBenchmark(BenchmarkMidiEvents);
+#endif
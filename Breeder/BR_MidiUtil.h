@@ -98,6 +98,8 @@ const int INLINE_MIDI_KEYBOARD_W             = 12;
 const int INLINE_MIDI_TOP_BAR_H              = 17;
 const int INLINE_MIDI_CC_LANE_CLICK_Y_OFFSET = 2;
 
+class BR_MidiEvents;
+
 /******************************************************************************
 * Class for managing normal or inline MIDI editor (read-only for now)         *
 ******************************************************************************/
@@ -133,6 +135,7 @@ public:
 	/* Event filter */
 	bool IsNoteVisible (MediaItem_Take* take, int id);
 	bool IsCCVisible (MediaItem_Take* take, int id);
+	bool IsCCVisible (MediaItem_Take* take, BR_MidiEvents& events, int id); // same as above but CC is read from events
 	bool IsSysVisible (MediaItem_Take* take, int id);
 	bool IsChannelVisible (int channel);
 
@@ -209,6 +212,67 @@ private:
 	vector<BR_MidiItemTimePos::MidiTake> savedMidiTakes;
 };
 
+/******************************************************************************
+* Class for reading and editing all MIDI events of a take at once. Events are *
+* decoded with a single MIDI_GetAllEvts and kept by column, edits are written *
+* back with a single MIDI_SetAllEvts in Commit() (per-event MIDI_Set* calls   *
+* make REAPER sort and validate the whole take each time)                     *
+*                                                                             *
+* Note, CC and text/sysex ids are the same as in REAPER's MIDI_Get* API and   *
+* stay valid until Commit() (deleting events doesn't shift them)              *
+******************************************************************************/
+class BR_MidiEvents
+{
+public:
+	explicit BR_MidiEvents (MediaItem_Take* take);
+	bool IsValid ();
+	bool Commit (); // returns false if there was nothing to commit or MIDI_SetAllEvts failed
+
+	/* Same as MIDI_CountEvts and MIDI_Get* API (return false if id is out of range or deleted) */
+	int CountEvts (int* noteCount, int* ccCount, int* sysCount);
+	bool GetNote (int id, bool* selected, bool* muted, double* startPpq, double* endPpq, int* chan, int* pitch, int* vel);
+	bool GetCC (int id, bool* selected, bool* muted, double* ppqPos, int* chanMsg, int* chan, int* msg2, int* msg3);
+	bool GetTextSysexEvt (int id, bool* selected, bool* muted, double* ppqPos, int* type);
+	int EnumSelNotes (int id);
+	int EnumSelCC (int id);
+	int EnumSelTextSysexEvts (int id);
+
+	/* Edits (note-offs follow their note-ons, CC bezier events follow their CCs) */
+	void SetNoteSelected (int id, bool selected);
+	void SetNoteMuted (int id, bool muted);
+	void SetCCSelected (int id, bool selected);
+	void SetTextSysexSelected (int id, bool selected);
+	void DeleteCC (int id);
+	void DeleteTextSysexEvt (int id);
+
+private:
+	enum EventFlags
+	{
+		FLAG_SELECTED = 1,
+		FLAG_MUTED    = 2
+	};
+
+	bool Build ();
+	bool IsEvent (const vector<int>& ids, int id);
+	int EnumSel (const vector<int>& ids, int id);
+	void SetFlag (int evt, int flag, bool set);
+	void Delete (int evt);
+	const unsigned char* GetMsg (int evt);
+
+	/* Columns, by event (same order as in the take) */
+	vector<double> m_pos;       // ppq, absolute
+	vector<unsigned char> m_flags; // see EventFlags, other bits (CC shape etc...) are kept as is
+	vector<int> m_msgOffset, m_msgSize; // in m_msgs
+	vector<bool> m_deleted;
+	vector<unsigned char> m_msgs;
+
+	/* REAPER's API ids -> events */
+	vector<int> m_noteOns, m_noteOffs, m_ccs, m_ccBeziers, m_sys; // m_noteOffs: -1 if note isn't closed, m_ccBeziers: -1 if CC has no bezier shape event
+
+	MediaItem_Take* m_take;
+	bool m_valid, m_edited, m_deletions;
+};
+
 /******************************************************************************
 * Mouse cursor                                                                *
 ******************************************************************************/
@@ -228,6 +292,7 @@ double GetOriginalPpqPos (MediaItem_Take* take, double ppqPos, bool* loopedItem,
 void SetMutedNotes (MediaItem_Take* take, const vector<int>& muteStatus);
 void SetSelectedNotes (MediaItem_Take* take, const vector<int>& selectedNotes, bool unselectOthers);
 void UnselectAllEvents (MediaItem_Take* take, int lane);
+void InvalidateMidiEditorViewStates (); // drops view settings cached by BR_MidiEditor (they also expire on undo points, SWS chunk writes, view changes and the next timer tick)
 bool AreAllNotesUnselected (MediaItem_Take* take);
 bool IsMidi (MediaItem_Take* take, bool* inProject = NULL);
 bool IsOpenInInlineEditor (MediaItem_Take* take);
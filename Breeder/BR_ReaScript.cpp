@@ -28,6 +28,7 @@
 #include "stdafx.h"
 #include "BR_ReaScript.h"
 #include "BR_EnvelopeUtil.h"
+#include "BR_MediaIndex.h"
 #include "BR_MidiUtil.h"
 #include "BR_MouseUtil.h"
 #include "BR_Util.h"
@@ -44,6 +45,16 @@ WDL_PtrList_DOD<BR_Envelope> g_script_brenvs; // just to validate function param
 /******************************************************************************
 * ReaScript export                                                            *
 ******************************************************************************/
+int BR_CountMissingMedia ()
+{
+	return g_mediaIndex.UpdateMissingFiles();
+}
+
+int BR_CountTakesUsingMedia (const char* file)
+{
+	return g_mediaIndex.CountTakes(file);
+}
+
 BR_Envelope* BR_EnvAlloc (TrackEnvelope* envelope, bool takeEnvelopesUseProjectTime)
 {
 	if (envelope)
@@ -235,6 +246,19 @@ double BR_EnvValueAtPos (BR_Envelope* envelope, double position)
 	return 0;
 }
 
+bool BR_GetActionLatency (int idx, bool toggleState, char* commandIdOut, int commandIdOut_sz, int* callsOut, double* totalMsOut, double* maxMsOut, char* histogramOut, int histogramOut_sz)
+{
+	WDL_FastString commandId, histogram;
+	if (!GetActionProfile(idx, toggleState, &commandId, callsOut, totalMsOut, maxMsOut, &histogram))
+		return false;
+
+	if (commandIdOut && commandIdOut_sz > 0)
+		snprintf(commandIdOut, commandIdOut_sz, "%s", commandId.Get());
+	if (histogramOut && histogramOut_sz > 0)
+		snprintf(histogramOut, histogramOut_sz, "%s", histogram.Get());
+	return true;
+}
+
 void BR_GetArrangeView (ReaProject* proj, double* startPositionOut, double* endPositionOut)
 {
 	double start, end;
@@ -434,6 +458,17 @@ bool BR_GetMidiTakeTempoInfo (MediaItem_Take* take, bool* ignoreProjTempoOut, do
 	return GetMidiTakeTempoInfo (take, ignoreProjTempoOut, bpmOut, numOut, denOut);
 }
 
+bool BR_GetMissingMedia (int idx, char* fileOut, int fileOut_sz)
+{
+	const char* file = g_mediaIndex.GetMissingFile(idx);
+	if (!file)
+		return false;
+
+	if (fileOut && fileOut_sz > 0)
+		snprintf(fileOut, fileOut_sz, "%s", file);
+	return true;
+}
+
 void BR_GetMouseCursorContext (char* windowOut, int windowOut_sz, char* segmentOut, int segmentOut_sz, char* detailsOut, int detailsOut_sz)
 {
 	g_mouseInfo.Update();
@@ -604,6 +639,11 @@ int BR_GetTakeFXCount (MediaItem_Take* take)
 	return GetTakeFXCount(take);
 }
 
+MediaItem_Take* BR_GetTakeUsingMedia (const char* file, int idx)
+{
+	return g_mediaIndex.GetTake(file, idx);
+}
+
 bool BR_IsTakeMidi (MediaItem_Take* take, bool* inProjectMidiOut)
 {
 	return IsMidi(take, inProjectMidiOut);
@@ -683,6 +723,11 @@ double BR_PositionAtMouseCursor (bool checkRuler)
 	return PositionAtMouseCursor(checkRuler, true);
 }
 
+int BR_RelinkMedia (const char* oldFile, const char* newFile)
+{
+	return g_mediaIndex.Relink(oldFile, newFile);
+}
+
 void BR_SetArrangeView (ReaProject* proj, double startPosition, double endPosition)
 {
 	GetSetArrangeView(proj, true, &startPosition, &endPosition);
@@ -884,12 +929,18 @@ bool BR_SetMidiTakeTempoInfo (MediaItem_Take* take, bool ignoreProjTempo, double
 
 bool BR_SetTakeSourceFromFile (MediaItem_Take* take, const char* filenameIn, bool inProjectData)
 {
-	return SetTakeSourceFromFile(take, filenameIn, inProjectData, false);
+	bool update = SetTakeSourceFromFile(take, filenameIn, inProjectData, false);
+	if (update)
+		g_mediaIndex.UpdateTake(take);
+	return update;
 }
 
 bool BR_SetTakeSourceFromFile2 (MediaItem_Take* take, const char* filenameIn, bool inProjectData, bool keepSourceProperties)
 {
-	return SetTakeSourceFromFile(take, filenameIn, inProjectData, keepSourceProperties);
+	bool update = SetTakeSourceFromFile(take, filenameIn, inProjectData, keepSourceProperties);
+	if (update)
+		g_mediaIndex.UpdateTake(take);
+	return update;
 }
 
 MediaItem_Take* BR_TakeAtMouseCursor (double* positionOut)
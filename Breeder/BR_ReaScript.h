@@ -32,6 +32,8 @@ class BR_Envelope;
 /******************************************************************************
 * ReaScript export                                                            *
 ******************************************************************************/
+int             BR_CountMissingMedia ();
+int             BR_CountTakesUsingMedia (const char* file);
 BR_Envelope*    BR_EnvAlloc (TrackEnvelope* envelope, bool takeEnvelopesUseProjectTime);
 int             BR_EnvCountPoints (BR_Envelope* envelope);
 bool            BR_EnvDeletePoint (BR_Envelope* envelope, int id);
@@ -47,6 +49,7 @@ bool            BR_EnvSetPoint (BR_Envelope* envelope, int id, double position,
 void            BR_EnvSetProperties (BR_Envelope* envelope, bool active, bool visible, bool armed, bool inLane, int laneHeight, int defaultShape, bool faderScaling, int* AIoptions);
 void            BR_EnvSortPoints (BR_Envelope* envelope);
 double          BR_EnvValueAtPos (BR_Envelope* envelope, double position);
+bool            BR_GetActionLatency (int idx, bool toggleState, char* commandIdOut, int commandIdOut_sz, int* callsOut, double* totalMsOut, double* maxMsOut, char* histogramOut, int histogramOut_sz);
 void            BR_GetArrangeView (ReaProject* proj, double* startPositionOut, double* endPositionOut);
 double          BR_GetClosestGridDivision (double position);
 void            BR_GetCurrentTheme (char* themePathOut, int themePathOut_sz, char* themeNameOut, int themeNameOut_sz);
@@ -64,6 +67,7 @@ MediaTrack*     BR_GetMediaTrackSendInfo_Track (MediaTrack* track, int category,
 double          BR_GetMidiSourceLenPPQ (MediaItem_Take* take);
 bool            BR_GetMidiTakePoolGUID (MediaItem_Take* take, char* guidStringOut, int guidStringOut_sz);
 bool            BR_GetMidiTakeTempoInfo (MediaItem_Take* take, bool* ignoreProjTempoOut, double* bpmOut, int* numOut, int* denOut);
+bool            BR_GetMissingMedia (int idx, char* fileOut, int fileOut_sz);
 void            BR_GetMouseCursorContext (char* windowOut, int windowOut_sz, char* segmentOut, int segmentOut_sz, char* detailsOut, int detailsOut_sz);
 TrackEnvelope*  BR_GetMouseCursorContext_Envelope (bool* takeEnvelopeOut);
 MediaItem*      BR_GetMouseCursorContext_Item ();
@@ -76,12 +80,14 @@ double          BR_GetNextGridDivision (double position);
 double          BR_GetPrevGridDivision (double position);
 double          BR_GetSetTrackSendInfo (MediaTrack* track, int category, int sendidx, const char* parmname, bool setNewValue, double newValue);
 int             BR_GetTakeFXCount (MediaItem_Take* take);
+MediaItem_Take* BR_GetTakeUsingMedia (const char* file, int idx);
 bool            BR_IsTakeMidi (MediaItem_Take* take, bool* inProjectMidiOut);
 bool			BR_IsMidiOpenInInlineEditor(MediaItem_Take* take);
 MediaItem*      BR_ItemAtMouseCursor (double* positionOut);
 bool            BR_MIDI_CCLaneRemove (void* midiEditor, int laneId);
 bool            BR_MIDI_CCLaneReplace (void* midiEditor, int laneId, int newCC);
 double          BR_PositionAtMouseCursor (bool checkRuler);
+int             BR_RelinkMedia (const char* oldFile, const char* newFile);
 void            BR_SetArrangeView (ReaProject* proj, double startPosition, double endPosition);
 bool            BR_SetItemEdges (MediaItem* item, double startTime, double endTime);
 void            BR_SetMediaItemImageResource (MediaItem* item, const char* imageIn, int imageFlags);
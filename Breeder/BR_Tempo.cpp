@@ -33,6 +33,7 @@
 #include "BR_Misc.h"
 #include "BR_MouseUtil.h"
 #include "BR_TempoDlg.h"
+#include "BR_TempoMap.h"
 #include "BR_Util.h"
 #include "../SnM/SnM_Util.h"
 #include "../reaper/localize.h"
@@ -1184,6 +1185,7 @@ void DeleteTempoPreserveItems (COMMAND_T* ct)
 	const int timeBase = ConfigVar<int>("tempoenvtimelock").value_or(0);
 	if (timeBase != 0)
 	{
+		BR_TempoMap& timeMap = GetTempoMap(); // tempo markers don't change until commit
 		double offset = 0;
 		for (int i = 0; i < tempoMap.CountConseq(); ++i)
 		{
@@ -1199,8 +1201,8 @@ void DeleteTempoPreserveItems (COMMAND_T* ct)
 				t0 -= offset; // last unselected point before next selection - readjust position to original (earlier iterations moved it)
 
 				int startMeasure, endMeasure, num, den;
-				double startBeats = TimeMap2_timeToBeats(NULL, t0, &startMeasure, &num, NULL, &den);
-				double endBeats   = TimeMap2_timeToBeats(NULL, t1, &endMeasure, NULL, NULL, NULL);
+				double startBeats = timeMap.TimeToBeats(t0, &startMeasure, &num, NULL, &den);
+				double endBeats   = timeMap.TimeToBeats(t1, &endMeasure);
 				double beatCount = endBeats - startBeats + num * (endMeasure - startMeasure);
 
 				if (s0 == SQUARE)
@@ -1383,6 +1385,7 @@ void TempoShapeLinear (COMMAND_T* ct)
 	int skipped = 0;
 	int count = tempoMap.CountPoints()-1;
 	vector<double> stretchMarkers;
+	BR_TempoMap& timeMap = GetTempoMap(); // tempo markers don't change until commit
 	for (int i = 0; i < tempoMap.CountSelected(); ++i)
 	{
 		int id = tempoMap.GetSelected(i);
@@ -1419,9 +1422,9 @@ void TempoShapeLinear (COMMAND_T* ct)
 					{
 						stretchMarkers.push_back(t0);
 
-						double t0_QN = TimeMap_timeToQN_abs(NULL, t0);
-						double t1_QN = TimeMap_timeToQN_abs(NULL, t1);
-						stretchMarkers.push_back(TimeMap_QNToTime_abs(NULL, (t0_QN + t1_QN) / 2));
+						double t0_QN = timeMap.TimeToQN(t0);
+						double t1_QN = timeMap.TimeToQN(t1);
+						stretchMarkers.push_back(timeMap.QNToTime((t0_QN + t1_QN) / 2));
 
 						stretchMarkers.push_back(t1);
 					}
@@ -1441,14 +1444,14 @@ void TempoShapeLinear (COMMAND_T* ct)
 				{
 					stretchMarkers.push_back(t0);
 
-					double t0_QN = TimeMap_timeToQN_abs(NULL, t0);
-					double t1_QN = TimeMap_timeToQN_abs(NULL, t1);
+					double t0_QN = timeMap.TimeToQN(t0);
+					double t1_QN = timeMap.TimeToQN(t1);
 					double lenHalfQ = (t1_QN - t0_QN) / 2;
 
 					if (tempoMap.CreatePoint(tempoMap.CountPoints(), position1, bpm1, LINEAR, 0, false))
-						stretchMarkers.push_back(TimeMap_QNToTime_abs(NULL, lenHalfQ * (1 - splitRatio) + t0_QN));
+						stretchMarkers.push_back(timeMap.QNToTime(lenHalfQ * (1 - splitRatio) + t0_QN));
 					if (tempoMap.CreatePoint(tempoMap.CountPoints(), position2, bpm2, LINEAR, 0, false))
-						stretchMarkers.push_back(TimeMap_QNToTime_abs(NULL, lenHalfQ * (splitRatio) + t0_QN + lenHalfQ));
+						stretchMarkers.push_back(timeMap.QNToTime(lenHalfQ * (splitRatio) + t0_QN + lenHalfQ));
 
 					stretchMarkers.push_back(t1);
 				}
@@ -1493,6 +1496,7 @@ void TempoShapeSquare (COMMAND_T* ct)
 	int skipped = 0;
 	int count = tempoMap.CountPoints()-1;
 	vector<double> stretchMarkers;
+	BR_TempoMap& timeMap = GetTempoMap(); // tempo markers don't change until commit
 	for (int i = 0; i < tempoMap.CountSelected(); ++i)
 	{
 		int id = tempoMap.GetSelected(i);
@@ -1546,9 +1550,9 @@ void TempoShapeSquare (COMMAND_T* ct)
 					{
 						stretchMarkers.push_back(t0);
 
-						double t0_QN = TimeMap_timeToQN_abs(NULL, t0);
-						double t1_QN = TimeMap_timeToQN_abs(NULL, t1);
-						stretchMarkers.push_back(TimeMap_QNToTime_abs(NULL, (t0_QN + t1_QN) / 2));
+						double t0_QN = timeMap.TimeToQN(t0);
+						double t1_QN = timeMap.TimeToQN(t1);
+						stretchMarkers.push_back(timeMap.QNToTime((t0_QN + t1_QN) / 2));
 
 						stretchMarkers.push_back(t1);
 					}
@@ -1567,14 +1571,14 @@ void TempoShapeSquare (COMMAND_T* ct)
 				{
 					stretchMarkers.push_back(t0);
 
-					double t0_QN = TimeMap_timeToQN_abs(NULL, t0);
-					double t1_QN = TimeMap_timeToQN_abs(NULL, t1);
+					double t0_QN = timeMap.TimeToQN(t0);
+					double t1_QN = timeMap.TimeToQN(t1);
 					double lenHalfQ = (t1_QN - t0_QN) / 2;
 
 					if (tempoMap.CreatePoint(tempoMap.CountPoints(), position1, bpm1, LINEAR, 0, false))
-						stretchMarkers.push_back(TimeMap_QNToTime_abs(NULL, lenHalfQ * (1 - splitRatio) + t0_QN));
+						stretchMarkers.push_back(timeMap.QNToTime(lenHalfQ * (1 - splitRatio) + t0_QN));
 					if (tempoMap.CreatePoint(tempoMap.CountPoints(), position2, bpm2, LINEAR, 0, false))
-						stretchMarkers.push_back(TimeMap_QNToTime_abs(NULL, lenHalfQ * (splitRatio)+t0_QN + lenHalfQ));
+						stretchMarkers.push_back(timeMap.QNToTime(lenHalfQ * (splitRatio)+t0_QN + lenHalfQ));
 
 					stretchMarkers.push_back(t1);
 				}
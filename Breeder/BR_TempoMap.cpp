@@ -0,0 +1,344 @@
+/******************************************************************************
+/ BR_TempoMap.cpp
+/
+/ Copyright (c) 2026 and later SWS
+/
+/
+/
+/ Permission is hereby granted, free of charge, to any person obtaining a copy
+/ of this software and associated documentation files (the "Software"), to deal
+/ in the Software without restriction, including without limitation the rights to
+/ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+/ of the Software, and to permit persons to whom the Software is furnished to
+/ do so, subject to the following conditions:
+/
+/ The above copyright notice and this permission notice shall be included in all
+/ copies or substantial portions of the Software.
+/
+/ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+/ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+/ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+/ HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+/ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/ OTHER DEALINGS IN THE SOFTWARE.
+/
+******************************************************************************/
+#include "stdafx.h"
+#include "BR_TempoMap.h"
+#include "BR_Util.h"
+
+const double BEAT_EPSILON = 0.0000001;
+
+static BR_TempoMap g_tempoMap;
+static bool        g_tempoMapValid = false;
+
+/******************************************************************************
+* Tempo map snapshot                                                          *
+******************************************************************************/
+BR_TempoMap::BR_TempoMap () :
+m_proj        (NULL),
+m_currentProj (true),
+m_stateCount  (0),
+m_markerCount (0),
+m_built       (false)
+{
+}
+
+BR_TempoMap::BR_TempoMap (ReaProject* proj) :
+m_proj        (NULL),
+m_currentProj (true),
+m_stateCount  (0),
+m_markerCount (0),
+m_built       (false)
+{
+	this->Build(proj);
+}
+
+void BR_TempoMap::Build (ReaProject* proj /*=NULL*/)
+{
+	m_currentProj = !proj;
+	m_proj        = (proj) ? proj : EnumProjects(-1, NULL, 0);
+	m_stateCount  = GetProjectStateChangeCount(m_proj);
+	m_markerCount = CountTempoTimeSigMarkers(m_proj);
+	m_built       = true;
+
+	m_segments.clear();
+	m_segments.reserve(m_markerCount + 1);
+	for (int i = 0; i < m_markerCount; ++i)
+	{
+		Segment segment;
+		if (GetTempoTimeSigMarker(m_proj, i, &segment.time, NULL, NULL, &segment.bpm, NULL, NULL, &segment.linear))
+			m_segments.push_back(segment);
+	}
+
+	// Project tempo applies until the first tempo marker
+	if (m_segments.empty() || m_segments.front().time > 0)
+	{
+		Segment segment;
+		int num, den;
+		segment.time   = 0;
+		segment.linear = false;
+		TimeMap_GetTimeSigAtTime(m_proj, 0, &num, &den, &segment.bpm);
+		m_segments.insert(m_segments.begin(), segment);
+	}
+
+	for (size_t i = 0; i < m_segments.size(); ++i)
+	{
+		Segment& segment = m_segments[i];
+		bool last = (i == m_segments.size() - 1);
+
+		segment.endTime = (last) ? segment.time : m_segments[i+1].time;
+		segment.linear  = segment.linear && segment.endTime > segment.time;
+		segment.endBpm  = (segment.linear) ? m_segments[i+1].bpm : segment.bpm;
+		if (segment.bpm <= 0) segment.bpm = segment.endBpm = MIN_BPM;
+		segment.qn      = TimeMap_timeToQN_abs(m_proj, segment.time);
+
+		// Anchor musical position somewhere inside the segment (at segment start REAPER could report previous time signature)
+		double sampleTime = (last) ? segment.time + 1 : (segment.time + segment.endTime) / 2;
+		segment.sampleBeats = TimeMap2_timeToBeats(m_proj, sampleTime, &segment.sampleMeasure, &segment.num, &segment.sampleFullBeats, &segment.den);
+		if (segment.num <= 0) segment.num = 4;
+		if (segment.den <= 0) segment.den = 4;
+		segment.sampleQN = BR_TempoMap::SegmentTimeToQN(segment, sampleTime);
+
+		double beatsToStart = (segment.qn - segment.sampleQN) * segment.den / 4;
+		segment.fullBeats    = segment.sampleFullBeats + beatsToStart;
+		segment.firstMeasure = segment.sampleMeasure + (int)ceil((segment.sampleBeats + beatsToStart) / segment.num - BEAT_EPSILON);
+	}
+}
+
+bool BR_TempoMap::IsValid ()
+{
+	if (!m_built || (m_currentProj && m_proj != EnumProjects(-1, NULL, 0)))
+		return false;
+	return m_stateCount == GetProjectStateChangeCount(m_proj) && m_markerCount == CountTempoTimeSigMarkers(m_proj);
+}
+
+int BR_TempoMap::CountSegments ()
+{
+	if (!m_built)
+		this->Build();
+	return (int)m_segments.size();
+}
+
+double BR_TempoMap::TimeToQN (double time)
+{
+	return BR_TempoMap::SegmentTimeToQN(m_segments[this->FindTime(time)], time);
+}
+
+double BR_TempoMap::QNToTime (double qn)
+{
+	return BR_TempoMap::SegmentQNToTime(m_segments[this->FindQN(qn)], qn);
+}
+
+double BR_TempoMap::TimeToBeats (double time, int* measure /*=NULL*/, int* measureLength /*=NULL*/, double* fullBeats /*=NULL*/, int* den /*=NULL*/)
+{
+	const Segment& segment = m_segments[this->FindTime(time)];
+	double beatsFromSample = (BR_TempoMap::SegmentTimeToQN(segment, time) - segment.sampleQN) * segment.den / 4;
+
+	double beats = segment.sampleBeats + beatsFromSample;
+	int measures = (int)floor(beats / segment.num);
+	beats -= (double)measures * segment.num;
+	if (beats > segment.num - BEAT_EPSILON)
+	{
+		beats = 0;
+		++measures;
+	}
+	else if (beats < 0)
+	{
+		beats = 0;
+	}
+
+	WritePtr(measure,       segment.sampleMeasure + measures);
+	WritePtr(measureLength, segment.num);
+	WritePtr(fullBeats,     segment.sampleFullBeats + beatsFromSample);
+	WritePtr(den,           segment.den);
+	return (measure) ? beats : segment.sampleFullBeats + beatsFromSample;
+}
+
+double BR_TempoMap::BeatsToTime (double beats, const int* measure /*=NULL*/)
+{
+	if (measure)
+	{
+		const Segment& segment = m_segments[this->FindMeasure(*measure)];
+		double beatsFromSample = (double)(*measure - segment.sampleMeasure) * segment.num - segment.sampleBeats + beats;
+		return this->QNToTime(segment.sampleQN + beatsFromSample * 4 / segment.den);
+	}
+	else
+	{
+		const Segment& segment = m_segments[this->FindFullBeats(beats)];
+		return BR_TempoMap::SegmentQNToTime(segment, segment.sampleQN + (beats - segment.sampleFullBeats) * 4 / segment.den);
+	}
+}
+
+double BR_TempoMap::GetBpmAtTime (double time)
+{
+	const Segment& segment = m_segments[this->FindTime(time)];
+	if (!segment.linear)
+		return segment.bpm;
+
+	double position = SetToBounds((time - segment.time) / (segment.endTime - segment.time), 0.0, 1.0);
+	return segment.bpm + (segment.endBpm - segment.bpm) * position;
+}
+
+double BR_TempoMap::GetDividedBpmAtTime (double time)
+{
+	return this->GetBpmAtTime(time) * m_segments[this->FindTime(time)].den / 4;
+}
+
+int BR_TempoMap::FindTime (double time)
+{
+	if (!m_built)
+		this->Build();
+
+	// Last segment starting at or before time (first one covers everything before it too)
+	int lo = 0, hi = (int)m_segments.size() - 1;
+	while (lo < hi)
+	{
+		int mid = (lo + hi + 1) / 2;
+		if (m_segments[mid].time <= time) lo = mid;
+		else                              hi = mid - 1;
+	}
+	return lo;
+}
+
+int BR_TempoMap::FindQN (double qn)
+{
+	if (!m_built)
+		this->Build();
+
+	int lo = 0, hi = (int)m_segments.size() - 1;
+	while (lo < hi)
+	{
+		int mid = (lo + hi + 1) / 2;
+		if (m_segments[mid].qn <= qn) lo = mid;
+		else                          hi = mid - 1;
+	}
+	return lo;
+}
+
+int BR_TempoMap::FindFullBeats (double fullBeats)
+{
+	if (!m_built)
+		this->Build();
+
+	int lo = 0, hi = (int)m_segments.size() - 1;
+	while (lo < hi)
+	{
+		int mid = (lo + hi + 1) / 2;
+		if (m_segments[mid].fullBeats <= fullBeats + BEAT_EPSILON) lo = mid;
+		else                                                       hi = mid - 1;
+	}
+	return lo;
+}
+
+int BR_TempoMap::FindMeasure (int measure)
+{
+	if (!m_built)
+		this->Build();
+
+	// Segments that don't start a measure share firstMeasure with the one that does, later segment wins
+	int lo = 0, hi = (int)m_segments.size() - 1;
+	while (lo < hi)
+	{
+		int mid = (lo + hi + 1) / 2;
+		if (m_segments[mid].firstMeasure <= measure) lo = mid;
+		else                                         hi = mid - 1;
+	}
+	return lo;
+}
+
+double BR_TempoMap::SegmentTimeToQN (const Segment& segment, double time)
+{
+	double offset = time - segment.time;
+	if (!segment.linear || offset <= 0)
+		return segment.qn + offset * segment.bpm / 60;
+
+	double length = segment.endTime - segment.time;
+	if (offset >= length)
+		return segment.qn + ((segment.bpm + segment.endBpm) * length / 2 + (offset - length) * segment.endBpm) / 60;
+	return segment.qn + (segment.bpm * offset + (segment.endBpm - segment.bpm) * offset * offset / (2 * length)) / 60;
+}
+
+double BR_TempoMap::SegmentQNToTime (const Segment& segment, double qn)
+{
+	double area = (qn - segment.qn) * 60; // area under BPM curve
+	if (!segment.linear || area <= 0)
+		return segment.time + area / segment.bpm;
+
+	double length = segment.endTime - segment.time;
+	double segmentArea = (segment.bpm + segment.endBpm) * length / 2;
+	if (area >= segmentArea)
+		return segment.endTime + (area - segmentArea) / segment.endBpm;
+
+	// Solve bpm*t + (endBpm-bpm)/(2*length)*t^2 = area (written so it doesn't fall apart when bpm barely changes)
+	double a = (segment.endBpm - segment.bpm) / (2 * length);
+	double b = segment.bpm;
+	return segment.time + 2 * area / (b + sqrt(max(b*b + 4*a*area, 0.0)));
+}
+
+/******************************************************************************
+* Current project's tempo map                                                 *
+* can be stale for API edits made in the same tick, see BR_TempoMap.h         *
+******************************************************************************/
+BR_TempoMap& GetTempoMap ()
+{
+	if (!g_tempoMapValid || !g_tempoMap.IsValid())
+	{
+		if (!g_tempoMapValid)
+			plugin_register("timer", (void*)InvalidateTempoMap);
+		g_tempoMap.Build();
+		g_tempoMapValid = true;
+	}
+	return g_tempoMap;
+}
+
+void InvalidateTempoMap ()
+{
+	g_tempoMapValid = false;
+	plugin_register("-timer", (void*)InvalidateTempoMap);
+}
+
+#ifdef BR_DEBUG_PERFORMANCE_BENCHMARK
+// Time/beat conversions through REAPER and through BR_TempoMap (snapshot build included) over the whole tempo map
+// Runs only when "Tempo markers" is set in the benchmark dialog, compare BR_TempoMap/reaper and BR_TempoMap/snapshot in SWS_benchmark.json
+static void BenchmarkTempoMap (const BR_BenchmarkConfig& cfg, vector<BR_BenchmarkResult>& results)
+{
+	const int queries = 100000;
+	if (cfg.tempoMarkers <= 0)
+		return;
+	double projLen = max(cfg.tempoMarkers * 1.0, 1.0); // tempo markers are a second apart
+
+	BR_BenchmarkResult reaper("BR_TempoMap/reaper"), snapshot("BR_TempoMap/snapshot");
+	reaper.name.SetFormatted(256, "%d time to beats conversions (TimeMap2_timeToBeats)", queries);
+	snapshot.name.SetFormatted(256, "%d time to beats conversions (BR_TempoMap)", queries);
+
+	double checksum[2] = {0, 0};
+	for (int i = 0; i < cfg.iterations; ++i)
+	{
+		double start = time_precise();
+		for (int j = 0; j < queries; ++j)
+		{
+			int measure;
+			checksum[0] += TimeMap2_timeToBeats(NULL, projLen * j / queries, &measure, NULL, NULL, NULL) + measure;
+		}
+		reaper.AddTime(start);
+
+		start = time_precise();
+		BR_TempoMap tempoMap(NULL);
+		for (int j = 0; j < queries; ++j)
+		{
+			int measure;
+			checksum[1] += tempoMap.TimeToBeats(projLen * j / queries, &measure) + measure;
+		}
+		snapshot.AddTime(start);
+	}
+
+	if (checksum[0] != 0 && fabs(checksum[0] - checksum[1]) / fabs(checksum[0]) > 0.0001)
+		snapshot.failure.SetFormatted(256, "results differ from REAPER (checksum %.3f vs %.3f)", checksum[1], checksum[0]);
+	results.push_back(reaper);
+	results.push_back(snapshot);
+}
+static BR_BenchmarkRegistration s_tempoMapBenchmark(BenchmarkTempoMap);
+#endif
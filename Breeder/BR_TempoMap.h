@@ -0,0 +1,96 @@
+/******************************************************************************
+/ BR_TempoMap.h
+/
+/ Copyright (c) 2026 and later SWS
+/
+/
+/
+/ Permission is hereby granted, free of charge, to any person obtaining a copy
+/ of this software and associated documentation files (the "Software"), to deal
+/ in the Software without restriction, including without limitation the rights to
+/ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+/ of the Software, and to permit persons to whom the Software is furnished to
+/ do so, subject to the following conditions:
+/
+/ The above copyright notice and this permission notice shall be included in all
+/ copies or substantial portions of the Software.
+/
+/ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+/ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+/ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+/ HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+/ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/ OTHER DEALINGS IN THE SOFTWARE.
+/
+******************************************************************************/
+#pragma once
+
+/******************************************************************************
+* Tempo map snapshot                                                          *
+*                                                                             *
+* Reads tempo markers once and answers time/QN/beat conversions with binary  *
+* search over a table of segments (one per tempo marker) instead of asking   *
+* REAPER for every position. Each segment holds start time, QN, BPM, shape   *
+* and time signature along with the musical position REAPER reports inside   *
+* it, so measures and beats follow REAPER (partial measures included).       *
+* Snapshot doesn't follow tempo map edits: use GetTempoMap() to get the one  *
+* kept in sync with the current project or create a local one when editing   *
+* tempo markers directly and call InvalidateTempoMap() when done             *
+******************************************************************************/
+class BR_TempoMap
+{
+public:
+	BR_TempoMap ();
+	explicit BR_TempoMap (ReaProject* proj);
+	void Build (ReaProject* proj = NULL);
+	bool IsValid (); // false if tempo markers (or project state) changed since Build()
+	int CountSegments ();
+
+	/* Same as TimeMap_timeToQN_abs, TimeMap_QNToTime_abs, TimeMap2_timeToBeats, TimeMap2_beatsToTime and TimeMap2_GetDividedBpmAtTime */
+	double TimeToQN (double time);
+	double QNToTime (double qn);
+	double TimeToBeats (double time, int* measure = NULL, int* measureLength = NULL, double* fullBeats = NULL, int* den = NULL);
+	double BeatsToTime (double beats, const int* measure = NULL);
+	double GetBpmAtTime (double time); // same units as tempo markers (quarter notes per minute)
+	double GetDividedBpmAtTime (double time);
+
+private:
+	struct Segment
+	{
+		double time, endTime;
+		double qn, fullBeats;
+		double bpm, endBpm;
+		bool linear;
+		int num, den, firstMeasure;
+		double sampleQN, sampleBeats, sampleFullBeats; // musical position reported by REAPER somewhere inside the segment
+		int sampleMeasure;
+	};
+	int FindTime (double time);
+	int FindQN (double qn);
+	int FindFullBeats (double fullBeats);
+	int FindMeasure (int measure);
+	static double SegmentTimeToQN (const Segment& segment, double time);
+	static double SegmentQNToTime (const Segment& segment, double qn);
+
+	ReaProject* m_proj;
+	bool m_currentProj;
+	int m_stateCount;
+	int m_markerCount;
+	bool m_built;
+	vector<Segment> m_segments;
+};
+
+/******************************************************************************
+* Snapshot of the current project's tempo map. It gets rebuilt when the       *
+* tempo marker count or project state change and expires on any action or     *
+* the next timer tick, so it's cheap to call for every conversion.            *
+* Within the same tick, tempo markers edited through the API without an undo  *
+* point (e.g. SetTempoTimeSigMarker() moving a marker or changing its tempo)  *
+* aren't seen: code editing tempo markers has to call InvalidateTempoMap()    *
+* before converting positions again (BR_Envelope::Commit() does it for the    *
+* tempo envelope)                                                             *
+******************************************************************************/
+BR_TempoMap& GetTempoMap ();
+void InvalidateTempoMap ();
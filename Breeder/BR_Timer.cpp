@@ -27,6 +27,8 @@
 ******************************************************************************/
 #include "stdafx.h"
 #include "BR_Timer.h"
+#include "BR_Util.h"
+#include "version.h"
 
 void CommandTimer (COMMAND_T* ct, int val /*= 0*/, int valhw /*= 0*/, int relmode /*= 0*/, HWND hwnd /*= NULL*/, bool commandHook2 /*= false*/)
 {
@@ -57,6 +59,169 @@ void CommandTimer (COMMAND_T* ct, int val /*= 0*/, int valhw /*= 0*/, int relmod
 	ShowConsoleMsg(string.Get());
 }
 
+/******************************************************************************
+* Action latency profiler                                                     *
+******************************************************************************/
+const int    ACTION_PROFILER_BUCKETS      = 16;
+const double ACTION_PROFILER_FIRST_BUCKET = 1.0 / 64; // ms, every next bucket is twice as wide
+
+struct BR_ActionProfile
+{
+	int cmd;
+	WDL_FastString id;
+	int count[2];                                  // [0] executing the action, [1] polling toggle state
+	double total[2], max[2];                       // ms
+	int histogram[2][ACTION_PROFILER_BUCKETS];
+
+	BR_ActionProfile (int cmd, const char* id) : cmd(cmd), id(id)
+	{
+		memset(count, 0, sizeof(count));
+		memset(total, 0, sizeof(total));
+		memset(max, 0, sizeof(max));
+		memset(histogram, 0, sizeof(histogram));
+	}
+};
+
+bool g_actionProfiler = false;
+
+static void DeleteActionProfile (BR_ActionProfile* profile) { delete profile; }
+static WDL_IntKeyedArray<BR_ActionProfile*> g_actionProfiles(DeleteActionProfile);
+
+static void RecordActionLatency (COMMAND_T* ct, int type, double ms)
+{
+	BR_ActionProfile* profile = g_actionProfiles.Get(ct->accel.accel.cmd);
+	if (!profile)
+	{
+		profile = new BR_ActionProfile(ct->accel.accel.cmd, ct->id);
+		g_actionProfiles.Insert(ct->accel.accel.cmd, profile);
+	}
+
+	profile->count[type]++;
+	profile->total[type] += ms;
+	if (ms > profile->max[type])
+		profile->max[type] = ms;
+
+	int bucket = 0;
+	for (double limit = ACTION_PROFILER_FIRST_BUCKET; bucket < ACTION_PROFILER_BUCKETS - 1 && ms >= limit; limit *= 2)
+		++bucket;
+	profile->histogram[type][bucket]++;
+}
+
+static bool CompareActionProfiles (BR_ActionProfile* first, BR_ActionProfile* second)
+{
+	return first->total[0] + first->total[1] > second->total[0] + second->total[1];
+}
+
+static void AppendCsvString (WDL_FastString& out, const char* str)
+{
+	out.Append("\"");
+	for (const char* p = str; p && *p; ++p)
+		out.Append((*p == '"') ? "\"\"" : p, (*p == '"') ? 2 : 1);
+	out.Append("\"");
+}
+
+void ProfileCommand (COMMAND_T* ct, int val /*= 0*/, int valhw /*= 0*/, int relmode /*= 0*/, HWND hwnd /*= NULL*/, bool commandHook2 /*= false*/)
+{
+	double start = time_precise();
+	if (commandHook2)
+		ct->onAction(ct, val, valhw, relmode, hwnd);
+	else
+		ct->doCommand(ct);
+	RecordActionLatency(ct, 0, (time_precise() - start) * 1000);
+}
+
+int ProfileToggleState (COMMAND_T* ct)
+{
+	double start = time_precise();
+	int state = ct->getEnabled(ct);
+	RecordActionLatency(ct, 1, (time_precise() - start) * 1000);
+	return state;
+}
+
+bool GetActionProfile (int idx, bool toggleState, WDL_FastString* commandId, int* count, double* totalMs, double* maxMs, WDL_FastString* histogram)
+{
+	BR_ActionProfile* profile = g_actionProfiles.Enumerate(idx);
+	if (!profile)
+		return false;
+
+	int type = toggleState ? 1 : 0;
+	if (commandId) commandId->Set(profile->id.Get());
+	WritePtr(count,   profile->count[type]);
+	WritePtr(totalMs, profile->total[type]);
+	WritePtr(maxMs,   profile->max[type]);
+	if (histogram)
+	{
+		histogram->Set("");
+		for (int i = 0; i < ACTION_PROFILER_BUCKETS; ++i)
+			histogram->AppendFormatted(32, i ? ",%d" : "%d", profile->histogram[type][i]);
+	}
+	return true;
+}
+
+void ToggleActionProfiler (COMMAND_T*)
+{
+	g_actionProfiler = !g_actionProfiler;
+}
+
+int IsActionProfilerOn (COMMAND_T*)
+{
+	return g_actionProfiler;
+}
+
+void ResetActionProfiler (COMMAND_T*)
+{
+	g_actionProfiles.DeleteAll();
+}
+
+void DumpActionProfiler (COMMAND_T*)
+{
+	vector<BR_ActionProfile*> profiles;
+	for (int i = 0; BR_ActionProfile* profile = g_actionProfiles.Enumerate(i); ++i)
+		profiles.push_back(profile);
+	stable_sort(profiles.begin(), profiles.end(), CompareActionProfiles);
+
+	WDL_FastString csv, summary;
+	csv.Set("command_id,name,type,count,total_ms,avg_ms,max_ms");
+	double limit = ACTION_PROFILER_FIRST_BUCKET;
+	for (int i = 0; i < ACTION_PROFILER_BUCKETS - 1; ++i, limit *= 2)
+		csv.AppendFormatted(64, ",<%gms", limit);
+	csv.AppendFormatted(64, ",>=%gms\n", limit / 2);
+
+	summary.AppendFormatted(256, "SWS action latency (%d profiled actions, %s):\n", (int)profiles.size(), g_actionProfiler ? "profiling on" : "profiling off");
+	int summaryLines = 0;
+	for (size_t i = 0; i < profiles.size(); ++i)
+	{
+		BR_ActionProfile* profile = profiles[i];
+		const char* name = kbd_getTextFromCmd(profile->cmd, NULL);
+		for (int type = 0; type < 2; ++type)
+		{
+			if (!profile->count[type])
+				continue;
+
+			AppendCsvString(csv, profile->id.Get());
+			csv.Append(",");
+			AppendCsvString(csv, name);
+			csv.AppendFormatted(256, ",%s,%d,%.3f,%.3f,%.3f", type ? "toggle" : "action", profile->count[type], profile->total[type], profile->total[type] / profile->count[type], profile->max[type]);
+			for (int j = 0; j < ACTION_PROFILER_BUCKETS; ++j)
+				csv.AppendFormatted(32, ",%d", profile->histogram[type][j]);
+			csv.Append("\n");
+
+			if (summaryLines++ < 10)
+				summary.AppendFormatted(1024, "%.3f ms total, %d calls, %.3f ms max%s: %s\n", profile->total[type], profile->count[type], profile->max[type], type ? " (toggle state)" : "", name);
+		}
+	}
+
+	WDL_FastString reportPath;
+	reportPath.SetFormatted(4096, "%s%cSWS_action_latency.csv", GetResourcePath(), PATH_SLASH_CHAR);
+	if (FILE* f = fopenUTF8(reportPath.Get(), "w"))
+	{
+		fputs(csv.Get(), f);
+		fclose(f);
+		summary.AppendFormatted(4096, "Report written to %s\n", reportPath.Get());
+	}
+	ShowConsoleMsg(summary.Get());
+}
+
 #ifdef BR_DEBUG_PERFORMANCE_TIMER
 	BR_Timer::BR_Timer (const char* message, bool autoPrint /*= true*/, bool autoStart /*= true*/) : m_message(message), m_autoPrint(autoPrint), m_paused(!autoStart)
 	{
@@ -174,3 +339,231 @@ void CommandTimer (COMMAND_T* ct, int val /*= 0*/, int valhw /*= 0*/, int relmod
 	void BR_Timer::Reset () {}
 	void BR_Timer::Progress (const char* message /*= NULL*/) {}
 #endif
+
+#ifdef BR_DEBUG_PERFORMANCE_BENCHMARK
+	static void AppendJsonString (WDL_FastString& out, const char* str)
+	{
+		out.Append("\"");
+		for (const char* p = str; p && *p; ++p)
+		{
+			if      (*p == '"' || *p == '\\') { char esc[3] = {'\\', *p, 0}; out.Append(esc); }
+			else if ((unsigned char)*p < 0x20) out.AppendFormatted(8, "\\u%04x", (unsigned char)*p);
+			else                               out.Append(p, 1);
+		}
+		out.Append("\"");
+	}
+
+	static void GenerateBenchmarkProject (const BR_BenchmarkConfig& cfg)
+	{
+		Main_OnCommand(40859, 0); // File: New project tab
+
+		PreventUIRefresh(1);
+		const double itemLen = 2.0;
+		for (int i = 0; i < cfg.tracks; ++i)
+		{
+			InsertTrackAtIndex(i, false);
+			MediaTrack* track = GetTrack(NULL, i);
+			if (!track)
+				continue;
+
+			char name[64];
+			snprintf(name, sizeof(name), "Track %d", i + 1);
+			GetSetMediaTrackInfo_String(track, "P_NAME", name, true);
+
+			for (int j = 0; j < cfg.items; ++j)
+			{
+				MediaItem* item = CreateNewMIDIItemInProj(track, j * itemLen, (j + 1) * itemLen, NULL);
+				MediaItem_Take* take = item ? GetActiveTake(item) : NULL;
+				if (!take)
+					continue;
+
+				double itemStartPPQ = MIDI_GetPPQPosFromProjTime(take, j * itemLen);
+				double itemEndPPQ   = MIDI_GetPPQPosFromProjTime(take, (j + 1) * itemLen);
+				double noteLen      = (cfg.notes > 0) ? (itemEndPPQ - itemStartPPQ) / cfg.notes : 0;
+				bool noSort = true;
+				for (int k = 0; k < cfg.notes; ++k)
+				{
+					double start = itemStartPPQ + k * noteLen;
+					MIDI_InsertNote(take, (k % 2) == 0, false, start, start + noteLen * 0.9, k % 16, 36 + (k % 48), 1 + (k * 7) % 127, &noSort);
+				}
+				MIDI_Sort(take);
+			}
+		}
+
+		if (cfg.envPoints > 0 && cfg.tracks > 0)
+		{
+			Main_OnCommand(40296, 0); // Track: Select all tracks
+			Main_OnCommand(40406, 0); // Track: Toggle track volume envelope visible
+			double projLen = max(cfg.items * itemLen, itemLen);
+			for (int i = 0; i < cfg.tracks; ++i)
+			{
+				if (TrackEnvelope* envelope = GetTrackEnvelopeByName(GetTrack(NULL, i), "Volume"))
+				{
+					bool noSort = true;
+					for (int j = 0; j < cfg.envPoints; ++j)
+						InsertEnvelopePoint(envelope, j * projLen / cfg.envPoints, (j % 2) ? 0.5 : 1.0, 0, 0, false, &noSort);
+					Envelope_SortPoints(envelope);
+				}
+			}
+		}
+
+		for (int i = 0; i < cfg.markers; ++i)
+		{
+			double pos = i * itemLen;
+			AddProjectMarker2(NULL, (i % 2) != 0, pos, pos + itemLen, "", -1, 0);
+		}
+
+		// Alternate square/linear tempo markers, a time signature change every 64 markers
+		for (int i = 0; i < cfg.tempoMarkers; ++i)
+		{
+			int num = (i % 64 == 0) ? ((i / 64) % 2 ? 7 : 4) : 0;
+			int den = (num == 7) ? 8 : ((num) ? 4 : 0);
+			SetTempoTimeSigMarker(NULL, -1, i * itemLen / 2, -1, -1, 90 + (i * 37) % 80, num, den, (i % 2) != 0);
+		}
+		PreventUIRefresh(-1);
+
+		TrackList_AdjustWindows(false);
+		UpdateArrange();
+	}
+
+	static void WriteBenchmarkReport (const BR_BenchmarkConfig& cfg, double generationTime, vector<BR_BenchmarkResult>& results)
+	{
+		WDL_FastString json, summary;
+		int failures = 0;
+		json.AppendFormatted(256, "{\n  \"sws_version\": \"%d.%d.%d.%d\",\n  \"reaper_version\": ", SWS_VERSION);
+		AppendJsonString(json, GetAppVersion());
+		json.AppendFormatted(512, ",\n  \"project\": {\"tracks\": %d, \"items_per_track\": %d, \"notes_per_item\": %d, \"markers\": %d, \"envelope_points_per_track\": %d, \"tempo_markers\": %d, \"base64_kb\": %d},\n", cfg.tracks, cfg.items, cfg.notes, cfg.markers, cfg.envPoints, cfg.tempoMarkers, cfg.base64KB);
+		json.AppendFormatted(256, "  \"iterations\": %d,\n  \"generation_ms\": %.3f,\n  \"results\": [", cfg.iterations, generationTime);
+
+		for (size_t i = 0; i < results.size(); ++i)
+		{
+			BR_BenchmarkResult& result = results[i];
+			json.Append(i ? ",\n    {\"id\": " : "\n    {\"id\": ");
+			AppendJsonString(json, result.id.Get());
+			json.Append(", \"name\": ");
+			AppendJsonString(json, result.name.Get());
+
+			double median = 0.0;
+			if (!result.times.empty())
+			{
+				sort(result.times.begin(), result.times.end());
+				double total = accumulate(result.times.begin(), result.times.end(), 0.0);
+				double avg = total / result.times.size();
+				median = result.times[result.times.size() / 2];
+				json.AppendFormatted(512, ", \"min_ms\": %.3f, \"avg_ms\": %.3f, \"median_ms\": %.3f, \"max_ms\": %.3f, \"total_ms\": %.3f", result.times.front(), avg, median, result.times.back(), total);
+			}
+			else if (!result.failure.GetLength())
+				result.failure.Set("no timing recorded");
+
+			if (result.failure.GetLength())
+			{
+				json.Append(", \"failure\": ");
+				AppendJsonString(json, result.failure.Get());
+				summary.AppendFormatted(1024, "FAILED: %s (%s)\n", result.name.GetLength() ? result.name.Get() : result.id.Get(), result.failure.Get());
+				++failures;
+			}
+			else
+			{
+				summary.AppendFormatted(512, "%.3f ms (median of %d) to execute: %s\n", median, (int)result.times.size(), result.name.Get());
+			}
+			json.Append("}");
+		}
+		json.AppendFormatted(64, "\n  ],\n  \"failures\": %d\n}\n", failures);
+		if (failures)
+			summary.AppendFormatted(128, "%d benchmark(s) failed\n", failures);
+
+		WDL_FastString reportPath;
+		reportPath.SetFormatted(4096, "%s%cSWS_benchmark.json", GetResourcePath(), PATH_SLASH_CHAR);
+		if (FILE* f = fopenUTF8(reportPath.Get(), "w"))
+		{
+			fputs(json.Get(), f);
+			fclose(f);
+			summary.AppendFormatted(4096, "Report written to %s\n", reportPath.Get());
+		}
+		ShowConsoleMsg(summary.Get());
+	}
+
+	// Benchmarks and self-tests registered by modules, run after requested actions (each one skips itself when the generated project doesn't have what it needs)
+	static vector<BR_BenchmarkFunc>& GetBenchmarks ()
+	{
+		static vector<BR_BenchmarkFunc> s_benchmarks; // not a global: modules register from their static initializers
+		return s_benchmarks;
+	}
+
+	BR_BenchmarkRegistration::BR_BenchmarkRegistration (BR_BenchmarkFunc benchmark)
+	{
+		GetBenchmarks().push_back(benchmark);
+	}
+
+	static void RunBenchmark (COMMAND_T* ct)
+	{
+		static char s_lastInput[4096] = "100,10,16,100,100,0,0,5,";
+		char input[4096];
+		lstrcpyn(input, s_lastInput, sizeof(input));
+		if (!GetUserInputs("SWS benchmark", 9, "Tracks,Items per track,Notes per item,Markers/regions,Envelope points per track,Tempo markers,Base64 payloads up to (KB),Iterations,Actions (comma separated),extrawidth=300", input, sizeof(input)))
+			return;
+		lstrcpyn(s_lastInput, input, sizeof(s_lastInput));
+
+		BR_BenchmarkConfig cfg;
+		int* values[] = {&cfg.tracks, &cfg.items, &cfg.notes, &cfg.markers, &cfg.envPoints, &cfg.tempoMarkers, &cfg.base64KB, &cfg.iterations};
+		char* token = strtok(input, ",");
+		for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i)
+		{
+			*values[i] = token ? max(0, atoi(token)) : 0;
+			token = strtok(NULL, ",");
+		}
+		cfg.iterations = max(1, cfg.iterations);
+
+		vector<BR_BenchmarkResult> results;
+		for (; token; token = strtok(NULL, ","))
+		{
+			while (*token == ' ') ++token;
+			if (!*token)
+				continue;
+
+			results.push_back(BR_BenchmarkResult(token));
+		}
+
+		double generationStart = time_precise();
+		GenerateBenchmarkProject(cfg);
+		double generationTime = (time_precise() - generationStart) * 1000;
+
+		for (size_t i = 0; i < results.size(); ++i)
+		{
+			BR_BenchmarkResult& result = results[i];
+			int cmd = NamedCommandLookup(result.id.Get());
+			if (!cmd)
+			{
+				result.failure.Set("unknown action");
+				continue;
+			}
+			result.name.Set(kbd_getTextFromCmd(cmd, NULL));
+
+			for (int j = 0; j < cfg.iterations; ++j)
+			{
+				double start = time_precise();
+				Main_OnCommand(cmd, 0);
+				result.AddTime(start);
+			}
+		}
+
+		for (size_t i = 0; i < GetBenchmarks().size(); ++i)
+			GetBenchmarks()[i](cfg, results);
+
+		WriteBenchmarkReport(cfg, generationTime, results);
+	}
+
+	static COMMAND_T s_benchmarkCmdTable[] =
+	{
+		{ { DEFACCEL, "SWS/BR: [developer] Run benchmark suite..." }, "BR_DEV_BENCHMARK", RunBenchmark},
+		{ {}, LAST_COMMAND}
+	};
+
+	void BenchmarkInitExit (bool init)
+	{
+		if (init)
+			SWSRegisterCmds(s_benchmarkCmdTable, __FILE__, false);
+	}
+#else
+	void BenchmarkInitExit (bool init) {}
+#endif
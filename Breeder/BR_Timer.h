@@ -31,6 +31,7 @@
 * Uncomment do enable timer functionality                                     *
 ******************************************************************************/
 //#define BR_DEBUG_PERFORMANCE_ACTIONS
+//#define BR_DEBUG_PERFORMANCE_BENCHMARK
 #define BR_DEBUG_PERFORMANCE_TIMER
 
 /******************************************************************************
@@ -39,6 +40,67 @@
 *******************************************************************************/
 void CommandTimer (COMMAND_T* ct, int val = 0, int valhw = 0, int relmode = 0, HWND hwnd = NULL, bool commandHook2 = false);
 
+/******************************************************************************
+* If BR_DEBUG_PERFORMANCE_BENCHMARK is defined (uncomment above or configure  *
+* with -DBUILD_SWS_BENCHMARK=ON), "SWS/BR: [developer] Run benchmark          *
+* suite..." gets registered. It generates a synthetic project of configurable *
+* size (tracks, MIDI items/notes, markers/regions, envelope points and tempo  *
+* markers) in a new project tab, runs the requested actions over it, then the *
+* benchmarks and self-tests registered by modules (BR_BenchmarkRegistration)  *
+* and writes per-action timings and test failures (unknown actions included)  *
+* to <resource path>/SWS_benchmark.json so reports from different builds can  *
+* be diffed by scripts. With envelope points, BR_Envelope commits (whole vs.  *
+* edited range) get timed, with notes per item note edits through MIDI API    *
+* vs. BR_MidiEvents (set notes per item to 50000 for a dense take), with      *
+* tempo markers REAPER's and BR_TempoMap's time to beats conversions and with *
+* Base64 payload size one-shot vs. streaming Base64 codecs (1 KB and up)      *
+******************************************************************************/
+#ifdef BR_DEBUG_PERFORMANCE_BENCHMARK
+struct BR_BenchmarkConfig
+{
+	int tracks, items, notes, markers, envPoints, tempoMarkers, base64KB, iterations;
+};
+
+struct BR_BenchmarkResult
+{
+	BR_BenchmarkResult (const char* id = "", const char* name = "") : id(id), name(name) {}
+	void AddTime (double start) { times.push_back((time_precise() - start) * 1000); } // start: time_precise() before the timed code
+
+	WDL_FastString id, name;
+	WDL_FastString failure;    // not empty if results differ from the reference implementation
+	vector<double> times;      // ms
+};
+
+// Modules register their benchmarks and self-tests with a static instance:
+//   static BR_BenchmarkRegistration s_myBenchmark(MyBenchmark);
+typedef void (*BR_BenchmarkFunc) (const BR_BenchmarkConfig& cfg, vector<BR_BenchmarkResult>& results);
+struct BR_BenchmarkRegistration
+{
+	BR_BenchmarkRegistration (BR_BenchmarkFunc benchmark);
+};
+#endif
+
+void BenchmarkInitExit (bool init);
+
+/******************************************************************************
+* Action latency profiler. Unlike BR_DEBUG_PERFORMANCE_ACTIONS it is compiled *
+* in release builds and enabled at runtime ("SWS/BR: Toggle action latency   *
+* profiling"). Command hooks in sws_extension.cpp only test                   *
+* g_actionProfiler when it's off, otherwise they go through ProfileCommand()  *
+* and ProfileToggleState() which record call count, total, max and a latency *
+* histogram per command (separately for executing and for polling toggle     *
+* state)                                                                      *
+******************************************************************************/
+extern bool g_actionProfiler;
+
+void ProfileCommand (COMMAND_T* ct, int val = 0, int valhw = 0, int relmode = 0, HWND hwnd = NULL, bool commandHook2 = false);
+int  ProfileToggleState (COMMAND_T* ct);
+bool GetActionProfile (int idx, bool toggleState, WDL_FastString* commandId, int* count, double* totalMs, double* maxMs, WDL_FastString* histogram);
+void ToggleActionProfiler (COMMAND_T*);
+int  IsActionProfilerOn (COMMAND_T*);
+void ResetActionProfiler (COMMAND_T*);
+void DumpActionProfiler (COMMAND_T*);
+
 /******************************************************************************
 * Creating the object starts the timer (if autoStart is true). When the       *
 * object goes out of scope, elapsed time is printed to the console along with *
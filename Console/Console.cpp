@@ -47,7 +47,7 @@ static DWORD g_dwLastKeyMsg = 0;
 #define CONSOLE_WINDOWPOS_KEY "ReaConsoleWindowPos"
 bool g_bCloseOnReturnPref = false;
 
-void ParseTrackId(char* strId, bool bReset = true);
+void ParseTrackId(const char* strId);
 void ProcessCommand(CONSOLE_COMMAND command, const char* args);
 const char* StatusString(CONSOLE_COMMAND command, const char* args);
 
@@ -185,48 +185,209 @@ CONSOLE_COMMAND ParseConsoleCommand(char* strCommand, char** trackid, char** arg
 	return command;
 }
 
-// ParseId fills in array of ints (g_selTracks.Get()) according to id string
-void ParseTrackId(char* strId, bool bReset)
+///////////////////////////////////////////////////////////////////////////////
+// Track ids are compiled once into a list of terms, which are then resolved
+// against an index of the project's track names and folders. The index is
+// only rebuilt when the project changes, so re-running a compiled track id
+// (custom commands, cycle actions) doesn't have to rebuild the name lookup.
+// Scripts can add/remove/rename tracks without creating undo points, so the
+// index is also checked against the tracks (pointers, names, folders) before
+// being reused.
+
+class ConsoleTrackIndex
 {
-	int track;
-	const char* cName;
-	char* p;
-	bool bChildren = false;
-	bool bInvert = false;
+public:
+	ConsoleTrackIndex() : m_proj(NULL), m_iStateCount(0), m_iGeneration(0) {}
+	void Invalidate() { m_proj = NULL; }
+	int  Update();  // returns the generation, which changes each time the index is rebuilt
+	int  NumTracks() { return (int)m_tracks.size(); }
+	const char* GetName(int i) { return m_names[i].c_str(); }
+	int  GetLastChild(int i) { return m_lastChild[i]; } // -1 if the track isn't a folder parent
+	void SelectName(const char* strId, int* selTracks);
+
+private:
+	bool IsUpToDate();
+
+	ReaProject* m_proj;
+	int m_iStateCount;
+	int m_iGeneration;
+	vector<MediaTrack*> m_tracks;
+	vector<string> m_names;
+	vector<int> m_folders; // I_FOLDERDEPTH
+	vector<int> m_lastChild;
+	multimap<string, int> m_byName; // lower case name -> track, sorted so names with the same prefix are adjacent
+};
 
-	if (!strId || !GetNumTracks())
-		return;
+static ConsoleTrackIndex g_trackIndex;
+
+static string LowerCase(const char* str)
+{
+	string s(str);
+	for (size_t i = 0; i < s.size(); i++)
+		if (s[i] >= 'A' && s[i] <= 'Z')
+			s[i] += 'a' - 'A';
+	return s;
+}
 
-	if (bReset)
+// Cheap check, no allocation: same tracks, names and folders as when the index was built
+bool ConsoleTrackIndex::IsUpToDate()
+{
+	for (int i = 0; i < NumTracks(); i++)
 	{
-		g_selTracks.Resize(GetNumTracks(), false);
-		memset(g_selTracks.Get(), 0, g_selTracks.GetSize() * sizeof(int));
+		MediaTrack* tr = CSurf_TrackFromID(i+1, false);
+		if (tr != m_tracks[i])
+			return false;
+		const char* cName = (const char*)GetSetMediaTrackInfo(tr, "P_NAME", NULL);
+		if (strcmp(cName ? cName : "", m_names[i].c_str()) || *(int*)GetSetMediaTrackInfo(tr, "I_FOLDERDEPTH", NULL) != m_folders[i])
+			return false;
 	}
+	return true;
+}
 
-	// Comma seperated list or whitespace? strip and recall
-	if (strchr(strId, ','))
+int ConsoleTrackIndex::Update()
+{
+	ReaProject* proj = EnumProjects(-1, NULL, 0);
+	int iStateCount = GetProjectStateChangeCount(proj);
+	if (proj == m_proj && iStateCount == m_iStateCount && NumTracks() == GetNumTracks() && IsUpToDate())
+		return m_iGeneration;
+
+	m_proj = proj;
+	m_iStateCount = iStateCount;
+	m_iGeneration++;
+
+	int iTracks = GetNumTracks();
+	m_tracks.resize(iTracks);
+	m_names.resize(iTracks);
+	m_folders.resize(iTracks);
+	m_lastChild.assign(iTracks, -1);
+	m_byName.clear();
+
+	// Same folder levels as GetFolderDepth(): a folder ends on the first track
+	// that closes it back to the parent's level (or on the last track)
+	vector<int> parents;
+	vector<int> levels(iTracks);
+	int iLevel = 0;
+	for (int i = 0; i < iTracks; i++)
 	{
-		char temp[128];
-		char* token;
-		strncpy(temp, strId, 128);
-		temp[127]=0; // Just in case
-		token = strtok(temp, ",");
+		MediaTrack* tr = CSurf_TrackFromID(i+1, false);
+		const char* cName = (const char*)GetSetMediaTrackInfo(tr, "P_NAME", NULL);
+		int iFolder = *(int*)GetSetMediaTrackInfo(tr, "I_FOLDERDEPTH", NULL);
+
+		m_tracks[i] = tr;
+		m_names[i].assign(cName ? cName : "");
+		m_folders[i] = iFolder;
+		if (m_names[i].size())
+			m_byName.insert(make_pair(LowerCase(m_names[i].c_str()), i));
+
+		levels[i] = iLevel;
+		while (parents.size() && iFolder + iLevel <= levels[parents.back()])
+		{
+			m_lastChild[parents.back()] = i;
+			parents.pop_back();
+		}
+		if (iFolder == 1)
+			parents.push_back(i);
+		iLevel += iFolder;
+	}
+	for (int i = 0; i < (int)parents.size(); i++)
+		m_lastChild[parents[i]] = iTracks - 1;
+
+	return m_iGeneration;
+}
+
+// Exact name matches, with "auto complete"
+//   e.g. if there's no exact match, but only one track that starts with the string, select that one
+void ConsoleTrackIndex::SelectName(const char* strId, int* selTracks)
+{
+	string key = LowerCase(strId);
+	int iCloseMatch = 0;
+	int iMatchedTrack = -1;
+	bool bExactMatch = false;
+	for (multimap<string, int>::iterator it = m_byName.lower_bound(key); it != m_byName.end() && !it->first.compare(0, key.size(), key); ++it)
+	{
+		if (it->first.size() == key.size())
+		{
+			bExactMatch = true;
+			selTracks[it->second] = 1;
+		}
+		else if (++iCloseMatch == 1)
+			iMatchedTrack = it->second;
+	}
+
+	if (!bExactMatch && iCloseMatch == 1)
+		selTracks[iMatchedTrack] = 1;
+}
+
+enum
+{
+	TRACKID_NONE,
+	TRACKID_ALL,
+	TRACKID_SELECTED,
+	TRACKID_RANGE,
+	TRACKID_WILDCARD,
+	TRACKID_NAME,
+};
+
+typedef struct TRACKID_TERM
+{
+	int iType;
+	bool bChildren;
+	bool bInvert;
+	int iStart;
+	int iEnd;
+	string strId;
+} TRACKID_TERM;
+
+class ConsoleTrackSelector
+{
+public:
+	ConsoleTrackSelector(const char* strId);
+	void Select(); // fills in g_selTracks
+
+private:
+	void AddTerm(char* strId);
+	void ApplyTerm(TRACKID_TERM* term, int* selTracks);
+
+	vector<TRACKID_TERM> m_terms;
+	bool m_bUsesSelection;
+	int m_iGeneration;
+	WDL_TypedBuf<int> m_result;
+};
+
+ConsoleTrackSelector::ConsoleTrackSelector(const char* strId) : m_bUsesSelection(false), m_iGeneration(0)
+{
+	if (!strId)
+		return;
+
+	// Comma seperated list: one term per token
+	char temp[128];
+	lstrcpyn(temp, strId, sizeof(temp));
+	if (strchr(temp, ','))
+	{
+		char* token = strtok(temp, ",");
 		if (!token)
-			ParseTrackId((char*)"", false);
+			AddTerm((char*)"");
 		while (token)
 		{
-			ParseTrackId(token, false);
+			AddTerm(token);
 			token = strtok(NULL, ",");
 		}
-		return;
 	}
+	else
+		AddTerm(temp);
+}
+
+void ConsoleTrackSelector::AddTerm(char* strId)
+{
+	TRACKID_TERM term = { TRACKID_NONE, false, false, 0, 0, "" };
+	char* p;
 
 	// Strip out / and signify a child
 	while ((p = strchr(strId, '/')) != NULL)
 	{
 		for (; *p; p++)
 			*p = *(p+1);
-		bChildren = true;
+		term.bChildren = true;
 	}
 
 	// Ignore the beginning spaces
@@ -237,144 +398,198 @@ void ParseTrackId(char* strId, bool bReset)
 	if (strId[0] == '!')
 	{
 		strId++;
-		bInvert = true;
+		term.bInvert = true;
 	}
 
 	// If the string is "all" or exactly "*", select all tracks.
 	if (_stricmp(strId, __LOCALIZE("all","sws_DLG_100")) == 0 || strcmp(strId, "*") == 0)
-		for (track = 0; track < GetNumTracks(); track++)
-			g_selTracks.Get()[track] = 1;
+		term.iType = TRACKID_ALL;
 
 	// If the string is empty, use the tracks' selected flags
 	else if (strId[0] == 0)
-		for (track = 0; track < GetNumTracks(); track++)
-		{
-			// If tracks were selected before (because of a comma separated list) don't change it here.
-			if (g_selTracks.Get()[track])
-				break;
-			int iSel = *((int*)GetSetMediaTrackInfo(CSurf_TrackFromID(track+1, false), "I_SELECTED", NULL));
-			g_selTracks.Get()[track] = iSel;
-		}
+	{
+		term.iType = TRACKID_SELECTED;
+		m_bUsesSelection = true;
+	}
 
 	// If a range is specified, select those numbers
 	else if ((p = strchr(strId, '-')) != NULL)
 	{
-		// Make sure the string is valid:
+		// Make sure the string is valid, an invalid range doesn't select, invert nor add children
 		int nondigchars = 0;
 		for (int i = 0; i < (int)strlen(strId); i++)
 			if (!isdigit(strId[i]))
 				nondigchars++;
 		if (nondigchars != 1)
-			return;
-
-		int start = atol(strId);
-		int end = atol(p+1);
-		if (start < 1)
-			start = 1;
-		if (end > GetNumTracks())
-			end = GetNumTracks();
-		for (track = start-1; track < end; track++)
-			g_selTracks.Get()[track] = 1;
+		{
+			term.bChildren = term.bInvert = false;
+		}
+		else
+		{
+			term.iType = TRACKID_RANGE;
+			term.iStart = atol(strId);
+			term.iEnd = atol(p+1);
+		}
 	}
-	
+
 	// If a wildcard is in the string, use loose matches
-	else if ((p = strchr(strId, '*')) != NULL)
+	else if (strchr(strId, '*'))
+	{
+		term.iType = TRACKID_WILDCARD;
+		term.strId.assign(strId);
+	}
+
+	// Exact numeric, or name
+	else
 	{
-		char* strMatch = NULL;
-		for (track = 0; track < GetNumTracks(); track++)
+		term.iType = TRACKID_NAME;
+		term.iStart = atol(strId);
+		term.strId.assign(strId);
+	}
+
+	m_terms.push_back(term);
+}
+
+void ConsoleTrackSelector::ApplyTerm(TRACKID_TERM* term, int* selTracks)
+{
+	int iTracks = g_trackIndex.NumTracks();
+	int track;
+
+	switch (term->iType)
+	{
+	case TRACKID_ALL:
+		for (track = 0; track < iTracks; track++)
+			selTracks[track] = 1;
+		break;
+	case TRACKID_SELECTED:
+		for (track = 0; track < iTracks; track++)
 		{
-			cName = (const char*)GetSetMediaTrackInfo(CSurf_TrackFromID(track+1, false), "P_NAME", NULL);
-			if (cName && cName[0])
-			{
-				if (p == strId && _strnicmp(strId+1, cName+1+strlen(cName)-strlen(strId), strlen(strId)-1) == 0)
-					g_selTracks.Get()[track] = 1;
-				else if (p-strId == strlen(strId) - 1 && _strnicmp(strId, cName, strlen(strId)-1) == 0)
-					g_selTracks.Get()[track] = 1;
-				// This "should" be the double wildcard case, but check anyway
-				else if (strId[0] == '*' && strlen(strId) > 2 && strId[strlen(strId)-1] == '*')
-				{
-					if (!strMatch)
-					{
-						strMatch = new char[strlen(strId)-1];
-						lstrcpyn(strMatch, strId+1, (int)strlen(strId)-1);
-					}
-					if (stristr(cName, strMatch))
-						g_selTracks.Get()[track] = 1;
-				}
-			}
+			// If tracks were selected before (because of a comma separated list) don't change it here.
+			if (selTracks[track])
+				break;
+			selTracks[track] = *((int*)GetSetMediaTrackInfo(CSurf_TrackFromID(track+1, false), "I_SELECTED", NULL));
 		}
-		delete [] strMatch;
+		break;
+	case TRACKID_RANGE:
+		for (track = (term->iStart < 1 ? 1 : term->iStart) - 1; track < term->iEnd && track < iTracks; track++)
+			selTracks[track] = 1;
+		break;
+	case TRACKID_WILDCARD:
+	{
+		const char* strId = term->strId.c_str();
+		size_t iLen = term->strId.size();
+		const char* p = strchr(strId, '*');
+		string strMatch = iLen > 2 ? term->strId.substr(1, iLen-2) : "";
+		for (track = 0; track < iTracks; track++)
+		{
+			const char* cName = g_trackIndex.GetName(track);
+			size_t iNameLen = strlen(cName);
+			if (!iNameLen)
+				continue;
+			if (p == strId && iNameLen+1 >= iLen && _strnicmp(strId+1, cName+1+iNameLen-iLen, iLen-1) == 0)
+				selTracks[track] = 1;
+			else if ((size_t)(p-strId) == iLen - 1 && _strnicmp(strId, cName, iLen-1) == 0)
+				selTracks[track] = 1;
+			// This "should" be the double wildcard case, but check anyway
+			else if (strId[0] == '*' && iLen > 2 && strId[iLen-1] == '*' && stristr(cName, strMatch.c_str()))
+				selTracks[track] = 1;
+		}
+		break;
+	}
+	case TRACKID_NAME:
+		if (term->iStart > 0 && term->iStart <= iTracks)
+			selTracks[term->iStart-1] = 1;
+		else
+			g_trackIndex.SelectName(term->strId.c_str(), selTracks);
+		break;
+	default:
+		break;
 	}
-	// Check for exact numeric
-	else if ((track = atol(strId)) > 0 && track <= GetNumTracks())
-		g_selTracks.Get()[track-1] = 1;
 
-	// Check for exact name matches, with "auto compelete"
-	//   e.g. if there's no exact match, but only one track that starts with the string, select that one
-	else
+	if (term->bChildren)
 	{
-		int iCloseMatch = 0;
-		int iExactMatch = 0;
-		int iMatchedTrack;
-		for (track = 0; track < GetNumTracks(); track++)
+		for (track = 0; track < iTracks; track++)
 		{
-			cName = (const char*)GetSetMediaTrackInfo(CSurf_TrackFromID(track+1, false), "P_NAME", NULL);
-			// Exact name match
-			if (cName[0] && _stricmp(strId, cName) == 0)
-			{
-				iExactMatch++;
-				g_selTracks.Get()[track] = 1;
-			}
-			// Exact number match
-			else if (atol(strId) == track+1)
+			int iLastChild = g_trackIndex.GetLastChild(track);
+			if (iLastChild >= 0 && selTracks[track])
 			{
-				iExactMatch++;
-				g_selTracks.Get()[track] = 1;
-			}
-			// Check for close match
-			else if (cName[0] && _strnicmp(strId, cName, strlen(strId)) == 0)
-			{
-				iCloseMatch++;
-				iMatchedTrack = track;
+				for (; track < iLastChild; track++)
+					selTracks[track+1] = 1;
 			}
 		}
-
-		if (!iExactMatch && iCloseMatch == 1)
-			g_selTracks.Get()[iMatchedTrack] = 1;
 	}
 
-	if (bChildren)
+	if (term->bInvert)
 	{
-		int iParentDepth;
-		bool bSelected = false;
-		MediaTrack* gfd = NULL;
-		for (int i = 0; i < GetNumTracks(); i++)
-		{
-			MediaTrack* tr = CSurf_TrackFromID(i+1, false);
-			int iType;
-			int iFolder = GetFolderDepth(tr, &iType, &gfd);
+		for (track = 0; track < iTracks; track++)
+			selTracks[track] = selTracks[track] ? 0 : 1;
+	}
+}
 
-			if (bSelected)
-				g_selTracks.Get()[i] = 1;
+void ConsoleTrackSelector::Select()
+{
+	int iGeneration = g_trackIndex.Update();
+	int iTracks = g_trackIndex.NumTracks();
+	if (!iTracks)
+		return;
 
-			if (iType == 1 && !bSelected && g_selTracks.Get()[i])
-			{
-				iParentDepth = iFolder;
-				bSelected = true;
-			}
+	g_selTracks.Resize(iTracks, false);
 
-			if (iType + iFolder <= iParentDepth)
-				bSelected = false;
-		}
+	// Unless the tracks' selected flags are involved, the result only depends on the index
+	if (!m_bUsesSelection && iGeneration == m_iGeneration && m_result.GetSize() == iTracks)
+	{
+		memcpy(g_selTracks.Get(), m_result.Get(), iTracks * sizeof(int));
+		return;
 	}
 
-	if (bInvert)
+	memset(g_selTracks.Get(), 0, iTracks * sizeof(int));
+	for (int i = 0; i < (int)m_terms.size(); i++)
+		ApplyTerm(&m_terms[i], g_selTracks.Get());
+
+	if (!m_bUsesSelection)
 	{
-		for (int i = 0; i < GetNumTracks(); i++)
-			g_selTracks.Get()[i] = g_selTracks.Get()[i] ? 0 : 1;
+		m_iGeneration = iGeneration;
+		m_result.Resize(iTracks, false);
+		memcpy(m_result.Get(), g_selTracks.Get(), iTracks * sizeof(int));
 	}
 }
 
+// ParseTrackId fills in array of ints (g_selTracks.Get()) according to id string
+void ParseTrackId(const char* strId)
+{
+	ConsoleTrackSelector(strId).Select();
+}
+
+// Console command compiled once, for custom commands and cycle actions
+class ConsoleProgram
+{
+public:
+	ConsoleProgram(const char* cmd) : m_command(UNKNOWN_COMMAND), m_selector(NULL)
+	{
+		char strCommand[128] = "";
+		lstrcpyn(strCommand, cmd, sizeof(strCommand));
+		char* pTrackId = strCommand;
+		char* pArgs = strCommand;
+		m_command = ParseConsoleCommand(strCommand, &pTrackId, &pArgs);
+		m_args.Set(pArgs);
+		m_selector = new ConsoleTrackSelector(pTrackId);
+	}
+	~ConsoleProgram() { delete m_selector; }
+	void Run()
+	{
+		m_selector->Select();
+		ProcessCommand(m_command, m_args.Get());
+	}
+
+private:
+	WDL_FastString m_args;
+	CONSOLE_COMMAND m_command;
+	ConsoleTrackSelector* m_selector;
+};
+
+static void DeleteConsoleProgram(ConsoleProgram* program) { delete program; }
+static WDL_StringKeyedArray<ConsoleProgram*> g_consolePrograms(true, DeleteConsoleProgram);
+
 // Here's where we actually do the command from the user
 void ProcessCommand(CONSOLE_COMMAND command, const char* args)
 {
@@ -630,6 +845,10 @@ void ProcessCommand(CONSOLE_COMMAND command, const char* args)
 			break;
 		}
 	}
+
+	// Track names changed, see ConsoleTrackIndex
+	if (command == NAME_SET || command == NAME_PREFIX || command == NAME_SUFFIX)
+		g_trackIndex.Invalidate();
 }
 
 // Provide a human readable string of what's up:
@@ -715,13 +934,13 @@ void BringKeyCommand(COMMAND_T* = NULL)
 // primitive (no undo point)
 void RunConsoleCommand(const char* cmd)
 {
-	char strCommand[128] = "";
-	lstrcpyn(strCommand, cmd, sizeof(strCommand));
-	char* pTrackId = strCommand;
-	char* pArgs = strCommand;
-	CONSOLE_COMMAND command = ParseConsoleCommand(strCommand, &pTrackId, &pArgs);
-	ParseTrackId(pTrackId);
-	ProcessCommand(command, pArgs);
+	ConsoleProgram* program = g_consolePrograms.Get(cmd);
+	if (!program)
+	{
+		program = new ConsoleProgram(cmd);
+		g_consolePrograms.Insert(cmd, program);
+	}
+	program->Run();
 }
 
 void RunConsoleCommand(COMMAND_T* ct)
@@ -43,31 +43,129 @@ void GrooveTemplateHandler::ClearGroove()
     me->grooveInBeats.clear();
 }
 
-static bool GetGrooveBeatPosition(double currentBeatPosition, double maxBeatDistance, 
-                                  double strength, std::vector<GrooveItem> *grooveInBeats,
-                                  GrooveItem &newGroove)
+static bool sortGrooveItems(const GrooveItem &lhs, const GrooveItem &rhs)
 {
-    /* get max distance position */
-    double minDistance = maxBeatDistance;
-    bool positive = true;
-    for (std::vector<GrooveItem>::iterator it = grooveInBeats->begin(); it != grooveInBeats->end();
-         ++it)
+    return lhs.position < rhs.position;
+}
+
+/* The groove repeats every nBeatsInGroove beats from the first measure of the
+ * selection. Instead of expanding it over the whole selection, keep one sorted
+ * period and find the nearest groove beat by modulo indexing + binary search. */
+class GrooveGrid
+{
+public:
+    GrooveGrid(const std::vector<GrooveItem> &grooveInBeats, int nBeatsInGroove, double leftEdge)
+        : mTemplate(grooveInBeats), mPeriod((double)nBeatsInGroove)
     {
-        double distance = currentBeatPosition - it->position;
-        if( abs(distance) < minDistance) {
-            positive = distance > 0 ? true : false;
-            minDistance = abs(distance);
-            newGroove = *it;
+        mOrigin = BeatsTillMeasure(TimeToMeasure(leftEdge));
+        if(mPeriod > 0.0) {
+            for(std::vector<GrooveItem>::iterator it = mTemplate.begin(); it != mTemplate.end(); ++it) {
+                it->position = fmod(it->position, mPeriod);
+                if(it->position < 0.0)
+                    it->position += mPeriod;
+            }
         }
+        std::stable_sort(mTemplate.begin(), mTemplate.end(), sortGrooveItems);
     }
-    if(minDistance >= maxBeatDistance) {
-        return false;
+
+    bool getGrooveBeatPosition(double currentBeatPosition, double maxBeatDistance, double strength, GrooveItem &newGroove) const
+    {
+        if(mTemplate.empty())
+            return false;
+
+        double offset = currentBeatPosition - mOrigin;
+        double cycle = mPeriod > 0.0 ? floor(offset / mPeriod) : 0.0;
+        GrooveItem local;
+        local.position = offset - cycle * mPeriod;
+        size_t next = std::lower_bound(mTemplate.begin(), mTemplate.end(), local, sortGrooveItems) - mTemplate.begin();
+
+        /* only the groove beats around the position can be the nearest ones,
+         * check them in ascending order so ties resolve to the earlier beat */
+        GrooveItem candidates[2];
+        int nCandidates = 0;
+        if(next > 0)
+            candidates[nCandidates++] = at(firstOf(next - 1), cycle);
+        else if(mPeriod > 0.0)
+            candidates[nCandidates++] = at(firstOf(mTemplate.size() - 1), cycle - 1.0);
+        if(next < mTemplate.size())
+            candidates[nCandidates++] = at(next, cycle);
+        else if(mPeriod > 0.0)
+            candidates[nCandidates++] = at(0, cycle + 1.0);
+
+        /* get max distance position */
+        double minDistance = maxBeatDistance;
+        bool positive = true;
+        for(int i = 0; i < nCandidates; ++i) {
+            if(candidates[i].position < 0.0)
+                continue;
+            double distance = currentBeatPosition - candidates[i].position;
+            if( abs(distance) < minDistance) {
+                positive = distance > 0 ? true : false;
+                minDistance = abs(distance);
+                newGroove = candidates[i];
+            }
+        }
+        if(minDistance >= maxBeatDistance) {
+            return false;
+        }
+
+        double distance = minDistance * (positive ? 1.0 : -1.0);
+        newGroove.position = currentBeatPosition - distance * strength;
+        return true;
     }
 
-    double distance = minDistance * (positive ? 1.0 : -1.0);
-    newGroove.position = currentBeatPosition - distance * strength;
-    return true;
-}
+private:
+    /* loaded grooves may hold duplicate positions, use the first one like a linear scan would */
+    size_t firstOf(size_t index) const
+    {
+        return std::lower_bound(mTemplate.begin(), mTemplate.begin() + index, mTemplate[index], sortGrooveItems) - mTemplate.begin();
+    }
+
+    GrooveItem at(size_t index, double cycle) const
+    {
+        GrooveItem grooveItem = mTemplate[index];
+        grooveItem.position += mOrigin + cycle * mPeriod;
+        return grooveItem;
+    }
+
+    std::vector<GrooveItem> mTemplate;
+    double mOrigin;
+    double mPeriod;
+};
+
+/* Remembers the last tempo map conversions so chords and notes sharing
+ * a groove beat only hit the tempo map once. */
+class GrooveTimeMapCache
+{
+public:
+    GrooveTimeMapCache() : mHasTime(false), mHasBeat(false) {}
+
+    double timeToBeat(double time, int &beatsInMeasure)
+    {
+        if(!mHasTime || time != mTime) {
+            mTime = time;
+            mBeat = TimeToBeat(time, &mBeatsInMeasure);
+            mHasTime = true;
+        }
+        beatsInMeasure = mBeatsInMeasure;
+        return mBeat;
+    }
+
+    double beatToTime(double beat)
+    {
+        if(!mHasBeat || beat != mGrooveBeat) {
+            mGrooveBeat = beat;
+            mGrooveTime = BeatToTime(beat);
+            mHasBeat = true;
+        }
+        return mGrooveTime;
+    }
+
+private:
+    bool mHasTime, mHasBeat;
+    double mTime, mBeat, mGrooveBeat, mGrooveTime;
+    int mBeatsInMeasure;
+};
 
 void GrooveTemplateHandler::Init()
 {
@@ -190,24 +288,28 @@ static bool convertToInProjectMidi(RprItemCtrPtr &ctr)
 }
 
 static void applyGrooveToMidiTake(RprMidiTake &midiTake, double beatDivider, double positionStrength, double velocityStrength,
-                                  std::vector<GrooveItem> &grooveBeats, bool selectedOnly)
+                                  const GrooveGrid &grooveGrid, bool selectedOnly)
 {
     RprItem rprItem = *midiTake.getParent();
+
+    /* fudge factor for issue 348 */
+    static const double epsilon = 0.0000000001;
+    double itemFirstBeat = TimeToBeat(rprItem.getPosition()) - epsilon;
+    double itemLastBeat = TimeToBeat(rprItem.getPosition() + rprItem.getLength());
+
+    GrooveTimeMapCache timeMap;
     for(int i = 0; i < midiTake.countNotes(); i++) {
         RprMidiNote *note = midiTake.getNoteAt(i);
         if(selectedOnly && !note->isSelected())
             continue;
-        double noteBeat = TimeToBeat(note->getPosition());
+        int beatsInMeasure = 0;
+        double noteBeat = timeMap.timeToBeat(note->getPosition(), beatsInMeasure);
         GrooveItem grooveItem;
-        if(!GetGrooveBeatPosition(noteBeat, BeatsInMeasure(BeatToMeasure(noteBeat)) / beatDivider, positionStrength, &grooveBeats, grooveItem))
+        if(!grooveGrid.getGrooveBeatPosition(noteBeat, beatsInMeasure / beatDivider, positionStrength, grooveItem))
             continue;
 
-                /* fudge factor for issue 348 */
-                static const double epsilon = 0.0000000001;
-        double itemFirstBeat = TimeToBeat(rprItem.getPosition()) - epsilon;
-        double itemLastBeat = TimeToBeat(rprItem.getPosition() + rprItem.getLength());
         if(grooveItem.position >= itemFirstBeat && grooveItem.position < itemLastBeat) {
-            note->setPosition(BeatToTime(grooveItem.position));
+            note->setPosition(timeMap.beatToTime(grooveItem.position));
             if(grooveItem.amplitude >= 0.0) {
                 int newVelocity = (int)(grooveItem.amplitude * 127.5);
                 int difference = newVelocity - note->getVelocity();
@@ -219,47 +321,6 @@ static void applyGrooveToMidiTake(RprMidiTake &midiTake, double beatDivider, dou
     }
 }
 
-static double getRightEdgeOfContainer(RprItemCtrPtr &ctr)
-{
-    double rightEdge = 0.0;
-    for(int i = 0; i < ctr->size(); i++) {
-        double testRightEdge = ctr->getAt(i).getPosition() + ctr->getAt(i).getLength();
-        if(testRightEdge > rightEdge)
-            rightEdge = testRightEdge;
-    }
-    return rightEdge;
-}
-
-static double getRightEdgeOfMidiTake(RprMidiTakePtr &take)
-{
-    double rightEdge = 0.0;
-    for(int i = 0; i < take->countNotes(); i++) {
-        double testRightEdge = take->getNoteAt(i)->getPosition() + take->getNoteAt(i)->getLength();
-        if(testRightEdge > rightEdge)
-            rightEdge = testRightEdge;
-    }
-    return rightEdge;
-}
-
-static void createGrooveVector(double leftEdge, double rightEdge, std::vector<GrooveItem> &inputGrooveBeats, int nBeatsInGroove, std::vector<GrooveItem> &outputGrooveBeats)
-{
-    /* create vector of positions which is longer then the total length of the items */
-    int beatCount = (int)ceil(TimeToBeat(rightEdge) - TimeToBeat(leftEdge));
-    int firstMeasure = TimeToMeasure(leftEdge);
-    double beatsTillFirstMeasure = BeatsTillMeasure(firstMeasure);
-
-    for(int i = -nBeatsInGroove; i < beatCount + nBeatsInGroove; i += nBeatsInGroove) {
-        for(std::vector<GrooveItem>::iterator j = inputGrooveBeats.begin(); j != inputGrooveBeats.end(); j++) {
-            double grooveBeatPosition = j->position + i + beatsTillFirstMeasure;
-            if(grooveBeatPosition >= 0.0f) {
-                GrooveItem grooveItem = *j;
-                grooveItem.position = grooveBeatPosition;
-                outputGrooveBeats.push_back(grooveItem);
-            }
-        }
-    }
-}
-
 bool treatAsMidiTake(RprMidiTake &midiTake)
 {
     if(!(midiTake.countNotes() == 1 && midiTake.getNoteAt(0)->getPosition() == 0.0))
@@ -267,11 +328,12 @@ bool treatAsMidiTake(RprMidiTake &midiTake)
     return false;
 }
 
-void applyGrooveToItem(RprItem &rprItem, double beatDivider, double strength, std::vector<GrooveItem> &grooveBeats)
+void applyGrooveToItem(RprItem &rprItem, double beatDivider, double strength, const GrooveGrid &grooveGrid)
 {
-    double beatPosition = TimeToBeat(rprItem.getPosition() + rprItem.getSnapOffset());
+    int beatsInMeasure = 0;
+    double beatPosition = TimeToBeat(rprItem.getPosition() + rprItem.getSnapOffset(), &beatsInMeasure);
     GrooveItem grooveItem;
-    if(!GetGrooveBeatPosition(beatPosition, BeatsInMeasure(BeatToMeasure(beatPosition)) / beatDivider, strength, &grooveBeats, grooveItem))
+    if(!grooveGrid.getGrooveBeatPosition(beatPosition, beatsInMeasure / beatDivider, strength, grooveItem))
         return;
 
     double timePosition = BeatToTime(grooveItem.position) - rprItem.getSnapOffset();
@@ -291,13 +353,8 @@ void GrooveTemplateHandler::ApplyGrooveToMidiEditor(int beatDivider, double posS
     if(me->grooveInBeats.size() == 0)
         return;
 
-    std::vector<GrooveItem> grooveBeats;
-    createGrooveVector(takePtr->getNoteAt(0)->getPosition(),
-        getRightEdgeOfMidiTake(takePtr),
-        me->grooveInBeats,
-        me->nBeatsInGroove,
-        grooveBeats);
-    applyGrooveToMidiTake(*takePtr.get(), (double)beatDivider, posStrength, velStrength, grooveBeats, true);
+    GrooveGrid grooveGrid(me->grooveInBeats, me->nBeatsInGroove, takePtr->getNoteAt(0)->getPosition());
+    applyGrooveToMidiTake(*takePtr.get(), (double)beatDivider, posStrength, velStrength, grooveGrid, true);
 }
 
 
@@ -318,29 +375,25 @@ void GrooveTemplateHandler::ApplyGroove(int beatDivider, double posStrength, dou
         return;
 
     ctr->sort();
-    std::vector<GrooveItem> grooveBeats;
-
-    createGrooveVector(ctr->first().getPosition() + ctr->first().getSnapOffset(),
-        getRightEdgeOfContainer(ctr),
-        me->grooveInBeats,
-        me->nBeatsInGroove,
-        grooveBeats);
+    GrooveGrid grooveGrid(me->grooveInBeats, me->nBeatsInGroove, ctr->first().getPosition() + ctr->first().getSnapOffset());
 
     /* apply groove to midi notes and media items */
+    PreventUIRefresh(1);
     for(int i = 0; i < ctr->size(); i++) {
         RprItem rprItem = ctr->getAt(i);
         if(!rprItem.getActiveTake().isMIDI()) {
-            applyGrooveToItem(rprItem, (double)beatDivider, posStrength, grooveBeats);
+            applyGrooveToItem(rprItem, (double)beatDivider, posStrength, grooveGrid);
             continue;
         }
 
         RprMidiTake midiTake(rprItem.getActiveTake());
         if(treatAsMidiTake(midiTake))
-            applyGrooveToMidiTake(midiTake, (double)beatDivider, posStrength, velStrength, grooveBeats, false);
+            applyGrooveToMidiTake(midiTake, (double)beatDivider, posStrength, velStrength, grooveGrid, false);
         else
-            applyGrooveToItem(rprItem, (double)beatDivider, posStrength, grooveBeats);
+            applyGrooveToItem(rprItem, (double)beatDivider, posStrength, grooveGrid);
 
     }
+    PreventUIRefresh(-1);
     UpdateTimeline();
 }
 
@@ -391,11 +444,6 @@ static int GetMidiBeatPositions(RprMidiTake &midiTake, const RprItem &parent, st
     return (int)vPositions.size();
 }
 
-static bool sortGrooveItems(const GrooveItem &lhs, const GrooveItem &rhs)
-{
-    return lhs.position < rhs.position;
-}
-
 static bool isGrooveItemUnique(const GrooveItem &lhs, const GrooveItem &rhs)
 {
     return lhs.position == rhs.position;
@@ -683,8 +731,11 @@ std::string GrooveTemplateHandler::GrooveToString()
 
 void GrooveTemplateHandler::BeginLoadProjectState(bool isUndo, struct project_config_extension_t *reg)
 {
-    GrooveTemplateHandler *me = GrooveTemplateHandler::Instance();
-    me->grooveMarkers.clear();
+    // groove markers aren't part of undo states (see SaveGrooveMarkers)
+    if(!isUndo) {
+        GrooveTemplateHandler *me = GrooveTemplateHandler::Instance();
+        me->grooveMarkers.clear();
+    }
 }
 
 static bool markerExists(int myIndex, const std::string &myName, double myPos)
@@ -797,3 +848,166 @@ void GrooveTemplateHandler::resetAmplitudes()
     }
 
 }
+
+#ifdef BR_DEBUG_PERFORMANCE_BENCHMARK
+/* The groove expansion and linear scan GrooveGrid replaced, kept as the reference */
+static void createReferenceGrooveVector(double origin, int beatCount, const std::vector<GrooveItem> &inputGrooveBeats, int nBeatsInGroove, std::vector<GrooveItem> &outputGrooveBeats)
+{
+    for(int i = -nBeatsInGroove; i < beatCount + nBeatsInGroove; i += nBeatsInGroove) {
+        for(std::vector<GrooveItem>::const_iterator j = inputGrooveBeats.begin(); j != inputGrooveBeats.end(); j++) {
+            double grooveBeatPosition = j->position + i + origin;
+            if(grooveBeatPosition >= 0.0f) {
+                GrooveItem grooveItem = *j;
+                grooveItem.position = grooveBeatPosition;
+                outputGrooveBeats.push_back(grooveItem);
+            }
+        }
+    }
+}
+
+static bool getReferenceGrooveBeatPosition(double currentBeatPosition, double maxBeatDistance, double strength, const std::vector<GrooveItem> &grooveBeats, GrooveItem &newGroove)
+{
+    double minDistance = maxBeatDistance;
+    bool positive = true;
+    for(std::vector<GrooveItem>::const_iterator it = grooveBeats.begin(); it != grooveBeats.end(); ++it) {
+        double distance = currentBeatPosition - it->position;
+        if( abs(distance) < minDistance) {
+            positive = distance > 0 ? true : false;
+            minDistance = abs(distance);
+            newGroove = *it;
+        }
+    }
+    if(minDistance >= maxBeatDistance) {
+        return false;
+    }
+
+    double distance = minDistance * (positive ? 1.0 : -1.0);
+    newGroove.position = currentBeatPosition - distance * strength;
+    return true;
+}
+
+/* Same random groove and queries resolved by the reference and by GrooveGrid,
+ * over the tempo map of the current project */
+static void GrooveGridBenchmark(const BR_BenchmarkConfig &cfg, vector<BR_BenchmarkResult> &results)
+{
+    const int nBeatsInGroove = 8, nGrooveItems = 24, beatCount = 1000, queries = 20000;
+    const double leftEdge = 1.0, maxBeatDistance = 0.25, strength = 0.75;
+
+    unsigned int seed = 12345;
+    std::vector<GrooveItem> groove;
+    for(int i = 0; i < nGrooveItems; ++i) {
+        GrooveItem grooveItem;
+        seed = seed * 1103515245 + 12345;
+        grooveItem.position = (double)i * nBeatsInGroove / nGrooveItems + ((seed >> 16) % 100) / 2000.0;
+        grooveItem.amplitude = (double)i / nGrooveItems;
+        groove.push_back(grooveItem);
+    }
+    groove.push_back(groove[nGrooveItems / 2]); /* loaded grooves may hold duplicate positions */
+    groove.back().amplitude = -1.0;
+    std::stable_sort(groove.begin(), groove.end(), sortGrooveItems);
+
+    std::vector<double> beats;
+    double origin = BeatsTillMeasure(TimeToMeasure(leftEdge));
+    for(int i = 0; i < queries; ++i) {
+        seed = seed * 1103515245 + 12345;
+        beats.push_back(origin + (double)((seed >> 8) % (beatCount * 1000)) / 1000.0);
+    }
+
+    BR_BenchmarkResult linear("GrooveGrid/linear"), grid("GrooveGrid/binary_search");
+    linear.name.SetFormatted(256, "%d groove beat lookups over %d beats (expanded groove, linear scan)", queries, beatCount);
+    grid.name.SetFormatted(256, "%d groove beat lookups over %d beats (GrooveGrid)", queries, beatCount);
+
+    std::vector<GrooveItem> expected(queries), found(queries);
+    std::vector<bool> expectedFound(queries), foundFound(queries);
+    for(int i = 0; i < cfg.iterations; ++i) {
+        double start = time_precise();
+        std::vector<GrooveItem> grooveBeats;
+        createReferenceGrooveVector(origin, beatCount, groove, nBeatsInGroove, grooveBeats);
+        for(int j = 0; j < queries; ++j)
+            expectedFound[j] = getReferenceGrooveBeatPosition(beats[j], maxBeatDistance, strength, grooveBeats, expected[j]);
+        linear.AddTime(start);
+
+        start = time_precise();
+        GrooveGrid grooveGrid(groove, nBeatsInGroove, leftEdge);
+        for(int j = 0; j < queries; ++j)
+            foundFound[j] = grooveGrid.getGrooveBeatPosition(beats[j], maxBeatDistance, strength, found[j]);
+        grid.AddTime(start);
+    }
+
+    for(int j = 0; j < queries && !grid.failure.GetLength(); ++j) {
+        if(expectedFound[j] != foundFound[j] || (expectedFound[j] &&
+           (fabs(expected[j].position - found[j].position) > 1e-9 || expected[j].amplitude != found[j].amplitude)))
+            grid.failure.SetFormatted(256, "results differ from the linear scan at beat %.3f", beats[j]);
+    }
+    results.push_back(linear);
+    results.push_back(grid);
+}
+static BR_BenchmarkRegistration s_grooveGridBenchmark(GrooveGridBenchmark);
+
+static void fillGrooveBenchmarkTake(MediaItem_Take *take, double position, double length, int noteCount)
+{
+    double startPPQ = MIDI_GetPPQPosFromProjTime(take, position);
+    double noteLen = (MIDI_GetPPQPosFromProjTime(take, position + length) - startPPQ) / noteCount;
+    bool noSort = true;
+    for(int i = 0; i < noteCount; ++i) {
+        double start = startPPQ + i * noteLen;
+        MIDI_InsertNote(take, false, false, start, start + noteLen * 0.9, i % 16, 36 + (i % 48), 1 + (i * 7) % 127, &noSort);
+    }
+    MIDI_Sort(take);
+}
+
+/* Whole groove application on a 50k-note take: parsing the take, moving every
+ * note through GrooveGrid and writing the take back. The take is recreated for
+ * each iteration so every pass grooves the same straight notes */
+static void GrooveMidiTakeBenchmark(const BR_BenchmarkConfig &cfg, vector<BR_BenchmarkResult> &results)
+{
+    const int nBeatsInGroove = 4, noteCount = 50000;
+    const double position = 1.0, length = 600.0;
+
+    std::vector<GrooveItem> groove;
+    for(int i = 0; i < 16; ++i) {
+        GrooveItem grooveItem;
+        grooveItem.position = i * 0.25 + ((i % 2) ? 0.08 : 0.0);
+        grooveItem.amplitude = (i % 4) ? 0.6 : 0.9;
+        groove.push_back(grooveItem);
+    }
+
+    BR_BenchmarkResult result("GrooveGrid/midi_take");
+    result.name.SetFormatted(256, "Apply groove to a take with %d notes (applyGrooveToMidiTake)", noteCount);
+
+    PreventUIRefresh(1);
+    int trackId = CountTracks(NULL);
+    InsertTrackAtIndex(trackId, false);
+    MediaTrack *track = GetTrack(NULL, trackId);
+    GrooveGrid grooveGrid(groove, nBeatsInGroove, position);
+    for(int i = 0; track && i < cfg.iterations && !result.failure.GetLength(); ++i) {
+        MediaItem *item = CreateNewMIDIItemInProj(track, position, position + length, NULL);
+        MediaItem_Take *take = item ? GetActiveTake(item) : NULL;
+        if(!take) {
+            result.failure.Set("unable to create the MIDI take");
+            break;
+        }
+        fillGrooveBenchmarkTake(take, position, length, noteCount);
+
+        double start = time_precise();
+        {
+            RprTake rprTake(take);
+            RprMidiTake midiTake(rprTake);
+            applyGrooveToMidiTake(midiTake, 1.0, 1.0, 0.5, grooveGrid, false);
+        }
+        result.AddTime(start);
+
+        int notes = 0;
+        MIDI_CountEvts(take, &notes, NULL, NULL);
+        if(notes != noteCount)
+            result.failure.SetFormatted(256, "take holds %d notes after applying the groove, expected %d", notes, noteCount);
+        DeleteTrackMediaItem(track, item);
+    }
+    if(track)
+        DeleteTrack(track);
+    PreventUIRefresh(-1);
+
+    results.push_back(result);
+}
+static BR_BenchmarkRegistration s_grooveMidiTakeBenchmark(GrooveMidiTakeBenchmark);
+#endif
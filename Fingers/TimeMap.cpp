@@ -1,21 +1,32 @@
 #include "stdafx.h"
 
 #include "TimeMap.h"
+#include "../Breeder/BR_TempoMap.h"
 
+// Conversions go through the cached tempo map snapshot (binary search) since
+// groove/quantize code calls these for every note and item
 double TimeToBeat(double time)
 {
-    return TimeMap2_timeToBeats(0, time, NULL, NULL, NULL, NULL);
+    return GetTempoMap().TimeToBeats(time);
+}
+
+double TimeToBeat(double time, int *beatsInMeasure)
+{
+    int measure = 0;
+    double fullBeats = 0.0;
+    GetTempoMap().TimeToBeats(time, &measure, beatsInMeasure, &fullBeats);
+    return fullBeats;
 }
 
 double BeatToTime(double beat)
 {
-    return TimeMap2_beatsToTime(0, beat, NULL);
+    return GetTempoMap().BeatsToTime(beat);
 }
 
 int TimeToMeasure(double time)
 {
     int measure = 0;
-    TimeMap2_timeToBeats(0, time, &measure, NULL, NULL, NULL);
+    GetTempoMap().TimeToBeats(time, &measure);
     return measure;
 }
 
@@ -27,26 +38,26 @@ int BeatToMeasure(double beat)
 
 double MeasureToTime(int measure)
 {
-    return TimeMap2_beatsToTime(0, 0.0f, &measure);
+    return GetTempoMap().BeatsToTime(0.0, &measure);
 }
 
 int BeatsInMeasure(int measure)
 {
     double time = MeasureToTime(measure);
     int measureLength = 0;
-    TimeMap2_timeToBeats(0, time, &measure, &measureLength, NULL, NULL);
+    GetTempoMap().TimeToBeats(time, &measure, &measureLength);
     return measureLength;
 }
 
 double BeatsTillMeasure(int measure)
 {
     double time = MeasureToTime(measure);
-    return TimeMap2_timeToBeats(0, time, NULL, NULL, NULL, NULL);
+    return GetTempoMap().TimeToBeats(time);
 }
 
 double BPMAtTime(double time)
 {
-    return TimeMap2_GetDividedBpmAtTime(0, time);
+    return GetTempoMap().GetDividedBpmAtTime(time);
 }
 
 double QNtoTime(double qn)
@@ -60,5 +71,5 @@ double TimeToQN(double t)
 
 double BPMatTime(double t)
 {
-    return TimeMap2_GetDividedBpmAtTime(0, t);
+    return GetTempoMap().GetDividedBpmAtTime(t);
 }
@@ -2,6 +2,7 @@
 #define _TIME_MAP_H_
 
 double TimeToBeat(double time);
+double TimeToBeat(double time, int *beatsInMeasure); /* one tempo map lookup for both */
 double BeatToTime(double beat);
 int TimeToMeasure(double time);
 int BeatToMeasure(double beat);
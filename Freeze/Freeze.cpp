@@ -31,6 +31,7 @@
 #include "MuteState.h"
 #include "ActiveTake.h"
 #include "TimeState.h"
+#include "../Utility/UndoStates.h"
 
 //#define TESTCODE
 
@@ -145,7 +146,7 @@ static bool ProcessExtensionLine(const char *line, ProjectStateContext *ctx, boo
 			if (lp.gettoken_str(0)[0] == '>')
 				break;
 			else if (strcmp("ITEMSTATE", lp.gettoken_str(0)) == 0)
-				ts->m_items.Add(new ItemState(&lp));
+				ts->AddItem(ItemState(&lp));
 		}
 		return true;
 	}
@@ -240,11 +241,12 @@ static void SaveExtensionConfig(ProjectStateContext *ctx, bool isUndo, struct pr
 {
 	char str[4096];
 
+	// written to undo states too (unchanged states are only referenced there, see g_undoStates)
 	for (int i = 0; i < g_tracks.Get()->GetSize(); i++)
 	{
 		ctx->AddLine("%s",g_tracks.Get()->Get(i)->ItemString(str, 4096)); 
-		for (int j = 0; j < g_tracks.Get()->Get(i)->m_items.GetSize(); j++)
-			ctx->AddLine("%s",g_tracks.Get()->Get(i)->m_items.Get(j)->ItemString(str, 4096));
+		for (int j = 0; j < (int)g_tracks.Get()->Get(i)->m_items.size(); j++)
+			ctx->AddLine("%s",g_tracks.Get()->Get(i)->m_items[j].ItemString(str, 4096));
 		ctx->AddLine(">");
 	}
 	bool bDone;
@@ -295,6 +297,7 @@ static void BeginLoadProjectState(bool isUndo, struct project_config_extension_t
 }
 
 static project_config_extension_t g_projectconfig = { ProcessExtensionLine, SaveExtensionConfig, BeginLoadProjectState, NULL };
+static SWS_UndoStates g_undoStates("FREEZE", &g_projectconfig); // unchanged states are referenced in undo points
 
 //!WANT_LOCALIZE_1ST_STRING_BEGIN:sws_actions
 static COMMAND_T g_commandTable[] = 
@@ -369,7 +372,7 @@ static COMMAND_T g_commandTable[] =
 int FreezeInit()
 {
 	SWSRegisterCommands(g_commandTable);
-	if (!plugin_register("projectconfig",&g_projectconfig))
+	if (!plugin_register("projectconfig", g_undoStates.GetProjectConfig()))
 		return 0;
 
 	return 1;
@@ -377,5 +380,5 @@ int FreezeInit()
 
 void FreezeExit()
 {
-	plugin_register("-projectconfig",&g_projectconfig);
+	plugin_register("-projectconfig", g_undoStates.GetProjectConfig());
 }
@@ -33,6 +33,31 @@
 // Globals
 SWSProjConfig<WDL_PtrList_DOD<TrackState> > g_tracks;
 
+// Maps the GUIDs of the track's items to the items, first one wins like a linear search would
+static void GetItemsByGuid(MediaTrack* tr, map<GUID, MediaItem*, GuidLess>* items)
+{
+	for (int i = 0; i < GetTrackNumMediaItems(tr); i++)
+	{
+		MediaItem* mi = GetTrackMediaItem(tr, i);
+		items->insert(make_pair(*(GUID*)GetSetMediaItemInfo(mi, "GUID", NULL), mi));
+	}
+}
+
+static MediaItem* FindItem(map<GUID, MediaItem*, GuidLess>& items, const GUID& guid)
+{
+	map<GUID, MediaItem*, GuidLess>::iterator it = items.find(guid);
+	return it != items.end() ? it->second : NULL;
+}
+
+static TrackState* FindTrackState(MediaTrack* tr)
+{
+	const GUID* guid = (GUID*)GetSetMediaTrackInfo(tr, "GUID", NULL);
+	for (int i = 0; i < g_tracks.Get()->GetSize(); i++)
+		if (GuidsEqual(guid, &g_tracks.Get()->Get(i)->m_guid))
+			return g_tracks.Get()->Get(i);
+	return NULL;
+}
+
 //*****************************************************
 // ItemState Class
 ItemState::ItemState(LineParser* lp)
@@ -71,25 +96,8 @@ ItemState::ItemState(MediaItem* mi)
 	m_dFadeOut = *(double*)GetSetMediaItemInfo(mi, "D_FADEOUTLEN", NULL);
 }
 
-MediaItem* ItemState::FindItem(MediaTrack* tr)
-{
-	// Find the media item in the track
-	MediaItem* mi = NULL;
-	for (int i = 0; i < GetTrackNumMediaItems(tr); i++)
-	{
-		mi = GetTrackMediaItem(tr, i);
-		if (GuidsEqual(&m_guid, (GUID*)GetSetMediaItemInfo(mi, "GUID", NULL)))
-			return mi;
-	}
-	return NULL;
-}
-
-void ItemState::Restore(MediaTrack* tr, bool bSelOnly)
+void ItemState::Restore(MediaItem* mi, bool bSelOnly)
 {
-	// First gotta find the media item in the track
-	MediaItem* mi = FindItem(tr);
-	if (mi == NULL)
-		return;
 	if (!bSelOnly || *(bool*)GetSetMediaItemInfo(mi, "B_UISEL", NULL))
 	{
 		GetSetMediaItemInfo(mi, "B_MUTE", &m_bMute);
@@ -115,14 +123,6 @@ char* ItemState::ItemString(char* str, int maxLen)
 	return str;
 }
 
-void ItemState::Select(MediaTrack* tr)
-{
-	MediaItem* mi = FindItem(tr);
-	if (mi == NULL)
-		return;
-	GetSetMediaItemInfo(mi, "B_UISEL", &g_bTrue);
-}
-
 //*****************************************************
 // TrackState Class
 TrackState::TrackState(MediaTrack* tr, bool bSelOnly)
@@ -134,7 +134,7 @@ TrackState::TrackState(MediaTrack* tr, bool bSelOnly)
 	{
 		MediaItem* mi = GetTrackMediaItem(tr, i);
 		if (!bSelOnly || *(bool*)GetSetMediaItemInfo(mi, "B_UISEL", NULL))
-			m_items.Add(new ItemState(mi));
+			AddItem(ItemState(mi));
 	}
 }
 
@@ -151,9 +151,16 @@ TrackState::TrackState(LineParser* lp)
 	m_iColor = lp->gettoken_int(3);
 }
 
-TrackState::~TrackState()
+void TrackState::AddItem(const ItemState& is)
 {
-	m_items.Empty(true);
+	map<GUID, int, GuidLess>::iterator it = m_itemIndex.find(is.m_guid);
+	if (it != m_itemIndex.end())
+		m_items[it->second] = is;
+	else
+	{
+		m_itemIndex[is.m_guid] = (int)m_items.size();
+		m_items.push_back(is);
+	}
 }
 
 void TrackState::AddSelItems(MediaTrack* tr)
@@ -162,19 +169,7 @@ void TrackState::AddSelItems(MediaTrack* tr)
 	{
 		MediaItem* mi = GetTrackMediaItem(tr, i);
 		if (*(bool*)GetSetMediaItemInfo(mi, "B_UISEL", NULL))
-		{
-			int j;
-			for (j = 0; j < m_items.GetSize(); j++)
-				if (mi == m_items.Get(j)->FindItem(tr))
-				{
-					ItemState* is = m_items.Get(j);
-					m_items.Set(j, new ItemState(mi));
-					delete is;
-					break;
-				}
-			if (j == m_items.GetSize())
-				m_items.Add(new ItemState(mi));
-		}
+			AddItem(ItemState(mi));
 	}
 }
 
@@ -195,8 +190,11 @@ void TrackState::Restore(MediaTrack* tr, bool bSelOnly)
 		GetSetMediaTrackInfo(tr, "B_FREEMODE", &m_bFIPM);
 		GetSetMediaTrackInfo(tr, "I_CUSTOMCOLOR", &m_iColor);
 	}
-	for (int i = 0; i < m_items.GetSize(); i++)
-		m_items.Get(i)->Restore(tr, bSelOnly);
+	map<GUID, MediaItem*, GuidLess> items;
+	GetItemsByGuid(tr, &items);
+	for (int i = 0; i < (int)m_items.size(); i++)
+		if (MediaItem* mi = FindItem(items, m_items[i].m_guid))
+			m_items[i].Restore(mi, bSelOnly);
 }
 
 char* TrackState::ItemString(char* str, int maxLen)
@@ -210,8 +208,11 @@ char* TrackState::ItemString(char* str, int maxLen)
 void TrackState::SelectItems(MediaTrack* tr)
 {
 	UnselAllItems(tr);
-	for (int i = 0; i < m_items.GetSize(); i++)
-		m_items.Get(i)->Select(tr);
+	map<GUID, MediaItem*, GuidLess> items;
+	GetItemsByGuid(tr, &items);
+	for (int i = 0; i < (int)m_items.size(); i++)
+		if (MediaItem* mi = FindItem(items, m_items[i].m_guid))
+			GetSetMediaItemInfo(mi, "B_UISEL", &g_bTrue);
 }
 
 //*****************************************************
@@ -224,18 +225,12 @@ void SaveTrack(COMMAND_T*)
 		if (*(int*)GetSetMediaTrackInfo(tr, "I_SELECTED", NULL))
 		{
 			// First see if this track is saved already
-			int j;
-			for (j = 0; j < g_tracks.Get()->GetSize(); j++)
+			if (TrackState* ts = FindTrackState(tr))
 			{
-				if (TrackMatchesGuid(tr, &g_tracks.Get()->Get(j)->m_guid))
-				{
-					TrackState* ts = g_tracks.Get()->Get(j);
-					g_tracks.Get()->Set(j, new TrackState(tr, false));
-					delete ts;
-					break;
-				}
+				g_tracks.Get()->Set(g_tracks.Get()->Find(ts), new TrackState(tr, false));
+				delete ts;
 			}
-			if (j == g_tracks.Get()->GetSize())
+			else
 				g_tracks.Get()->Add(new TrackState(tr, false));
 		}
 	}
@@ -249,9 +244,8 @@ void RestoreTrack(COMMAND_T* _ct)
 		MediaTrack* tr = CSurf_TrackFromID(i, false);
 		if (*(int*)GetSetMediaTrackInfo(tr, "I_SELECTED", NULL))
 			// Find the saved track
-			for (int j = 0; j < g_tracks.Get()->GetSize(); j++)
-				if (TrackMatchesGuid(tr, &g_tracks.Get()->Get(j)->m_guid))
-					g_tracks.Get()->Get(j)->Restore(tr, false);
+			if (TrackState* ts = FindTrackState(tr))
+				ts->Restore(tr, false);
 	}
 	PreventUIRefresh(-1);
 	UpdateTimeline();
@@ -266,9 +260,8 @@ void SelItemsWithState(COMMAND_T* _ct)
 		MediaTrack* tr = CSurf_TrackFromID(i, false);
 		if (*(int*)GetSetMediaTrackInfo(tr, "I_SELECTED", NULL))
 			// Find the saved track
-			for (int j = 0; j < g_tracks.Get()->GetSize(); j++)
-				if (TrackMatchesGuid(tr, &g_tracks.Get()->Get(j)->m_guid))
-					g_tracks.Get()->Get(j)->SelectItems(tr);
+			if (TrackState* ts = FindTrackState(tr))
+				ts->SelectItems(tr);
 	}
 	PreventUIRefresh(-1);
 	UpdateArrange();
@@ -283,14 +276,9 @@ void SaveSelOnTrack(COMMAND_T*)
 		if (*(int*)GetSetMediaTrackInfo(tr, "I_SELECTED", NULL))
 		{
 			// First see if this track is saved already
-			int j;
-			for (j = 0; j < g_tracks.Get()->GetSize(); j++)
-				if (TrackMatchesGuid(tr, &g_tracks.Get()->Get(j)->m_guid))
-				{
-					g_tracks.Get()->Get(j)->AddSelItems(tr);
-					break;
-				}
-			if (j == g_tracks.Get()->GetSize())
+			if (TrackState* ts = FindTrackState(tr))
+				ts->AddSelItems(tr);
+			else
 				g_tracks.Get()->Add(new TrackState(tr, true));
 		}
 	}
@@ -304,9 +292,8 @@ void RestoreSelOnTrack(COMMAND_T* _ct)
 		MediaTrack* tr = CSurf_TrackFromID(i, false);
 		if (*(int*)GetSetMediaTrackInfo(tr, "I_SELECTED", NULL))
 			// Find the saved track
-			for (int j = 0; j < g_tracks.Get()->GetSize(); j++)
-				if (TrackMatchesGuid(tr, &g_tracks.Get()->Get(j)->m_guid))
-					g_tracks.Get()->Get(j)->Restore(tr, true);
+			if (TrackState* ts = FindTrackState(tr))
+				ts->Restore(tr, true);
 	}
 	PreventUIRefresh(-1);
 	UpdateTimeline();
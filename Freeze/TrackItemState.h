@@ -33,10 +33,8 @@ class ItemState
 public:
 	ItemState(LineParser* lp);
 	ItemState(MediaItem* mi);
-	MediaItem* FindItem(MediaTrack* tr);
-	void Restore(MediaTrack* tr, bool bSelOnly);
+	void Restore(MediaItem* mi, bool bSelOnly);
     char* ItemString(char* str, int maxLen);
-	void Select(MediaTrack* tr);
 
 	GUID m_guid;
 	bool m_bMute;
@@ -49,22 +47,28 @@ public:
 	double m_dFadeOut;
 };
 
+// Item states are kept by value, indexed by item GUID. The text format is only
+// used when saving/loading the project, and restores look up the track's items
+// in a GUID map built with a single pass over the track.
 class TrackState
 {
 public:
 	TrackState(MediaTrack* tr, bool bSelOnly);
 	TrackState(LineParser* lp);
-	~TrackState();
+	void AddItem(const ItemState& is); // Replaces the item's previous state, if any
 	void AddSelItems(MediaTrack* tr);
 	void UnselAllItems(MediaTrack* tr);
 	void Restore(MediaTrack* tr, bool bSelOnly);
     char* ItemString(char* str, int maxLen);
 	void SelectItems(MediaTrack* tr);
 
-	WDL_PtrList<ItemState> m_items;
+	vector<ItemState> m_items;
 	GUID m_guid;
 	bool m_bFIPM;
 	int m_iColor;
+
+private:
+	map<GUID, int, GuidLess> m_itemIndex;
 };
 
 extern SWSProjConfig<WDL_PtrList_DOD<TrackState> > g_tracks;
@@ -27,7 +27,9 @@
 
 #include "stdafx.h"
 #include "../reaper/localize.h"
+#include "../SnM/SnM.h"
 #include "../SnM/SnM_Dlg.h"
+#include "../Utility/UndoStates.h"
 #include "WDL/projectcontext.h"
 #include "MarkerListClass.h"
 #include "MarkerList.h"
@@ -63,7 +65,7 @@ void SWS_MarkerListView::GetItemText(SWS_ListItem* item, int iCol, char* str, in
 		switch (iCol)
 		{
 		case 0:
-			format_timestr_pos(mi->GetPos(), str, iStrMax, -1);
+			lstrcpyn(str, mi->GetPosStr(), iStrMax);
 			break;
 		case 1:
 			snprintf(str, iStrMax, "%s", mi->IsRegion() ? __LOCALIZE("Region","sws_DLG_102") : __LOCALIZE("Marker","sws_DLG_102"));
@@ -219,16 +221,12 @@ SWS_MarkerListWnd::SWS_MarkerListWnd()
 	Init();
 }
 
-void SWS_MarkerListWnd::Update(bool bForce)
+// bRebuild: false to skip the project markers enumeration (no marker/region change notified)
+void SWS_MarkerListWnd::Update(bool bForce, bool bRebuild)
 {
-	// Change the time string if the project time mode changes
-	static int prevTimeMode = -1;
+	// time mode/offset and tempo map changes (cached time strings) are notified by
+	// the marker/region listener too, see UpdateTimeStringsState()
 	bool bChanged = bForce;
-	if (*ConfigVar<int>("projtimemode") != prevTimeMode)
-	{
-		prevTimeMode = *ConfigVar<int>("projtimemode");
-		bChanged = true;
-	}
 
 	double dCurPos = GetCursorPosition();
 	if (dCurPos != m_dCurPos)
@@ -242,8 +240,13 @@ void SWS_MarkerListWnd::Update(bool bForce)
 		g_curList = new MarkerList("CurrentList", true);
 		bChanged = true;
 	}
-	else if (g_curList->BuildFromReaper())
-		bChanged = true;
+	else if (bRebuild)
+	{
+		// a notified update may only concern time strings (tempo map, etc)
+		if (g_curList->BuildFromReaper() || m_mkrRgnListener.m_bDirty)
+			bChanged = true;
+		m_mkrRgnListener.m_bDirty = false;
+	}
 
 	if (m_pLists.GetSize() && bChanged)
 	{
@@ -275,9 +278,10 @@ void SWS_MarkerListWnd::OnInitDlg()
 	CheckDlgButton(m_hwnd, IDC_PLAY, m_bPlayOnSel ? BST_CHECKED : BST_UNCHECKED);
 	CheckDlgButton(m_hwnd, IDC_SCROLL, m_bScroll  ? BST_CHECKED : BST_UNCHECKED);
 	
+	RegisterToMarkerRegionUpdates(&m_mkrRgnListener);
 	Update();
 
-	SetTimer(m_hwnd, 1, 500, NULL);
+	SetTimer(m_hwnd, 1, g_SNM_MkrRgnUpdateFreq, NULL);
 }
 
 void SWS_MarkerListWnd::OnCommand(WPARAM wParam, LPARAM lParam)
@@ -387,6 +391,7 @@ HMENU SWS_MarkerListWnd::OnContextMenu(int x, int y, bool* wantDefaultItems)
 void SWS_MarkerListWnd::OnDestroy()
 {
 	KillTimer(m_hwnd, 1);
+	UnregisterToMarkerRegionUpdates(&m_mkrRgnListener);
 	char cOptions[4];
 	sprintf(cOptions, "%c %c", m_bPlayOnSel ? '1' : '0', m_bScroll ? '1' : '0');
 	WritePrivateProfileString(SWS_INI, ML_OPTIONS_KEY, cOptions, get_ini_file());
@@ -395,7 +400,7 @@ void SWS_MarkerListWnd::OnDestroy()
 void SWS_MarkerListWnd::OnTimer(WPARAM wParam)
 {
 	if (ListView_GetSelectedCount(m_pLists.Get(0)->GetHWND()) <= 1 || !IsActive())
-		Update();
+		Update(false, m_mkrRgnListener.m_bDirty);
 }
 
 int SWS_MarkerListWnd::OnKey(MSG* msg, int iKeyState)
@@ -749,10 +754,11 @@ static void BeginLoadProjectState(bool isUndo, struct project_config_extension_t
 }
 
 static project_config_extension_t g_projectconfig = { ProcessExtensionLine, SaveExtensionConfig, BeginLoadProjectState, NULL };
+static SWS_UndoStates g_undoStates("MARKERLIST", &g_projectconfig); // unchanged states are referenced in undo points
 
 int MarkerListInit()
 {
-	if (!plugin_register("projectconfig",&g_projectconfig))
+	if (!plugin_register("projectconfig", g_undoStates.GetProjectConfig()))
 		return 0;
 
 	SWSRegisterCommands(g_commandTable);
@@ -763,6 +769,6 @@ int MarkerListInit()
 
 void MarkerListExit()
 {
-	plugin_register("-projectconfig",&g_projectconfig);
+	plugin_register("-projectconfig", g_undoStates.GetProjectConfig());
 	DELETE_NULL(g_pMarkerList);
 }
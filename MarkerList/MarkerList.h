@@ -28,8 +28,19 @@
 
 #pragma once
 
+#include "../SnM/SnM_Marker.h"
+
 class SWS_MarkerListWnd;
 
+// flags marker/region changes so that the list is rebuilt from the project only when needed
+class MarkerListMarkerRegionListener : public SNM_MarkerRegionListener
+{
+public:
+	MarkerListMarkerRegionListener() : m_bDirty(true) {}
+	void NotifyMarkerRegionUpdate(int updateFlags) { m_bDirty = true; }
+	bool m_bDirty;
+};
+
 class SWS_MarkerListView : public SWS_ListView
 {
 public:
@@ -53,7 +64,7 @@ class SWS_MarkerListWnd : public SWS_DockWnd
 {
 public:
 	SWS_MarkerListWnd();
-	void Update(bool bForce = false);
+	void Update(bool bForce = false, bool bRebuild = true);
 	double m_dCurPos;
 
 	WDL_String m_filter;
@@ -67,6 +78,8 @@ protected:
 	void OnDestroy();
 	void OnTimer(WPARAM wParam=0);
 	int OnKey(MSG* msg, int iKeyState);
+
+	MarkerListMarkerRegionListener m_mkrRgnListener;
 };
 
 #define EXPORT_FORMAT_KEY "MarkerExport Format"
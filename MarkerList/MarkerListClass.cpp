@@ -34,6 +34,7 @@
 #include "MarkerListActions.h"
 #include "../SnM/SnM_Project.h"
 
+int MarkerItem::s_timeStrGen = 0;
 
 MarkerItem::MarkerItem(bool bReg, double dPos, double dRegEnd, const char* cName, int num, int color)
 {
@@ -43,6 +44,7 @@ MarkerItem::MarkerItem(bool bReg, double dPos, double dRegEnd, const char* cName
 	m_num = num;
 	SetName(cName);
 	m_iColor = color;
+	m_timeStrGen = -1;
 }
 
 MarkerItem::MarkerItem(LineParser* lp)
@@ -53,6 +55,7 @@ MarkerItem::MarkerItem(LineParser* lp)
 	m_bReg    = lp->gettoken_int(3) ? true : false;
 	m_dRegEnd = lp->gettoken_float(4);
 	m_iColor  = lp->gettoken_int(5);
+	m_timeStrGen = -1;
 }
 
 char* MarkerItem::ItemString(char* str, int iSize)
@@ -63,6 +66,29 @@ char* MarkerItem::ItemString(char* str, int iSize)
 	return str;
 }
 
+void MarkerItem::UpdateTimeStrings()
+{
+	if (m_timeStrGen == s_timeStrGen)
+		return;
+
+	char str[64];
+	format_timestr_pos(m_dPos, str, sizeof(str), -1);
+	m_posStr.Set(str);
+	if (m_bReg)
+	{
+		format_timestr_pos(m_dRegEnd, str, sizeof(str), -1);
+		m_endStr.Set(str);
+		format_timestr_len(m_dRegEnd - m_dPos, str, sizeof(str), m_dPos, -1);
+		m_lenStr.Set(str);
+	}
+	else
+	{
+		m_endStr.Set("");
+		m_lenStr.Set("");
+	}
+	m_timeStrGen = s_timeStrGen;
+}
+
 bool MarkerItem::Compare(bool bReg, double dPos, double dRegEnd, const char* cName, int num, int color)
 {
 	return (bReg == m_bReg && dPos == m_dPos && num == m_num && (!bReg || dRegEnd == m_dRegEnd) && m_iColor == color && strcmp(cName, GetName()) == 0);
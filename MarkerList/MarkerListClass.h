@@ -44,23 +44,35 @@ public:
 	char* GetName() { return m_name.Get(); }
 	void SetName(const char* newname) { m_name.Set(!newname ? "" : newname); }
 	double GetPos() { return m_dPos; }
-	void SetPos(double dPos) { m_dPos = dPos; }
+	void SetPos(double dPos) { m_dPos = dPos; m_timeStrGen = -1; }
 	double GetRegEnd() { return m_dRegEnd; }
-	void SetRegEnd(double dEnd) { m_dRegEnd = dEnd; }
+	void SetRegEnd(double dEnd) { m_dRegEnd = dEnd; m_timeStrGen = -1; }
 	bool IsRegion() { return m_bReg; }
-	void SetReg(bool bIsReg) {  m_bReg = bIsReg; }
+	void SetReg(bool bIsReg) {  m_bReg = bIsReg; m_timeStrGen = -1; }
 	int GetNum() { return m_num; }
 	void SetNum(int num) { m_num = num; }
 	int GetColor() { return m_iColor; }
 	void SetColor(int iColor) { m_iColor = iColor; }
 
+	// Formatted times, cached until the item moves or InvalidateTimeStrings() is called
+	// (project time mode, time offset or tempo map change)
+	const char* GetPosStr() { UpdateTimeStrings(); return m_posStr.Get(); }
+	const char* GetEndStr() { UpdateTimeStrings(); return m_endStr.Get(); }
+	const char* GetLenStr() { UpdateTimeStrings(); return m_lenStr.Get(); }
+	static void InvalidateTimeStrings() { s_timeStrGen++; }
+
 protected:
+	void UpdateTimeStrings();
+
 	WDL_String m_name;
 	double m_dPos;
 	bool m_bReg;
 	double m_dRegEnd;
 	int m_num;
 	int m_iColor;
+	WDL_FastString m_posStr, m_endStr, m_lenStr;
+	int m_timeStrGen;
+	static int s_timeStrGen;
 };
 
 class MarkerList
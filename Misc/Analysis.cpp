@@ -57,6 +57,7 @@ static bool AnalyzePCMSource(ANALYZE_PCM* a)
 	double* dSumSquares = new double[t.nch];
 	for (int i = 0; i < t.nch; i++)
 		dSumSquares[i] = 0.0;
+	double dTotalSumSquares = 0.0; // all channels, not windowed
 
 	// Init output variables.  Note can have different channel count.
 	for (int i = 0; i < a->iChannels; i++)
@@ -68,6 +69,7 @@ static bool AnalyzePCMSource(ANALYZE_PCM* a)
 	}
 	a->dPeakVal = 0.0;
 	a->dRMS = 0.0;
+	a->dAvgRMS = 0.0;
 	a->peakRMSsample = -666;
 	a->peakSample = 0;
 	a->dProgress = 0.0;
@@ -77,7 +79,8 @@ static bool AnalyzePCMSource(ANALYZE_PCM* a)
 	int iFrame = 0;
 
 	a->pcm->GetSamples(&t);
-	while (t.samples_out)
+	bool aborted = false;
+	while (t.samples_out && !(aborted = (a->abort && *a->abort)))
 	{
 		for (int samp = 0; samp < t.samples_out; samp++)
 		{
@@ -85,6 +88,7 @@ static bool AnalyzePCMSource(ANALYZE_PCM* a)
 			{
 				int i = samp*t.nch + chan;
 				dSumSquares[chan] += t.samples[i] * t.samples[i];
+				dTotalSumSquares += t.samples[i] * t.samples[i];
 				double absamp = fabs(t.samples[i]);
 				if (absamp > a->dPeakVal)
 				{
@@ -136,6 +140,17 @@ static bool AnalyzePCMSource(ANALYZE_PCM* a)
 		a->pcm->GetSamples(&t);
 	}
 
+	if (aborted)
+	{
+		delete[] t.samples;
+		delete[] prevBuf;
+		delete[] dSumSquares;
+		return false;
+	}
+
+	if (a->sampleCount && t.nch)
+		a->dAvgRMS = sqrt(dTotalSumSquares / (a->sampleCount * t.nch));
+
 	if (a->dWindowSize == 0.0)
 	{
 		// Non-windowed mode.  Calculate the RMS for the entire item
@@ -177,23 +192,155 @@ unsigned int WINAPI AnalyzePCMThread(void* pAnalyze)
 	return 0;
 }
 
+// A take that isn't the active one, as a PCM source: its own source played
+// from the take's start offset at the take's playrate, over the item length
+// (the item as a PCM source only plays its active take)
+class TakeAnalysisSource : public PCM_source
+{
+public:
+	TakeAnalysisSource(PCM_source* src, double offset, double playrate, double length, bool loop)
+	: m_src(src), m_offset(offset), m_playrate(playrate > 0.0 ? playrate : 1.0), m_length(length), m_loop(loop) {}
+	~TakeAnalysisSource() { delete m_src; }
+	PCM_source* Duplicate() { return new TakeAnalysisSource(m_src->Duplicate(), m_offset, m_playrate, m_length, m_loop); }
+	bool IsAvailable() { return m_src->IsAvailable(); }
+	const char* GetType() { return m_src->GetType(); }
+	const char* GetFileName() { return m_src->GetFileName(); }
+	bool SetFileName(const char* newfn) { return false; }
+	PCM_source* GetSource() { return m_src; }
+	int GetNumChannels() { return m_src->GetNumChannels(); }
+	double GetSampleRate() { return m_src->GetSampleRate(); }
+	double GetLength() { return m_length; }
+	int PropertiesWindow(HWND hwndParent) { return -1; }
+	void GetPeakInfo(PCM_source_peaktransfer_t* block) { block->peaks_out = 0; }
+	void SaveState(ProjectStateContext* ctx) {}
+	int LoadState(const char* firstline, ProjectStateContext* ctx) { return -1; }
+	void Peaks_Clear(bool deleteFile) {}
+	int PeaksBuild_Begin() { return 0; }
+	int PeaksBuild_Run() { return 0; }
+	void PeaksBuild_Finish() {}
+
+	void GetSamples(PCM_source_transfer_t* block)
+	{
+		const double srcLen = m_src->GetLength();
+		int done = 0;
+		double time = block->time_s;
+		while (done < block->length && time < m_length)
+		{
+			int n = min(block->length - done, max(1, (int)((m_length - time) * block->samplerate + 0.5)));
+			ReaSample* out = block->samples + done * block->nch;
+			double srcTime = m_offset + time * m_playrate;
+			bool silent = false;
+			if (m_loop && srcLen > 0.0)
+			{
+				srcTime = fmod(srcTime, srcLen);
+				if (srcTime < 0.0) srcTime += srcLen;
+				n = min(n, max(1, (int)((srcLen - srcTime) / m_playrate * block->samplerate + 0.5))); // up to the loop point
+			}
+			else if (srcTime < 0.0) // negative start offset
+			{
+				n = min(n, max(1, (int)(-srcTime / m_playrate * block->samplerate + 0.5)));
+				silent = true;
+			}
+
+			int got = 0;
+			if (!silent)
+			{
+				// reading the source at samplerate/playrate and playing it at samplerate applies the playrate
+				PCM_source_transfer_t t = *block;
+				t.time_s = srcTime;
+				t.samplerate = block->samplerate / m_playrate;
+				t.length = n;
+				t.samples = out;
+				t.samples_out = 0;
+				t.midi_events = NULL;
+				m_src->GetSamples(&t);
+				got = t.samples_out;
+			}
+			if (got < n)
+				memset(out + got * block->nch, 0, (n - got) * block->nch * sizeof(ReaSample));
+
+			done += n;
+			time += n / block->samplerate;
+		}
+		block->samples_out = done;
+	}
+
+private:
+	PCM_source* m_src;
+	double m_offset, m_playrate, m_length;
+	bool m_loop;
+};
+
+PCM_source* DuplicateItemForAnalysis(MediaItem* item, MediaItem_Take* take)
+{
+	if (!item)
+		return NULL;
+
+	PCM_source* pcm = NULL;
+	const bool takeSource = take && take != GetActiveTake(item);
+	if (takeSource)
+	{
+		// the project isn't touched (analyses can be scheduled in the background, while playing)
+		PCM_source* src = GetMediaItemTake_Source(take);
+		if (src && strcmp(src->GetType(), "MIDI") && strcmp(src->GetType(), "MIDIPOOL"))
+		{
+			if (PCM_source* dup = src->Duplicate())
+				pcm = new TakeAnalysisSource(dup,
+					GetMediaItemTakeInfo_Value(take, "D_STARTOFFS"),
+					GetMediaItemTakeInfo_Value(take, "D_PLAYRATE"),
+					GetMediaItemInfo_Value(item, "D_LENGTH"),
+					GetMediaItemInfo_Value(item, "B_LOOPSRC") != 0.0);
+		}
+	}
+	else
+	{
+		pcm = (PCM_source*)item;
+		if (strcmp(pcm->GetType(), "MIDI") == 0 || strcmp(pcm->GetType(), "MIDIPOOL") == 0)
+			pcm = NULL;
+		else
+			pcm = pcm->Duplicate();
+	}
+
+	if (pcm && !pcm->GetNumChannels())
+	{
+		delete pcm;
+		return NULL;
+	}
+
+	if (pcm && !takeSource) // the item's duplicate plays from its position
+	{
+		double dZero = 0.0;
+		GetSetMediaItemInfo((MediaItem*)pcm, "D_POSITION", &dZero);
+	}
+	return pcm;
+}
+
+bool AnalyzePCM(ANALYZE_PCM* a)
+{
+	a->dProgress = 0.0;
+	if (!a->pcm)
+		return false;
+
+	const double oldWinSize = a->dWindowSize;
+	if (a->dWindowSize > a->pcm->GetLength())
+		a->dWindowSize = 0.0;
+
+	a->success = AnalyzePCMSource(a);
+	a->dProgress = 1.0;
+
+	a->dWindowSize = oldWinSize;
+	return a->success;
+}
+
 // return true for successful analysis
 // wraps AnalyzePCM to check item validity and create a wait dialog
 bool AnalyzeItem(MediaItem* item, ANALYZE_PCM* a)
 {
 	a->dProgress = 0.0;
-	a->pcm = (PCM_source*)item;
-
-	if (!a->pcm || strcmp(a->pcm->GetType(), "MIDI") == 0 || strcmp(a->pcm->GetType(), "MIDIPOOL") == 0)
+	a->pcm = DuplicateItemForAnalysis(item);
+	if (!a->pcm)
 		return false;
 
-	a->pcm = a->pcm->Duplicate();
-	if (!a->pcm || !a->pcm->GetNumChannels())
-		return false;
-
-	double dZero = 0.0;
-	GetSetMediaItemInfo((MediaItem*)a->pcm, "D_POSITION", &dZero);
-
 	const char* cName = NULL;
 	MediaItem_Take* take = GetMediaItemTake(item, -1);
 	if (take)
@@ -39,6 +39,7 @@ typedef struct ANALYZE_PCM
 	double dPeakVal;        // out Maximum peak valume over all channels
 	double* dRMSs;          // i/o Array of channel RMS values
 	double dRMS;            // out RMS of all channels
+	double dAvgRMS;         // out RMS of all channels over the entire source (in windowed mode too)
 	INT64* peakRMSsamples;  // i/o Array of channel RMS peak locations (not calculated if dRMSs is omitted), -666 if dWindowSize == 0.0 or >= item length 
 	INT64 peakRMSsample;    // out Position of overall peak RMS in windowed mode, -666 if dWindowSize == 0.0 or >= item length 
 	INT64* peakSamples;     // i/o Array of channel peak locations (not calculated if dPeakVals is omitted)
@@ -46,12 +47,15 @@ typedef struct ANALYZE_PCM
 	double dProgress;       // out Analysis progress, 0.0-1.0 for 0-100%
 	INT64 sampleCount;      // out # of samples analyzed
 	double dWindowSize;     // RMS window in seconds.  If this is != 0.0, then RMS is calculated/returned as max within window
+	const volatile bool* abort; // in  Polled between blocks, the analysis stops and fails once it's true (optional)
 	bool success;
 } ANALYZE_PCM;
 
 int AnalysisInit();
 
 bool AnalyzeItem(MediaItem* mi, ANALYZE_PCM* a);
+PCM_source* DuplicateItemForAnalysis(MediaItem* mi, MediaItem_Take* take = NULL); // main thread only, take: analyze this take rather than the active one (the item is left untouched)
+bool AnalyzePCM(ANALYZE_PCM* a); // no wait dialog, can be called from any thread, a->pcm from DuplicateItemForAnalysis()
 
 // #781 Export to ReaScript
 void NF_GetRMSOptions(double *targetOut, double *winSizeOut);
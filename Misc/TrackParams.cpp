@@ -597,5 +597,6 @@ static COMMAND_T g_commandTable[] =
 int TrackParamsInit()
 {
 	SWSRegisterCommands(g_commandTable);
+	SWSCacheToggleStates(CheckTrackParam, SWS_TOGGLE_DIRTY_TRACKS); // scans all tracks
 	return 1;
 }
@@ -59,6 +59,7 @@ void ObjectStateCache::WriteCache()
 			int fxstate = SNM_PreObjectState(m_str.Get(i), false);
 			GetSetObjectState(m_obj.Get(i), m_str.Get(i)->Get());
 			SNM_PostObjectState(fxstate);
+			SWS_ObjectStateWritten();
 #ifdef GOS_DEBUG
 			iCount++;
 #endif
@@ -109,6 +110,7 @@ const char* ObjectStateCache::GetSetObjState(void* obj, const char* str, bool wa
 }
 
 ObjectStateCache* g_objStateCache = NULL;
+static unsigned int g_objStateWrites = 0; // see SWS_GetObjectStateWriteCount()
 
 const char* SWS_GetSetObjectState(void* obj, WDL_FastString* str, bool wantsMinimalState)
 {
@@ -121,6 +123,8 @@ const char* SWS_GetSetObjectState(void* obj, WDL_FastString* str, bool wantsMini
 		int fxstate = SNM_PreObjectState(str, wantsMinimalState);
 		ret = GetSetObjectState(obj, str ? str->Get() : NULL);
 		SNM_PostObjectState(fxstate);
+		if (str)
+			SWS_ObjectStateWritten();
 	}
 
 #ifdef GOS_DEBUG
@@ -133,6 +137,18 @@ const char* SWS_GetSetObjectState(void* obj, WDL_FastString* str, bool wantsMini
 }
 
 
+// Chunk writes don't always change the project state change count (e.g. MIDI editor
+// view settings), caches of values read from chunks can check this count instead
+void SWS_ObjectStateWritten()
+{
+	g_objStateWrites++;
+}
+
+unsigned int SWS_GetObjectStateWriteCount()
+{
+	return g_objStateWrites;
+}
+
 void SWS_FreeHeapPtr(void* ptr)
 {
 	// Ignore frees on cached object states, 
@@ -47,6 +47,8 @@ const char* SWS_GetSetObjectState(void* obj, WDL_FastString* str, bool wantsMini
 void SWS_FreeHeapPtr(void* ptr);
 void SWS_FreeHeapPtr(const char* ptr);
 void SWS_CacheObjectState(bool bStart);
+void SWS_ObjectStateWritten();
+unsigned int SWS_GetObjectStateWriteCount();
 
 bool GetChunkLine(const char* chunk, char* line, int iLineMax, int* pos, bool bNewLine);
 void AppendChunkLine(WDL_FastString* chunk, const char* line);
@@ -158,6 +158,7 @@ APIdef g_apidefs[] =
 	{ APIFUNC(SNM_AddTCPFXParm), "bool", "MediaTrack*,int,int", "tr,fxId,prmId", "[S&M] Add an FX parameter knob in the TCP. Returns false if nothing updated (invalid parameters, knob already present, etc..)", },
 	{ APIFUNC(SNM_TagMediaFile), "bool", "const char*,const char*,const char*", "fn,tag,tagval", "[S&M] Tags a media file thanks to <a href=\"https://taglib.github.io\">TagLib</a>. Supported tags: \"artist\", \"album\", \"genre\", \"comment\", \"title\", \"track\" (track number) or \"year\". Use an empty tagval to clear a tag. When a file is opened in REAPER, turn it offline before using this function. Returns false if nothing updated. See SNM_ReadMediaFileTag.", },
 	{ APIFUNC(SNM_ReadMediaFileTag), "bool", "const char*,const char*,char*,int", "fn,tag,tagvalOut,tagvalOut_sz", "[S&M] Reads a media file tag. Supported tags: \"artist\", \"album\", \"genre\", \"comment\", \"title\", \"track\" (track number) or \"year\". Returns false if tag was not found. See SNM_TagMediaFile.", },
+	{ APIFUNC(SNM_ReadMediaFileTags), "int", "const char*,const char*,WDL_FastString*", "fns,tags,tagvals", "[S&M] Reads several tags of several media files at once: each file is opened once, files are read in parallel and the tags of the last read files are cached (until they are modified). fns: file names separated by new lines. tags: comma separated, case insensitive tag keys:\n- \"artist\", \"album\", \"genre\", \"comment\", \"title\", \"track\" or \"year\" (like SNM_ReadMediaFileTag)\n- \"ID3:<frame id>\" for ID3v2 tags (mp3 and wav files), e.g. \"ID3:TBPM\"\n- \"VORBIS:<field>\" for Vorbis comments (ogg, opus and flac files), e.g. \"VORBIS:TITLE\"\n- \"INFO:<chunk id>\" for RIFF INFO tags, e.g. \"INFO:IART\"\n- \"BWF:<field>\" for BWF tags: Description, Originator, OriginatorReference, OriginationDate, OriginationTime, TimeReference (in samples) or CodingHistory\n- \"IXML:<element>\" for iXML leaf elements, e.g. \"IXML:PROJECT\", \"IXML:SCENE\" or \"IXML:TAKE\"\ntagvals gets one line per file (same order as fns) with tag values separated by tabs (empty values if not found). Tabs, new lines and backslashes in values are escaped as \\t, \\n, \\r and \\\\. Returns the number of files that could be read. See SNM_CreateFastString and SNM_DeleteFastString.", },
 
 	{ APIFUNC(FNG_AllocMidiTake), "RprMidiTake*", "MediaItem_Take*", "take", "[FNG] Allocate a RprMidiTake from a take pointer. Returns a NULL pointer if the take is not an in-project MIDI take", },
 	{ APIFUNC(FNG_FreeMidiTake), "void", "RprMidiTake*", "midiTake", "[FNG] Commit changes to MIDI take and free allocated memory", },
@@ -167,6 +168,8 @@ APIdef g_apidefs[] =
 	{ APIFUNC(FNG_SetMidiNoteIntProperty), "void", "RprMidiNote*,const char*,int", "midiNote,property,value", "[FNG] Set MIDI note property", },
 	{ APIFUNC(FNG_AddMidiNote), "RprMidiNote*", "RprMidiTake*", "midiTake", "[FNG] Add MIDI note to MIDI take", },
 
+	{ APIFUNC(BR_CountMissingMedia), "int", "", "", "[BR] Check every media file used by takes in the current project and return the number of files that can't be found. Call this before enumerating them with <a href=\"#BR_GetMissingMedia\">BR_GetMissingMedia</a>.", },
+	{ APIFUNC(BR_CountTakesUsingMedia), "int", "const char*", "file", "[BR] Count takes in the current project whose source uses the media file (including takes with section sources of that file). To get the takes, see <a href=\"#BR_GetTakeUsingMedia\">BR_GetTakeUsingMedia</a>.", },
 	{ APIFUNC(BR_EnvAlloc), "BR_Envelope*", "TrackEnvelope*,bool", "envelope,takeEnvelopesUseProjectTime", "[BR] Allocate envelope object from track or take envelope pointer. Always call <a href=\"#BR_EnvFree\">BR_EnvFree</a> when done to release the object and commit changes if needed.\n takeEnvelopesUseProjectTime: take envelope points' positions are counted from take position, not project start time. If you want to work with project time instead, pass this as true.\n\nFor further manipulation see BR_EnvCountPoints, BR_EnvDeletePoint, BR_EnvFind, BR_EnvFindNext, BR_EnvFindPrevious, BR_EnvGetParentTake, BR_EnvGetParentTrack, BR_EnvGetPoint, BR_EnvGetProperties, BR_EnvSetPoint, BR_EnvSetProperties, BR_EnvValueAtPos.", },
 	{ APIFUNC(BR_EnvCountPoints), "int", "BR_Envelope*", "envelope", "[BR] Count envelope points in the envelope object allocated with <a href=\"#BR_EnvAlloc\">BR_EnvAlloc</a>.", },
 	{ APIFUNC(BR_EnvDeletePoint), "bool", "BR_Envelope*,int", "envelope,id", "[BR] Delete envelope point by index (zero-based) in the envelope object allocated with <a href=\"#BR_EnvAlloc\">BR_EnvAlloc</a>. Returns true on success.", },
@@ -182,6 +185,7 @@ APIdef g_apidefs[] =
 	{ APIFUNC(BR_EnvSetProperties), "void", "BR_Envelope*,bool,bool,bool,bool,int,int,bool,int*", "envelope,active,visible,armed,inLane,laneHeight,defaultShape,faderScaling,automationItemsOptionsInOptional", "[BR] Set envelope properties for the envelope object allocated with <a href=\"#BR_EnvAlloc\">BR_EnvAlloc</a>. For parameter description see BR_EnvGetProperties.\nSetting automationItemsOptions requires REAPER 5.979+.", },
 	{ APIFUNC(BR_EnvSortPoints), "void", "BR_Envelope*", "envelope", "[BR] Sort envelope points by position. The only reason to call this is if sorted points are explicitly needed after editing them with <a href=\"#BR_EnvSetPoint\">BR_EnvSetPoint</a>. Note that you do not have to call this before doing <a href=\"#BR_EnvFree\">BR_EnvFree</a> since it does handle unsorted points too.", },
 	{ APIFUNC(BR_EnvValueAtPos), "double", "BR_Envelope*,double", "envelope,position", "[BR] Get envelope value at time position for the envelope object allocated with <a href=\"#BR_EnvAlloc\">BR_EnvAlloc</a>.", },
+	{ APIFUNC(BR_GetActionLatency), "bool", "int,bool,char*,int,int*,double*,double*,char*,int", "idx,toggleState,commandIdOut,commandIdOut_sz,callsOut,totalMsOut,maxMsOut,histogramOut,histogramOut_sz", "[BR] Get latency statistics recorded by the action latency profiler (see action \"SWS/BR: Toggle action latency profiling\") for SWS action at index idx. Returns false when idx is out of range.\n toggleState: false to get the cost of running the action, true to get the cost of polling its toggle state (toolbars, menus).\n histogramOut: comma separated call counts, first bucket is below 1/64 ms and every next bucket is twice as wide (the last one is open-ended).\nAll statistics can also be written to a file with action \"SWS/BR: Write action latency statistics to file\".", },
 	{ APIFUNC(BR_GetArrangeView), "void", "ReaProject*,double*,double*", "proj,startTimeOut,endTimeOut", "[BR] Deprecated, see GetSet_ArrangeView2 (REAPER v5.12pre4+) -- Get start and end time position of arrange view. To set arrange view instead, see BR_SetArrangeView.", },
 	{ APIFUNC(BR_GetClosestGridDivision), "double", "double", "position", "[BR] Get closest grid division to position. Note that this functions is different from <a href=\"#SnapToGrid\">SnapToGrid</a> in two regards. SnapToGrid() needs snap enabled to work and this one works always. Secondly, grid divisions are different from grid lines because some grid lines may be hidden due to zoom level - this function ignores grid line visibility and always searches for the closest grid division at given position. For more grid division functions, see <a href=\"#BR_GetNextGridDivision\">BR_GetNextGridDivision</a> and <a href=\"#BR_GetPrevGridDivision\">BR_GetPrevGridDivision</a>.", },
 	{ APIFUNC(BR_GetCurrentTheme), "void", "char*,int,char*,int", "themePathOut,themePathOut_sz,themeNameOut,themeNameOut_sz", "[BR] Get current theme information. themePathOut is set to full theme path and themeNameOut is set to theme name excluding any path info and extension", },
@@ -199,6 +203,7 @@ APIdef g_apidefs[] =
 	{ APIFUNC(BR_GetMidiSourceLenPPQ), "double", "MediaItem_Take*", "take", "[BR] Get MIDI take source length in PPQ. In case the take isn't MIDI, return value will be -1.", },
 	{ APIFUNC(BR_GetMidiTakePoolGUID), "bool", "MediaItem_Take*,char*,int", "take,guidStringOut,guidStringOut_sz", "[BR] Get MIDI take pool GUID as a string (guidStringOut_sz should be at least 64). Returns true if take is pooled.", },
 	{ APIFUNC(BR_GetMidiTakeTempoInfo), "bool", "MediaItem_Take*,bool*,double*,int*,int*", "take,ignoreProjTempoOut,bpmOut,numOut,denOut", "[BR] Get \"ignore project tempo\" information for MIDI take. Returns true if take can ignore project tempo (no matter if it's actually ignored), otherwise false.", },
+	{ APIFUNC(BR_GetMissingMedia), "bool", "int,char*,int", "idx,fileOut,fileOut_sz", "[BR] Get missing media file by index (zero-based) as found by the last call to <a href=\"#BR_CountMissingMedia\">BR_CountMissingMedia</a>. Returns false when idx is out of range.", },
 	{ APIFUNC(BR_GetMouseCursorContext), "void", "char*,int,char*,int,char*,int", "windowOut,windowOut_sz,segmentOut,segmentOut_sz,detailsOut,detailsOut_sz", BR_MOUSE_REASCRIPT_DESC, },
 	{ APIFUNC(BR_GetMouseCursorContext_Envelope), "TrackEnvelope*", "bool*", "takeEnvelopeOut", "[BR] Returns envelope that was captured with the last call to <a href=\"#BR_GetMouseCursorContext\">BR_GetMouseCursorContext</a>. In case the envelope belongs to take, takeEnvelope will be true.", },
 	{ APIFUNC(BR_GetMouseCursorContext_Item), "MediaItem*", "", "", "[BR] Returns item under mouse cursor that was captured with the last call to <a href=\"#BR_GetMouseCursorContext\">BR_GetMouseCursorContext</a>. Note that the function will return item even if mouse cursor is over some other track lane element like stretch marker or envelope. This enables for easier identification of items when you want to ignore elements within the item."},
@@ -211,12 +216,14 @@ APIdef g_apidefs[] =
 	{ APIFUNC(BR_GetPrevGridDivision), "double", "double", "position", "[BR] Get previous grid division before the time position. For more grid division functions, see <a href=\"#BR_GetClosestGridDivision\">BR_GetClosestGridDivision</a> and <a href=\"#BR_GetNextGridDivision\">BR_GetNextGridDivision</a>.", },
 	{ APIFUNC(BR_GetSetTrackSendInfo), "double", "MediaTrack*,int,int,const char*,bool,double", "track,category,sendidx,parmname,setNewValue,newValue", "[BR] Get or set send attributes.\n\ncategory is <0 for receives, 0=sends, >0 for hardware outputs\nsendidx is zero-based (see GetTrackNumSends to count track sends/receives/hardware outputs)\nTo set attribute, pass setNewValue as true\n\nList of possible parameters:\nB_MUTE : send mute state (1.0 if muted, otherwise 0.0)\nB_PHASE : send phase state (1.0 if phase is inverted, otherwise 0.0)\nB_MONO : send mono state (1.0 if send is set to mono, otherwise 0.0)\nD_VOL : send volume (1.0=+0dB etc...)\nD_PAN : send pan (-1.0=100%L, 0=center, 1.0=100%R)\nD_PANLAW : send pan law (1.0=+0.0db, 0.5=-6dB, -1.0=project default etc...)\nI_SENDMODE : send mode (0=post-fader, 1=pre-fx, 2=post-fx(deprecated), 3=post-fx)\nI_SRCCHAN : audio source starting channel index or -1 if audio send is disabled (&1024=mono...note that in that case, when reading index, you should do (index XOR 1024) to get starting channel index)\nI_DSTCHAN : audio destination starting channel index (&1024=mono (and in case of hardware output &512=rearoute)...note that in that case, when reading index, you should do (index XOR (1024 OR 512)) to get starting channel index)\nI_MIDI_SRCCHAN : source MIDI channel, -1 if MIDI send is disabled (0=all, 1-16)\nI_MIDI_DSTCHAN : destination MIDI channel, -1 if MIDI send is disabled (0=original, 1-16)\nI_MIDI_SRCBUS : source MIDI bus, -1 if MIDI send is disabled (0=all, otherwise bus index)\nI_MIDI_DSTBUS : receive MIDI bus, -1 if MIDI send is disabled (0=all, otherwise bus index)\nI_MIDI_LINK_VOLPAN : link volume/pan controls to MIDI\n\nNote: To get or set other send attributes, see <a href=\"#BR_GetMediaTrackSendInfo_Envelope\">BR_GetMediaTrackSendInfo_Envelope</a> and <a href=\"#BR_GetMediaTrackSendInfo_Track\">BR_GetMediaTrackSendInfo_Track</a>.", },
 	{ APIFUNC(BR_GetTakeFXCount), "int", "MediaItem_Take*", "take", "[BR] Returns FX count for supplied take", },
+	{ APIFUNC(BR_GetTakeUsingMedia), "MediaItem_Take*", "const char*,int", "file,idx", "[BR] Get take using the media file by index (zero-based). Returns NULL when idx is out of range. To count takes using the file, see <a href=\"#BR_CountTakesUsingMedia\">BR_CountTakesUsingMedia</a>.", },
 	{ APIFUNC(BR_IsTakeMidi), "bool", "MediaItem_Take*,bool*", "take,inProjectMidiOut", "[BR] Check if take is MIDI take, in case MIDI take is in-project MIDI source data, inProjectMidiOut will be true, otherwise false.", },
 	{ APIFUNC(BR_IsMidiOpenInInlineEditor), "bool", "MediaItem_Take*", "take", "[SWS] Check if take has MIDI inline editor open and returns true or false.", },
 	{ APIFUNC(BR_ItemAtMouseCursor), "MediaItem*", "double*", "positionOut", "[BR] Get media item under mouse cursor. Position is mouse cursor position in arrange.", },
 	{ APIFUNC(BR_MIDI_CCLaneRemove), "bool", "void*,int", "midiEditor,laneId", "[BR] Remove CC lane in midi editor. Top visible CC lane is laneId 0. Returns true on success", },
 	{ APIFUNC(BR_MIDI_CCLaneReplace), "bool", "void*,int,int", "midiEditor,laneId,newCC", "[BR] Replace CC lane in midi editor. Top visible CC lane is laneId 0. Returns true on success.\nValid CC lanes: CC0-127=CC, 0x100|(0-31)=14-bit CC, 0x200=velocity, 0x201=pitch, 0x202=program, 0x203=channel pressure, 0x204=bank/program select, 0x205=text, 0x206=sysex, 0x207", },
 	{ APIFUNC(BR_PositionAtMouseCursor), "double", "bool", "checkRuler", "[BR] Get position at mouse cursor. To check ruler along with arrange, pass checkRuler=true. Returns -1 if cursor is not over arrange/ruler.", },
+	{ APIFUNC(BR_RelinkMedia), "int", "const char*,const char*", "oldFile,newFile", "[BR] Point every take in the current project that uses oldFile to newFile, including takes with section sources of that file. The file itself isn't touched. Paths are compared with normalized separators (and case-insensitively on Windows). Returns the number of relinked takes.", },
 	{ APIFUNC(BR_SetArrangeView), "void", "ReaProject*,double,double", "proj,startTime,endTime", "[BR] Deprecated, see GetSet_ArrangeView2 (REAPER v5.12pre4+) -- Set start and end time position of arrange view. To get arrange view instead, see BR_GetArrangeView.", },
 	{ APIFUNC(BR_SetItemEdges), "bool", "MediaItem*,double,double", "item,startTime,endTime", "[BR] Set item start and end edges' position - returns true in case of any changes", },
 	{ APIFUNC(BR_SetMediaItemImageResource), "void", "MediaItem*,const char*,int", "item,imageIn,imageFlags", "[BR] Set image resource and its flags for a given item. To clear current image resource, pass imageIn as \"\".\nimageFlags: &1=0: don't display image, &1: center / tile, &3: stretch, &5: full height (REAPER 5.974+).\nTo get image resource, see BR_GetMediaItemImageResource.", },
@@ -284,6 +291,13 @@ APIdef g_apidefs[] =
 	{ APIFUNC(NF_GetMediaItemPeakRMS_NonWindowed), "double", "MediaItem*", "item", "Returns the greatest overall (non-windowed) RMS peak level of all active channels of an audio item active take, post item gain, post take volume envelope, post-fade, pre fader, pre item FX. \n Returns -150.0 if MIDI take or empty item.", },
 	{ APIFUNC(NF_GetMediaItemAverageRMS), "double", "MediaItem*", "item", "Returns the average overall (non-windowed) RMS level of active channels of an audio item active take, post item gain, post take volume envelope, post-fade, pre fader, pre item FX. \n Returns -150.0 if MIDI take or empty item.", },
 	{ APIFUNC(NF_AnalyzeMediaItemPeakAndRMS), "bool", "MediaItem*,double,void*,void*,void*,void*", "item,windowSize,reaper.array_peaks,reaper.array_peakpositions,reaper.array_RMSs,reaper.array_RMSpositions", "This function combines all other NF_Peak/RMS functions in a single one and additionally returns peak RMS positions. Lua example code <a href=\"https://forum.cockos.com/showpost.php?p=2050961&postcount=6\">here</a>. Note: It's recommended to use this function with ReaScript/Lua as it provides reaper.array objects. If using this function with other scripting languages, you must provide arrays in the <a href=\"https://forum.cockos.com/showpost.php?p=2039829&postcount=2\">reaper.array</a> format.", },
+	{ APIFUNC(NF_AnalysisJob_Create), "int", "int,double", "flags,windowSize", "Creates a batch analysis job, returns its id (or 0 if failed). Add takes with <a href=\"#NF_AnalysisJob_AddTake\">NF_AnalysisJob_AddTake</a>, then start the job with <a href=\"#NF_AnalysisJob_Start\">NF_AnalysisJob_Start</a>: takes are analyzed in parallel in the background, poll the job with <a href=\"#NF_AnalysisJob_GetProgress\">NF_AnalysisJob_GetProgress</a> (e.g. from a deferred function) and get all values of a metric at once with <a href=\"#NF_AnalysisJob_GetResults\">NF_AnalysisJob_GetResults</a>. Delete the job with <a href=\"#NF_AnalysisJob_Destroy\">NF_AnalysisJob_Destroy</a>.\nflags: &1=peak, &2=RMS (average and windowed), &4=true peak, &8=loudness (integrated, range, max short-term/momentary and loudness curves). Peak and RMS are analyzed in a single pass like <a href=\"#NF_AnalyzeMediaItemPeakAndRMS\">NF_AnalyzeMediaItemPeakAndRMS</a>, true peak and loudness like <a href=\"#NF_AnalyzeTakeLoudness2\">NF_AnalyzeTakeLoudness2</a>.\nwindowSize: RMS window in seconds, <= 0 to use the SWS RMS options (see <a href=\"#NF_GetSWS_RMSoptions\">NF_GetSWS_RMSoptions</a>).", },
+	{ APIFUNC(NF_AnalysisJob_AddTake), "bool", "int,MediaItem_Take*", "job,take", "Adds a take (need not be active) to an analysis job that has not been started yet. Returns false for MIDI takes. See <a href=\"#NF_AnalysisJob_Create\">NF_AnalysisJob_Create</a>.", },
+	{ APIFUNC(NF_AnalysisJob_Start), "bool", "int", "job", "Starts analyzing the takes of an analysis job in the background. See <a href=\"#NF_AnalysisJob_Create\">NF_AnalysisJob_Create</a>.", },
+	{ APIFUNC(NF_AnalysisJob_GetProgress), "double", "int", "job", "Returns the progress of an analysis job (0.0-1.0, 1.0 when all takes are analyzed) or -1 if the job does not exist. See <a href=\"#NF_AnalysisJob_Create\">NF_AnalysisJob_Create</a>.", },
+	{ APIFUNC(NF_AnalysisJob_GetResults), "bool", "int,int,void*", "job,metric,reaper.array_values", "Appends one value per take (in the order takes were added) to reaper.array_values, the job must be finished. Returns false if the job is not finished or if the array is too small.\nmetric: 0=peak (dB), 1=peak position, 2=average RMS (dB), 3=peak windowed RMS (dB), 4=peak windowed RMS position, 5=true peak (dBTP), 6=true peak position, 7=integrated loudness (LUFS), 8=loudness range (LU), 9=max. short-term loudness (LUFS), 10=max. momentary loudness (LUFS).\nPositions are in seconds, relative to the item start (-666 for RMS positions and -1 for true peak positions if not available). Failed or not requested values are -150 (0 for loudness range). See <a href=\"#NF_AnalysisJob_Create\">NF_AnalysisJob_Create</a>.", },
+	{ APIFUNC(NF_AnalysisJob_GetLoudnessCurve), "bool", "int,int,bool,void*", "job,takeIdx,shortTerm,reaper.array_values", "Appends the loudness curve of a take (0-based index in the order takes were added) to reaper.array_values: momentary loudness values (LUFS, every 0.4 s) or short-term loudness values (LUFS, every 3 s) if shortTerm is true. The job must be finished and created with loudness analysis (flags&8). See <a href=\"#NF_AnalysisJob_Create\">NF_AnalysisJob_Create</a>.", },
+	{ APIFUNC(NF_AnalysisJob_Destroy), "void", "int", "job", "Deletes an analysis job, analyses in progress are aborted. See <a href=\"#NF_AnalysisJob_Create\">NF_AnalysisJob_Create</a>.", },
 
 	// #880
 	{ APIFUNC(NF_AnalyzeTakeLoudness_IntegratedOnly), "bool", "MediaItem_Take*,double*", "take,lufsIntegratedOut", "Does LUFS integrated analysis only. Faster than full loudness analysis (<a href=\"#NF_AnalyzeTakeLoudness\">NF_AnalyzeTakeLoudness</a>) . Use this if only LUFS integrated is required. Take vol. env. is taken into account. See: <a href=\"http://wiki.cockos.com/wiki/index.php/Measure_and_normalize_loudness_with_SWS\">Signal flow</a>", },
@@ -294,6 +308,7 @@ APIdef g_apidefs[] =
 	{ APIFUNC(NF_GetSWSTrackNotes), "const char*", "MediaTrack*", "track", "", },
 	{ APIFUNC(NF_SetSWSTrackNotes), "void", "MediaTrack*,const char*", "track,str", "", },
 	{ APIFUNC(NF_GetSWSMarkerRegionSub), "const char*", "int", "markerRegionIdx", "Returns SWS/S&M marker/region subtitle. markerRegionIdx: Refers to index that can be passed to <a href=\"#EnumProjectMarkers\">EnumProjectMarkers</a> (not displayed marker/region index). Returns empty string if marker/region with specified index not found or marker/region subtitle not set. Lua code example <a href=\"https://github.com/ReaTeam/ReaScripts-Templates/blob/master/Markers%20and%20Regions/NF_Get%20SWS%20markers%20and%20regions%20notes.lua\">here</a>.", },
+	{ APIFUNC(NF_GetSWSMarkerRegionSubAtPosition), "const char*", "double,int,int*", "position,flags,markerRegionIdxOut", "Returns the SWS/S&M subtitle of the marker/region displayed by the Notes window at the specified position (i.e. the last marker or the last region containing position). flags: &1=markers, &2=regions (0: both). markerRegionIdxOut: index that can be passed to <a href=\"#EnumProjectMarkers\">EnumProjectMarkers</a>, -1 if no marker/region found. Returns empty string if no marker/region found or subtitle not set.", },
 	{ APIFUNC(NF_SetSWSMarkerRegionSub), "bool", "const char*,int", "markerRegionSub,markerRegionIdx", "Set SWS/S&M marker/region subtitle. markerRegionIdx: Refers to index that can be passed to <a href=\"#EnumProjectMarkers\">EnumProjectMarkers</a> (not displayed marker/region index). Returns true if subtitle is set successfully (i.e. marker/region with specified index is present in project). Lua code example <a href=\"https://github.com/ReaTeam/ReaScripts-Templates/blob/master/Markers%20and%20Regions/NF_Get%20SWS%20markers%20and%20regions%20notes.lua\">here</a>.", },
 	{ APIFUNC(NF_UpdateSWSMarkerRegionSubWindow), "void", "", "", "Redraw the Notes window (call if you've changed a subtitle via <a href=\"NF_SetSWSMarkerRegionSub\">NF_SetSWSMarkerRegionSub</a> which is currently displayed in the Notes window and you want to appear the new subtitle immediately.)", },
 
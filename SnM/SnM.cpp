@@ -28,6 +28,7 @@
 #include "stdafx.h"
 #include "SnM.h"
 #include "SnM_CueBuss.h"
+#include "SnM_CSurf.h"
 #include "SnM_Cyclactions.h"
 #include "SnM_Dlg.h"
 #include "SnM_Find.h"
@@ -1106,8 +1107,9 @@ int MidiOscActionJob::AdjustRelative(int _adjmode, int _reladj)
 
 WDL_FastString g_SNM_IniFn, g_SNM_CyclIniFn, g_SNM_DiffToolFn;
 int g_SNM_Beta=0, g_SNM_LearnPitchAndNormOSC=0;
-int g_SNM_MediaFlags=0, g_SNM_ToolbarRefreshFreq=SNM_DEF_TOOLBAR_RFRSH_FREQ;
-bool g_SNM_ToolbarRefresh = false;
+int g_SNM_MediaFlags=0, g_SNM_ToolbarRefreshFreq=SNM_DEF_TOOLBAR_RFRSH_FREQ, g_SNM_OscAddrInterval=SNM_DEF_OSC_ADDR_INTERVAL, g_SNM_MkrRgnUpdateFreq=SNM_DEF_MKR_RGN_UPDATE_FREQ;
+int g_SNM_PreviewCacheSize=SNM_DEF_PREVIEW_CACHE_SIZE, g_SNM_PreviewPrefetchLen=SNM_DEF_PREVIEW_PREFETCH;
+bool g_SNM_ToolbarRefresh = false, g_SNM_OscLogStats = false, g_SNM_PreviewLogStats = false, g_SNM_RoutingMergeSends = false, g_SNM_RoutingLogStats = false, g_SNM_FXChainLogStats = false;
 
 
 void IniFileInit()
@@ -1119,8 +1121,11 @@ void IniFileInit()
 	SNM_UpgradeIniFiles(iniVersion);
 
 	g_SNM_MediaFlags |= (GetPrivateProfileInt("General", "MediaFileLockAudio", 0, g_SNM_IniFn.Get()) ? 1:0);
+	g_SNM_PreviewCacheSize = BOUNDED(GetPrivateProfileInt("General", "MediaFilePreviewCacheSize", SNM_DEF_PREVIEW_CACHE_SIZE, g_SNM_IniFn.Get()), 0, 256);
+	g_SNM_PreviewPrefetchLen = BOUNDED(GetPrivateProfileInt("General", "MediaFilePreviewPrefetch", SNM_DEF_PREVIEW_PREFETCH, g_SNM_IniFn.Get()), 0, 60);
 	g_SNM_ToolbarRefresh = (GetPrivateProfileInt("General", "ToolbarsAutoRefresh", 1, g_SNM_IniFn.Get()) == 1);
 	g_SNM_ToolbarRefreshFreq = BOUNDED(GetPrivateProfileInt("General", "ToolbarsAutoRefreshFreq", SNM_DEF_TOOLBAR_RFRSH_FREQ, g_SNM_IniFn.Get()), 100, 5000);
+	g_SNM_MkrRgnUpdateFreq = BOUNDED(GetPrivateProfileInt("General", "MarkerRegionUpdateFreq", SNM_DEF_MKR_RGN_UPDATE_FREQ, g_SNM_IniFn.Get()), 100, 5000);
 	g_SNM_SupportBuggyPlug = GetPrivateProfileInt("General", "BuggyPlugsSupport", 0, g_SNM_IniFn.Get());
 
 	// #1175, prompt by default, may be overridden
@@ -1135,6 +1140,12 @@ void IniFileInit()
 	g_SNM_DiffToolFn.Set(buf);
 #endif
 	g_SNM_LearnPitchAndNormOSC = GetPrivateProfileInt("General", "LearnPitchAndNormOSC", 0, g_SNM_IniFn.Get());
+	g_SNM_OscAddrInterval = BOUNDED(GetPrivateProfileInt("General", "OscFeedbackAddrInterval", SNM_DEF_OSC_ADDR_INTERVAL, g_SNM_IniFn.Get()), 0, 5000);
+	g_SNM_OscLogStats = (GetPrivateProfileInt("OscFeedback", "LogStats", 0, g_SNM_IniFn.Get()) == 1);
+	g_SNM_PreviewLogStats = (GetPrivateProfileInt("Preview", "LogStats", 0, g_SNM_IniFn.Get()) == 1);
+	g_SNM_RoutingMergeSends = (GetPrivateProfileInt("Routing", "MergeSends", 0, g_SNM_IniFn.Get()) == 1);
+	g_SNM_RoutingLogStats = (GetPrivateProfileInt("Routing", "LogStats", 0, g_SNM_IniFn.Get()) == 1);
+	g_SNM_FXChainLogStats = (GetPrivateProfileInt("FXChains", "LogStats", 0, g_SNM_IniFn.Get()) == 1);
 	g_SNM_Beta = GetPrivateProfileInt("General", "Beta", 0, g_SNM_IniFn.Get());
 }
 
@@ -1153,14 +1164,18 @@ void IniFileExit()
 	// general prefs
 	iniSection.AppendFormatted(128, "IniFileUpgrade=%d\n", SNM_INI_FILE_VERSION); 
 	iniSection.AppendFormatted(128, "MediaFileLockAudio=%d\n", g_SNM_MediaFlags&1 ? 1:0); 
+	iniSection.AppendFormatted(128, "MediaFilePreviewCacheSize=%d ; nb of media file sources kept open (min: 0, max: 256)\n", g_SNM_PreviewCacheSize);
+	iniSection.AppendFormatted(128, "MediaFilePreviewPrefetch=%d ; in s (min: 0, max: 60)\n", g_SNM_PreviewPrefetchLen);
 	iniSection.AppendFormatted(128, "ToolbarsAutoRefresh=%d\n", g_SNM_ToolbarRefresh ? 1:0); 
 	iniSection.AppendFormatted(128, "ToolbarsAutoRefreshFreq=%d ; in ms (min: 100, max: 5000)\n", g_SNM_ToolbarRefreshFreq);
+	iniSection.AppendFormatted(128, "MarkerRegionUpdateFreq=%d ; in ms (min: 100, max: 5000)\n", g_SNM_MkrRgnUpdateFreq);
 	iniSection.AppendFormatted(128, "BuggyPlugsSupport=%d\n", g_SNM_SupportBuggyPlug ? 1:0);
 #ifdef _WIN32
 	iniSection.AppendFormatted(128, "ClearTypeFont=%d\n", g_SNM_ClearType ? 1:0);
 	iniSection.AppendFormatted(SNM_MAX_PATH, "DiffTool=\"%s\"\n", g_SNM_DiffToolFn.Get());
 #endif
 	iniSection.AppendFormatted(128, "LearnPitchAndNormOSC=%d\n", g_SNM_LearnPitchAndNormOSC); 
+	iniSection.AppendFormatted(128, "OscFeedbackAddrInterval=%d ; in ms (min: 0, max: 5000)\n", g_SNM_OscAddrInterval);
 	iniSection.AppendFormatted(128, "Beta=%d\n", g_SNM_Beta); 
 	SaveIniSection("General", &iniSection, g_SNM_IniFn.Get());
 
@@ -1212,6 +1227,11 @@ int SNM_Init(reaper_plugin_info_t* _rec)
 		return 0;
 	}
 
+	// fx bypass toggle states are re-evaluated on track selection/fx changes only,
+	// except for the "selected fx" one (fx selection in fx chains is not notified)
+	SWSCacheToggleStates(IsFXBypassedSelTracks, SWS_TOGGLE_DIRTY_SELECTION|SWS_TOGGLE_DIRTY_TRACKS|SWS_TOGGLE_DIRTY_FX);
+	SWSCacheToggleState(SWSGetCommandID(ToggleFXBypassSelTracks, -1), 0);
+
 	SNM_UIInit();
 	CueBussInit();
 	LiveConfigInit();
@@ -1231,8 +1251,10 @@ int SNM_Init(reaper_plugin_info_t* _rec)
 
 void SNM_Exit()
 {
+	OscFeedbackExit();
 	LiveConfigExit();
 	ResourcesExit();
+	TrackPreviewExit();
 	NotesExit();
 	FindExit();
 	ImageExit();
@@ -77,6 +77,7 @@
 #define SNM_CYCLACTION_INI_FILE    "%s\\S&M_Cyclactions.ini"
 #define SNM_CYCLACTION_BAK_FILE    "%s\\S&M_Cyclactions.bak"
 #define SNM_CYCLACTION_EXPORT_FILE "%s\\S&M_Cyclactions_export.ini"
+#define SNM_RES_CATALOG_FILE       "%s\\S&M_ResourceCatalog.txt"
 #define SNM_KB_INI_FILE            "%s\\reaper-kb.ini"
 #define SNM_CONSOLE_FILE           "%s\\reaconsole_customcommands.txt"
 #define SNM_REAPER_EXE_FILE        "%s\\reaper.exe"
@@ -96,6 +97,7 @@
 #define SNM_CYCLACTION_INI_FILE    "%s/S&M_Cyclactions.ini"
 #define SNM_CYCLACTION_BAK_FILE    "%s/S&M_Cyclactions.bak"
 #define SNM_CYCLACTION_EXPORT_FILE "%s/S&M_Cyclactions_export.ini"
+#define SNM_RES_CATALOG_FILE       "%s/S&M_ResourceCatalog.txt"
 #define SNM_KB_INI_FILE            "%s/reaper-kb.ini"
 #define SNM_CONSOLE_FILE           "%s/reaconsole_customcommands.txt"
 #ifdef __LP64__
@@ -118,9 +120,12 @@
 
 #define SNM_PRESETS_NB_FX          8
 #define SNM_CSURF_RUN_TICK_MS      27.0 // monitored average, 1 tick ~= 27ms
-#define SNM_MKR_RGN_UPDATE_FREQ    500  // gentle value (ms) not to stress REAPER
+#define SNM_DEF_MKR_RGN_UPDATE_FREQ 500 // default max. frequency in ms of marker/region updates, gentle value not to stress REAPER
 #define SNM_OFFSCREEN_UPDATE_FREQ  1000	// gentle value (ms) not to stress REAPER
 #define SNM_DEF_TOOLBAR_RFRSH_FREQ 300  // default frequency in ms for the "auto-refresh toolbars" option 
+#define SNM_DEF_OSC_ADDR_INTERVAL  50   // default min. interval in ms between 2 osc feedback messages sent to the same address
+#define SNM_DEF_PREVIEW_CACHE_SIZE 16   // default max. number of media file sources kept open for previews
+#define SNM_DEF_PREVIEW_PREFETCH   5    // default length in s of the media file heads read ahead for previews
 #define SNM_FUDGE_FACTOR           0.0000000001
 #define SNM_CSURF_EXT_UNREGISTER   0x00016666
 #define SNM_REAPER_IMG_EXTS        "png,pcx,jpg,jpeg,jfif,ico,bmp" // img exts supported by REAPER (v4.32), can't get those at runtime yet
@@ -160,6 +165,7 @@
 #define SNM_MAX_PRESET_NAME_LEN    SNM_MAX_PATH // vst3 presets can be full filenames (.vstpreset files)
 #define SNM_MAX_FX_NAME_LEN        128
 #define SNM_MAX_OSC_MSG_LEN        256
+#define SNM_MAX_OSC_PENDING_MSGS   1024 // per osc device
 
 #define SNM_LOGO_PNG_FILE "iVBORw0KGgoAAAANSUhEUgAAADIAAAAUCAMAAAGPE64+AAAAFXRFWA==\n\
 dENyZWF0aW9uIFRpbWUAB9oHEQEwJvx8Q0oAAAAHdElNRQfaBxAXJA==\n\
@@ -201,9 +207,9 @@ vezn/Q+t/AIQiCv/Q4iRxAAAAABJRU5ErkJggg==\n"
 // Misc global/common classes, vars, etc.
 ///////////////////////////////////////////////////////////////////////////////
 
-extern int g_SNM_Beta, g_SNM_LearnPitchAndNormOSC, g_SNM_MediaFlags, g_SNM_ToolbarRefreshFreq;
+extern int g_SNM_Beta, g_SNM_LearnPitchAndNormOSC, g_SNM_MediaFlags, g_SNM_ToolbarRefreshFreq, g_SNM_OscAddrInterval, g_SNM_MkrRgnUpdateFreq, g_SNM_PreviewCacheSize, g_SNM_PreviewPrefetchLen;
 extern WDL_FastString g_SNM_IniFn, g_SNM_CyclIniFn, g_SNM_DiffToolFn;
-extern bool g_SNM_ToolbarRefresh;
+extern bool g_SNM_ToolbarRefresh, g_SNM_OscLogStats, g_SNM_PreviewLogStats, g_SNM_RoutingMergeSends, g_SNM_RoutingLogStats, g_SNM_FXChainLogStats;
 
 
 class SNM_TrackInt {
@@ -32,6 +32,7 @@
 #include "SnM_Misc.h"
 #include "SnM_Notes.h"
 #include "SnM_RegionPlaylist.h"
+#include "SnM_ResourceCatalog.h"
 #include "SnM_Resources.h"
 #include "SnM_Track.h"
 #include "SnM_Util.h"
@@ -59,6 +60,8 @@ void SNM_CSurfRun()
 	StopTrackPreviewsRun();
 	UpdateMarkerRegionRun();
 	AutoRefreshToolbarRun();
+	OscFeedbackRun();
+	ResourceCatalogRun();
 
 	sRecurseCheck = false;
 }
@@ -74,6 +77,7 @@ void SNM_CSurfSetTrackListChange()
 	LiveConfigsTrackListChange();
 	RegionPlaylistSetTrackListChange();
 	ResourcesTrackListChange();
+	OscFeedbackTrackListChange();
 }
 
 bool g_lastPlayState=false, g_lastPauseState=false, g_lastRecState=false;
@@ -109,69 +113,485 @@ int SNM_CSurfExtended(int _call, void* _parm1, void* _parm2, void* _parm3)
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+// OSC feedback output
+// Messages are not sent right away but queued per device and per osc address:
+// - a new message replaces a pending one with the same address (coalesced)
+// - pending messages are packed into bundles of up to m_maxOut bytes (or up
+//   to the max udp payload when m_maxOut is 0), once per frame (i.e. the
+//   device's "wait between packets" pref)
+// - a given address cannot be re-sent before g_SNM_OscAddrInterval ms, it
+//   just stays pending (and can be coalesced again) until then
+// - messages queued together (SendStrBundle) are kept together: they are
+//   coalesced and sent as a whole, in the same bundle, and they wait for the
+//   rate limit of each of their addresses
+// - SendStr() & co return once the message is queued, not sent: failures to
+//   send (full queue, oversized bundle, socket error) are only counted
+// => fast param changes & monitoring updates do not flood controllers with
+//    tiny udp packets anymore
+// Stats can be logged to the console with [OscFeedback]/LogStats=1 in S&M.ini
+///////////////////////////////////////////////////////////////////////////////
+
+#define SNM_OSC_STATS_LOG_FREQ		10.0 // in s
+#define SNM_OSC_MAX_UDP_PACKET		65507 // max udp payload (ipv4), used when the device has no max packet size
+
+// size of a "/address ,s string" osc message, see oscpkt::Message
+static int GetOscStrMsgSize(const WDL_FastString* _addr, const WDL_FastString* _arg) {
+	return ((_addr->GetLength()+4)&~3) + 4 + ((_arg->GetLength()+4)&~3); // 4: ",s" type tags
+}
+
+class SNM_OscOutput
+{
+public:
+	SNM_OscOutput(const char* _ip, int _port)
+		: m_ip(_ip), m_port(_port), m_maxOut(0), m_waitOut(0), m_sock(NULL), m_lastFlush(0.0),
+		m_pendingByKey(true), m_lastSent(true), m_sent(0), m_coalesced(0), m_dropped(0), m_packets(0) {
+		memset(m_loggedStats, 0, sizeof(m_loggedStats));
+	}
+	~SNM_OscOutput() {
+		m_pending.Empty(true);
+		DELETE_NULL(m_sock);
+	}
+
+	// _strs: osc address, osc string arg, osc address, etc.. (at least 1 pair)
+	bool Queue(const char** _strs, int _nbStrs)
+	{
+		WDL_FastString key;
+		for (int i=0; i<_nbStrs; i+=2)
+		{
+			if (i) key.Append("\n");
+			key.Append(_strs[i]);
+		}
+
+		if (PendingMsg* msg = m_pendingByKey.Get(key.Get()))
+		{
+			msg->SetArgs(_strs);
+			m_coalesced += _nbStrs/2;
+			return true;
+		}
+		if (m_pending.GetSize() >= SNM_MAX_OSC_PENDING_MSGS)
+		{
+			m_dropped += _nbStrs/2;
+			return false;
+		}
+		PendingMsg* msg = m_pending.Add(new PendingMsg(key.Get(), _strs, _nbStrs));
+		m_pendingByKey.Insert(msg->m_key.Get(), msg);
+		return true;
+	}
+
+	// _force: ignore frame & rate limits, used on exit
+	void Run(double _now, bool _force = false)
+	{
+		if (!m_pending.GetSize() || (!_force && (_now-m_lastFlush)*1000.0 < m_waitOut))
+			return;
+		m_lastFlush = _now;
+
+		WDL_PtrList<PendingMsg> bundle;
+		int bundleSz = 16; // "#bundle" + time tag
+		for (int i=0; i<m_pending.GetSize(); )
+		{
+			PendingMsg* msg = m_pending.Get(i);
+			if (!_force && IsRateLimited(msg, _now))
+			{
+				i++; // keep it pending
+				continue;
+			}
+
+			m_pendingByKey.Delete(msg->m_key.Get());
+			m_pending.Delete(i, false);
+
+			int sz = msg->GetSize(), maxSz = m_maxOut>0 ? m_maxOut : SNM_OSC_MAX_UDP_PACKET;
+			if (bundle.GetSize() && (bundleSz+sz) >= maxSz)
+			{
+				SendBundle(&bundle);
+				bundleSz = 16;
+			}
+			if ((bundleSz+sz) >= maxSz)
+			{
+				m_dropped += msg->GetMsgCount(); // would not fit in a packet anyway
+				delete msg;
+				continue;
+			}
+			for (int j=0; j<msg->m_strs.GetSize(); j+=2)
+				m_lastSent.Insert(msg->m_strs.Get(j)->Get(), _now);
+			bundle.Add(msg);
+			bundleSz += sz;
+		}
+		if (bundle.GetSize())
+			SendBundle(&bundle);
+
+		// entries older than the rate limit are useless
+		if (m_lastSent.GetSize() > SNM_MAX_OSC_PENDING_MSGS)
+			PruneLastSent(_now);
+	}
+
+	// forget rate limits, e.g. on track list changes (addresses of removed tracks would stay forever otherwise)
+	void ResetLastSent() {
+		m_lastSent.DeleteAll();
+	}
+
+	// returns true if counters changed since last call
+	bool LogStats(WDL_FastString* _out)
+	{
+		if (m_loggedStats[0]==m_sent && m_loggedStats[1]==m_coalesced && m_loggedStats[2]==m_dropped && m_loggedStats[3]==m_packets)
+			return false;
+		m_loggedStats[0]=m_sent; m_loggedStats[1]=m_coalesced; m_loggedStats[2]=m_dropped; m_loggedStats[3]=m_packets;
+		_out->AppendFormatted(256, "S&M OSC feedback: %s:%d - sent: %d (%d packets), coalesced: %d, dropped: %d, pending: %d\n",
+			m_ip.Get(), m_port, m_sent, m_packets, m_coalesced, m_dropped, m_pending.GetSize());
+		return true;
+	}
+
+	WDL_FastString m_ip;
+	int m_port, m_maxOut, m_waitOut;
+	int m_sent, m_coalesced, m_dropped, m_packets; // in nb of osc messages, except m_packets
+
+private:
+	// one or several osc messages that are sent together
+	struct PendingMsg
+	{
+		PendingMsg(const char* _key, const char** _strs, int _nbStrs) : m_key(_key) {
+			for (int i=0; i+1<_nbStrs; i+=2) {
+				m_strs.Add(new WDL_FastString(_strs[i]));
+				m_strs.Add(new WDL_FastString(_strs[i+1]));
+			}
+		}
+		~PendingMsg() { m_strs.Empty(true); }
+		void SetArgs(const char** _strs) {
+			for (int i=1; i<m_strs.GetSize(); i+=2)
+				m_strs.Get(i)->Set(_strs[i]);
+		}
+		int GetMsgCount() const { return m_strs.GetSize()/2; }
+		int GetSize() {
+			int sz = 0;
+			for (int i=0; i+1<m_strs.GetSize(); i+=2)
+				sz += 4 + GetOscStrMsgSize(m_strs.Get(i), m_strs.Get(i+1)); // 4: element size
+			return sz;
+		}
+		WDL_FastString m_key; // osc address(es)
+		WDL_PtrList<WDL_FastString> m_strs; // osc address, osc string arg, osc address, etc..
+	};
+
+	// rate limits are per address: a bundle waits for the most recently sent of its addresses
+	bool IsRateLimited(PendingMsg* _msg, double _now)
+	{
+		for (int i=0; i<_msg->m_strs.GetSize(); i+=2)
+		{
+			double lastSent = m_lastSent.Get(_msg->m_strs.Get(i)->Get(), -1.0);
+			if (lastSent>=0.0 && (_now-lastSent)*1000.0 < g_SNM_OscAddrInterval)
+				return true;
+		}
+		return false;
+	}
+
+	// sends and deletes _msgs
+	void SendBundle(WDL_PtrList<PendingMsg>* _msgs)
+	{
+		if (!m_sock)
+		{
+			m_sock = new oscpkt::UdpSocket;
+			m_sock->connectTo(m_ip.Get(), m_port);
+		}
+
+		int nbMsgs = 0;
+		oscpkt::PacketWriter pw;
+		pw.startBundle();
+		for (int i=0; i<_msgs->GetSize(); i++)
+		{
+			PendingMsg* msg = _msgs->Get(i);
+			for (int j=0; j+1<msg->m_strs.GetSize(); j+=2)
+			{
+				oscpkt::Message oscMsg(msg->m_strs.Get(j)->Get());
+				oscMsg.pushStr(msg->m_strs.Get(j+1)->Get());
+				pw.addMessage(oscMsg);
+				nbMsgs++;
+			}
+		}
+		pw.endBundle();
+
+		if (m_sock->isOk() && m_sock->sendPacket(pw.packetData(), pw.packetSize()))
+		{
+			m_sent += nbMsgs;
+			m_packets++;
+		}
+		else
+		{
+			m_dropped += nbMsgs;
+			DELETE_NULL(m_sock); // re-connect on next bundle
+		}
+		_msgs->Empty(true);
+	}
+
+	void PruneLastSent(double _now)
+	{
+		for (int i=m_lastSent.GetSize()-1; i>=0; i--)
+		{
+			double lastSent = m_lastSent.Enumerate(i, NULL, -1.0);
+			if ((_now-lastSent)*1000.0 >= g_SNM_OscAddrInterval)
+				m_lastSent.DeleteByIndex(i);
+		}
+	}
+
+	oscpkt::UdpSocket* m_sock;
+	double m_lastFlush;
+	int m_loggedStats[4]; // last logged m_sent, m_coalesced, m_dropped, m_packets
+	WDL_PtrList<PendingMsg> m_pending; // queued order
+	WDL_StringKeyedArray<PendingMsg*> m_pendingByKey;
+	WDL_StringKeyedArray<double> m_lastSent; // per osc address
+};
+
+static WDL_PtrList_DeleteOnDestroy<SNM_OscOutput> g_oscOutputs;
+static double g_oscLastStatsLog = 0.0;
+
+// one output per device, i.e. shared by all SNM_OscCSurf targetting the same ip:port
+static SNM_OscOutput* GetOscOutput(SNM_OscCSurf* _osc, bool _create = true)
+{
+	SNM_OscOutput* out = NULL;
+	for (int i=0; !out && i<g_oscOutputs.GetSize(); i++)
+		if (g_oscOutputs.Get(i)->m_port==_osc->m_portOut && !strcmp(g_oscOutputs.Get(i)->m_ip.Get(), _osc->m_ipOut.Get()))
+			out = g_oscOutputs.Get(i);
+
+	if (!out && _create)
+		out = g_oscOutputs.Add(new SNM_OscOutput(_osc->m_ipOut.Get(), _osc->m_portOut));
+
+	if (out)
+	{
+		out->m_maxOut = _osc->m_maxOut;
+		out->m_waitOut = _osc->m_waitOut;
+	}
+	return out;
+}
+
+static void LogOscStats()
+{
+	if (!g_SNM_OscLogStats || !g_oscOutputs.GetSize())
+		return;
+
+	WDL_FastString stats;
+	for (int i=0; i<g_oscOutputs.GetSize(); i++)
+		g_oscOutputs.Get(i)->LogStats(&stats);
+	if (stats.GetLength())
+		ShowConsoleMsg(stats.Get());
+}
+
+// called from SNM_CSurfRun()
+void OscFeedbackRun()
+{
+	if (g_oscOutputs.GetSize())
+	{
+		double now = time_precise();
+		for (int i=0; i<g_oscOutputs.GetSize(); i++)
+			g_oscOutputs.Get(i)->Run(now);
+
+		if (g_SNM_OscLogStats && (now-g_oscLastStatsLog) >= SNM_OSC_STATS_LOG_FREQ)
+		{
+			g_oscLastStatsLog = now;
+			LogOscStats();
+		}
+	}
+}
+
+// called from SNM_CSurfSetTrackListChange(), also covers project switches
+void OscFeedbackTrackListChange()
+{
+	for (int i=0; i<g_oscOutputs.GetSize(); i++)
+		g_oscOutputs.Get(i)->ResetLastSent();
+}
+
+void OscFeedbackExit()
+{
+	double now = time_precise();
+	for (int i=0; i<g_oscOutputs.GetSize(); i++)
+		g_oscOutputs.Get(i)->Run(now, true); // flush pending messages
+	LogOscStats();
+	g_oscOutputs.Empty(true);
+}
+
+#ifdef BR_DEBUG_PERFORMANCE_BENCHMARK
+// receives one packet on _sock, returns its messages as "address=arg;" (empty on timeout)
+static void ReceiveOscLoopback(oscpkt::UdpSocket* _sock, WDL_FastString* _out)
+{
+	_out->Set("");
+	if (!_sock->receiveNextPacket(1000))
+		return;
+	oscpkt::PacketReader pr(_sock->packetData(), _sock->packetSize());
+	while (oscpkt::Message* msg = pr.popMessage())
+	{
+		std::string arg;
+		msg->arg().popStr(arg);
+		_out->AppendFormatted(SNM_MAX_OSC_MSG_LEN, "%s=%s;", msg->addressPattern().c_str(), arg.c_str());
+	}
+}
+
+// SNM_OscOutput over a loopback udp socket, with a simulated clock:
+// coalescing, bundles kept together, per address rate limiting, packet size limit
+static bool OscLoopbackTest(WDL_FastString* _failure)
+{
+	oscpkt::UdpSocket sock;
+	if (!sock.bindTo(0) || !sock.isBound())
+	{
+		_failure->Set("cannot bind loopback socket");
+		return false;
+	}
+
+	SNM_OscOutput out("127.0.0.1", sock.boundPort());
+	out.m_maxOut = 1024;
+	out.m_waitOut = 0;
+
+	const char* vol[] = { "/track/1/volume", "-6.0dB" };
+	const char* vol2[] = { "/track/1/volume", "-3.0dB" };
+	const char* pan[] = { "/track/1/pan/str", "L10", "/track/1/pan2/str", "R10" };
+	const char* big[] = { "/track/2/name", "", "/track/3/name", "" };
+
+	WDL_FastString got, name;
+
+	// step 1: coalesced volume + pan bundle, all in one packet
+	out.Queue(vol, 2);
+	out.Queue(vol2, 2);
+	out.Queue(pan, 4);
+	out.Run(0.0);
+	ReceiveOscLoopback(&sock, &got);
+	if (strcmp(got.Get(), "/track/1/volume=-3.0dB;/track/1/pan/str=L10;/track/1/pan2/str=R10;") || out.m_coalesced!=1 || out.m_packets!=1)
+	{
+		_failure->SetFormatted(SNM_MAX_OSC_MSG_LEN*2, "coalescing: got '%s'", got.Get());
+		return false;
+	}
+
+	// step 2: same address re-sent before g_SNM_OscAddrInterval stays pending, then goes out
+	out.Queue(vol, 2);
+	out.Run(g_SNM_OscAddrInterval/2000.0);
+	if (out.m_sent!=3)
+	{
+		_failure->Set("rate limiting: message sent too early");
+		return false;
+	}
+	out.Run(g_SNM_OscAddrInterval/1000.0 + 0.001);
+	ReceiveOscLoopback(&sock, &got);
+	if (strcmp(got.Get(), "/track/1/volume=-6.0dB;"))
+	{
+		_failure->SetFormatted(SNM_MAX_OSC_MSG_LEN*2, "rate limiting: got '%s'", got.Get());
+		return false;
+	}
+
+	// step 3: a bundle that doesn't fit in the current packet goes whole in the next one
+	name.SetFormatted(512, "%0450d", 0);
+	big[1] = big[3] = name.Get();
+	out.Queue(pan, 4); // rate limit expired by now
+	out.Queue(big, 4);
+	out.Run(10.0);
+	ReceiveOscLoopback(&sock, &got);
+	if (strcmp(got.Get(), "/track/1/pan/str=L10;/track/1/pan2/str=R10;"))
+	{
+		_failure->SetFormatted(SNM_MAX_OSC_MSG_LEN*2, "atomic bundles: first packet '%s'", got.Get());
+		return false;
+	}
+	ReceiveOscLoopback(&sock, &got);
+	if (strncmp(got.Get(), "/track/2/name=000", 17) || !strstr(got.Get(), ";/track/3/name=000"))
+	{
+		_failure->Set("atomic bundles: bundle was split");
+		return false;
+	}
+
+	// step 4: a bundle bigger than a packet is dropped as a whole
+	out.m_maxOut = 512;
+	out.Queue(big, 4);
+	int dropped = out.m_dropped;
+	out.Run(20.0);
+	if (out.m_dropped!=dropped+2)
+	{
+		_failure->Set("packet size limit: oversized bundle not dropped");
+		return false;
+	}
+
+	// step 5: no max packet size, the same bundle goes out
+	out.m_maxOut = 0;
+	out.Queue(big, 4);
+	out.Run(30.0);
+	ReceiveOscLoopback(&sock, &got);
+	if (strncmp(got.Get(), "/track/2/name=000", 17) || !strstr(got.Get(), ";/track/3/name=000"))
+	{
+		_failure->Set("no packet size limit: bundle not sent");
+		return false;
+	}
+
+	// step 6: an address sent in a bundle is rate limited on its own too
+	const char* name2[] = { "/track/2/name", "x" };
+	int sent = out.m_sent;
+	out.Queue(name2, 2);
+	out.Run(30.0 + g_SNM_OscAddrInterval/2000.0);
+	if (out.m_sent!=sent)
+	{
+		_failure->Set("per address rate limiting: message sent too early");
+		return false;
+	}
+	out.Run(31.0);
+	ReceiveOscLoopback(&sock, &got);
+	if (strcmp(got.Get(), "/track/2/name=x;"))
+	{
+		_failure->SetFormatted(SNM_MAX_OSC_MSG_LEN*2, "per address rate limiting: got '%s'", got.Get());
+		return false;
+	}
+	return true;
+}
+
+static void OscFeedbackBenchmark(const BR_BenchmarkConfig& _cfg, vector<BR_BenchmarkResult>& _results)
+{
+	BR_BenchmarkResult result("SNM_OscOutput/loopback", "S&M OSC feedback loopback test");
+
+	int addrInterval = g_SNM_OscAddrInterval;
+	g_SNM_OscAddrInterval = 50;
+	for (int i=0; i<_cfg.iterations && !result.failure.GetLength(); i++)
+	{
+		double start = time_precise();
+		OscLoopbackTest(&result.failure);
+		result.AddTime(start);
+	}
+	g_SNM_OscAddrInterval = addrInterval;
+	_results.push_back(result);
+}
+static BR_BenchmarkRegistration s_oscFeedbackBenchmark(OscFeedbackBenchmark);
+#endif
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // OSC feedtack
 ///////////////////////////////////////////////////////////////////////////////
 
+// note: messages are queued, see SNM_OscOutput
+// returns true if the message was queued (or coalesced with a pending one), not if it was sent
 bool SNM_OscCSurf::SendStr(const char* _msg, const char* _oscArg, int _msgArg)
 {
 	if (_msg && *_msg && _oscArg)
 	{
-		oscpkt::UdpSocket sock;
-		sock.connectTo(m_ipOut.Get(), m_portOut);
-		if (sock.isOk())
+		if (SNM_OscOutput* out = GetOscOutput(this))
 		{
 			WDL_FastString msg(_msg);
 			if (_msgArg>=0)
 				msg.SetFormatted(SNM_MAX_OSC_MSG_LEN, _msg, _msgArg);
-
-			oscpkt::Message oscMsg(msg.Get());
-			oscMsg.pushStr(_oscArg);
-			oscpkt::PacketWriter pw;
-			pw.startBundle();
-			pw.addMessage(oscMsg);
-			pw.endBundle();
-			if ((int)pw.packetSize() < m_maxOut) // C4018
-				return sock.sendPacket(pw.packetData(), pw.packetSize());
+			const char* strs[2] = { msg.Get(), _oscArg };
+			return out->Queue(strs, 2);
 		}
 	}
 	return false;
 }
 
+// _strs: osc address, osc string arg, osc address, etc..
+// note: messages are queued, see SNM_OscOutput, but they are sent in the same bundle
+// returns true if the messages were queued, not if they were sent
 bool SNM_OscCSurf::SendStrBundle(WDL_PtrList<WDL_FastString> * _strs)
 {
 	if (_strs && _strs->GetSize())
 	{
-		oscpkt::UdpSocket sock;
-		sock.connectTo(m_ipOut.Get(), m_portOut);
-		if (sock.isOk())
+		WDL_TypedBuf<const char*> strs;
+		for (int i=0; i<_strs->GetSize(); i+=2)
 		{
-			// build osc messages
-			WDL_PtrList_DeleteOnDestroy<oscpkt::Message> msgs; // for "auto-deletion"
-			for (int i=0; i<_strs->GetSize(); i+=2)
-			{
-				if (WDL_FastString* msg = _strs->Get(i))
-				{
-					oscpkt::Message* oscMsg = msgs.Add(new oscpkt::Message(msg->Get()));
-					if (WDL_FastString* oscArg = _strs->Get(i+1))
-						oscMsg->pushStr(oscArg->Get());
-					else
-						return false;
-				}
-			}
-
-			// bundle & send osc messages
-			if (msgs.GetSize())
-			{
-				oscpkt::PacketWriter pw;
-				pw.startBundle();
-				for (int i=0; i<msgs.GetSize(); i++)
-					pw.addMessage(*msgs.Get(i));
-				pw.endBundle();
-				if ((int)pw.packetSize() < m_maxOut) // C4018
-					return sock.sendPacket(pw.packetData(), pw.packetSize());
-			}
+			if (!_strs->Get(i) || !_strs->Get(i+1))
+				return false;
+			strs.Add(_strs->Get(i)->Get());
+			strs.Add(_strs->Get(i+1)->Get());
 		}
+
+		if (SNM_OscOutput* out = GetOscOutput(this))
+			return out->Queue(strs.Get(), strs.GetSize());
 	}
 	return false;
 }
@@ -49,8 +49,8 @@ public:
 		: m_name(&_osc->m_name), m_flags(_osc->m_flags), m_portIn(_osc->m_portIn), 
 		m_ipOut(&_osc->m_ipOut), m_portOut(_osc->m_portOut), m_maxOut(_osc->m_maxOut), m_waitOut(_osc->m_waitOut), m_layout(&_osc->m_layout) {}
 	~SNM_OscCSurf() {}
-	bool SendStr(const char* _msg, const char* _oscArg, int _msgArg = -1);
-	bool SendStrBundle(WDL_PtrList<WDL_FastString> * _strs);
+	bool SendStr(const char* _msg, const char* _oscArg, int _msgArg = -1); // true if queued, see SNM_OscOutput
+	bool SendStrBundle(WDL_PtrList<WDL_FastString> * _strs); // true if queued, see SNM_OscOutput
 	bool Equals(SNM_OscCSurf* _osc);
 
 	WDL_FastString m_name;
@@ -63,6 +63,9 @@ public:
 
 SNM_OscCSurf* LoadOscCSurfs(WDL_PtrList<SNM_OscCSurf>* _out, const char* _name = NULL);
 void AddOscCSurfMenu(HMENU _menu, SNM_OscCSurf* _activeOsc, int _startMsg, int _endMsg);
+void OscFeedbackRun();
+void OscFeedbackTrackListChange();
+void OscFeedbackExit();
 
 
 // fake/local osc csurf (local input)
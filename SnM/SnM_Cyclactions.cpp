@@ -212,6 +212,23 @@ bool IsCondStatement(const char* _cmd) {
 	return (_cmd && (!_stricmp(STATEMENT_IF, _cmd) || !_stricmp(STATEMENT_IFNOT, _cmd) || IsTwoCondStatement(_cmd)));
 }
 
+// compiled commands, see Cyclaction::Compile()
+enum {
+  CA_OP_NONE=0,   // empty cmd
+  CA_OP_STEP,     // '!' (next cycle step)
+  CA_OP_CMD,      // action, performed by id
+  CA_OP_MACRO,    // macro, script or console custom action, performed by id, no toggle state
+  CA_OP_CA,       // sub cycle action, m_arg: 0-based index in the section (-1: invalid)
+  CA_OP_STR,      // CONSOLE/LABEL statement, performed by string
+  CA_OP_IF,       // m_arg: IDX_STATEMENT_IF..IDX_STATEMENT_IFXNOR
+  CA_OP_ELSE,
+  CA_OP_ENDIF,
+  CA_OP_LOOP,     // m_arg: loop count (-1: prompt)
+  CA_OP_ENDLOOP
+};
+
+#define CA_MAX_DEPTH 64 // sub-CA depth guard (registered CAs can't be recursive anyway)
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // Explode _cmdStr into "atomic" actions
@@ -452,6 +469,33 @@ int ExplodeConsoleAction(int _section, const char* _cmdStr,
 // Perform cycle actions
 ///////////////////////////////////////////////////////////////////////////////
 
+// _cmdId: registered command id (hard checked)
+int PerformSingleCommand(int _section, int _cmdId, int _val, int _valhw, int _relmode, HWND _hwnd)
+{
+	KbdSectionInfo* kbdSec = SNM_GetActionSection(_section);
+	if (!kbdSec || !_cmdId)
+		return 0;
+
+	// can't just rely on kbdSec->onAction() because some actions
+	// depend on the current focused window, etc
+	switch (_section)
+	{
+		case SNM_SEC_IDX_MAIN:
+			return KBD_OnMainActionEx(_cmdId, _val, _valhw, _relmode, _hwnd, NULL);
+		case SNM_SEC_IDX_ME:
+		case SNM_SEC_IDX_ME_EL:
+			return MIDIEditor_LastFocused_OnCommand(_cmdId, _section==SNM_SEC_IDX_ME_EL);
+		case SNM_SEC_IDX_EPXLORER:
+			if (HWND h = GetReaHwndByTitle(__localizeFunc("Media Explorer", "explorer", 0))) {
+				SendMessage(h, WM_COMMAND, _cmdId, 0);
+				return 1;
+			}
+			return 0;
+		default:
+			return kbdSec->onAction(_cmdId, _val, _valhw, _relmode, _hwnd);
+	}
+}
+
 // assumes _cmdStr is valid and has been "exploded", if needed
 int PerformSingleCommand(int _section, const char* _cmdStr, int _val, int _valhw, int _relmode, HWND _hwnd)
 {
@@ -467,25 +511,8 @@ int PerformSingleCommand(int _section, const char* _cmdStr, int _val, int _valhw
 
 		// SNM_NamedCommandLookup hard check: the command MUST be registered
 		if (int cmdId = SNM_NamedCommandLookup(_cmdStr, kbdSec, true))
-	{
-			// can't just rely on kbdSec->onAction() because some actions
-			// depend on the current focused window, etc
-			switch (_section)
-			{
-				case SNM_SEC_IDX_MAIN:
-					return KBD_OnMainActionEx(cmdId, _val, _valhw, _relmode, _hwnd, NULL);
-				case SNM_SEC_IDX_ME:
-				case SNM_SEC_IDX_ME_EL:
-					return MIDIEditor_LastFocused_OnCommand(cmdId, _section==SNM_SEC_IDX_ME_EL);
-				case SNM_SEC_IDX_EPXLORER:
-					if (HWND h = GetReaHwndByTitle(__localizeFunc("Media Explorer", "explorer", 0))) {
-						SendMessage(h, WM_COMMAND, cmdId, 0);
-						return 1;
-					}
-					return 0;
-				default:
-					return kbdSec->onAction(cmdId, _val, _valhw, _relmode, _hwnd);
-			}
+		{
+			return PerformSingleCommand(_section, cmdId, _val, _valhw, _relmode, _hwnd);
 		}
 		// custom console command?
 		// note: authorized in any section
@@ -517,8 +544,117 @@ int PerformSingleCommand(int _section, const char* _cmdStr, int _val, int _valhw
 	return 0;
 }
 
+// a flattened compiled command
+struct CA_Ref
+{
+	Cyclaction* m_a;
+	int m_idx; // cmd index in m_a
+};
+
+// resolves compiled commands lazily, e.g. scripts registered after the CA was compiled
+int GetCmdId(int _section, Cyclaction* _a, int _idx, bool _hardCheck)
+{
+	CA_Instr* instr = _a->GetInstr(_section, _idx);
+	if (!instr->m_cmdId && (instr->m_op==CA_OP_CMD || instr->m_op==CA_OP_MACRO))
+	{
+		KbdSectionInfo* kbdSec = SNM_GetActionSection(_section);
+		if ((instr->m_cmdId = SNM_NamedCommandLookup(_a->GetCmd(_idx), kbdSec)))
+			instr->m_hard = (SNM_NamedCommandLookup(_a->GetCmd(_idx), kbdSec, true) != 0);
+	}
+	return (_hardCheck && !instr->m_hard) ? 0 : instr->m_cmdId;
+}
+
+// flattens the commands of the current cycle step of _a (sub-CAs included)
+// and switches _a (and sub-CAs) to their next cycle step, i.e. the compiled
+// version of ExplodeCyclaction(..., 0x1)
+// returns false if failed
+bool FlattenCycleStep(int _section, Cyclaction* _a, WDL_TypedBuf<CA_Ref>* _cmds, int _depth = 0)
+{
+	int startIdx = _a->GetStepIdx();
+	if (startIdx<0 || _depth>CA_MAX_DEPTH)
+		return false;
+
+	int sz = _a->GetCmdSize();
+	for (int i=startIdx; i<sz; i++)
+	{
+		CA_Instr* instr = _a->GetInstr(_section, i);
+		bool done = false;
+
+		// break on end of list
+		if (i == sz-1)
+		{
+			_a->m_performState = 0;
+			_a->m_fakeToggle = !_a->m_fakeToggle;
+			done = true;
+		}
+		// break on next step
+		else if (instr->m_op == CA_OP_STEP)
+		{
+			_a->m_performState++;
+			_a->m_fakeToggle = !_a->m_fakeToggle;
+			done = true;
+		}
+
+		if (instr->m_op == CA_OP_CA)
+		{
+			Cyclaction* sub = g_cas[_section].Get(instr->m_arg);
+			if (!sub || !FlattenCycleStep(_section, sub, _cmds, _depth+1))
+				return false;
+		}
+		else if (instr->m_op != CA_OP_NONE && instr->m_op != CA_OP_STEP)
+		{
+			CA_Ref ref = { _a, i };
+			_cmds->Add(ref);
+		}
+
+		if (done)
+			break;
+	}
+	return true;
+}
+
+// 1st valid toggle state of the current cycle step of _a, -1 if none, i.e. the
+// compiled version of ExplodeCyclaction(..., 0x2)
+int GetCycleStepToggleState(int _section, Cyclaction* _a, int _depth = 0)
+{
+	switch(_a->IsToggle())
+	{
+		case 1: return _a->m_fakeToggle ? 1 : 0;
+		case 2: break;
+		default: return -1;
+	}
+
+	int startIdx = _a->GetStepIdx();
+	if (startIdx<0 || _depth>CA_MAX_DEPTH)
+		return -1;
+
+	KbdSectionInfo* kbdSec = SNM_GetActionSection(_section);
+	for (int i=startIdx; i<_a->GetCmdSize(); i++)
+	{
+		CA_Instr* instr = _a->GetInstr(_section, i);
+		if (instr->m_op == CA_OP_STEP)
+			break;
+
+		int tgl = -1;
+		if (instr->m_op == CA_OP_CA)
+		{
+			if (Cyclaction* sub = g_cas[_section].Get(instr->m_arg))
+				tgl = GetCycleStepToggleState(_section, sub, _depth+1);
+		}
+		else if (instr->m_op == CA_OP_CMD)
+		{
+			if (int cmdId = GetCmdId(_section, _a, i, false))
+				tgl = GetToggleCommandState2(kbdSec, cmdId);
+		}
+		if (tgl>=0)
+			return tgl;
+	}
+	return -1;
+}
+
 // assumes the CA is valid (e.g. no recursion) + its statements are valid + etc..
 // (faulty CAs must not be registered at this point, see CheckRegisterableCyclaction())
+// commands are compiled (see Cyclaction::Compile()): no string parsing/action lookup here
 void RunCycleAction(COMMAND_T* _ct, int _val, int _valhw, int _relmode, HWND _hwnd)
 {
 	int sec = _ct ? SNM_GetActionSectionIndex(_ct->uniqueSectionId) : -1;
@@ -536,41 +672,44 @@ void RunCycleAction(COMMAND_T* _ct, int _val, int _valhw, int _relmode, HWND _hw
 	for (;;)
 	{
 		// store step or action name *before* m_performState update
-		const char* undoStr = action->GetStepName();
+		WDL_FastString undoStr(action->GetStepName());
 
-		WDL_PtrList_DeleteOnDestroy<WDL_FastString> subCmds;
-		if (ExplodeCyclaction(sec, _ct->id, &subCmds, NULL, NULL, 0x1, action) > 0) // 0x1!
+		WDL_TypedBuf<CA_Ref> subCmds;
+		if (!FlattenCycleStep(sec, action, &subCmds))
+			break;
+
+		int loopCnt = -1;
+		WDL_TypedBuf<CA_Ref> allCmds, loopCmds;
+		const CA_Ref* cmds = subCmds.Get();
+		for (int i=0; i<subCmds.GetSize(); i++)
 		{
-			int loopCnt = -1;
-			WDL_PtrList<WDL_FastString> allCmds, loopCmds;
-			for (int i=0; i<subCmds.GetSize(); i++)
+			CA_Instr* instr = cmds[i].m_a->GetInstr(sec, cmds[i].m_idx);
+			switch (instr->m_op)
 			{
-				const char* cmdStr = subCmds.Get(i) ? subCmds.Get(i)->Get() : "";
-				if (IsCondStatement(cmdStr))
+				case CA_OP_IF:
 				{
-					bool twoConds = IsTwoCondStatement(cmdStr);
+					bool twoConds = (instr->m_arg>=IDX_STATEMENT_IFAND);
 					if ((i + (twoConds?2:1)) < subCmds.GetSize())
 					{
-						bool isON = (!_stricmp(STATEMENT_IF, cmdStr) ||
-							!_stricmp(STATEMENT_IFAND, cmdStr) ||
-							!_stricmp(STATEMENT_IFOR, cmdStr) ||
-							!_stricmp(STATEMENT_IFXOR, cmdStr));
-
-						const char* cmdStrIF = cmdStr;
-						cmdStr = subCmds.Get(++i) ? subCmds.Get(i)->Get() : ""; //++i ! => zap next command
-						int tgl = GetToggleCommandState2(kbdSec, SNM_NamedCommandLookup(cmdStr, kbdSec));
+						bool isON = (instr->m_arg==IDX_STATEMENT_IF ||
+							instr->m_arg==IDX_STATEMENT_IFAND ||
+							instr->m_arg==IDX_STATEMENT_IFOR ||
+							instr->m_arg==IDX_STATEMENT_IFXOR);
+
+						++i; // => zap next command
+						int tgl = GetToggleCommandState2(kbdSec, GetCmdId(sec, cmds[i].m_a, cmds[i].m_idx, false));
 						
 						if (twoConds)
 						{
-							cmdStr = subCmds.Get(++i) ? subCmds.Get(i)->Get() : ""; //++i ! => zap next command
-							int tgl2 = GetToggleCommandState2(kbdSec, SNM_NamedCommandLookup(cmdStr, kbdSec));
+							++i; // => zap next command
+							int tgl2 = GetToggleCommandState2(kbdSec, GetCmdId(sec, cmds[i].m_a, cmds[i].m_idx, false));
 
 							// tgl = overall toggle state value
-							if (!_stricmp(STATEMENT_IFAND, cmdStrIF) || !_stricmp(STATEMENT_IFNAND, cmdStrIF))
+							if (instr->m_arg==IDX_STATEMENT_IFAND || instr->m_arg==IDX_STATEMENT_IFNAND)
 								tgl = (tgl && tgl2) ? 1 : 0;
-							else if (!_stricmp(STATEMENT_IFOR, cmdStrIF) || !_stricmp(STATEMENT_IFNOR, cmdStrIF))
+							else if (instr->m_arg==IDX_STATEMENT_IFOR || instr->m_arg==IDX_STATEMENT_IFNOR)
 								tgl = (tgl || tgl2) ? 1 : 0;
-							else // if (!_stricmp(STATEMENT_IFXOR, cmdStrIF) || !_stricmp(STATEMENT_IFXNOR, cmdStrIF))
+							else // IDX_STATEMENT_IFXOR, IDX_STATEMENT_IFXNOR
 								tgl = (tgl ^ tgl2) ? 1 : 0;
 						}
 
@@ -580,102 +719,115 @@ void RunCycleAction(COMMAND_T* _ct, int _val, int _valhw, int _relmode, HWND _hw
 							{
 								// zap commands until next ELSE or ENDIF
 								while (++i<subCmds.GetSize())
-									if (subCmds.Get(i) && (!_stricmp(STATEMENT_ELSE, subCmds.Get(i)->Get()) || !_stricmp(STATEMENT_ENDIF, subCmds.Get(i)->Get())))
+								{
+									int op = cmds[i].m_a->GetInstr(sec, cmds[i].m_idx)->m_op;
+									if (op==CA_OP_ELSE || op==CA_OP_ENDIF)
 										break;
+								}
 							}
 						}
 						// zap commands until next ENDIF
 						else
 						{
 							while (++i<subCmds.GetSize())
-								if (subCmds.Get(i) && !_stricmp(STATEMENT_ENDIF, subCmds.Get(i)->Get()))
+								if (cmds[i].m_a->GetInstr(sec, cmds[i].m_idx)->m_op == CA_OP_ENDIF)
 									break;
 						}
 					}
 					continue; // zap 
 				}
-				else if (!_stricmp(STATEMENT_ELSE, cmdStr))
-				{
-					// zap commands until next ELSE or ENDIF
+				case CA_OP_ELSE:
+					// zap commands until next ENDIF
 					while (++i<subCmds.GetSize())
-						if (subCmds.Get(i) && !_stricmp(STATEMENT_ENDIF, subCmds.Get(i)->Get()))
+						if (cmds[i].m_a->GetInstr(sec, cmds[i].m_idx)->m_op == CA_OP_ENDIF)
 							break;
 					continue;
-				}
-				else if (!_strnicmp(STATEMENT_LOOP, cmdStr, strlen(STATEMENT_LOOP)))
-				{
-					if (cmdStr[strlen(STATEMENT_LOOP)+1] == 'x' || cmdStr[strlen(STATEMENT_LOOP)+1] == 'X') {
-						loopCnt = PromptForInteger(undoStr, __LOCALIZE("Number of times to repeat","sws_DLG_161"), 0, 4096, false);
+				case CA_OP_LOOP:
+					if (instr->m_arg<0) {
+						loopCnt = PromptForInteger(undoStr.Get(), __LOCALIZE("Number of times to repeat","sws_DLG_161"), 0, 4096, false);
 						loopCnt++; // 0-based => 1-based + ignore the loop if user has cancelled
 					}
 					else
-						loopCnt = atoi((char*)cmdStr+strlen(STATEMENT_LOOP)+1); // +1 for the space char in "LOOP n"
+						loopCnt = instr->m_arg;
 					continue;
-				}
-				else if (!_stricmp(STATEMENT_ENDLOOP, cmdStr))
-				{
+				case CA_OP_ENDLOOP:
 					if (loopCnt>=0)
 					{
 						for (int j=0; j<loopCnt; j++)
 							for (int k=0; k<loopCmds.GetSize(); k++)
-								if (loopCmds.Get(k))
-									allCmds.Add(loopCmds.Get(k));
+								allCmds.Add(loopCmds.Get()[k]);
 
-						loopCmds.Empty(false);
+						loopCmds.Resize(0, false);
 						loopCnt = -1;
 					}
 					continue;
-				}
-				else if (!_stricmp(STATEMENT_ENDIF, cmdStr))
+				case CA_OP_ENDIF:
 					continue;
+			}
+
+			if (loopCnt > 0)
+				loopCmds.Add(cmds[i]);
+			else if (loopCnt == -1)
+				allCmds.Add(cmds[i]);
+		}
 
-				if (*cmdStr)
+		if (allCmds.GetSize())
+		{
+#ifdef _SNM_DEBUG
+			OutputDebugString("RunCycleAction: ");
+			OutputDebugString(undoStr.Get());
+			OutputDebugString(" ---------->");
+			OutputDebugString("\n");
+#endif
+			// resolve everything before performing anything
+			// (a performed command could update CAs, e.g. reload them)
+			WDL_TypedBuf<int> cmdIds;
+			WDL_PtrList_DeleteOnDestroy<WDL_FastString> strCmds;
+			for (int i=0; i<allCmds.GetSize(); i++)
+			{
+				const CA_Ref& ref = allCmds.Get()[i];
+				if (ref.m_a->GetInstr(sec, ref.m_idx)->m_op == CA_OP_STR)
 				{
-					if (loopCnt > 0)
-						loopCmds.Add(subCmds.Get(i));
-					else if (loopCnt == -1)
-						allCmds.Add(subCmds.Get(i));
+					strCmds.Add(new WDL_FastString(ref.m_a->GetCmd(ref.m_idx)));
+					cmdIds.Add(-strCmds.GetSize()); // <0: -1-based index in strCmds
 				}
+				else
+					cmdIds.Add(GetCmdId(sec, ref.m_a, ref.m_idx, true));
 			}
 
-			if (allCmds.GetSize())
-			{
-#ifdef _SNM_DEBUG
-				OutputDebugString("RunCycleAction: ");
-				OutputDebugString(undoStr);
-				OutputDebugString(" ---------->");
-				OutputDebugString("\n");
-#endif
-				if (g_undos)
-					Undo_BeginBlock2(NULL);
+			if (g_undos)
+				Undo_BeginBlock2(NULL);
 
-				PreventUIRefresh(1);
+			PreventUIRefresh(1);
 
-				for (int i=0; i<allCmds.GetSize(); i++)
-					PerformSingleCommand(sec, allCmds.Get(i)->Get(), _val, _valhw, _relmode, _hwnd);
+			for (int i=0; i<cmdIds.GetSize(); i++)
+			{
+				int id = cmdIds.Get()[i];
+				if (id<0) PerformSingleCommand(sec, strCmds.Get(-id-1)->Get(), _val, _valhw, _relmode, _hwnd);
+				else if (id) PerformSingleCommand(sec, id, _val, _valhw, _relmode, _hwnd);
+			}
 
-				PreventUIRefresh(-1);
+			PreventUIRefresh(-1);
 
-				if (g_undos)
-					Undo_EndBlock2(NULL, undoStr, UNDO_STATE_ALL);
+			if (g_undos)
+				Undo_EndBlock2(NULL, undoStr.Get(), UNDO_STATE_ALL);
 
-				RefreshToolbar(0); // not strictly needed, except for toggle states of CAs calling other CAs
+			RefreshToolbar(0); // not strictly needed, except for toggle states of CAs calling other CAs
 #ifdef _SNM_DEBUG
-				OutputDebugString("RunCycleAction <-------------------------");
-				OutputDebugString("\n");
+			OutputDebugString("RunCycleAction <-------------------------");
+			OutputDebugString("\n");
 #endif
+			break;
+		}
+		// (try to) switch to the next action step if nothing has been
+		// performed (avoids to run some CAs once before they sync properly)
+		// note: m_performState is already updated via FlattenCycleStep()
+		else //JFB!! if (action->IsToggle()==2)
+		{
+			// cycled back to the 1st step?
+			if (!action->m_performState)
 				break;
-			}
-			// (try to) switch to the next action step if nothing has been
-			// performed (avoids to run some CAs once before they sync properly)
-			// note: m_performState is already updated via ExplodeCyclaction()
-			else //JFB!! if (action->IsToggle()==2)
-			{
-				// cycled back to the 1st step?
-				if (!action->m_performState)
-					break;
-			}
-		} // if (ExplodeCyclaction())
+		}
 	} // for(;;)
 }
 
@@ -691,7 +843,7 @@ int IsCyclactionEnabled(COMMAND_T* _ct)
 		if (action->IsToggle()==2) // real state?
 		{
 			// no recursion check, etc.. : such faulty cycle actions are not registered
-			int tgl = ExplodeCyclaction(sec, _ct->id, NULL, NULL, NULL, 0x2, action);
+			int tgl = GetCycleStepToggleState(sec, action);
 			if (tgl>=0)
 				return tgl;
 		}
@@ -1149,7 +1301,14 @@ void LoadCyclactions(bool _wantMsg, WDL_PtrList<Cyclaction>* _cyclactions = NULL
 			if (!_cyclactions)
 				for (int j=0; j<g_cas[sec].GetSize(); j++)
 					if (Cyclaction* a = g_cas[sec].Get(j))
+					{
 						a->m_cmdId = RegisterCyclation(a, sec, j+1, &macros, &consoles, _wantMsg ? &msg : NULL); // recursive
+
+						// fake toggle states only change when CAs are performed, i.e. when
+						// all cached toggle states are invalidated anyway
+						if (a->m_cmdId && a->IsToggle()==1)
+							SWSCacheToggleState(a->m_cmdId, SWS_TOGGLE_DIRTY_ALL);
+					}
 		}
 	}
 
@@ -1308,6 +1467,7 @@ void Cyclaction::ReplaceCmd(WDL_FastString* _cmd, bool _wantDelete, WDL_PtrList<
 
 void Cyclaction::UpdateNameAndCmds()
 {
+	m_progSection = -1;
 	m_cmds.EmptySafe(false); // to be deleted by callers (might be used in a list view)
 
 	char actionStr[CA_MAX_LEN] = "";
@@ -1324,6 +1484,7 @@ void Cyclaction::UpdateNameAndCmds()
 
 void Cyclaction::UpdateFromCmd()
 {
+	m_progSection = -1;
 	WDL_FastString newDef;
 	if (int tgl=IsToggle())
 		newDef.SetFormatted(CA_MAX_LEN, "%c", tgl==1?CA_TGL1:CA_TGL2);
@@ -1336,6 +1497,84 @@ void Cyclaction::UpdateFromCmd()
 	m_def.Set(&newDef);
 }
 
+// compiles commands into instructions: statements are parsed, actions are resolved
+// once (rather than each time the CA is performed or its toggle state is polled)
+void Cyclaction::Compile(int _section)
+{
+	KbdSectionInfo* kbdSec = SNM_GetActionSection(_section);
+	m_prog.Resize(GetCmdSize(), false);
+	if (m_prog.GetSize() != GetCmdSize())
+		return;
+
+	CA_Instr* prog = m_prog.Get();
+	for (int i=0; i<GetCmdSize(); i++)
+	{
+		const char* cmd = GetCmd(i);
+		CA_Instr* instr = &prog[i];
+		memset(instr, 0, sizeof(CA_Instr));
+
+		if (!*cmd)
+			instr->m_op = CA_OP_NONE;
+		else if (*cmd == '!')
+			instr->m_op = CA_OP_STEP;
+		else if (*cmd == '_' && strstr(cmd, "_CYCLACTION"))
+		{
+			instr->m_op = CA_OP_CA;
+			instr->m_arg = -1;
+			int cycleId;
+			if (_section == GetCASectionFromCustId(cmd) && GetCAFromCustomId(_section, cmd, &cycleId))
+				instr->m_arg = cycleId-1;
+		}
+		else
+		{
+			int st = IsStatement(cmd);
+			switch (st)
+			{
+				case IDX_STATEMENT_IF:
+				case IDX_STATEMENT_IFNOT:
+				case IDX_STATEMENT_IFAND:
+				case IDX_STATEMENT_IFNAND:
+				case IDX_STATEMENT_IFOR:
+				case IDX_STATEMENT_IFNOR:
+				case IDX_STATEMENT_IFXOR:
+				case IDX_STATEMENT_IFXNOR:
+					instr->m_op = CA_OP_IF;
+					instr->m_arg = st;
+					break;
+				case IDX_STATEMENT_ELSE:
+					instr->m_op = CA_OP_ELSE;
+					break;
+				case IDX_STATEMENT_ENDIF:
+					instr->m_op = CA_OP_ENDIF;
+					break;
+				case IDX_STATEMENT_LOOP:
+				{
+					instr->m_op = CA_OP_LOOP;
+					size_t len = strlen(STATEMENT_LOOP);
+					if (strlen(cmd) > len && (cmd[len+1] == 'x' || cmd[len+1] == 'X'))
+						instr->m_arg = -1; // prompt
+					else
+						instr->m_arg = strlen(cmd) > len ? atoi(cmd+len+1) : 0; // +1 for the space char in "LOOP n"
+					break;
+				}
+				case IDX_STATEMENT_ENDLOOP:
+					instr->m_op = CA_OP_ENDLOOP;
+					break;
+				case IDX_STATEMENT_CONSOLE:
+				case IDX_STATEMENT_LABEL:
+					instr->m_op = CA_OP_STR;
+					break;
+				default:
+					instr->m_op = (*cmd == '_' && (strstr(cmd, "_SWSCONSOLE_CUST") || IsMacroOrScript(cmd, false))) ? CA_OP_MACRO : CA_OP_CMD;
+					if (kbdSec && (instr->m_cmdId = SNM_NamedCommandLookup(cmd, kbdSec)))
+						instr->m_hard = (SNM_NamedCommandLookup(cmd, kbdSec, true) != 0);
+					break;
+			}
+		}
+	}
+	m_progSection = _section;
+}
+
 int Cyclaction::GetIndent(WDL_FastString* _cmd)
 {
 	int indent=0;
@@ -2687,6 +2926,8 @@ static bool ProcessExtensionLine(const char *line, ProjectStateContext *ctx, boo
 							{
 								a->m_performState = state;
 								a->m_fakeToggle = !a->m_fakeToggle;
+								if (a->IsToggle()==1)
+									SWSCacheToggleState(a->m_cmdId, SWS_TOGGLE_DIRTY_ALL); // invalidates the cached state
 								RefreshToolbar(a->m_cmdId);
 							}
 						}
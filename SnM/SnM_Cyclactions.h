@@ -47,12 +47,22 @@ static const char s_CA_TGL1_STR[] = { CA_TGL1, '\0' };
 static const char s_CA_TGL2_STR[] = { CA_TGL2, '\0' };
 
 
+// compiled command, see Cyclaction::Compile()
+struct CA_Instr
+{
+	int m_op;     // CA_OP_*
+	int m_cmdId;  // resolved command id, 0 if not resolved (yet)
+	bool m_hard;  // m_cmdId passes SNM_NamedCommandLookup()'s hard check
+	int m_arg;    // statement params (loop count, etc..) or sub-CA index
+};
+
+
 class Cyclaction
 {
 public:
 	// constructors assume their params are valid
-	Cyclaction(const char* _def=CA_EMPTY, bool _added=false) : m_def(_def), m_performState(0), m_fakeToggle(false), m_cmdId(0), m_added(_added) { UpdateNameAndCmds(); }
-	Cyclaction(Cyclaction* _a) : m_def(_a->m_def), m_performState(_a->m_performState), m_fakeToggle(_a->m_fakeToggle), m_cmdId(_a->m_cmdId), m_added(_a->m_added) { UpdateNameAndCmds(); }
+	Cyclaction(const char* _def=CA_EMPTY, bool _added=false) : m_def(_def), m_performState(0), m_fakeToggle(false), m_cmdId(0), m_added(_added), m_progSection(-1) { UpdateNameAndCmds(); }
+	Cyclaction(Cyclaction* _a) : m_def(_a->m_def), m_performState(_a->m_performState), m_fakeToggle(_a->m_fakeToggle), m_cmdId(_a->m_cmdId), m_added(_a->m_added), m_progSection(-1) { UpdateNameAndCmds(); }
 	~Cyclaction() {}
 	const char* GetDefinition() { return m_def.Get(); }
 	void Update(const char* _def) { m_def.Set(_def); UpdateNameAndCmds(); }
@@ -74,6 +84,7 @@ public:
 	WDL_FastString* GetCmdString(int _i) { return m_cmds.Get(_i); }
 	int FindCmd(WDL_FastString* _cmd) { return m_cmds.Find(_cmd); }
 	int GetIndent(WDL_FastString* _cmd);
+	CA_Instr* GetInstr(int _section, int _i) { if (m_progSection!=_section) Compile(_section); return m_prog.Get()+_i; } // _i: cmd index
 
 	int m_performState;
 	bool m_added; // CA added by the user, not yet registered
@@ -83,10 +94,13 @@ public:
 private:
 	void UpdateNameAndCmds();
 	void UpdateFromCmd();
+	void Compile(int _section);
 
 	WDL_FastString m_def;
 	WDL_FastString m_name;
 	WDL_PtrList_DeleteOnDestroy<WDL_FastString> m_cmds;
+	WDL_TypedBuf<CA_Instr> m_prog; // 1 instruction per cmd, valid for m_progSection (-1: not compiled)
+	int m_progSection;
 };
 
 
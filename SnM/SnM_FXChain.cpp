@@ -41,6 +41,390 @@
 WDL_FastString g_fXChainClipboard;
 
 
+///////////////////////////////////////////////////////////////////////////////
+// FX chain apply engine
+// FX are matched by state hash: the whole FX block (plugin line, state, 
+// parameters, etc..) excluding bypass/offline flags, FLOAT/FLOATPOS and FXID.
+// Matching FX are kept and reordered with TrackFX/TakeFX_CopyToXXX(), flags
+// are set via the API, unmatched FX are deleted and the missing ones are
+// instantiated in a temporary track (same FX state chunks), then moved.
+// Chains which cannot be split safely fall back to the chunk patchers.
+// Stats can be logged to the console with [FXChains]/LogStats=1 in S&M.ini
+///////////////////////////////////////////////////////////////////////////////
+
+SNM_FXChainEngine::SNM_FXChainEngine()
+	: m_targets(0), m_kept(0), m_instantiated(0), m_removed(0), m_moved(0), m_flags(0), m_chunkSets(0), m_tempTr(NULL)
+{
+	m_t0 = time_precise();
+	PreventUIRefresh(1);
+}
+
+SNM_FXChainEngine::~SNM_FXChainEngine()
+{
+	if (m_tempTr)
+		DeleteTrack(m_tempTr);
+	PreventUIRefresh(-1);
+
+	if (m_targets && g_SNM_FXChainLogStats)
+	{
+		char msg[256];
+		snprintf(msg, sizeof(msg), "S&M FX chains: %d targets, %d FX kept, %d instantiated, %d removed, %d moved, %d bypass/offline changes, %d chunk fallbacks (%.2f ms)\n",
+			m_targets, m_kept, m_instantiated, m_removed, m_moved, m_flags, m_chunkSets, (time_precise()-m_t0)*1000.0);
+		ShowConsoleMsg(msg);
+	}
+}
+
+// splits an FX chain into FX blocks, i.e. from a "BYPASS" line up to the next one
+// _subChunk: true if _chain is a "<FXCHAIN", "<FXCHAIN_REC" or "<TAKEFX" sub-chunk
+//            (header lines are skipped), false for .RfxChain-like chains
+// returns false if the chain cannot be split safely (FX w/o BYPASS line, extra data, etc..)
+// note: one FX per block is not checked here, FX counts are checked by callers
+bool SNM_FXChainEngine::ParseChain(const char* _chain, bool _subChunk, WDL_TypedBuf<FX>* _fx)
+{
+	_fx->Resize(0, false);
+	int depth = 0;
+	bool header = _subChunk;
+	const char* p = _chain;
+	while (*p)
+	{
+		const char* eol = strchr(p, '\n');
+		const char* next = eol ? eol+1 : p+strlen(p);
+		const char* l = p;
+		int len = (int)((eol ? eol : next) - p);
+		while (len && (*l==' ' || *l=='\t')) { l++; len--; }
+		while (len && (l[len-1]=='\r' || l[len-1]==' ' || l[len-1]=='\t')) len--;
+
+		FX* fx = _fx->GetSize() ? _fx->Get()+_fx->GetSize()-1 : NULL;
+		if (!len || (!depth && *l=='#')) {} // empty line, comment (e.g. "#NCHAN 2")
+		else if (header) // "<FXCHAIN" line
+			header = false;
+		else if (!depth && *l=='>')
+		{
+			if (_subChunk) break; // end of the FX chain
+			return false; // e.g. take FX chain + TAKEFX_NCH
+		}
+		else if (!depth && !strncmp(l, "BYPASS", 6) && (len==6 || l[6]==' '))
+		{
+			if (fx) fx->m_len = (int)(p-_chain) - fx->m_pos;
+			FX newFX;
+			newFX.m_pos = (int)(p-_chain);
+			newFX.m_len = 0;
+			newFX.m_match = -1;
+
+			// bypass and offline flags are ignored by the hash, other tokens are not
+			char* tok = (char*)l+6;
+			newFX.m_bypass = strtol(tok, &tok, 10);
+			newFX.m_offline = strtol(tok, &tok, 10);
+			if (tok > l+len) tok = (char*)l+len;
+			newFX.m_hash = FNV64(FNV64_IV, (const unsigned char*)tok, len-(int)(tok-l));
+			_fx->Add(newFX);
+		}
+		else if (!fx)
+		{
+			// only chain window states are tolerated before the 1st FX
+			if (*l=='<' || (strncmp(l, "WNDRECT", 7) && strncmp(l, "SHOW", 4) && strncmp(l, "LASTSEL", 7) && strncmp(l, "DOCKED", 6)))
+				return false;
+		}
+		else
+		{
+			if (*l == '<') depth++;
+			else if (*l == '>') depth--;
+			if (depth || (strncmp(l, "FLOAT", 5) && strncmp(l, "FXID", 4))) // FLOAT or FLOATPOS
+			{
+				fx->m_hash = FNV64(fx->m_hash, (const unsigned char*)l, len);
+				fx->m_hash = FNV64(fx->m_hash, (const unsigned char*)"\n", 1);
+			}
+		}
+		p = next;
+	}
+	if (depth)
+		return false;
+	if (_fx->GetSize())
+		_fx->Get()[_fx->GetSize()-1].m_len = (int)(p-_chain) - _fx->Get()[_fx->GetSize()-1].m_pos;
+	return true;
+}
+
+int SNM_FXChainEngine::CountFX(MediaTrack* _tr, MediaItem_Take* _tk, int _flag)
+{
+	if (_tk) return TakeFX_GetCount(_tk);
+	return _flag ? TrackFX_GetRecCount(_tr) : TrackFX_GetCount(_tr);
+}
+
+// instantiates the unmatched FX of _fx in the temporary track, in order
+bool SNM_FXChainEngine::Instantiate(const char* _chain, WDL_TypedBuf<FX>* _fx, int _count)
+{
+	if (!m_tempTr)
+	{
+		const int idx = GetNumTracks();
+		InsertTrackAtIndex(idx, false);
+		m_tempTr = GetTrack(NULL, idx);
+		if (!m_tempTr)
+			return false;
+	}
+
+	WDL_FastString chunk("<TRACK\n<FXCHAIN\nSHOW 0\nLASTSEL 0\nDOCKED 0\n");
+	for (int i=0; i<_fx->GetSize(); i++)
+	{
+		FX* fx = _fx->Get()+i;
+		if (fx->m_match < 0)
+		{
+			chunk.Append(_chain+fx->m_pos, fx->m_len);
+			if (fx->m_len && _chain[fx->m_pos+fx->m_len-1] != '\n')
+				chunk.Append("\n");
+		}
+	}
+	chunk.Append(">\n>\n");
+	return (SetTrackStateChunk(m_tempTr, chunk.Get(), false) && TrackFX_GetCount(m_tempTr) == _count);
+}
+
+// _curChain: current FX chain sub-chunk, only needed to replace a chain (i.e. !_paste)
+// returns -1 if _chain cannot be applied natively (nothing done), 0 if nothing changed, 1 otherwise
+int SNM_FXChainEngine::Apply(MediaTrack* _tr, MediaItem_Take* _tk, int _flag, const char* _curChain, WDL_FastString* _chain, bool _paste)
+{
+	WDL_TypedBuf<FX> cur, want;
+	if (_chain && !ParseChain(_chain->Get(), false, &want))
+		return -1;
+
+	// plan
+	const int curCnt = CountFX(_tr, _tk, _flag);
+	int newCnt = want.GetSize();
+	if (!_paste && curCnt && newCnt)
+	{
+		if (!_curChain || !ParseChain(_curChain, true, &cur) || cur.GetSize() != curCnt)
+			return -1;
+		for (int i=0; i<want.GetSize(); i++)
+			for (int j=0; j<cur.GetSize(); j++)
+				if (cur.Get()[j].m_match<0 && cur.Get()[j].m_hash==want.Get()[i].m_hash)
+				{
+					cur.Get()[j].m_match = i;
+					want.Get()[i].m_match = j;
+					newCnt--;
+					break;
+				}
+	}
+
+	// nothing touched until there: instantiation first
+	if (newCnt && !Instantiate(_chain->Get(), &want, newCnt))
+		return -1;
+
+	m_targets++;
+	bool updated = false;
+
+	// delete unmatched FX, last first
+	WDL_TypedBuf<int> live; // current FX chain (cur indexes, -1 for new FX)
+	if (_paste)
+		m_kept += curCnt;
+	else
+	{
+		for (int i=curCnt-1; i>=0; i--)
+		{
+			if (cur.GetSize() && cur.Get()[i].m_match>=0)
+				continue;
+			if (_tk) TakeFX_Delete(_tk, i);
+			else TrackFX_Delete(_tr, i|_flag);
+			m_removed++;
+			updated = true;
+		}
+		for (int i=0; i<cur.GetSize(); i++)
+			if (cur.Get()[i].m_match>=0)
+				live.Add(i);
+	}
+
+	// move kept FX, insert new ones
+	const int base = _paste ? curCnt : 0;
+	for (int i=0; i<want.GetSize(); i++)
+	{
+		FX* w = want.Get()+i;
+		const int dest = base+i;
+		if (w->m_match >= 0)
+		{
+			int pos = i;
+			while (pos<live.GetSize() && live.Get()[pos]!=w->m_match) pos++;
+			if (pos != i)
+			{
+				if (_tk) TakeFX_CopyToTake(_tk, base+pos, _tk, dest, true);
+				else TrackFX_CopyToTrack(_tr, (base+pos)|_flag, _tr, dest|_flag, true);
+				live.Delete(pos);
+				live.Insert(w->m_match, i);
+				m_moved++;
+				updated = true;
+			}
+			m_kept++;
+
+			FX* c = cur.Get()+w->m_match;
+			if (c->m_bypass != w->m_bypass)
+			{
+				if (_tk) TakeFX_SetEnabled(_tk, dest, !w->m_bypass);
+				else TrackFX_SetEnabled(_tr, dest|_flag, !w->m_bypass);
+				m_flags++;
+				updated = true;
+			}
+			if (c->m_offline != w->m_offline)
+			{
+				if (_tk) TakeFX_SetOffline(_tk, dest, !!w->m_offline);
+				else TrackFX_SetOffline(_tr, dest|_flag, !!w->m_offline);
+				m_flags++;
+				updated = true;
+			}
+		}
+		else
+		{
+			if (_tk) TrackFX_CopyToTake(m_tempTr, 0, _tk, dest, true);
+			else TrackFX_CopyToTrack(m_tempTr, 0, _tr, dest|_flag, true);
+			live.Insert(-1, i);
+			m_instantiated++;
+			updated = true;
+		}
+	}
+	return updated ? 1 : 0;
+}
+
+// _chain: NULL clears the FX chain (replace mode only)
+// _paste: false to replace the FX chain, true to insert _chain at the end of it
+// returns true if the track has been updated
+bool SNM_FXChainEngine::ApplyTrack(MediaTrack* _tr, WDL_FastString* _chain, bool _inputFX, bool _paste)
+{
+	if (!_tr || (_paste && (!_chain || !_chain->GetLength())))
+		return false;
+
+	const int flag = _inputFX ? 0x1000000 : 0;
+	WDL_FastString curChain;
+	if (!_paste && _chain && CountFX(_tr, NULL, flag))
+	{
+		SNM_ChunkParserPatcher p(_tr, false);
+		p.GetSubChunk(_inputFX ? "FXCHAIN_REC" : "FXCHAIN", 2, 0, &curChain, "<ITEM");
+	}
+
+	int res = Apply(_tr, NULL, flag, curChain.Get(), _chain, _paste);
+	if (res >= 0)
+		return (res > 0);
+
+	// chunk fallback
+	m_targets++;
+	m_chunkSets++;
+	SNM_FXChainTrackPatcher p(_tr);
+	if (_paste)
+	{
+		WDL_FastString currentFXChain;
+		int pos = p.GetSubChunk(_inputFX ? "FXCHAIN_REC" : "FXCHAIN", 2, 0, &currentFXChain, "<ITEM");
+
+		// paste (well.. insert at the end of the current FX chain)
+		if (pos >= 0) 
+		{
+			p.GetChunk()->Insert(_chain->Get(), pos + currentFXChain.GetLength() - 2); // -2: before ">\n"
+			p.IncUpdates();
+			return true;
+		}
+	}
+	// create/replace fx chain
+	return p.SetFXChain(_chain, _inputFX);
+}
+
+bool SNM_FXChainEngine::PasteTakeChunk(MediaItem* _item, int _tkIdx, WDL_FastString* _chain)
+{
+	SNM_TakeParserPatcher p(_item, CountTakes(_item));
+	WDL_FastString takeChunk;
+	int tkPos, tklen;
+	if (!p.GetTakeChunk(_tkIdx, &takeChunk, &tkPos, &tklen))
+		return false;
+
+	SNM_ChunkParserPatcher ptk(&takeChunk, false);
+
+	// fx chain exists for this take?
+	// note: eolTakeFx is '\n' position + 1
+	int eolTkFx = ptk.Parse(SNM_GET_SUBCHUNK_OR_LINE_EOL, 1, "TAKEFX", "<TAKEFX", 0);
+
+	// paste fx chain (just before the end of the current TAKEFX)
+	if (eolTkFx > 0) {
+		ptk.GetChunk()->Insert(_chain->Get(), eolTkFx-2); //-2: before ">\n"
+	}
+	// set/create fx chain (after SOURCE)
+	else 
+	{
+		int eolSrc = ptk.Parse(SNM_GET_SUBCHUNK_OR_LINE_EOL, 1, "SOURCE", "<SOURCE", 0);
+		if (eolSrc > 0) {
+			WDL_FastString newTakeFx;
+			MakeChunkTakeFX(&newTakeFx, _chain);
+			ptk.GetChunk()->Insert(newTakeFx.Get(), eolSrc);
+		}
+	}
+	return p.ReplaceTake(tkPos, tklen, ptk.GetChunk());
+}
+
+// _chain: NULL clears the take's FX chain
+bool SNM_FXChainEngine::SetTakeChunk(MediaItem* _item, int _tkIdx, WDL_FastString* _chain)
+{
+	SNM_TakeParserPatcher p(_item, CountTakes(_item));
+	WDL_FastString takeChunk;
+	int tkPos, tklen;
+	if (!p.GetTakeChunk(_tkIdx, &takeChunk, &tkPos, &tklen))
+		return false;
+
+	SNM_ChunkParserPatcher ptk(&takeChunk, false);
+	bool updated = ptk.RemoveSubChunk("TAKEFX", 1, 0);
+
+	// set fx chain (after SOURCE)
+	if (_chain && _chain->GetLength())
+	{
+		int eolSrc = ptk.Parse(SNM_GET_SUBCHUNK_OR_LINE_EOL, 1, "SOURCE", "<SOURCE", 0);
+		if (eolSrc > 0) {
+			WDL_FastString newTakeFx;
+			MakeChunkTakeFX(&newTakeFx, _chain);
+			ptk.GetChunk()->Insert(newTakeFx.Get(), eolSrc);
+			updated = true;
+		}
+	}
+	return updated && p.ReplaceTake(tkPos, tklen, ptk.GetChunk());
+}
+
+// applies _chain to the active take or to all takes of _item
+// _chain: NULL clears the FX chain(s) (replace mode only)
+// returns true if the item has been updated
+bool SNM_FXChainEngine::ApplyItem(MediaItem* _item, WDL_FastString* _chain, bool _activeOnly, bool _paste)
+{
+	if (!_item || (_paste && (!_chain || !_chain->GetLength())))
+		return false;
+
+	bool updated = false;
+	SNM_TakeParserPatcher* p = NULL; // lazy init, current take chunks
+	const int nbTakes = CountTakes(_item);
+	const int first = _activeOnly ? *(int*)GetSetMediaItemInfo(_item, "I_CURTAKE", NULL) : 0;
+	const int last = _activeOnly ? first : nbTakes-1;
+	for (int i=first; i<=last; i++)
+	{
+		int res = -1;
+		if (MediaItem_Take* tk = GetMediaItemTake(_item, i))
+		{
+			WDL_FastString curChain;
+			if (!_paste && _chain && CountFX(NULL, tk, 0))
+			{
+				WDL_FastString takeChunk;
+				if (!p) p = new SNM_TakeParserPatcher(_item, nbTakes);
+				if (p->GetTakeChunk(i, &takeChunk))
+				{
+					SNM_ChunkParserPatcher ptk(&takeChunk, false);
+					ptk.GetSubChunk("TAKEFX", 1, 0, &curChain);
+				}
+			}
+			res = Apply(NULL, tk, 0, curChain.Get(), _chain, _paste);
+		}
+
+		if (res >= 0)
+			updated |= (res > 0);
+		else
+		{
+			m_targets++;
+			m_chunkSets++;
+			// chunk fallback, only for this take (the other ones may have been applied natively)
+			if (_paste) updated |= PasteTakeChunk(_item, i, _chain);
+			else updated |= SetTakeChunk(_item, i, _chain);
+		}
+	}
+	delete p;
+	return updated;
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // Take FX chains
 ///////////////////////////////////////////////////////////////////////////////
@@ -101,53 +485,11 @@ void PasteTakeFXChain(const char* _title, WDL_FastString* _chain, bool _activeOn
 	bool updated = false;
 	if (_chain && _chain->GetLength())
 	{
-		for (int i = 1; i <= GetNumTracks(); i++) // skip master
-		{
-			MediaTrack* tr = CSurf_TrackFromID(i, false);
-			for (int j = 0; tr && j < GetTrackNumMediaItems(tr); j++)
-			{
-				MediaItem* item = GetTrackMediaItem(tr,j);
-				if (item && *(bool*)GetSetMediaItemInfo(item,"B_UISEL",NULL))
-				{
-					SNM_TakeParserPatcher p(item, CountTakes(item));
-					int tkIdx = (_activeOnly ? *(int*)GetSetMediaItemInfo(item, "I_CURTAKE", NULL) : 0);
-					bool done = false;
-					while (!done && tkIdx >= 0)
-					{
-						WDL_FastString takeChunk;
-						int tkPos, tklen;
-						if (p.GetTakeChunk(tkIdx, &takeChunk, &tkPos, &tklen)) 
-						{
-							SNM_ChunkParserPatcher ptk(&takeChunk, false);
-
-							// fx chain exists for this take?
-							// note: eolTakeFx is '\n' position + 1
-							int eolTkFx = ptk.Parse(SNM_GET_SUBCHUNK_OR_LINE_EOL, 1, "TAKEFX", "<TAKEFX", 0);
-
-							// paste fx chain (just before the end of the current TAKEFX)
-							if (eolTkFx > 0) {
-								ptk.GetChunk()->Insert(_chain->Get(), eolTkFx-2); //-2: before ">\n"
-							}
-							// set/create fx chain (after SOURCE)
-							else 
-							{
-								int eolSrc = ptk.Parse(SNM_GET_SUBCHUNK_OR_LINE_EOL, 1, "SOURCE", "<SOURCE", 0);
-								if (eolSrc > 0) {
-									WDL_FastString newTakeFx;
-									MakeChunkTakeFX(&newTakeFx, _chain);
-									ptk.GetChunk()->Insert(newTakeFx.Get(), eolSrc);
-								}
-							}
-							updated = p.ReplaceTake(tkPos, tklen, ptk.GetChunk());
-						}
-						else done = true;
-
-						if (_activeOnly) done = true;
-						else tkIdx++;
-					}
-				}
-			}
-		}
+		WDL_PtrList<MediaItem> items;
+		SNM_GetSelectedItems(NULL, &items);
+		SNM_FXChainEngine engine;
+		for (int i=0; i < items.GetSize(); i++)
+			updated |= engine.ApplyItem(items.Get(i), _chain, _activeOnly, true);
 	}
 	if (updated)
 		Undo_OnStateChangeEx2(NULL, _title, UNDO_STATE_ALL, -1);
@@ -157,18 +499,12 @@ void PasteTakeFXChain(const char* _title, WDL_FastString* _chain, bool _activeOn
 void SetTakeFXChain(const char* _title, WDL_FastString* _chain, bool _activeOnly)
 {
 	bool updated = false;
-	for (int i = 1; i <= GetNumTracks(); i++) // skip master
 	{
-		MediaTrack* tr = CSurf_TrackFromID(i, false);
-		for (int j = 0; tr && j < GetTrackNumMediaItems(tr); j++)
-		{
-			MediaItem* item = GetTrackMediaItem(tr,j);
-			if (item && *(bool*)GetSetMediaItemInfo(item,"B_UISEL",NULL))
-			{
-				SNM_FXChainTakePatcher p(item);
-				updated |= p.SetFXChain(_chain, _activeOnly);
-			}
-		}
+		WDL_PtrList<MediaItem> items;
+		SNM_GetSelectedItems(NULL, &items);
+		SNM_FXChainEngine engine;
+		for (int i=0; i < items.GetSize(); i++)
+			updated |= engine.ApplyItem(items.Get(i), _chain, _activeOnly, false);
 	}
 	if (updated)
 		Undo_OnStateChangeEx2(NULL, _title, UNDO_STATE_ALL, -1);
@@ -200,38 +536,30 @@ bool SetTrackChannelsForFXChain(MediaTrack* _tr, WDL_FastString* _chain)
 	return false;
 }
 
+// selected tracks incl. master (collected first: the FX chain engine may add a temp track)
+static void GetSelectedTracksWithMaster(WDL_PtrList<MediaTrack>* _trs)
+{
+	for (int i=0; i <= GetNumTracks(); i++)
+	{
+		MediaTrack* tr = CSurf_TrackFromID(i, false);
+		if (tr && *(int*)GetSetMediaTrackInfo(tr, "I_SELECTED", NULL))
+			_trs->Add(tr);
+	}
+}
+
 void PasteTrackFXChain(const char* _title, WDL_FastString* _chain, bool _inputFX)
 {
 	bool updated = false;
 	if (_chain && _chain->GetLength())
 	{
-		for (int i=0; i <= GetNumTracks(); i++) // incl. master
+		WDL_PtrList<MediaTrack> trs;
+		GetSelectedTracksWithMaster(&trs);
+		SNM_FXChainEngine engine;
+		for (int i=0; i < trs.GetSize(); i++)
 		{
-			MediaTrack* tr = CSurf_TrackFromID(i, false);
-			if (tr && *(int*)GetSetMediaTrackInfo(tr, "I_SELECTED", NULL))
-			{
-				// (try to) set track channels
-				updated |= SetTrackChannelsForFXChain(tr, _chain);
-
-				// the meat
-				bool patch = false;
-				SNM_FXChainTrackPatcher p(tr);
-				WDL_FastString currentFXChain;
-				int pos = p.GetSubChunk(_inputFX ? "FXCHAIN_REC" : "FXCHAIN", 2, 0, &currentFXChain, "<ITEM");
-
-				// paste (well.. insert at the end of the current FX chain)
-				if (pos >= 0) 
-				{
-					patch = true;
-					p.GetChunk()->Insert(_chain->Get(), pos + currentFXChain.GetLength() - 2); // -2: before ">\n"
-					p.IncUpdates();
-				}
-				// create fx chain
-				else 
-					patch = p.SetFXChain(_chain, _inputFX);
-
-				updated |= patch;
-			}
+			// (try to) set track channels
+			updated |= SetTrackChannelsForFXChain(trs.Get(i), _chain);
+			updated |= engine.ApplyTrack(trs.Get(i), _chain, _inputFX, true);
 		}
 	}
 	if (updated)
@@ -242,18 +570,15 @@ void PasteTrackFXChain(const char* _title, WDL_FastString* _chain, bool _inputFX
 void SetTrackFXChain(const char* _title, WDL_FastString* _chain, bool _inputFX)
 {
 	bool updated = false;
-	for (int i=0; i <= GetNumTracks(); i++) // incl. master
 	{
-		MediaTrack* tr = CSurf_TrackFromID(i, false);
-		if (tr && *(int*)GetSetMediaTrackInfo(tr, "I_SELECTED", NULL))
+		WDL_PtrList<MediaTrack> trs;
+		GetSelectedTracksWithMaster(&trs);
+		SNM_FXChainEngine engine;
+		for (int i=0; i < trs.GetSize(); i++)
 		{
 			// (try to) set track channels
-			updated |= SetTrackChannelsForFXChain(tr, _chain);
-
-			// the meat
-			SNM_FXChainTrackPatcher p(tr);
-			bool patch = p.SetFXChain(_chain, _inputFX);
-			updated |= patch;
+			updated |= SetTrackChannelsForFXChain(trs.Get(i), _chain);
+			updated |= engine.ApplyTrack(trs.Get(i), _chain, _inputFX, false);
 		}
 	}
 	if (updated)
@@ -31,6 +31,37 @@
 #define _SNM_FXCHAIN_H_
 
 
+// applies FX chains through the FX API rather than by rewriting chunks: FX
+// already in place with the same state are kept (and moved if needed), other
+// ones are removed or instantiated via a temporary track
+// no undo point (up to the caller), one instance can be used for a batch
+class SNM_FXChainEngine
+{
+public:
+	SNM_FXChainEngine();
+	~SNM_FXChainEngine();
+	bool ApplyTrack(MediaTrack* _tr, WDL_FastString* _chain, bool _inputFX, bool _paste);
+	bool ApplyItem(MediaItem* _item, WDL_FastString* _chain, bool _activeOnly, bool _paste);
+	int m_targets, m_kept, m_instantiated, m_removed, m_moved, m_flags, m_chunkSets;
+private:
+	struct FX {
+		WDL_UINT64 m_hash; // state hash, excl. bypass/offline and UI stuff
+		int m_pos, m_len;  // block in the parsed chain
+		int m_bypass, m_offline;
+		int m_match;       // matching FX in the other chain, -1 if none
+	};
+	static bool ParseChain(const char* _chain, bool _subChunk, WDL_TypedBuf<FX>* _fx);
+	static int CountFX(MediaTrack* _tr, MediaItem_Take* _tk, int _flag);
+	int Apply(MediaTrack* _tr, MediaItem_Take* _tk, int _flag, const char* _curChain, WDL_FastString* _chain, bool _paste);
+	bool Instantiate(const char* _chain, WDL_TypedBuf<FX>* _fx, int _count);
+	bool PasteTakeChunk(MediaItem* _item, int _tkIdx, WDL_FastString* _chain);
+	bool SetTakeChunk(MediaItem* _item, int _tkIdx, WDL_FastString* _chain);
+
+	MediaTrack* m_tempTr;
+	double m_t0;
+};
+
+
 void MakeChunkTakeFX(WDL_FastString* _outTakeFX, const WDL_FastString* _inRfxChain);
 int CopyTakeFXChain(WDL_FastString* _fxChain, int _startSelItem=0);
 void PasteTakeFXChain(const char* _title, WDL_FastString* _chain, bool _activeOnly);
@@ -36,9 +36,31 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 DWORD g_mkrRgnNotifyTime = 0; // really approx (updated on timer)
-WDL_PtrList<MarkerRegion> g_mkrRgnCache;
+WDL_PtrList<MarkerRegion> g_mkrRgnCache; // snapshot, same order as EnumProjectMarkers3()
+std::multimap<int,MarkerRegion*> g_mkrRgnCacheIds; // same snapshot by id (duplicate ids are possible)
+SNM_MarkerRegionDiff g_mkrRgnDiff;
 WDL_PtrList<SNM_MarkerRegionListener> g_mkrRgnListeners;
 
+bool SNM_MarkerRegionDiff::Contains(int _id) const
+{
+	const WDL_TypedBuf<int>* ids[] = { &m_added, &m_removed, &m_changed };
+	for (int i=0; i<3; i++)
+		for (int j=0; j<ids[i]->GetSize(); j++)
+			if (ids[i]->Get()[j] == _id)
+				return true;
+	return false;
+}
+
+const SNM_MarkerRegionDiff* GetMarkerRegionDiff() {
+	return &g_mkrRgnDiff;
+}
+
+MarkerRegion* GetMarkerRegionSnapshot(int _id)
+{
+	std::multimap<int,MarkerRegion*>::iterator it = g_mkrRgnCacheIds.lower_bound(_id);
+	return (it!=g_mkrRgnCacheIds.end() && it->first==_id) ? it->second : NULL;
+}
+
 void RegisterToMarkerRegionUpdates(SNM_MarkerRegionListener* _listener)
 {
 	if (_listener && g_mkrRgnListeners.Find(_listener) < 0)
@@ -52,48 +74,128 @@ void UnregisterToMarkerRegionUpdates(SNM_MarkerRegionListener* _listener)
 		g_mkrRgnListeners.Delete(idx, false);
 }
 
+// formatted times depend on the project time mode/offset and on the tempo map
+// note: the tempo map is only re-checked when the project state changes
+static bool UpdateTimeStringsState()
+{
+	static int sPrevTimemode = *ConfigVar<int>("projtimemode");
+	static double sPrevTimeOffs = 0.0;
+	static ReaProject* sPrevProj = NULL;
+	static int sPrevStateCount = -1;
+	static WDL_TypedBuf<double> sPrevTempoMap;
+
+	bool updated = false;
+	if (const ConfigVar<int> timemode = "projtimemode")
+		if (*timemode != sPrevTimemode) {
+			sPrevTimemode = *timemode;
+			updated = true;
+		}
+	if (const ConfigVar<double> timeoffs = "projtimeoffs")
+		if (*timeoffs != sPrevTimeOffs) {
+			sPrevTimeOffs = *timeoffs;
+			updated = true;
+		}
+
+	ReaProject* proj = EnumProjects(-1, NULL, 0);
+	int stateCount = GetProjectStateChangeCount(proj);
+	if (proj != sPrevProj || stateCount != sPrevStateCount)
+	{
+		sPrevProj = proj;
+		sPrevStateCount = stateCount;
+
+		int nbPts = CountTempoTimeSigMarkers(proj);
+		WDL_TypedBuf<double> tempoMap;
+		double* pts = tempoMap.Resize(nbPts*5, false);
+		for (int i=0; i<nbPts; i++, pts+=5)
+		{
+			int num, denom; bool linear;
+			GetTempoTimeSigMarker(proj, i, &pts[0], NULL, NULL, &pts[1], &num, &denom, &linear);
+			pts[2] = num;
+			pts[3] = denom;
+			pts[4] = linear ? 1.0 : 0.0;
+		}
+		if (tempoMap.GetSize() != sPrevTempoMap.GetSize() || 
+			memcmp(tempoMap.Get(), sPrevTempoMap.Get(), tempoMap.GetSize()*sizeof(double)))
+		{
+			sPrevTempoMap.Resize(tempoMap.GetSize(), false);
+			memcpy(sPrevTempoMap.Get(), tempoMap.Get(), tempoMap.GetSize()*sizeof(double));
+			updated = true;
+		}
+	}
+
+	if (updated)
+		MarkerItem::InvalidateTimeStrings();
+	return updated;
+}
+
+// diff the project markers/regions against the snapshot, items are matched by id
+// so that insertions/deletions do not invalidate the following ones
 // return a bitmask: &SNM_MARKER_MASK: marker update, &SNM_REGION_MASK: region update
+// (details in g_mkrRgnDiff)
 int UpdateMarkerRegionCache()
 {
+	g_mkrRgnDiff.Clear();
+
 	int updateFlags=0;
-	int i=0, x=0, num, col; double pos, rgnend; const char* name; bool isRgn;
+	int x=0, num, col; double pos, rgnend; const char* name; bool isRgn;
+
+	std::multimap<int,MarkerRegion*> prevIds;
+	prevIds.swap(g_mkrRgnCacheIds);
+	g_mkrRgnCache.Empty(false);
 
 	// added/updated markers/regions?
 	while ((x = EnumProjectMarkers3(NULL, x, &isRgn, &pos, &rgnend, &name, &num, &col)))
 	{
-		MarkerRegion* m = g_mkrRgnCache.Get(i);
-		if (!m || (m && !m->Compare(isRgn, pos, rgnend, name, num, col)))
+		int id = MakeMarkerRegionId(num, isRgn);
+		MarkerRegion* m = NULL;
+		std::multimap<int,MarkerRegion*>::iterator it = prevIds.lower_bound(id);
+		if (it!=prevIds.end() && it->first==id)
+		{
+			m = it->second;
+			prevIds.erase(it);
+			if (!m->Compare(isRgn, pos, rgnend, name, num, col))
+			{
+				updateFlags |= (isRgn ? SNM_REGION_MASK : SNM_MARKER_MASK);
+				g_mkrRgnDiff.m_changed.Add(id);
+				DELETE_NULL(m);
+			}
+		}
+		else
 		{
-			if (m) g_mkrRgnCache.Delete(i, true);
-			g_mkrRgnCache.Insert(i, new MarkerRegion(isRgn, pos, rgnend, name, num, col));
 			updateFlags |= (isRgn ? SNM_REGION_MASK : SNM_MARKER_MASK);
+			g_mkrRgnDiff.m_added.Add(id);
 		}
-		i++;
+
+		if (!m)
+			m = new MarkerRegion(isRgn, pos, rgnend, name, num, col);
+		g_mkrRgnCache.Add(m);
+		g_mkrRgnCacheIds.insert(std::make_pair(id, m)); // keeps duplicates in project order
 	}
+
 	// removed markers/regions?
-	for (int j=g_mkrRgnCache.GetSize()-1; j>=i; j--) {
-		if (MarkerRegion* m = g_mkrRgnCache.Get(j))
-			updateFlags |= (m->IsRegion() ? SNM_REGION_MASK : SNM_MARKER_MASK);
-		g_mkrRgnCache.Delete(j, true);
+	for (std::multimap<int,MarkerRegion*>::iterator it=prevIds.begin(); it!=prevIds.end(); ++it)
+	{
+		updateFlags |= (it->second->IsRegion() ? SNM_REGION_MASK : SNM_MARKER_MASK);
+		g_mkrRgnDiff.m_removed.Add(it->first);
+		delete it->second;
+	}
+
+	// project time mode/tempo update?
+	if (UpdateTimeStringsState())
+	{
+		g_mkrRgnDiff.m_timeStrings = true;
+		return SNM_MARKER_MASK|SNM_REGION_MASK;
 	}
-	// project time mode update?
-	static int sPrevTimemode = *ConfigVar<int>("projtimemode");
-	if (updateFlags != (SNM_MARKER_MASK|SNM_REGION_MASK))
-		if (const ConfigVar<int> timemode = "projtimemode")
-			if (*timemode != sPrevTimemode) {
-				sPrevTimemode = *timemode;
-				return SNM_MARKER_MASK|SNM_REGION_MASK;
-			}
 	return updateFlags;
 }
 
 // notify marker/region listeners?
-// polled via SNM_CSurfRun()
+// polled via SNM_CSurfRun(), at most every g_SNM_MkrRgnUpdateFreq ms (S&M.ini)
 void UpdateMarkerRegionRun()
 {
 	if (GetTickCount() > g_mkrRgnNotifyTime)
 	{
-		g_mkrRgnNotifyTime = GetTickCount() + SNM_MKR_RGN_UPDATE_FREQ;
+		g_mkrRgnNotifyTime = GetTickCount() + g_SNM_MkrRgnUpdateFreq;
 		
 		if (int sz=g_mkrRgnListeners.GetSize())
 			if (int updateFlags = UpdateMarkerRegionCache())
@@ -133,6 +235,144 @@ int FindMarkerRegion(ReaProject* _proj, double _pos, int _flags, int* _idOut)
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+// Marker/region timeline index
+///////////////////////////////////////////////////////////////////////////////
+
+struct IndexItem { double m_pos, m_end; bool m_isrgn; int m_idx, m_id; };
+struct IndexBound { double m_pos; bool m_open; }; // m_open: bound is just after m_pos (region ends)
+
+static bool IndexBoundLess(const IndexBound& _a, const IndexBound& _b) {
+	return _a.m_pos<_b.m_pos || (_a.m_pos==_b.m_pos && !_a.m_open && _b.m_open);
+}
+static bool IndexBoundEq(const IndexBound& _a, const IndexBound& _b) {
+	return _a.m_pos==_b.m_pos && _a.m_open==_b.m_open;
+}
+static bool IndexItemPosLess(const IndexItem* _a, const IndexItem* _b) {
+	return _a->m_pos<_b->m_pos || (_a->m_pos==_b->m_pos && _a->m_idx<_b->m_idx);
+}
+static bool IndexItemIdxLess(const IndexItem* _a, const IndexItem* _b) { // heap: greatest index on top
+	return _a->m_idx<_b->m_idx;
+}
+
+bool SNM_MarkerRegionIndex::Segment::IsReached(double _pos) const {
+	return m_open ? _pos>m_pos : _pos>=m_pos;
+}
+
+bool SNM_MarkerRegionIndex::IsValid(ReaProject* _proj)
+{
+	int nbMkrs=0, nbRgns=0;
+	CountProjectMarkers(_proj, &nbMkrs, &nbRgns);
+	return m_proj==_proj && m_stateCount==GetProjectStateChangeCount(_proj) && m_count==nbMkrs+nbRgns;
+}
+
+// the marker/region found in a segment is the one FindMarkerRegion() would
+// return for any position of that segment, i.e. the eligible one with the
+// greatest enum index amongst the ones that started, computed with a sweep
+void SNM_MarkerRegionIndex::Build(ReaProject* _proj)
+{
+	m_segs.Resize(0, false);
+	m_cursor = 0;
+	m_proj = _proj;
+	m_stateCount = GetProjectStateChangeCount(_proj);
+	int nbMkrs=0, nbRgns=0;
+	CountProjectMarkers(_proj, &nbMkrs, &nbRgns);
+	m_count = nbMkrs+nbRgns;
+
+	std::vector<IndexItem> items;
+	std::vector<IndexBound> bounds;
+	bool isrgn;
+	double dPos, dEnd;
+	int x=0, lastx=0, num;
+	while ((x = EnumProjectMarkers3(_proj, x, &isrgn, &dPos, &dEnd, NULL, &num, NULL)))
+	{
+		if ((!isrgn && m_flags&SNM_MARKER_MASK) || (isrgn && m_flags&SNM_REGION_MASK))
+		{
+			IndexItem item = { dPos, dEnd, isrgn, lastx, MakeMarkerRegionId(num, isrgn) };
+			items.push_back(item);
+			IndexBound start = { dPos, false };
+			bounds.push_back(start);
+			if (isrgn) {
+				IndexBound end = { dEnd, true };
+				bounds.push_back(end);
+			}
+		}
+		lastx=x;
+	}
+	if (bounds.empty())
+		return;
+
+	std::sort(bounds.begin(), bounds.end(), IndexBoundLess);
+	bounds.erase(std::unique(bounds.begin(), bounds.end(), IndexBoundEq), bounds.end());
+
+	std::vector<const IndexItem*> byPos, heap;
+	for (size_t i=0; i<items.size(); i++)
+		byPos.push_back(&items[i]);
+	std::sort(byPos.begin(), byPos.end(), IndexItemPosLess);
+
+	size_t next=0;
+	for (size_t i=0; i<bounds.size(); i++)
+	{
+		const IndexBound& b = bounds[i];
+		while (next<byPos.size() && byPos[next]->m_pos<=b.m_pos) {
+			heap.push_back(byPos[next++]);
+			std::push_heap(heap.begin(), heap.end(), IndexItemIdxLess);
+		}
+		// regions that ended before this segment are gone for good
+		while (heap.size() && heap.front()->m_isrgn && (b.m_open ? heap.front()->m_end<=b.m_pos : heap.front()->m_end<b.m_pos)) {
+			std::pop_heap(heap.begin(), heap.end(), IndexItemIdxLess);
+			heap.pop_back();
+		}
+
+		Segment seg = { b.m_pos, b.m_open, heap.size() ? heap.front()->m_idx : -1, heap.size() ? heap.front()->m_id : -1 };
+		int sz = m_segs.GetSize();
+		if (!sz || m_segs.Get()[sz-1].m_idx!=seg.m_idx) // merge consecutive segments
+			m_segs.Add(seg);
+	}
+}
+
+// same result as FindMarkerRegion(_proj, _pos, flags, _idOut) but in O(log n),
+// or O(1) when the position is in the same or the next segment as the previous
+// lookup (e.g. linear playback)
+int SNM_MarkerRegionIndex::Find(ReaProject* _proj, double _pos, int* _idOut)
+{
+	if (!_proj)
+		_proj = EnumProjects(-1, NULL, 0);
+	if (!IsValid(_proj))
+		Build(_proj);
+
+	int idx=-1, id=-1;
+	const Segment* segs = m_segs.Get();
+	int sz = m_segs.GetSize();
+	if (sz && segs[0].IsReached(_pos))
+	{
+		int cur = m_cursor<sz ? m_cursor : 0;
+		if (!segs[cur].IsReached(_pos) || (cur+1<sz && segs[cur+1].IsReached(_pos)))
+		{
+			if (cur+1<sz && segs[cur+1].IsReached(_pos) && (cur+2>=sz || !segs[cur+2].IsReached(_pos)))
+				cur++;
+			else
+			{
+				// last segment that contains _pos
+				int lo=0, hi=sz-1;
+				while (lo<hi)
+				{
+					int mid = (lo+hi+1)/2;
+					if (segs[mid].IsReached(_pos)) lo=mid;
+					else hi=mid-1;
+				}
+				cur=lo;
+			}
+		}
+		m_cursor = cur;
+		idx = segs[cur].m_idx;
+		id = segs[cur].m_id;
+	}
+	if (_idOut) *_idOut = id;
+	return idx;
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // Marker/region "IDs"
 ///////////////////////////////////////////////////////////////////////////////
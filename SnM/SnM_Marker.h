@@ -39,14 +39,54 @@ public:
 	SNM_MarkerRegionListener() {}
 	virtual ~SNM_MarkerRegionListener() {}
 	// _updateFlags: &1 marker update, &2 region update
+	// details of the update: GetMarkerRegionDiff()
 	virtual void NotifyMarkerRegionUpdate(int _updateFlags) {}
 };
 
+// marker/region ids added, removed or changed since the previous snapshot
+// m_timeStrings: all formatted times changed (time mode, time offset, tempo map)
+class SNM_MarkerRegionDiff {
+public:
+	SNM_MarkerRegionDiff() : m_timeStrings(false) {}
+	void Clear() { m_added.Resize(0, false); m_removed.Resize(0, false); m_changed.Resize(0, false); m_timeStrings=false; }
+	bool Contains(int _id) const;
+	WDL_TypedBuf<int> m_added, m_removed, m_changed;
+	bool m_timeStrings;
+};
+
 void RegisterToMarkerRegionUpdates(SNM_MarkerRegionListener* _sub);
 void UnregisterToMarkerRegionUpdates(SNM_MarkerRegionListener* _sub) ;
 void UpdateMarkerRegionRun();
+const SNM_MarkerRegionDiff* GetMarkerRegionDiff();
 
 int FindMarkerRegion(ReaProject* _proj, double _pos, int _flags, int* _idOut = NULL);
+
+// "marker/region at position" lookups over a sorted timeline, for repeated
+// FindMarkerRegion() calls (e.g. following the play cursor)
+// rebuilt when the project, its state change count or its nb of markers/regions change,
+// markers/regions moved w/o undo point must be notified with Invalidate()
+// (see NotesMarkerRegionListener)
+class SNM_MarkerRegionIndex {
+public:
+	SNM_MarkerRegionIndex(int _flags) : m_flags(_flags), m_stateCount(-1), m_count(-1), m_cursor(0), m_proj(NULL) {}
+	int Find(ReaProject* _proj, double _pos, int* _idOut = NULL);
+	void Invalidate() { m_proj=NULL; }
+	int GetFlags() { return m_flags; }
+private:
+	// marker/region found from m_pos (or just after m_pos when m_open) to the next segment
+	struct Segment {
+		double m_pos;
+		bool m_open;
+		int m_idx, m_id; // -1: none
+		bool IsReached(double _pos) const;
+	};
+	bool IsValid(ReaProject* _proj);
+	void Build(ReaProject* _proj);
+
+	int m_flags, m_stateCount, m_count, m_cursor;
+	ReaProject* m_proj;
+	WDL_TypedBuf<Segment> m_segs; // sorted
+};
 int MakeMarkerRegionId(int _num, bool _isRgn);
 int GetMarkerRegionIdFromIndex(ReaProject* _proj, int _idx);
 int GetMarkerRegionIndexFromId(ReaProject* _proj, int _id);
@@ -71,4 +111,7 @@ protected:
 	int m_id;
 };
 
+// snapshot lookup, only maintained while there are registered listeners
+MarkerRegion* GetMarkerRegionSnapshot(int _id);
+
 #endif
@@ -39,6 +39,23 @@
 
 #include <taglib/tag.h>
 #include <taglib/fileref.h>
+#ifdef USE_SYSTEM_TAGLIB
+#  include <taglib/id3v2frame.h>
+#  include <taglib/id3v2tag.h>
+#  include <taglib/mpegfile.h>
+#  include <taglib/flacfile.h>
+#  include <taglib/xiphcomment.h>
+#  include <taglib/wavfile.h>
+#  include <taglib/infotag.h>
+#else
+#  include <taglib/mpeg/id3v2/id3v2frame.h>
+#  include <taglib/mpeg/id3v2/id3v2tag.h>
+#  include <taglib/mpeg/mpegfile.h>
+#  include <taglib/flac/flacfile.h>
+#  include <taglib/ogg/xiphcomment.h>
+#  include <taglib/riff/wav/wavfile.h>
+#  include <taglib/riff/wav/infotag.h>
+#endif
 
 ///////////////////////////////////////////////////////////////////////////////
 // Reascript export, funcs made dumb-proof!
@@ -163,6 +180,7 @@ bool SNM_GetSetObjectState(void* _obj, WDL_FastString* _state, bool _setnewvalue
 		if (_setnewvalue)
 		{
 			ok = (p==NULL);
+			SWS_ObjectStateWritten();
 		}
 		else if (p)
 		{
@@ -226,36 +244,410 @@ void ULT_SetMediaItemNote(MediaItem* _item, const char* _str) {
 	if (_item) GetSetMediaItemInfo(_item, "P_NOTES", (char*)_str);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Media file tags
+// All tags of a file are parsed at once (i.e. the file is opened once), the
+// last parsed tag sets are kept in a LRU cache keyed by path and modification
+// time. See SNM_ReadMediaFileTags() for the keys.
+///////////////////////////////////////////////////////////////////////////////
+
+#define SNM_TAG_CACHE_SIZE		256
+#define SNM_TAG_READ_THREADS	4
+
+typedef std::map<std::string,std::string> SNM_MediaFileTags; // keys in upper case
+
+static std::string MakeTagKey(const char* _prefix, const char* _key)
+{
+	std::string key(_prefix);
+	for (const char* p=_key; *p; p++)
+		key += (char)toupper((unsigned char)*p);
+	return key;
+}
+
+// first value wins (e.g. first frame of a given ID3v2 frame id)
+static void AddTag(SNM_MediaFileTags* _tags, const char* _prefix, const char* _key, const std::string& _val)
+{
+	if (_val.length())
+		_tags->insert(SNM_MediaFileTags::value_type(MakeTagKey(_prefix, _key), _val));
+}
+
+static void AddTag(SNM_MediaFileTags* _tags, const char* _prefix, const TagLib::String& _key, const TagLib::String& _val) {
+	AddTag(_tags, _prefix, _key.toCString(true), _val.to8Bit(true));
+}
+
+// fields of fixed size, NUL padded
+static std::string GetChunkString(const TagLib::ByteVector& _data, unsigned int _offset, unsigned int _len)
+{
+	std::string str;
+	for (unsigned int i=_offset; i<_offset+_len && i<_data.size() && _data[i]; i++)
+		str += _data[i];
+	return str;
+}
+
+static void AddBasicTags(SNM_MediaFileTags* _tags, TagLib::Tag* _t)
+{
+	if (!_t || _t->isEmpty())
+		return;
+
+	AddTag(_tags, "", "ARTIST", _t->artist());
+	AddTag(_tags, "", "ALBUM", _t->album());
+	AddTag(_tags, "", "GENRE", _t->genre());
+	AddTag(_tags, "", "COMMENT", _t->comment());
+	AddTag(_tags, "", "TITLE", _t->title());
+	if (_t->year()) AddTag(_tags, "", "YEAR", TagLib::String::number(_t->year()));
+	if (_t->track()) AddTag(_tags, "", "TRACK", TagLib::String::number(_t->track()));
+}
+
+static void AddID3v2Tags(SNM_MediaFileTags* _tags, TagLib::ID3v2::Tag* _t)
+{
+	if (!_t || _t->isEmpty())
+		return;
+
+	const TagLib::ID3v2::FrameList& frames = _t->frameList();
+	for (TagLib::ID3v2::FrameList::ConstIterator it=frames.begin(); it!=frames.end(); ++it)
+		AddTag(_tags, "ID3:", TagLib::String((*it)->frameID()), (*it)->toString());
+}
+
+static void AddXiphTags(SNM_MediaFileTags* _tags, TagLib::Ogg::XiphComment* _t)
+{
+	if (!_t)
+		return;
+
+	const TagLib::Ogg::FieldListMap& fields = _t->fieldListMap();
+	for (TagLib::Ogg::FieldListMap::ConstIterator it=fields.begin(); it!=fields.end(); ++it)
+		if (!it->second.isEmpty())
+			AddTag(_tags, "VORBIS:", it->first, it->second.front());
+}
+
+// EBU Tech 3285 "bext" chunk
+static void AddBextTags(SNM_MediaFileTags* _tags, const TagLib::ByteVector& _data)
+{
+	if (_data.size() < 346) // up to TimeReference
+		return;
+
+	AddTag(_tags, "BWF:", "Description", GetChunkString(_data, 0, 256));
+	AddTag(_tags, "BWF:", "Originator", GetChunkString(_data, 256, 32));
+	AddTag(_tags, "BWF:", "OriginatorReference", GetChunkString(_data, 288, 32));
+	AddTag(_tags, "BWF:", "OriginationDate", GetChunkString(_data, 320, 10));
+	AddTag(_tags, "BWF:", "OriginationTime", GetChunkString(_data, 330, 8));
+
+	char timeRef[32];
+	unsigned long long samples = ((unsigned long long)_data.toUInt(342, false) << 32) | _data.toUInt(338, false);
+	snprintf(timeRef, sizeof(timeRef), "%llu", samples);
+	AddTag(_tags, "BWF:", "TimeReference", timeRef);
+
+	if (_data.size() > 602)
+		AddTag(_tags, "BWF:", "CodingHistory", GetChunkString(_data, 602, _data.size()-602));
+}
+
+// iXML chunk: leaf elements only, e.g. "IXML:PROJECT", "IXML:SCENE", "IXML:TAKE"
+static void AddIXMLTags(SNM_MediaFileTags* _tags, const TagLib::ByteVector& _data)
+{
+	std::string xml = GetChunkString(_data, 0, _data.size());
+	size_t pos = 0;
+	while ((pos = xml.find('<', pos)) != std::string::npos)
+	{
+		pos++;
+		if (pos >= xml.length() || xml[pos] == '/' || xml[pos] == '?' || xml[pos] == '!')
+			continue;
+
+		size_t nameEnd = xml.find_first_of(" \t\r\n/>", pos);
+		size_t valStart = xml.find('>', pos);
+		if (nameEnd == std::string::npos || valStart == std::string::npos || xml[valStart-1] == '/')
+			continue;
+
+		std::string name = xml.substr(pos, nameEnd-pos);
+		size_t valEnd = xml.find('<', ++valStart);
+		if (valEnd == std::string::npos || xml.compare(valEnd, name.length()+3, "</" + name + ">"))
+			continue; // not a leaf
+
+		std::string val;
+		for (size_t i=valStart; i<valEnd; i++)
+		{
+			if (xml[i] == '&')
+			{
+				static const char* entities[][2] = { {"&amp;","&"}, {"&lt;","<"}, {"&gt;",">"}, {"&quot;","\""}, {"&apos;","'"} };
+				bool found = false;
+				for (int j=0; !found && j<5; j++)
+				{
+					size_t len = strlen(entities[j][0]);
+					if (!xml.compare(i, len, entities[j][0]))
+					{
+						val += entities[j][1];
+						i += len-1;
+						found = true;
+					}
+				}
+				if (found)
+					continue;
+			}
+			val += xml[i];
+		}
+		AddTag(_tags, "IXML:", name.c_str(), val);
+		pos = valEnd;
+	}
+}
+
+// exposes RIFF chunks, TagLib doesn't parse "bext" and "iXML" ones
+class SNM_WavFile : public TagLib::RIFF::WAV::File
+{
+public:
+	SNM_WavFile(TagLib::FileName _fn) : TagLib::RIFF::WAV::File(_fn, false) {}
+	void GetTags(SNM_MediaFileTags* _tags)
+	{
+		AddBasicTags(_tags, tag());
+		AddID3v2Tags(_tags, ID3v2Tag());
+
+		const TagLib::RIFF::Info::FieldListMap& fields = InfoTag()->fieldListMap();
+		for (TagLib::RIFF::Info::FieldListMap::ConstIterator it=fields.begin(); it!=fields.end(); ++it)
+			AddTag(_tags, "INFO:", TagLib::String(it->first), it->second);
+
+		for (unsigned int i=0; i<chunkCount(); i++)
+		{
+			TagLib::ByteVector name = chunkName(i);
+			if (name == "bext") AddBextTags(_tags, chunkData(i));
+			else if (name == "iXML") AddIXMLTags(_tags, chunkData(i));
+		}
+	}
+};
+
+// thread safe, returns false if the file can't be read
+static bool ParseMediaFileTags(const char* _fn, SNM_MediaFileTags* _tags)
+{
+	if (HasFileExtension(_fn, "WAV") || HasFileExtension(_fn, "BWF"))
+	{
+		SNM_WavFile f(win32::widen(_fn).c_str());
+		if (!f.isValid())
+			return false;
+		f.GetTags(_tags);
+		return true;
+	}
+
+	TagLib::FileRef f(win32::widen(_fn).c_str(), false);
+	if (f.isNull())
+		return false;
+
+	AddBasicTags(_tags, f.tag());
+	if (TagLib::MPEG::File* mpeg = dynamic_cast<TagLib::MPEG::File*>(f.file()))
+		AddID3v2Tags(_tags, mpeg->ID3v2Tag());
+	else if (TagLib::FLAC::File* flac = dynamic_cast<TagLib::FLAC::File*>(f.file()))
+		AddXiphTags(_tags, flac->xiphComment());
+	else
+		AddXiphTags(_tags, dynamic_cast<TagLib::Ogg::XiphComment*>(f.tag())); // Ogg Vorbis, Opus, etc..
+	return true;
+}
+
+class SNM_MediaFileTagCache
+{
+public:
+	// thread safe, _tags gets a copy of the (cached or parsed) tag set
+	bool Get(const char* _fn, SNM_MediaFileTags* _tags)
+	{
+		time_t mtime=0;
+		if (!_fn || !*_fn || !GetFileModTime(_fn, &mtime))
+			return false;
+
+		{
+			SWS_SectionLock lock(&m_mutex);
+			int i = Find(_fn);
+			if (i>=0 && m_entries.Get(i)->m_mtime == mtime)
+			{
+				Entry* e = m_entries.Get(i);
+				m_entries.Delete(i, false);
+				m_entries.Insert(0, e);
+				*_tags = e->m_tags;
+				return true;
+			}
+		}
+
+		Entry* e = new Entry(_fn, mtime);
+		if (!ParseMediaFileTags(_fn, &e->m_tags))
+		{
+			delete e;
+			return false;
+		}
+		*_tags = e->m_tags;
+
+		SWS_SectionLock lock(&m_mutex);
+		int i = Find(_fn);
+		if (i>=0) m_entries.Delete(i, true);
+		m_entries.Insert(0, e); // most recently used first
+		while (m_entries.GetSize() > SNM_TAG_CACHE_SIZE)
+			m_entries.Delete(m_entries.GetSize()-1, true);
+		return true;
+	}
+
+	// modification times have a 1 second resolution: files tagged by SWS are explicitly removed
+	void Remove(const char* _fn)
+	{
+		SWS_SectionLock lock(&m_mutex);
+		int i = Find(_fn);
+		if (i>=0) m_entries.Delete(i, true);
+	}
+
+private:
+	struct Entry
+	{
+		Entry(const char* _fn, time_t _mtime) : m_fn(_fn), m_mtime(_mtime) {}
+		WDL_FastString m_fn;
+		time_t m_mtime;
+		SNM_MediaFileTags m_tags;
+	};
+
+	// lock must be held
+	int Find(const char* _fn)
+	{
+		for (int i=0; i < m_entries.GetSize(); i++)
+			if (!_stricmp(m_entries.Get(i)->m_fn.Get(), _fn))
+				return i;
+		return -1;
+	}
+
+	SWS_Mutex m_mutex;
+	WDL_PtrList_DOD<Entry> m_entries; // most recently used first
+};
+
+SNM_MediaFileTagCache g_SNM_TagCache;
+
+bool SNM_GetMediaFileTag(const char* _fn, const char* _key, WDL_FastString* _val)
+{
+	SNM_MediaFileTags tags;
+	if (_key && g_SNM_TagCache.Get(_fn, &tags))
+	{
+		SNM_MediaFileTags::const_iterator it = tags.find(MakeTagKey("", _key));
+		if (it != tags.end())
+		{
+			_val->Set(it->second.c_str());
+			return true;
+		}
+	}
+	return false;
+}
+
 bool SNM_ReadMediaFileTag(const char *fn, const char* tag, char* tagval, int tagval_sz)
 {
   if (!fn || !*fn || !tagval || tagval_sz<=0) return false;
   *tagval=0;
 
-  TagLib::FileRef f(win32::widen(fn).c_str(), false);
-
-  if (!f.isNull() && !f.tag()->isEmpty())
-  {
-    TagLib::String s;
-    if (!_stricmp(tag, "artist")) s=f.tag()->artist();
-    else if (!_stricmp(tag, "album")) s=f.tag()->album();
-    else if (!_stricmp(tag, "genre")) s=f.tag()->genre();
-    else if (!_stricmp(tag, "comment")) s=f.tag()->comment();
-    else if (!_stricmp(tag, "title")) s=f.tag()->title();
-    if (s.length())
-    {
-      const char *p=s.toCString(true);
-      if (strcmp(p,"0")) lstrcpyn(tagval, p, tagval_sz); // must be a taglib bug...
-    }
-    else
-    {
-      if (!_stricmp(tag, "year") && f.tag()->year()) snprintf(tagval, tagval_sz, "%u", f.tag()->year());
-      else if (!_stricmp(tag, "track") && f.tag()->track()) snprintf(tagval, tagval_sz, "%u", f.tag()->track());
-    }
-  }
+  WDL_FastString val;
+  if (tag && !strchr(tag, ':') && SNM_GetMediaFileTag(fn, tag, &val)) // basic tags only, see SNM_ReadMediaFileTags()
+    if (strcmp(val.Get(),"0")) lstrcpyn(tagval, val.Get(), tagval_sz); // must be a taglib bug...
 
   return !!*tagval;
 }
 
+// a batch is shared by up to SNM_TAG_READ_THREADS threads, each file is read by a single thread
+struct SNM_TagReadBatch
+{
+	SNM_TagReadBatch() : m_next(0), m_read(0) {}
+	WDL_PtrList_DOD<WDL_FastString> m_fns;
+	WDL_PtrList_DOD<WDL_FastString> m_vals; // m_fns.GetSize() * m_keys.size() values
+	std::vector<std::string> m_keys;
+	SWS_Mutex m_mutex;
+	int m_next, m_read;
+};
+
+static unsigned WINAPI TagReadThread(void* _batch)
+{
+	SNM_TagReadBatch* batch = (SNM_TagReadBatch*)_batch;
+	const int nbKeys = (int)batch->m_keys.size();
+	for (;;)
+	{
+		int i;
+		{
+			SWS_SectionLock lock(&batch->m_mutex);
+			i = batch->m_next++;
+		}
+		if (i >= batch->m_fns.GetSize())
+			return 0;
+
+		SNM_MediaFileTags tags;
+		if (g_SNM_TagCache.Get(batch->m_fns.Get(i)->Get(), &tags))
+		{
+			for (int k=0; k<nbKeys; k++)
+			{
+				SNM_MediaFileTags::const_iterator it = tags.find(batch->m_keys[k]);
+				if (it != tags.end())
+					batch->m_vals.Get(i*nbKeys+k)->Set(it->second.c_str());
+			}
+			SWS_SectionLock lock(&batch->m_mutex);
+			batch->m_read++;
+		}
+	}
+}
+
+// _fns: file names separated by new lines, _keys: comma separated tag keys (case insensitive)
+// _vals: one line per file, tab separated values (tabs, new lines and backslashes are escaped)
+// returns the number of files that could be read
+int SNM_ReadMediaFileTags(const char* _fns, const char* _keys, WDL_FastString* _vals)
+{
+	if (!_fns || !_keys || !_vals || g_script_strs.Find(_vals)<0)
+		return 0;
+
+	SNM_TagReadBatch batch;
+
+	LineParser lp(false);
+	WDL_FastString key;
+	for (const char* p=_keys; ; p++)
+	{
+		if (*p == ',' || !*p)
+		{
+			lp.parse(key.Get()); // trims spaces
+			batch.m_keys.push_back(MakeTagKey("", lp.getnumtokens() ? lp.gettoken_str(0) : ""));
+			key.Set("");
+			if (!*p) break;
+		}
+		else
+			key.Append(p, 1);
+	}
+
+	for (const char* p=_fns; *p; )
+	{
+		const char* eol = strchr(p, '\n');
+		int len = eol ? (int)(eol-p) : (int)strlen(p);
+		batch.m_fns.Add(new WDL_FastString(p, (len && p[len-1]=='\r') ? len-1 : len));
+		for (size_t k=0; k<batch.m_keys.size(); k++)
+			batch.m_vals.Add(new WDL_FastString);
+		p += eol ? len+1 : len;
+	}
+
+	int nbThreads = min(SNM_TAG_READ_THREADS, batch.m_fns.GetSize()) - 1; // + main thread
+	WDL_TypedBuf<HANDLE> threads;
+	for (int i=0; i<nbThreads; i++)
+		if (HANDLE h = (HANDLE)_beginthreadex(NULL, 0, TagReadThread, (void*)&batch, 0, NULL))
+			threads.Add(h);
+
+	TagReadThread(&batch); // main thread helps too (and reads everything if threads couldn't be created)
+	for (int i=0; i<threads.GetSize(); i++)
+	{
+		WaitForSingleObject(threads.Get()[i], INFINITE);
+		CloseHandle(threads.Get()[i]);
+	}
+
+	_vals->Set("");
+	const int nbKeys = (int)batch.m_keys.size();
+	for (int i=0; i<batch.m_fns.GetSize(); i++)
+	{
+		for (int k=0; k<nbKeys; k++)
+		{
+			if (k) _vals->Append("\t");
+			for (const char* v=batch.m_vals.Get(i*nbKeys+k)->Get(); *v; v++)
+			{
+				switch (*v)
+				{
+					case '\t': _vals->Append("\\t"); break;
+					case '\n': _vals->Append("\\n"); break;
+					case '\r': _vals->Append("\\r"); break;
+					case '\\': _vals->Append("\\\\"); break;
+					default: _vals->Append(v, 1); break;
+				}
+			}
+		}
+		_vals->Append("\n");
+	}
+	return batch.m_read;
+}
+
 bool SNM_TagMediaFile(const char *fn, const char* tag, const char* tagval)
 {
   if (!fn || !*fn || !tagval || !tag) return false;
@@ -283,6 +675,7 @@ bool SNM_TagMediaFile(const char *fn, const char* tag, const char* tagval)
     }
     if (didsmthg) f.save();
   }
+  if (didsmthg) g_SNM_TagCache.Remove(fn);
 
   return didsmthg;
 }
@@ -49,7 +49,9 @@ double SNM_GetDoubleConfigVar(const char* _varName, double _errVal);
 bool SNM_SetDoubleConfigVar(const char* _varName, double _newVal);
 const char* ULT_GetMediaItemNote(MediaItem* _item);
 void ULT_SetMediaItemNote(MediaItem* _item, const char* _str);
+bool SNM_GetMediaFileTag(const char* _fn, const char* _key, WDL_FastString* _val);
 bool SNM_ReadMediaFileTag(const char *fn, const char* tag, char* tagval, int tagval_sz);
+int SNM_ReadMediaFileTags(const char* _fns, const char* _keys, WDL_FastString* _vals);
 bool SNM_TagMediaFile(const char *fn, const char* tag, const char* tagval);
 
 // toolbar auto refresh
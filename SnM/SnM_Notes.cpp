@@ -126,6 +126,30 @@ MediaTrack* g_trNote = NULL;
 // to distinguish internal marker/region updates from external ones
 bool g_internalMkrRgnChange = false;
 
+// marker/region lookups while the cursor moves, one index per notes type mask
+SNM_MarkerRegionIndex g_mkrIndex(SNM_MARKER_MASK);
+SNM_MarkerRegionIndex g_rgnIndex(SNM_REGION_MASK);
+SNM_MarkerRegionIndex g_mkrRgnIndex(SNM_MARKER_MASK|SNM_REGION_MASK);
+
+int FindMarkerRegionIndexed(double _pos, int _mask, int* _idOut)
+{
+	switch (_mask)
+	{
+		case SNM_MARKER_MASK: return g_mkrIndex.Find(NULL, _pos, _idOut);
+		case SNM_REGION_MASK: return g_rgnIndex.Find(NULL, _pos, _idOut);
+		case SNM_MARKER_MASK|SNM_REGION_MASK: return g_mkrRgnIndex.Find(NULL, _pos, _idOut);
+	}
+	return FindMarkerRegion(NULL, _pos, _mask, _idOut);
+}
+
+SNM_RegionSubtitle* FindRegionSub(int _id)
+{
+	for (int i=0; i < g_pRegionSubs.Get()->GetSize(); i++)
+		if (g_pRegionSubs.Get()->Get(i)->m_id == _id)
+			return g_pRegionSubs.Get()->Get(i);
+	return NULL;
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // NotesWnd
@@ -1023,8 +1047,7 @@ int NotesWnd::UpdateMkrRgnNameOrSub(int _type)
 		if (_type!=SNM_NOTES_RGN_NAME && _type!=SNM_NOTES_RGN_SUB)
 			mask |= SNM_MARKER_MASK;
 
-		// NF: could use API GetLastMarkerAndCurRegion() instead
-		int id, idx = FindMarkerRegion(NULL, dPos, mask, &id);
+		int id, idx = FindMarkerRegionIndexed(dPos, mask, &id);
 		if (id > 0)
 		{
 			if (id != g_lastMarkerRegionId)
@@ -1040,11 +1063,10 @@ int NotesWnd::UpdateMkrRgnNameOrSub(int _type)
 				}
 				else // update subtitle
 				{
-					for (int i=0; i < g_pRegionSubs.Get()->GetSize(); i++)
-						if (g_pRegionSubs.Get()->Get(i)->m_id == id) {
-							SetText(g_pRegionSubs.Get()->Get(i)->m_notes.Get());
-							return REQUEST_REFRESH;
-						}
+					if (SNM_RegionSubtitle* sub = FindRegionSub(id)) {
+						SetText(sub->m_notes.Get());
+						return REQUEST_REFRESH;
+					}
 					g_pRegionSubs.Get()->Add(new SNM_RegionSubtitle(id, ""));
 					SetText("");
 				}
@@ -1075,16 +1097,14 @@ void NotesWnd::ForceUpdateMkrRgnNameOrSub(int _type)
 	if (_type != SNM_NOTES_RGN_NAME && _type != SNM_NOTES_RGN_SUB)
 		mask |= SNM_MARKER_MASK;
 
-	int id; FindMarkerRegion(NULL, dPos, mask, &id);
+	int id; FindMarkerRegionIndexed(dPos, mask, &id);
 	if (id > 0)
 	{
-		for (int i = 0; i < g_pRegionSubs.Get()->GetSize(); i++)
-			if (g_pRegionSubs.Get()->Get(i)->m_id == id) {
-				SetText(g_pRegionSubs.Get()->Get(i)->m_notes.Get());
-				if (g_locked)
-					RefreshGUI();
-				return;
-			}
+		if (SNM_RegionSubtitle* sub = FindRegionSub(id)) {
+			SetText(sub->m_notes.Get());
+			if (g_locked)
+				RefreshGUI();
+		}
 	}
 }
 
@@ -1240,6 +1260,11 @@ void NotesUpdateJob::Perform() {
 // ScheduledJob because of multi-notifs during project switches (vs CSurfSetTrackListChange)
 void NotesMarkerRegionListener::NotifyMarkerRegionUpdate(int _updateFlags)
 {
+	// in case markers/regions were changed w/o undo point
+	g_mkrIndex.Invalidate();
+	g_rgnIndex.Invalidate();
+	g_mkrRgnIndex.Invalidate();
+
 	if (g_notesType>=SNM_NOTES_MKR_SUB && g_notesType<=SNM_NOTES_MKRRGN_SUB)
 	{
 		ScheduledJob::Schedule(new NotesUpdateJob(SNM_SCHEDJOB_ASYNC_DELAY_OPT));
@@ -1265,8 +1290,10 @@ bool ImportSubRipFile(const char* _fn)
 	double firstPos = -1.0;
 
 	// no need to check extension here, it's done for us
+	// cues are added while reading, the file is never loaded as a whole
 	if (FILE* f = fopenUTF8(_fn, "rt"))
 	{
+		PreventUIRefresh(1);
 		char buf[1024];
 		while(fgets(buf, sizeof(buf), f) && *buf)
 		{
@@ -1318,6 +1345,7 @@ bool ImportSubRipFile(const char* _fn)
 			}
 		}
 		fclose(f);
+		PreventUIRefresh(-1);
 	}
 	
 	if (ok)
@@ -1348,6 +1376,12 @@ bool ExportSubRipFile(const char* _fn)
 {
 	if (FILE* f = fopenUTF8(_fn, "wt"))
 	{
+		// subs by id (duplicates are possible, kept in list order)
+		std::multimap<int,SNM_RegionSubtitle*> subsById;
+		for (int i=0; i < g_pRegionSubs.Get()->GetSize(); i++)
+			if (SNM_RegionSubtitle* rn = g_pRegionSubs.Get()->Get(i))
+				subsById.insert(std::make_pair(rn->m_id, rn));
+
 		WDL_FastString subs;
 		int x=0, subIdx=1, num; bool isRgn; double p1, p2;
 		while ((x = EnumProjectMarkers2(NULL, x, &isRgn, &p1, &p2, NULL, &num)))
@@ -1363,24 +1397,22 @@ bool ExportSubRipFile(const char* _fn)
 			int id = MakeMarkerRegionId(num, isRgn);
 			if (id > 0)
 			{
-				for (int i=0; i < g_pRegionSubs.Get()->GetSize(); i++)
+				std::multimap<int,SNM_RegionSubtitle*>::iterator it = subsById.lower_bound(id);
+				for (; it!=subsById.end() && it->first==id; ++it)
 				{
-					SNM_RegionSubtitle* rn = g_pRegionSubs.Get()->Get(i);
-					if (rn->m_id == id)
-					{
-						subs.AppendFormatted(64, "%d\n", subIdx++); // subs have their own indexes
-						
-						int h, m, s, ms;
-						TranslatePos(p1, &h, &m, &s, &ms);
-						subs.AppendFormatted(64,"%02d:%02d:%02d,%03d --> ",h,m,s,ms);
-						TranslatePos(p2, &h, &m, &s, &ms);
-						subs.AppendFormatted(64,"%02d:%02d:%02d,%03d\n",h,m,s,ms);
-
-						subs.Append(rn->m_notes.Get());
-						if (rn->m_notes.GetLength() && rn->m_notes.Get()[rn->m_notes.GetLength()-1] != '\n')
-							subs.Append("\n");
+					SNM_RegionSubtitle* rn = it->second;
+					subs.AppendFormatted(64, "%d\n", subIdx++); // subs have their own indexes
+					
+					int h, m, s, ms;
+					TranslatePos(p1, &h, &m, &s, &ms);
+					subs.AppendFormatted(64,"%02d:%02d:%02d,%03d --> ",h,m,s,ms);
+					TranslatePos(p2, &h, &m, &s, &ms);
+					subs.AppendFormatted(64,"%02d:%02d:%02d,%03d\n",h,m,s,ms);
+
+					subs.Append(rn->m_notes.Get());
+					if (rn->m_notes.GetLength() && rn->m_notes.Get()[rn->m_notes.GetLength()-1] != '\n')
 						subs.Append("\n");
-					}
+					subs.Append("\n");
 				}
 			}
 		}
@@ -1740,6 +1772,21 @@ const char* NFDoGetSWSMarkerRegionSub(int mkrRgnIdxNumberIn)
 	return "";
 }
 
+// flags: &1=markers, &2=regions (0: both)
+// note: no index here, scripts can move markers/regions w/o undo point between
+// two calls, before the listener gets a chance to invalidate the indexes
+const char* NFDoGetSWSMarkerRegionSubAtPosition(double position, int flags, int* mkrRgnIdxOut)
+{
+	int mask = flags & (SNM_MARKER_MASK|SNM_REGION_MASK);
+	int id, idx = FindMarkerRegion(NULL, position, mask ? mask : SNM_MARKER_MASK|SNM_REGION_MASK, &id);
+	if (mkrRgnIdxOut) *mkrRgnIdxOut = idx;
+
+	if (id > 0)
+		if (SNM_RegionSubtitle* sub = FindRegionSub(id))
+			return sub->m_notes.Get();
+	return "";
+}
+
 bool NFDoSetSWSMarkerRegionSub(const char* mkrRgnSubIn, int mkrRgnIdxNumberIn)
 {
 	int idx = 0; bool mkrRgnExists = false;
@@ -184,6 +184,7 @@ const char* NFDoGetSWSTrackNotes(MediaTrack* track);
 void NFDoSetSWSTrackNotes(MediaTrack* track, const char* buf);
 
 const char* NFDoGetSWSMarkerRegionSub(int mkrRgnIdx);
+const char* NFDoGetSWSMarkerRegionSubAtPosition(double position, int flags, int* mkrRgnIdxOut);
 bool NFDoSetSWSMarkerRegionSub(const char* mkrRgnSubIn, int mkrRgnIdx);
 void NF_DoUpdateSWSMarkerRegionSubWindow();
 
@@ -119,6 +119,8 @@ double g_lastRunPos = -1.0;
 double g_nextRgnPos, g_nextRgnEnd;
 double g_curRgnPos = 0.0, g_curRgnEnd = -1.0; // to detect unsync, end<pos means non relevant
 
+RegionPlaylistScheduler g_rgnplScheduler;
+
 int g_oldSeekPref = -1;
 int g_oldStopprojlenPref = -1;
 int g_oldRepeatState = -1;
@@ -315,24 +317,24 @@ void RegionPlaylistView::GetItemText(SWS_ListItem* item, int iCol, char* str, in
 				else
 					snprintf(str, iStrMax, "%d", pItem->m_cnt);
 				break;
-			case COL_RGN_START: {
-				double pos;
-				if (EnumMarkerRegionById(NULL, pItem->m_rgnId, NULL, &pos, NULL, NULL, NULL, NULL)>=0)
-					format_timestr_pos(pos, str, iStrMax, -1);
-				break;
-			}
-			case COL_RGN_END: {
-				double end;
-				if (EnumMarkerRegionById(NULL, pItem->m_rgnId, NULL, NULL, &end, NULL, NULL, NULL)>=0)
-					format_timestr_pos(end, str, iStrMax, -1);
-				break;
-			}
-			case COL_RGN_LEN: {
-				double pos, end;
-				if (EnumMarkerRegionById(NULL, pItem->m_rgnId, NULL, &pos, &end, NULL, NULL, NULL)>=0)
-					format_timestr_len(end-pos, str, iStrMax, pos, -1);
+			case COL_RGN_START:
+			case COL_RGN_END:
+			case COL_RGN_LEN:
+				// cached time strings from the marker/region snapshot (kept up to date via m_mkrRgnListener)
+				if (MarkerRegion* rgn = GetMarkerRegionSnapshot(pItem->m_rgnId))
+				{
+					lstrcpyn(str, iCol==COL_RGN_START ? rgn->GetPosStr() : iCol==COL_RGN_END ? rgn->GetEndStr() : rgn->GetLenStr(), iStrMax);
+				}
+				else
+				{
+					double pos, end;
+					if (EnumMarkerRegionById(NULL, pItem->m_rgnId, NULL, &pos, &end, NULL, NULL, NULL)>=0)
+					{
+						if (iCol==COL_RGN_LEN) format_timestr_len(end-pos, str, iStrMax, pos, -1);
+						else format_timestr_pos(iCol==COL_RGN_START ? pos : end, str, iStrMax, -1);
+					}
+				}
 				break;
-			}
 		}
 	}
 }
@@ -1343,6 +1345,254 @@ int GetPrevValidItem(int _plId, int _itemId, bool _startWith, bool _repeat, bool
 	return -1;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// RegionPlaylistScheduler
+///////////////////////////////////////////////////////////////////////////////
+
+void RegionPlaylistScheduler::Reset()
+{
+	Invalidate();
+	m_plId = m_fromItemId = -1;
+	m_lastTick = -1.0;
+	m_tickAvg = SNM_CSURF_RUN_TICK_MS/1000.0;
+	m_tickMax = m_pollWindow = 0.0;
+	m_transitions = m_atRisk = m_syncLosses = m_ticks = 0;
+	m_latencySum = m_latencyMax = 0.0;
+	m_marginMin = -1.0;
+}
+
+// called on each poll
+void RegionPlaylistScheduler::Tick(double _now, double _playRate)
+{
+	if (m_lastTick >= 0.0)
+	{
+		double dt = _now - m_lastTick;
+		if (dt > 0.0 && dt < 1.0) // ignore hiccups (modal dialogs, etc..)
+		{
+			m_tickAvg = 0.9*m_tickAvg + 0.1*dt;
+			if (dt > m_tickMax) m_tickMax = dt;
+			m_ticks++;
+		}
+	}
+	m_lastTick = _now;
+	m_pollWindow = (m_tickAvg + m_lookahead) * _playRate;
+}
+
+bool RegionPlaylistScheduler::PlanStep(int _plId, int _fromItemId, bool _repeat, bool _shuffle, RgnPlaylistStep* _stepOut)
+{
+	int itemId = GetNextValidItem(_plId, _fromItemId, false, _repeat, _shuffle);
+	if (RegionPlaylist* pl = GetPlaylist(_plId))
+	{
+		if (RgnPlaylistItem* item = pl->Get(itemId))
+		{
+			double pos, end;
+			if (EnumMarkerRegionById(NULL, item->m_rgnId, NULL, &pos, &end, NULL, NULL, NULL)>=0)
+			{
+				_stepOut->m_itemId = itemId;
+				_stepOut->m_rgnId = item->m_rgnId;
+				_stepOut->m_loops = item->m_cnt<0 ? -1 : item->m_cnt>1 ? item->m_cnt : 0;
+				_stepOut->m_pos = pos;
+				_stepOut->m_end = end;
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+// returns the transition that follows _curItemId (planned ahead if possible),
+// or NULL at the end of the playlist
+// note: the returned step is valid until the next call
+const RgnPlaylistStep* RegionPlaylistScheduler::PopNext(int _plId, int _curItemId, bool _repeat, bool _shuffle)
+{
+	if (m_plId != _plId || m_fromItemId != _curItemId)
+		Invalidate();
+	m_plId = _plId;
+
+	// plan ahead: shuffled items are decided here, once
+	int fromItemId = m_nbSteps ? m_steps[m_nbSteps-1].m_itemId : _curItemId;
+	while (m_nbSteps < SNM_RGNPL_PLANNED_STEPS && PlanStep(_plId, fromItemId, _repeat, _shuffle, &m_steps[m_nbSteps]))
+		fromItemId = m_steps[m_nbSteps++].m_itemId;
+
+	if (!m_nbSteps)
+	{
+		m_fromItemId = -1;
+		return NULL;
+	}
+
+	m_popped = m_steps[0];
+	for (int i=1; i<m_nbSteps; i++)
+		m_steps[i-1] = m_steps[i];
+	m_nbSteps--;
+	m_fromItemId = m_popped.m_itemId;
+
+	// a region shorter than the poll window is likely to be played past its
+	// end (its own transition cannot be polled in time)
+	if ((m_popped.m_end - m_popped.m_pos) < m_pollWindow)
+		m_atRisk++;
+
+	return &m_popped;
+}
+
+// called when a new region is detected: _pos is the polled position, 
+// the next seek is requested right after this call
+void RegionPlaylistScheduler::OnTransition(double _pos, double _rgnPos, double _rgnEnd)
+{
+	m_transitions++;
+
+	double latency = _pos - _rgnPos; // how late the transition was polled
+	if (latency < 0.0) latency = 0.0;
+	m_latencySum += latency;
+	if (latency > m_latencyMax) m_latencyMax = latency;
+
+	// time left to queue the next seek
+	double margin = _rgnEnd - _pos;
+	if (m_marginMin < 0.0 || margin < m_marginMin) m_marginMin = margin;
+}
+
+void RegionPlaylistScheduler::LogStats()
+{
+	if (!m_logStats || !m_transitions)
+		return;
+
+	WDL_FastString str;
+	str.SetFormatted(512, "Region Playlist scheduling stats - Transitions: %d, at risk: %d, sync losses: %d\n", 
+		m_transitions, m_atRisk, m_syncLosses);
+	str.AppendFormatted(512, "  Polling interval (ms): avg %.2f, max %.2f (%d polls), lookahead: %.2f\n", 
+		m_tickAvg*1000.0, m_tickMax*1000.0, m_ticks, m_lookahead*1000.0);
+	str.AppendFormatted(512, "  Transition latency (ms): avg %.2f, max %.2f, min margin before region end: %.2f\n", 
+		m_latencySum*1000.0/m_transitions, m_latencyMax*1000.0, m_marginMin*1000.0);
+	ShowConsoleMsg(str.Get());
+}
+
+void RegionPlaylistScheduler::GetStats(int* _transitions, int* _atRisk, double* _tickAvg) const
+{
+	if (_transitions) *_transitions = m_transitions;
+	if (_atRisk) *_atRisk = m_atRisk;
+	if (_tickAvg) *_tickAvg = m_tickAvg;
+}
+
+#ifdef BR_DEBUG_PERFORMANCE_BENCHMARK
+// RegionPlaylistScheduler driven by a simulated clock over temporary regions:
+// the simulated transport polls every _tick s and jumps to the planned seek
+// target when the current region ends (i.e. a smooth seek requested in time)
+static bool RegionPlaylistSchedulerTest(double _tick, WDL_FastString* _failure)
+{
+	const double lengths[] = { 2.0, 0.01, 1.0, 3.0 };
+	const int counts[] = { 1, 1, 2, 1 };
+	const int nbRgns = sizeof(lengths)/sizeof(lengths[0]);
+
+	// temporary regions past the project end & playlist
+	int nums[nbRgns];
+	double rgnPos = SNM_GetProjectLength() + 10.0;
+	RegionPlaylist* pl = new RegionPlaylist("SWS benchmark");
+	for (int i=0; i<nbRgns; i++)
+	{
+		nums[i] = AddProjectMarker2(NULL, true, rgnPos, rgnPos+lengths[i], "", -1, 0);
+		pl->Add(new RgnPlaylistItem(MakeMarkerRegionId(nums[i], true), counts[i]));
+		rgnPos += lengths[i] + 1.0;
+	}
+	int plId = g_pls.Get()->GetSize();
+	g_pls.Get()->Add(pl);
+
+	RegionPlaylistScheduler sched;
+	sched.m_lookahead = 0.01;
+
+	WDL_FastString played("0");
+	int misses = 0, loopsLeft = 0, curItem = 0;
+	double now = 0.0, pos = 0.0, curEnd = 0.0;
+	EnumMarkerRegionById(NULL, pl->Get(0)->m_rgnId, NULL, &pos, &curEnd, NULL, NULL, NULL);
+	sched.Tick(now, 1.0);
+	const RgnPlaylistStep* next = sched.PopNext(plId, curItem, false, false);
+	for (int i=0; i<100000 && (next || loopsLeft>1 || pos<curEnd); i++)
+	{
+		now += _tick;
+		pos += _tick;
+		sched.Tick(now, 1.0);
+		if (pos < curEnd)
+			continue;
+
+		double overshoot = pos - curEnd, curPos = 0.0;
+		if (loopsLeft > 1)
+		{
+			loopsLeft--;
+			EnumMarkerRegionById(NULL, pl->Get(curItem)->m_rgnId, NULL, &curPos, &curEnd, NULL, NULL, NULL);
+		}
+		else if (next)
+		{
+			curItem = next->m_itemId;
+			loopsLeft = next->m_loops;
+			curPos = next->m_pos;
+			curEnd = next->m_end;
+		}
+		else
+			break;
+
+		// polled past the region end: the following seek could not be queued in time
+		pos = curPos + overshoot;
+		if (pos >= curEnd)
+		{
+			misses++;
+			pos = curEnd;
+		}
+		sched.OnTransition(pos, curPos, curEnd);
+		played.AppendFormatted(16, ",%d", curItem);
+		if (loopsLeft <= 1)
+			next = sched.PopNext(plId, curItem, false, false);
+	}
+
+	g_pls.Get()->Delete(plId, true);
+	for (int i=0; i<nbRgns; i++)
+		if (nums[i] >= 0)
+			DeleteProjectMarker(NULL, nums[i], true);
+
+	int transitions, atRisk;
+	double tickAvg;
+	sched.GetStats(&transitions, &atRisk, &tickAvg);
+	if (strcmp(played.Get(), "0,1,2,2,3"))
+		_failure->SetFormatted(256, "played items %s instead of 0,1,2,2,3", played.Get());
+	else if (transitions != 4)
+		_failure->SetFormatted(256, "%d transitions instead of 4", transitions);
+	else if (atRisk != 1)
+		_failure->SetFormatted(256, "%d regions at risk instead of 1", atRisk);
+	else if (misses > atRisk)
+		_failure->SetFormatted(256, "%d regions played past their end, only %d were at risk", misses, atRisk);
+	else if (fabs(tickAvg - _tick) > 0.001)
+		_failure->SetFormatted(256, "measured polling interval %.2f ms instead of %.2f ms", tickAvg*1000.0, _tick*1000.0);
+	return !_failure->GetLength();
+}
+
+static void RegionPlaylistBenchmark(const BR_BenchmarkConfig& _cfg, vector<BR_BenchmarkResult>& _results)
+{
+	BR_BenchmarkResult result("RegionPlaylistScheduler/simulated_clock", "Region Playlist scheduler test (simulated clock)");
+	if (g_playPlaylist >= 0)
+		result.failure.Set("a playlist is playing");
+	for (int i=0; i<_cfg.iterations && !result.failure.GetLength(); i++)
+	{
+		double start = time_precise();
+		RegionPlaylistSchedulerTest(0.02, &result.failure); // != SNM_CSURF_RUN_TICK_MS, the initial estimate
+		result.AddTime(start);
+	}
+	_results.push_back(result);
+}
+static BR_BenchmarkRegistration s_regionPlaylistBenchmark(RegionPlaylistBenchmark);
+#endif
+
+
+static void SeekStep(int _plId, const RgnPlaylistStep* _step, int _curItemId)
+{
+	g_playNext = _step->m_itemId;
+	g_playCur = _plId==g_playPlaylist ? g_playCur : _curItemId;
+	g_rgnLoop = _step->m_loops;
+	g_nextRgnPos = _step->m_pos;
+	g_nextRgnEnd = _step->m_end;
+	if (_curItemId<0) {
+		g_curRgnPos = 0.0;
+		g_curRgnEnd = -1.0;
+	}
+	SeekPlay(g_nextRgnPos);
+}
+
 bool SeekItem(int _plId, int _nextItemId, int _curItemId)
 {
 	if (RegionPlaylist* pl = g_pls.Get()->Get(_plId))
@@ -1364,19 +1614,13 @@ bool SeekItem(int _plId, int _nextItemId, int _curItemId)
 		}
 		else if (RgnPlaylistItem* next = pl->Get(_nextItemId))
 		{
-			double a, b;
-			if (EnumMarkerRegionById(NULL, next->m_rgnId, NULL, &a, &b, NULL, NULL, NULL)>=0)
+			RgnPlaylistStep step;
+			if (EnumMarkerRegionById(NULL, next->m_rgnId, NULL, &step.m_pos, &step.m_end, NULL, NULL, NULL)>=0)
 			{
-				g_playNext = _nextItemId;
-				g_playCur = _plId==g_playPlaylist ? g_playCur : _curItemId;
-				g_rgnLoop = next->m_cnt<0 ? -1 : next->m_cnt>1 ? next->m_cnt : 0;
-				g_nextRgnPos = a;
-				g_nextRgnEnd = b;
-				if (_curItemId<0) {
-					g_curRgnPos = 0.0;
-					g_curRgnEnd = -1.0;
-				}
-				SeekPlay(g_nextRgnPos);
+				step.m_itemId = _nextItemId;
+				step.m_rgnId = next->m_rgnId;
+				step.m_loops = next->m_cnt<0 ? -1 : next->m_cnt>1 ? next->m_cnt : 0;
+				SeekStep(_plId, &step, _curItemId);
 				return true;
 			}
 		}
@@ -1386,7 +1630,7 @@ bool SeekItem(int _plId, int _nextItemId, int _curItemId)
 
 // the meat!
 // polls the playing position and smooth seeks if needed
-// remember we always lookup one region ahead!
+// remember we always lookup one region ahead! (and plan a few more, see RegionPlaylistScheduler)
 // made as idle as possible, polled via SNM_CSurfRun()
 void PlaylistRun()
 {
@@ -1397,6 +1641,7 @@ void PlaylistRun()
 #endif
 		bool updated = false;
 		double pos = GetPlayPosition2Ex(NULL);
+		g_rgnplScheduler.Tick(time_precise(), Master_GetPlayRate(NULL));
 
 		// NF: potentially fix #886
 		// it seems that if '+0.01' isn't added to 'pos' below, adjacent regions are no more occasionally skipped
@@ -1431,6 +1676,7 @@ void PlaylistRun()
 					g_playCur = g_playNext;
 					g_curRgnPos = g_nextRgnPos;
 					g_curRgnEnd = g_nextRgnEnd;
+					g_rgnplScheduler.OnTransition(pos, g_curRgnPos, g_curRgnEnd);
 				}
 
 				// region loop?
@@ -1445,21 +1691,23 @@ void PlaylistRun()
 
 				if (!g_rgnLoop) // if, not else if!
 				{
-					int nextId = GetNextValidItem(g_playPlaylist, g_playCur, false, g_repeatPlaylist, g_shufflePlaylist);
+					// already planned (and resolved), usually
+					const RgnPlaylistStep* next = g_rgnplScheduler.PopNext(g_playPlaylist, g_playCur, g_repeatPlaylist, g_shufflePlaylist);
 
 					// loop corner cases
 					// ex: 1 item in the playlist + repeat on, or repeat on + last region == first region,
 					//     or playlist = region3, then unknown region (e.g. deleted) and region3 again, or etc..
-					if (nextId>=0)
+					if (next)
 						if (RegionPlaylist* pl = GetPlaylist(g_playPlaylist))
-							if (RgnPlaylistItem* next = pl->Get(nextId)) 
-								if (RgnPlaylistItem* cur = pl->Get(g_playCur)) 
-									g_plLoop = (cur->m_rgnId==next->m_rgnId); // valid regions at this point
+							if (RgnPlaylistItem* cur = pl->Get(g_playCur)) 
+								g_plLoop = (cur->m_rgnId==next->m_rgnId); // valid regions at this point
 
 #ifdef _SNM_RGNPL_DEBUG1
-					snprintf(dbg, sizeof(dbg), "SEEK - Current = %d, Next = %d\n", g_playCur, nextId); OutputDebugString(dbg);
+					snprintf(dbg, sizeof(dbg), "SEEK - Current = %d, Next = %d\n", g_playCur, next ? next->m_itemId : -1); OutputDebugString(dbg);
 #endif
-					if (!SeekItem(g_playPlaylist, nextId, g_playCur))
+					if (next)
+						SeekStep(g_playPlaylist, next, g_playCur);
+					else
 						SeekItem(g_playPlaylist, -1, g_playCur); // end of playlist..
 					updated = true;
 				}
@@ -1469,8 +1717,8 @@ void PlaylistRun()
 		else if (g_curRgnPos<g_curRgnEnd) // relevant vars?
 		{
 			// seek play requested, waiting for region switch..
-			if ((pos+0.01) >= g_curRgnPos && pos <= g_curRgnEnd) //JFB!! +0.01 because 'pos' can be a bit ahead of time
-																 // +1 sample block would be better, but no API..
+			if ((pos+g_rgnplScheduler.GetTolerance()) >= g_curRgnPos && pos <= g_curRgnEnd) //JFB!! +lookahead (0.01 by default) because 'pos' can be a bit ahead of time
+																							 // +1 sample block would be better, but no API..
 			{
 				// a bunch of calls end here!
 				g_unsync = false;
@@ -1484,6 +1732,7 @@ void PlaylistRun()
 				snprintf(dbg, sizeof(dbg), "                g_nextRgnPos = %f, g_nextRgnEnd = %f\n", g_nextRgnPos, g_nextRgnEnd); OutputDebugString(dbg);
 #endif
 				updated = g_unsync = true;
+				g_rgnplScheduler.OnSyncLoss();
 				int spareItemId = -1;
 				if (RegionPlaylist* pl = g_pls.Get()->Get(g_playPlaylist))
 					spareItemId = pl->IsInPlaylist(pos, g_repeatPlaylist, g_playCur>=0?g_playCur:0);
@@ -1600,6 +1849,10 @@ void PlaylistPlay(int _plId, int _itemId)
 			g_plLoop = false;
 			g_unsync = false;
 			g_lastRunPos = SNM_GetProjectLength()+1.0;
+			if (g_playPlaylist<0)
+				g_rgnplScheduler.Reset();
+			else
+				g_rgnplScheduler.Invalidate();
 			if (SeekItem(_plId, _itemId, g_playPlaylist==_plId ? g_playCur : -1))
 			{
 				g_playPlaylist = _plId; // enables PlaylistRun()
@@ -1693,6 +1946,8 @@ void PlaylistStopped(bool _pause)
 	if (g_playPlaylist>=0 && !_pause)
 	{
 		g_playPlaylist = -1;
+		g_rgnplScheduler.LogStats();
+		g_rgnplScheduler.Reset();
 
 		// restore options
 		if (g_oldSeekPref >= 0)
@@ -1722,6 +1977,7 @@ void PlaylistUnpaused() {
 // used when editing the playlist/regions while playing (required because we always look one region ahead)
 void PlaylistResync()
 {
+	g_rgnplScheduler.Invalidate();
 	if (RegionPlaylist* pl = GetPlaylist(g_playPlaylist))
 		if (RgnPlaylistItem* item = pl->Get(g_playCur))
 			SeekItem(g_playPlaylist, GetNextValidItem(g_playPlaylist, g_playCur, item->m_cnt<0 || item->m_cnt>1, g_repeatPlaylist, g_shufflePlaylist), g_playCur);
@@ -2059,10 +2315,28 @@ void PlaylistUpdateJob::Perform() {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// true if the last marker/region update concerns regions used in playlists
+// (or formatted times), added/removed/renumbered regions included
+static bool IsPlaylistRegionUpdate(const SNM_MarkerRegionDiff* _diff)
+{
+	if (!_diff || _diff->m_timeStrings)
+		return true;
+	for (int i=0; i < g_pls.Get()->GetSize(); i++)
+		if (RegionPlaylist* pl = g_pls.Get()->Get(i))
+			for (int j=0; j < pl->GetSize(); j++)
+				if (RgnPlaylistItem* item = pl->Get(j))
+					if (_diff->Contains(item->m_rgnId))
+						return true;
+	return false;
+}
+
 // ScheduledJob used because of multi-notifs
+// marker-only updates and updates of unused regions are ignored
 void PlaylistMarkerRegionListener::NotifyMarkerRegionUpdate(int _updateFlags) {
-	PlaylistResync();
-	ScheduledJob::Schedule(new PlaylistUpdateJob(SNM_SCHEDJOB_ASYNC_DELAY_OPT));
+	if ((_updateFlags&SNM_REGION_MASK) && IsPlaylistRegionUpdate(GetMarkerRegionDiff())) {
+		PlaylistResync();
+		ScheduledJob::Schedule(new PlaylistUpdateJob(SNM_SCHEDJOB_ASYNC_DELAY_OPT));
+	}
 }
 
 
@@ -2163,6 +2437,8 @@ int RegionPlaylistInit()
 	g_seekImmediate = GetPrivateProfileInt("RegionPlaylist", "SeekImmediate", 0, g_SNM_IniFn.Get());
 	g_shufflePlaylist = GetPrivateProfileInt("RegionPlaylist", "ShufflePlaylist", 0, g_SNM_IniFn.Get());
 	g_optionFlags = GetPrivateProfileInt("RegionPlaylist", "SeekPlay", 0, g_SNM_IniFn.Get());
+	g_rgnplScheduler.m_lookahead = BOUNDED(GetPrivateProfileInt("RegionPlaylist", "Lookahead", 10, g_SNM_IniFn.Get()), 0, 100) / 1000.0;
+	g_rgnplScheduler.m_logStats = (GetPrivateProfileInt("RegionPlaylist", "LogSchedulingStats", 0, g_SNM_IniFn.Get()) == 1);
 	GetPrivateProfileString("RegionPlaylist", "BigFontName", SNM_DYN_FONT_NAME, g_rgnplBigFontName, sizeof(g_rgnplBigFontName), g_SNM_IniFn.Get());
 	GetPrivateProfileString("RegionPlaylist", "OscFeedback", "", buf, sizeof(buf), g_SNM_IniFn.Get());
 	g_osc = LoadOscCSurfs(NULL, buf); // NULL on err (e.g. "", token doesn't exist, etc.)
@@ -2189,6 +2465,8 @@ void RegionPlaylistExit()
 		{ "SeekImmediate",   g_seekImmediate   },
 		{ "ShufflePlaylist", g_shufflePlaylist },
 		{ "SeekPlay",        g_optionFlags     },
+		{ "Lookahead",       int(g_rgnplScheduler.m_lookahead*1000.0 + 0.5) },
+		{ "LogSchedulingStats", g_rgnplScheduler.m_logStats },
 	};
 	for(const auto &pair : intOptions) {
 		snprintf(format, sizeof(format), "%d", pair.second);
@@ -71,6 +71,57 @@ public:
 	int m_editId; // edited playlist id
 };
 
+#define SNM_RGNPL_PLANNED_STEPS 4
+
+// a planned playlist transition, see RegionPlaylistScheduler
+struct RgnPlaylistStep {
+	int m_itemId, m_rgnId, m_loops; // m_loops: 0 not looping, <0 infinite loop, n>0 looping n times (as g_rgnLoop)
+	double m_pos, m_end;            // seek target & region end
+};
+
+// lookahead scheduler for PlaylistRun():
+// - plans the next transitions ahead of time (items, seek targets & loop counts
+//   are resolved when a region starts playing, not when its end is polled)
+// - estimates how far playback goes between two polls from the measured
+//   polling interval, the play rate and a configurable lookahead (S&M.ini):
+//   regions shorter than that are counted as at risk (only one smooth seek
+//   can be queued, their transition may not be polled in time)
+// - collects scheduling jitter stats (optionally logged when playback stops)
+// note: seeks are not issued from a predicted play position: REAPER only queues
+//       one smooth seek, relative to the playing region, so the next seek is
+//       still requested when the transition is polled. The lookahead is the
+//       sync tolerance of PlaylistRun() and widens the at risk window
+// note: time and positions are passed in, so that it can be driven by a simulated clock
+class RegionPlaylistScheduler {
+public:
+	RegionPlaylistScheduler() : m_lookahead(0.01), m_logStats(false) { Reset(); }
+	void Reset();
+	void Invalidate() { m_nbSteps = 0; }
+	void Tick(double _now, double _playRate);
+	double GetTolerance() const { return m_lookahead; }
+	const RgnPlaylistStep* PopNext(int _plId, int _curItemId, bool _repeat, bool _shuffle);
+	void OnTransition(double _pos, double _rgnPos, double _rgnEnd);
+	void OnSyncLoss() { m_syncLosses++; }
+	void LogStats();
+	void GetStats(int* _transitions, int* _atRisk, double* _tickAvg) const;
+
+	double m_lookahead; // in seconds
+	bool m_logStats;
+
+private:
+	bool PlanStep(int _plId, int _fromItemId, bool _repeat, bool _shuffle, RgnPlaylistStep* _stepOut);
+
+	RgnPlaylistStep m_steps[SNM_RGNPL_PLANNED_STEPS]; // planned transitions, m_steps[0] is the next one
+	RgnPlaylistStep m_popped;
+	int m_nbSteps;
+	int m_plId, m_fromItemId;              // m_steps[0] follows m_fromItemId in playlist m_plId
+	double m_lastTick, m_tickAvg, m_tickMax, m_pollWindow;
+
+	// jitter stats
+	int m_transitions, m_atRisk, m_syncLosses, m_ticks;
+	double m_latencySum, m_latencyMax, m_marginMin;
+};
+
 class RegionPlaylistView : public SWS_ListView {
 public:
 	RegionPlaylistView(HWND hwndList, HWND hwndEdit);
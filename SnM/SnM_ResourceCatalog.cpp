@@ -0,0 +1,547 @@
+/******************************************************************************
+/ SnM_ResourceCatalog.cpp
+/
+/ Copyright (c) 2026 and later SWS
+/
+/
+/ Permission is hereby granted, free of charge, to any person obtaining a copy
+/ of this software and associated documentation files (the "Software"), to deal
+/ in the Software without restriction, including without limitation the rights to
+/ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+/ of the Software, and to permit persons to whom the Software is furnished to
+/ do so, subject to the following conditions:
+/ 
+/ The above copyright notice and this permission notice shall be included in all
+/ copies or substantial portions of the Software.
+/ 
+/ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+/ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+/ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+/ HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+/ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/ OTHER DEALINGS IN THE SOFTWARE.
+/
+******************************************************************************/
+
+
+#include "stdafx.h"
+#include "SnM.h"
+#include "SnM_Resources.h"
+#include "SnM_ResourceCatalog.h"
+#include "SnM_Util.h"
+#include "../reaper/localize.h"
+#include "WDL/projectcontext.h"
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Resource catalog
+// A worker thread scans resource dirs (and files queued by the Resources
+// window), up-to-date files (same mtime and size) are not re-parsed. Files are
+// parsed line by line, looking only at plugin lines (1st sub-chunk after a
+// "BYPASS" line), "<TRACK" and "FILE" lines.
+// The catalog is persisted in S&M_ResourceCatalog.txt (resource path), scans
+// stats can be logged to the console with [ResourceCatalog]/LogStats=1 in S&M.ini
+///////////////////////////////////////////////////////////////////////////////
+
+#define SNM_RES_CATALOG_VERSION			1
+#define SNM_RES_CATALOG_SCAN_INTERVAL	30.0 // min. interval between 2 automatic scans of a dir, in s
+
+struct SNM_StriLess {
+	bool operator()(const std::string& _a, const std::string& _b) const { return _stricmp(_a.c_str(), _b.c_str()) < 0; }
+};
+
+class SNM_ResourceCatalog
+{
+public:
+	SNM_ResourceCatalog() : m_thread(NULL), m_running(false), m_exit(false), m_loaded(false), m_dirty(false), m_logStats(false), m_generation(0), m_notified(0) {}
+
+	void Init() {
+		m_fn.SetFormatted(SNM_MAX_PATH, SNM_RES_CATALOG_FILE, GetResourcePath());
+		m_logStats = (GetPrivateProfileInt("ResourceCatalog", "LogStats", 0, g_SNM_IniFn.Get()) == 1); // read here, used by the worker thread
+	}
+
+	// scans _dir asynchronously, at most every SNM_RES_CATALOG_SCAN_INTERVAL s unless _force is true
+	void ScanDir(const char* _dir, const char* _fileFilter, bool _force)
+	{
+		if (!_dir || !*_dir || !_fileFilter)
+			return;
+
+		SWS_SectionLock lock(&m_mutex);
+		if (m_exit)
+			return;
+
+		Dir* d = NULL;
+		for (int i=0; !d && i < m_dirs.GetSize(); i++)
+			if (!_stricmp(m_dirs.Get(i)->m_path.Get(), _dir) && !strcmp(m_dirs.Get(i)->m_filter.Get(), _fileFilter))
+				d = m_dirs.Get(i);
+		if (!d)
+			d = m_dirs.Add(new Dir(_dir, _fileFilter));
+
+		const double now = time_precise();
+		if (d->m_pending || (!_force && d->m_lastScan > 0.0 && now - d->m_lastScan < SNM_RES_CATALOG_SCAN_INTERVAL))
+			return;
+		d->m_pending = true;
+		d->m_lastScan = now;
+		Start();
+	}
+
+	// (re)parses _fn asynchronously, if it was modified
+	void AddFile(const char* _fn)
+	{
+		if (!_fn || !*_fn)
+			return;
+
+		SWS_SectionLock lock(&m_mutex);
+		if (m_exit)
+			return;
+		m_files.insert(_fn);
+		Start();
+	}
+
+	// returns false if _fn does not contain _fxName or if it is not cataloged yet (it is queued then)
+	bool MatchFX(const char* _fn, const char* _fxName)
+	{
+		{
+			SWS_SectionLock lock(&m_mutex);
+			std::map<std::string,Entry*,SNM_StriLess>::iterator it = m_entries.find(_fn);
+			if (it != m_entries.end())
+				return (stristr(it->second->m_fx.Get(), _fxName) != NULL);
+		}
+		AddFile(_fn);
+		return false;
+	}
+
+	bool GetInfo(const char* _fn, char* _bufOut, int _bufOutSz)
+	{
+		{
+			SWS_SectionLock lock(&m_mutex);
+			std::map<std::string,Entry*,SNM_StriLess>::iterator it = m_entries.find(_fn);
+			if (it != m_entries.end())
+			{
+				Entry* e = it->second;
+				snprintf(_bufOut, _bufOutSz, __LOCALIZE_VERFMT("FX: %d (instruments: %d), tracks: %d, media files: %d, size: %.1f KB\n%s","sws_DLG_150"), 
+					e->m_fxCount, e->m_instruments, e->m_trackCount, e->m_mediaCount, e->m_size/1024.0, e->m_fx.Get());
+				return true;
+			}
+		}
+		AddFile(_fn);
+		return false;
+	}
+
+	// main thread: logs stats and refreshes the Resources window if the catalog has been updated
+	void Run()
+	{
+		int gen;
+		WDL_FastString stats;
+		{
+			SWS_SectionLock lock(&m_mutex);
+			gen = m_generation;
+			if (m_stats.GetLength())
+			{
+				stats.Set(&m_stats);
+				m_stats.Set("");
+			}
+		}
+		if (stats.GetLength())
+			ShowConsoleMsg(stats.Get());
+		if (gen != m_notified)
+		{
+			m_notified = gen;
+			ResourcesUpdate();
+		}
+	}
+
+	void Exit()
+	{
+		{
+			SWS_SectionLock lock(&m_mutex);
+			m_exit = true;
+		}
+		if (m_thread)
+		{
+			WaitForSingleObject(m_thread, INFINITE);
+			CloseHandle(m_thread);
+			m_thread = NULL;
+		}
+		Save();
+
+		SWS_SectionLock lock(&m_mutex);
+		for (std::map<std::string,Entry*,SNM_StriLess>::iterator it=m_entries.begin(); it!=m_entries.end(); ++it)
+			delete it->second;
+		m_entries.clear();
+		m_dirs.Empty(true);
+	}
+
+private:
+	struct Entry
+	{
+		Entry(time_t _mtime, WDL_INT64 _size) : m_mtime(_mtime), m_size(_size), m_fxCount(0), m_instruments(0), m_trackCount(0), m_mediaCount(0) {}
+		void AddFX(const char* _name)
+		{
+			m_fx.Append(_name);
+			m_fx.Append("\n");
+			m_fxCount++;
+			const char* p = strstr(_name, ": "); // "VSTi: ", "VST3i: ", "AUi: ", etc..
+			if (p && p > _name && p[-1] == 'i')
+				m_instruments++;
+		}
+		void AddMedia(const char* _fn)
+		{
+			for (const char* p = stristr(m_media.Get(), _fn); p; p = stristr(p+1, _fn))
+				if ((p == m_media.Get() || p[-1] == '\n') && p[strlen(_fn)] == '\n')
+					return;
+			m_media.Append(_fn);
+			m_media.Append("\n");
+			m_mediaCount++;
+		}
+		time_t m_mtime;
+		WDL_INT64 m_size;
+		int m_fxCount, m_instruments, m_trackCount, m_mediaCount;
+		WDL_FastString m_fx, m_media; // one name/file per line
+	};
+
+	struct Dir
+	{
+		Dir(const char* _path, const char* _filter) : m_path(_path), m_filter(_filter), m_lastScan(0.0), m_pending(false) {}
+		WDL_FastString m_path, m_filter;
+		double m_lastScan;
+		bool m_pending;
+	};
+
+	// lock must be held
+	void Start()
+	{
+		if (!m_running)
+		{
+			if (m_thread) CloseHandle(m_thread);
+			m_running = true;
+			m_thread = (HANDLE)_beginthreadex(NULL, 0, ScanThread, (void*)this, 0, NULL);
+		}
+	}
+
+	bool IsExiting()
+	{
+		SWS_SectionLock lock(&m_mutex);
+		return m_exit;
+	}
+
+	// lock must be held, takes ownership of _e
+	void SetEntry(const char* _fn, Entry* _e)
+	{
+		std::map<std::string,Entry*,SNM_StriLess>::iterator it = m_entries.find(_fn);
+		if (it != m_entries.end())
+		{
+			delete it->second;
+			it->second = _e;
+		}
+		else
+			m_entries[_fn] = _e;
+	}
+
+	static bool IsToken(const char* _line, const char* _token, int _len) {
+		return (!strncmp(_line, _token, _len) && (!_line[_len] || _line[_len]==' ' || _line[_len]=='\r' || _line[_len]=='\n'));
+	}
+
+	static bool ParseFile(const char* _fn, Entry* _e)
+	{
+		FILE* f = fopenUTF8(_fn, "r");
+		if (!f)
+			return false;
+
+		char line[SNM_MAX_CHUNK_LINE_LENGTH];
+		bool bol = true, bypass = false;
+		WDL_FastString name;
+		while (fgets(line, sizeof(line), f))
+		{
+			// lines longer than the buffer are read in several parts, skip the next ones
+			const bool startOfLine = bol;
+			const size_t len = strlen(line);
+			bol = (len && line[len-1] == '\n');
+			if (!startOfLine)
+				continue;
+
+			const char* p = line;
+			while (*p == ' ' || *p == '\t') p++;
+			if (!*p || *p == '\n' || *p == '\r')
+				continue;
+
+			if (bypass && *p == '<')
+			{
+				// plugin: "<VST "VST: ReaEQ (Cockos)" reaeq.dll ..", "<JS utility/volume """, etc..
+				LineParser lp(false);
+				if (!lp.parse(p) && lp.getnumtokens() >= 2)
+				{
+					if (strstr(lp.gettoken_str(1), ": ")) name.Set(lp.gettoken_str(1));
+					else name.SetFormatted(SNM_MAX_FX_NAME_LEN, "%s: %s", lp.gettoken_str(0)+1, lp.gettoken_str(1));
+					_e->AddFX(name.Get());
+				}
+			}
+			bypass = IsToken(p, "BYPASS", 6);
+
+			if (IsToken(p, "<TRACK", 6))
+				_e->m_trackCount++;
+			else if (IsToken(p, "FILE", 4))
+			{
+				LineParser lp(false);
+				if (!lp.parse(p) && lp.getnumtokens() >= 2 && *lp.gettoken_str(1))
+					_e->AddMedia(lp.gettoken_str(1));
+			}
+		}
+		fclose(f);
+		return true;
+	}
+
+	// worker thread
+	void Load()
+	{
+		FILE* f = fopenUTF8(m_fn.Get(), "r");
+		if (!f)
+			return;
+
+		char line[SNM_MAX_CHUNK_LINE_LENGTH];
+		LineParser lp(false);
+		WDL_FastString fn;
+		Entry* e = NULL;
+		bool ok = (fgets(line, sizeof(line), f) && !lp.parse(line) && 
+			!strcmp(lp.gettoken_str(0), "SNM_RESCATALOG") && lp.gettoken_int(1) == SNM_RES_CATALOG_VERSION);
+		while (ok && fgets(line, sizeof(line), f))
+		{
+			if (lp.parse(line) || lp.getnumtokens() < 2)
+				continue;
+			const char* tok = lp.gettoken_str(0);
+			if (!strcmp(tok, "FILE") && lp.getnumtokens() >= 6)
+			{
+				if (e)
+				{
+					SWS_SectionLock lock(&m_mutex);
+					SetEntry(fn.Get(), e);
+				}
+				fn.Set(lp.gettoken_str(1));
+				e = new Entry((time_t)atoll(lp.gettoken_str(2)), (WDL_INT64)atoll(lp.gettoken_str(3)));
+				e->m_trackCount = lp.gettoken_int(4);
+				// token 5: nb of FX, recounted
+			}
+			else if (e && !strcmp(tok, "FX"))
+				e->AddFX(lp.gettoken_str(1));
+			else if (e && !strcmp(tok, "MEDIA"))
+				e->AddMedia(lp.gettoken_str(1));
+		}
+		if (e)
+		{
+			SWS_SectionLock lock(&m_mutex);
+			SetEntry(fn.Get(), e);
+		}
+		fclose(f);
+	}
+
+	// the catalog is formatted under lock, written without
+	void Save()
+	{
+		WDL_FastString str, esc;
+		{
+			SWS_SectionLock lock(&m_mutex);
+			if (!m_dirty)
+				return;
+			m_dirty = false;
+
+			str.SetFormatted(64, "SNM_RESCATALOG %d\n", SNM_RES_CATALOG_VERSION);
+			for (std::map<std::string,Entry*,SNM_StriLess>::iterator it=m_entries.begin(); it!=m_entries.end(); ++it)
+			{
+				Entry* e = it->second;
+				makeEscapedConfigString(it->first.c_str(), &esc);
+				str.AppendFormatted(SNM_MAX_PATH+128, "FILE %s %lld %lld %d %d\n", esc.Get(), (long long)e->m_mtime, (long long)e->m_size, e->m_trackCount, e->m_fxCount);
+				AppendLines(&str, "FX", &e->m_fx, &esc);
+				AppendLines(&str, "MEDIA", &e->m_media, &esc);
+			}
+		}
+
+		if (FILE* f = fopenUTF8(m_fn.Get(), "w"))
+		{
+			fwrite(str.Get(), 1, str.GetLength(), f);
+			fclose(f);
+		}
+	}
+
+	static void AppendLines(WDL_FastString* _str, const char* _keyword, WDL_FastString* _lines, WDL_FastString* _esc)
+	{
+		const char* p = _lines->Get();
+		while (const char* eol = strchr(p, '\n'))
+		{
+			WDL_FastString line;
+			line.Set(p, (int)(eol-p));
+			makeEscapedConfigString(line.Get(), _esc);
+			_str->AppendFormatted(SNM_MAX_PATH+32, "%s %s\n", _keyword, _esc->Get());
+			p = eol+1;
+		}
+	}
+
+	static bool MatchFilter(const char* _fn, const char* _filter)
+	{
+		char ext[64];
+		snprintf(ext, sizeof(ext), "*.%s", GetFileExtension(_fn));
+		return (stristr(_filter, ext) != NULL);
+	}
+
+	static unsigned WINAPI ScanThread(void* _catalog)
+	{
+		SNM_ResourceCatalog* cat = (SNM_ResourceCatalog*)_catalog;
+		if (!cat->m_loaded)
+		{
+			cat->m_loaded = true; // only accessed by this thread
+			cat->Load();
+
+			SWS_SectionLock lock(&cat->m_mutex);
+			if (!cat->m_entries.empty())
+				cat->m_generation++;
+		}
+
+		for (;;)
+		{
+			// next job: a dir to scan or queued files
+			WDL_FastString dir, filter;
+			WDL_PtrList_DeleteOnDestroy<WDL_String> files;
+			{
+				SWS_SectionLock lock(&cat->m_mutex);
+				if (!cat->m_exit)
+				{
+					for (int i=0; !dir.GetLength() && i < cat->m_dirs.GetSize(); i++)
+					{
+						Dir* d = cat->m_dirs.Get(i);
+						if (d->m_pending)
+						{
+							d->m_pending = false;
+							dir.Set(&d->m_path);
+							filter.Set(&d->m_filter);
+						}
+					}
+					if (!dir.GetLength())
+					{
+						for (std::set<std::string,SNM_StriLess>::iterator it=cat->m_files.begin(); it!=cat->m_files.end(); ++it)
+							files.Add(new WDL_String(it->c_str()));
+						cat->m_files.clear();
+					}
+				}
+				if (cat->m_exit || (!dir.GetLength() && !files.GetSize()))
+				{
+					cat->m_running = false;
+					return 0;
+				}
+			}
+
+			const double t0 = time_precise();
+			if (dir.GetLength())
+				ScanFiles(&files, dir.Get(), filter.Get(), true);
+
+			int parsed=0, upToDate=0, removed=0;
+			std::set<std::string,SNM_StriLess> seen;
+			for (int i=0; i < files.GetSize() && !cat->IsExiting(); i++)
+			{
+				const char* fn = files.Get(i)->Get();
+				time_t mtime=0;
+				WDL_INT64 size=0;
+				if (!GetFileModTime(fn, &mtime, &size))
+					continue;
+				seen.insert(fn);
+
+				{
+					SWS_SectionLock lock(&cat->m_mutex);
+					std::map<std::string,Entry*,SNM_StriLess>::iterator it = cat->m_entries.find(fn);
+					if (it != cat->m_entries.end() && it->second->m_mtime == mtime && it->second->m_size == size)
+					{
+						upToDate++;
+						continue;
+					}
+				}
+
+				Entry* e = new Entry(mtime, size);
+				if (ParseFile(fn, e))
+				{
+					SWS_SectionLock lock(&cat->m_mutex);
+					cat->SetEntry(fn, e);
+					cat->m_dirty = true;
+					parsed++;
+				}
+				else
+					delete e;
+			}
+
+			// dir scans: remove deleted files
+			if (dir.GetLength() && !cat->IsExiting())
+			{
+				SWS_SectionLock lock(&cat->m_mutex);
+				const int dirLen = dir.GetLength();
+				std::map<std::string,Entry*,SNM_StriLess>::iterator it = cat->m_entries.begin();
+				while (it != cat->m_entries.end())
+				{
+					const char* fn = it->first.c_str();
+					if (!_strnicmp(fn, dir.Get(), dirLen) && (fn[dirLen] == '/' || fn[dirLen] == '\\') &&
+						MatchFilter(fn, filter.Get()) && seen.find(it->first) == seen.end())
+					{
+						delete it->second;
+						cat->m_entries.erase(it++);
+						removed++;
+					}
+					else
+						++it;
+				}
+				if (removed)
+					cat->m_dirty = true;
+			}
+
+			{
+				SWS_SectionLock lock(&cat->m_mutex);
+				if (parsed || removed)
+					cat->m_generation++;
+				if (cat->m_logStats)
+					cat->m_stats.AppendFormatted(SNM_MAX_PATH+256, "S&M resource catalog: %s - %d files (%d parsed, %d up to date, %d removed) in %.2f ms, %d files cataloged\n",
+						dir.GetLength() ? dir.Get() : "queued files", files.GetSize(), parsed, upToDate, removed, (time_precise()-t0)*1000.0, (int)cat->m_entries.size());
+			}
+			cat->Save(); // no-op if not dirty
+		}
+	}
+
+	SWS_Mutex m_mutex;
+	std::map<std::string,Entry*,SNM_StriLess> m_entries; // full paths -> file infos
+	std::set<std::string,SNM_StriLess> m_files; // queued files
+	WDL_PtrList<Dir> m_dirs;
+	WDL_FastString m_fn, m_stats;
+	HANDLE m_thread;
+	bool m_running, m_exit, m_loaded, m_dirty, m_logStats;
+	int m_generation, m_notified;
+};
+
+SNM_ResourceCatalog g_resCatalog;
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+void ResourceCatalogScanDir(const char* _dir, const char* _fileFilter, bool _force) {
+	g_resCatalog.ScanDir(_dir, _fileFilter, _force);
+}
+
+void ResourceCatalogAddFile(const char* _fn) {
+	g_resCatalog.AddFile(_fn);
+}
+
+bool ResourceCatalogMatchFX(const char* _fn, const char* _fxName) {
+	return g_resCatalog.MatchFX(_fn, _fxName);
+}
+
+bool ResourceCatalogGetInfo(const char* _fn, char* _bufOut, int _bufOutSz) {
+	return g_resCatalog.GetInfo(_fn, _bufOut, _bufOutSz);
+}
+
+// polled from the main thread via SNM_CSurfRun()
+void ResourceCatalogRun() {
+	g_resCatalog.Run();
+}
+
+void ResourceCatalogInit() {
+	g_resCatalog.Init();
+}
+
+void ResourceCatalogExit() {
+	g_resCatalog.Exit();
+}
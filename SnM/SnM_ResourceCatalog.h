@@ -0,0 +1,46 @@
+/******************************************************************************
+/ SnM_ResourceCatalog.h
+/
+/ Copyright (c) 2026 and later SWS
+/
+/
+/ Permission is hereby granted, free of charge, to any person obtaining a copy
+/ of this software and associated documentation files (the "Software"), to deal
+/ in the Software without restriction, including without limitation the rights to
+/ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+/ of the Software, and to permit persons to whom the Software is furnished to
+/ do so, subject to the following conditions:
+/ 
+/ The above copyright notice and this permission notice shall be included in all
+/ copies or substantial portions of the Software.
+/ 
+/ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+/ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+/ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+/ HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+/ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/ OTHER DEALINGS IN THE SOFTWARE.
+/
+******************************************************************************/
+
+
+//#pragma once
+
+#ifndef _SNM_RESOURCECATALOG_H_
+#define _SNM_RESOURCECATALOG_H_
+
+
+// background catalog of FX chain and track template files:
+// plugins, FX/track counts, media files and file sizes are extracted once per
+// file version (a worker thread scans/parses files) and persisted across sessions
+void ResourceCatalogScanDir(const char* _dir, const char* _fileFilter, bool _force = false);
+void ResourceCatalogAddFile(const char* _fn);
+bool ResourceCatalogMatchFX(const char* _fn, const char* _fxName);
+bool ResourceCatalogGetInfo(const char* _fn, char* _bufOut, int _bufOutSz);
+void ResourceCatalogRun();
+void ResourceCatalogInit();
+void ResourceCatalogExit();
+
+#endif
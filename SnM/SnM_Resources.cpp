@@ -37,6 +37,7 @@
 #include "SnM_FXChain.h"
 #include "SnM_Item.h"
 #include "SnM_Project.h"
+#include "SnM_ResourceCatalog.h"
 #include "SnM_Resources.h"
 #include "SnM_Track.h"
 #include "SnM_Util.h"
@@ -81,6 +82,7 @@ enum {
   FILTER_BY_NAME_MSG,
   FILTER_BY_PATH_MSG,
   FILTER_BY_COMMENT_MSG,
+  FILTER_BY_FX_MSG,
   RENAME_MSG,
   TIE_ACTIONS_MSG,
   TIE_PROJECT_MSG,
@@ -214,7 +216,7 @@ int g_resType = -1; // current type (user selection)
 int g_tiedSlotActions[SNM_NUM_DEFAULT_SLOTS]; // slot actions of default type/idx are tied to type/value
 int g_dblClickPrefs[SNM_MAX_SLOT_TYPES];
 WDL_FastString g_filter; // see init + localization in ResourcesInit()
-int g_filterPref = 1; // bitmask: &1 = filter by name, &2 = filter by path, &4 = filter by comment
+int g_filterPref = 1; // bitmask: &1 = filter by name, &2 = filter by path, &4 = filter by comment, &8 = filter by FX (FX chains, track templates)
 WDL_PtrList_DOD<WDL_FastString> g_autoSaveDirs;
 WDL_PtrList_DOD<WDL_FastString> g_autoFillDirs;
 WDL_PtrList_DOD<WDL_FastString> g_tiedProjects;
@@ -284,6 +286,26 @@ bool IsMultiType(int _type = -1)
 	return false;
 }
 
+// FX chain and track template files are cataloged (plugins, nb of tracks, etc..)
+bool IsCatalogType(int _typeForUser) {
+	return (_typeForUser == SNM_SLOT_FXC || _typeForUser == SNM_SLOT_TR);
+}
+
+// (re)scans default resource and auto-fill dirs of _type, throttled by the catalog
+void ScanCatalogDirs(int _type = -1)
+{
+	if (_type < 0) _type = g_resType;
+	if (!IsCatalogType(GetTypeForUser(_type)))
+		return;
+
+	char dir[SNM_MAX_PATH]="", fileFilter[2048]="";
+	g_SNM_ResSlots.Get(_type)->GetFileFilter(fileFilter, sizeof(fileFilter), false);
+	snprintf(dir, sizeof(dir), "%s%c%s", GetResourcePath(), PATH_SLASH_CHAR, g_SNM_ResSlots.Get(_type)->GetResourceDir());
+	ResourceCatalogScanDir(dir, fileFilter);
+	if (*GetAutoFillDir(_type) && _stricmp(dir, GetAutoFillDir(_type)))
+		ResourceCatalogScanDir(GetAutoFillDir(_type), fileFilter);
+}
+
 void GetIniSectionName(int _type, char* _bufOut, size_t _bufOutSz)
 {
 	if (_type >= SNM_NUM_DEFAULT_SLOTS)
@@ -595,8 +617,28 @@ static SWS_LVColumn s_resListCols[] = { {65,2,"Slot"}, {100,1,"Name"}, {250,2,"P
 // !WANT_LOCALIZE_STRINGS_END
 
 ResourcesView::ResourcesView(HWND hwndList, HWND hwndEdit)
-	: SWS_ListView(hwndList, hwndEdit, COL_COUNT, s_resListCols, "ResourcesViewState", false, "sws_DLG_150")
+	: SWS_ListView(hwndList, hwndEdit, COL_COUNT, s_resListCols, "ResourcesViewState", true, "sws_DLG_150")
+{
+}
+
+// FX chains, track templates only: other types have no per-row tooltip work on refresh
+bool ResourcesView::HasItemTooltips()
+{
+	return IsCatalogType(GetTypeForUser());
+}
+
+// FX chains, track templates: cataloged info
+void ResourcesView::GetItemTooltip(SWS_ListItem* item, char* str, int iStrMax)
 {
+	*str = '\0';
+	ResourceList* fl = g_SNM_ResSlots.Get(g_resType);
+	ResourceItem* pItem = (ResourceItem*)item;
+	if (fl && pItem && !pItem->IsDefault())
+	{
+		char fn[SNM_MAX_PATH] = "";
+		if (fl->GetFullPath(fl->Find(pItem), fn, sizeof(fn)) && !ResourceCatalogGetInfo(fn, str, iStrMax))
+			*str = '\0';
+	}
 }
 
 void ResourcesView::GetItemText(SWS_ListItem* item, int iCol, char* str, int iStrMax)
@@ -731,9 +773,12 @@ void ResourcesView::GetItemList(SWS_ListItemList* pList)
 	if (!fl)
 		return;
 
+	ScanCatalogDirs();
+
 	if (IsFiltered())
 	{
 		char buf[SNM_MAX_PATH] = "";
+		const bool filterFX = ((g_filterPref&8) && IsCatalogType(GetTypeForUser()));
 		LineParser lp(false);
 		if (!lp.parse(g_filter.Get()))
 		{
@@ -759,6 +804,11 @@ void ResourcesView::GetItemList(SWS_ListItemList* pList)
 						}
 						if (!match && (g_filterPref&4)) // comment
 							match |= (stristr(item->m_comment.Get(), lp.gettoken_str(j)) != NULL);
+						if (!match && filterFX && !item->IsDefault()) // contained FX (not-yet cataloged files are queued)
+						{
+							if (fl->GetFullPath(i, buf, sizeof(buf)))
+								match |= ResourceCatalogMatchFX(buf, lp.gettoken_str(j));
+						}
 					}
 					if (match)
 						pList->Add((SWS_ListItem*)item);
@@ -1402,23 +1452,28 @@ void ResourcesWnd::OnCommand(WPARAM wParam, LPARAM lParam)
 			break;
 		// text filter mode
 		case FILTER_BY_NAME_MSG:
-			if (g_filterPref&1) g_filterPref &= 6; // 110
+			if (g_filterPref&1) g_filterPref &= 14; // 1110
 			else g_filterPref |= 1;
 			Update();
 //			SetFocus(GetDlgItem(m_hwnd, IDC_FILTER));
 			break;
 		case FILTER_BY_PATH_MSG:
-			if (g_filterPref&2) g_filterPref &= 5; // 101
+			if (g_filterPref&2) g_filterPref &= 13; // 1101
 			else g_filterPref |= 2;
 			Update();
 //			SetFocus(GetDlgItem(m_hwnd, IDC_FILTER));
 			break;
 		case FILTER_BY_COMMENT_MSG:
-			if (g_filterPref&4) g_filterPref &= 3; // 011
+			if (g_filterPref&4) g_filterPref &= 11; // 1011
 			else g_filterPref |= 4;
 			Update();
 //			SetFocus(GetDlgItem(m_hwnd, IDC_FILTER));
 			break;
+		case FILTER_BY_FX_MSG:
+			if (g_filterPref&8) g_filterPref &= 7; // 0111
+			else g_filterPref |= 8;
+			Update();
+			break;
 		case RENAME_MSG:
 			if (item)
 			{
@@ -1918,6 +1973,8 @@ HMENU ResourcesWnd::OnContextMenu(int _x, int _y, bool* _wantDefaultItems)
 		AddToMenu(hFilterSubMenu, __LOCALIZE("Name","sws_DLG_150"), FILTER_BY_NAME_MSG, -1, false, (g_filterPref&1) ? MFS_CHECKED : MFS_UNCHECKED);
 		AddToMenu(hFilterSubMenu, __LOCALIZE("Path","sws_DLG_150"), FILTER_BY_PATH_MSG, -1, false, (g_filterPref&2) ? MFS_CHECKED : MFS_UNCHECKED);
 		AddToMenu(hFilterSubMenu, __LOCALIZE("Comment","sws_DLG_150"), FILTER_BY_COMMENT_MSG, -1, false, (g_filterPref&4) ? MFS_CHECKED : MFS_UNCHECKED);
+		if (IsCatalogType(typeForUser))
+			AddToMenu(hFilterSubMenu, __LOCALIZE("FX","sws_DLG_150"), FILTER_BY_FX_MSG, -1, false, (g_filterPref&8) ? MFS_CHECKED : MFS_UNCHECKED);
 	}
 	return hMenu;
 }
@@ -2429,6 +2486,8 @@ bool AutoSaveSlot(int _type, const char* _dirPath,
 			}
 		}
 	}
+	if (saved && IsCatalogType(GetTypeForUser(_type)))
+		ResourceCatalogAddFile(fn);
 	return saved;
 }
 
@@ -3279,6 +3338,9 @@ int ResourcesInit()
 		}
 	}
 
+	// background catalog of fx chains & track templates (before the window, can trigger scans)
+	ResourceCatalogInit();
+
 	// instanciate the window if needed, can be NULL
 	g_resWndMgr.Init();
 
@@ -3384,6 +3446,7 @@ void ResourcesExit()
 	}
 
 	g_resWndMgr.Delete();
+	ResourceCatalogExit();
 }
 
 void OpenResources(COMMAND_T* _ct)
@@ -4087,10 +4150,29 @@ void LoadOrSelectNextPreviousProjectTabSlot(COMMAND_T* _ct) {
 // Media file slots
 ///////////////////////////////////////////////////////////////////////////////
 
+// prefetch the next media file of the list, likely to be played next
+void PrefetchNextMediaSlot(int _slotType, int _slot)
+{
+	if (ResourceList* fl = g_SNM_ResSlots.Get(_slotType))
+	{
+		for (int i=_slot+1; i < fl->GetSize(); i++)
+		{
+			if (!fl->Get(i)->IsDefault())
+			{
+				char fn[SNM_MAX_PATH]="";
+				if (fl->GetFullPath(i, fn, sizeof(fn)))
+					SNM_PrefetchTrackPreview(fn);
+				break;
+			}
+		}
+	}
+}
+
 // undo does not make sense here: _title ignored
 void PlaySelTrackMediaSlot(int _slotType, const char* _title, int _slot, bool _pause, bool _loop, double _msi) {
 	if (WDL_FastString* fnStr = GetOrPromptOrBrowseSlot(_slotType, &_slot)) {
 		SNM_PlaySelTrackPreviews(fnStr->Get(), _pause, _loop, _msi);
+		PrefetchNextMediaSlot(_slotType, _slot);
 		delete fnStr;
 	}
 }
@@ -4117,6 +4199,7 @@ bool TogglePlaySelTrackMediaSlot(int _slotType, const char* _title, int _slot, b
 	bool done = false;
 	if (WDL_FastString* fnStr = GetOrPromptOrBrowseSlot(_slotType, &_slot)) {
 		done = SNM_TogglePlaySelTrackPreviews(fnStr->Get(), _pause, _loop, _msi);
+		PrefetchNextMediaSlot(_slotType, _slot);
 		delete fnStr;
 	}
 	return done;
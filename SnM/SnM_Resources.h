@@ -112,6 +112,8 @@ public:
 	void Perform(int _what);
 protected:
 	void GetItemText(SWS_ListItem* item, int iCol, char* str, int iStrMax);
+	void GetItemTooltip(SWS_ListItem* item, char* str, int iStrMax);
+	bool HasItemTooltips();
 	bool IsEditListItemAllowed(SWS_ListItem* item, int iCol);
 	void SetItemText(SWS_ListItem* item, int iCol, const char* str);
 	void OnItemDblClk(SWS_ListItem* item, int iCol);
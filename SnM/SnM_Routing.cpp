@@ -34,6 +34,196 @@
 #include "../reaper/localize.h"
 
 
+///////////////////////////////////////////////////////////////////////////////
+// SNM_RoutingEngine
+// Note: routings are handled on the send side (category 0) only
+///////////////////////////////////////////////////////////////////////////////
+
+SNM_RoutingEngine::~SNM_RoutingEngine()
+{
+	for (std::map<MediaTrack*,WDL_PtrList<Send>*>::iterator it=m_sends.begin(); it!=m_sends.end(); ++it)
+	{
+		it->second->Empty(true);
+		delete it->second;
+	}
+}
+
+MediaTrack* SNM_RoutingEngine::GetTrack(const GUID* _g)
+{
+	if (m_tracks.empty())
+		for (int i=1; i <= GetNumTracks(); i++) // skip master
+			if (MediaTrack* tr = CSurf_TrackFromID(i, false))
+				m_tracks[*TrackToGuid(tr)] = tr;
+	std::map<GUID,MediaTrack*,GuidLess>::iterator it = m_tracks.find(*_g);
+	return it!=m_tracks.end() ? it->second : NULL;
+}
+
+// current sends of _src, captured once
+WDL_PtrList<SNM_RoutingEngine::Send>* SNM_RoutingEngine::GetSends(MediaTrack* _src)
+{
+	WDL_PtrList<Send>*& sends = m_sends[_src];
+	if (!sends)
+	{
+		sends = new WDL_PtrList<Send>;
+		const int cnt = GetTrackNumSends(_src, 0);
+		for (int i=0; i<cnt; i++)
+		{
+			Send* snd = new Send;
+			snd->m_dest = (MediaTrack*)GetSetTrackSendInfo(_src, 0, i, "P_DESTTRACK", NULL);
+			snd->m_idx = i;
+			snd->m_io.FillIOFromReaper(_src, snd->m_dest, 0, i);
+			snd->m_update = -1;
+			snd->m_matched = snd->m_delete = false;
+			sends->Add(snd);
+		}
+	}
+	return sends;
+}
+
+// _send: true to add _io as a send of _tr, false to add it as a receive of _tr
+void SNM_RoutingEngine::AddSendReceive(bool _send, MediaTrack* _tr, SNM_SndRcv* _io)
+{
+	if (MediaTrack* tr = _io ? GetTrack(_send ? &_io->m_dest : &_io->m_src) : NULL)
+		if (tr != _tr)
+		{
+			Wanted w;
+			w.m_src = _send ? _tr : tr;
+			w.m_dest = _send ? tr : _tr;
+			w.m_io = _io;
+			m_wanted.Add(w);
+		}
+}
+
+// _cur: current params or NULL for a new send, returns true if something has been updated
+bool SNM_RoutingEngine::SetSendParams(MediaTrack* _src, int _idx, SNM_SndRcv* _cur, SNM_SndRcv* _io)
+{
+	bool updated = false;
+#define SET_SEND_PARAM(member, parm, type) \
+	if (!_cur || _cur->member != _io->member) { type v=(type)_io->member; GetSetTrackSendInfo(_src, 0, _idx, parm, &v); updated=true; }
+	SET_SEND_PARAM(m_mode, "I_SENDMODE", int)
+	SET_SEND_PARAM(m_vol, "D_VOL", double)
+	SET_SEND_PARAM(m_pan, "D_PAN", double)
+	SET_SEND_PARAM(m_panl, "D_PANLAW", double)
+	SET_SEND_PARAM(m_mute, "B_MUTE", bool)
+	SET_SEND_PARAM(m_mono, "B_MONO", bool)
+	SET_SEND_PARAM(m_phase, "B_PHASE", bool)
+	SET_SEND_PARAM(m_srcChan, "I_SRCCHAN", int)
+	SET_SEND_PARAM(m_destChan, "I_DSTCHAN", int)
+	SET_SEND_PARAM(m_midi, "I_MIDIFLAGS", int)
+#undef SET_SEND_PARAM
+	return updated;
+}
+
+// plans and applies the minimal set of operations (no undo point, up to the caller):
+// - removed sends are deleted, wanted routings are created
+// - with [Routing]/MergeSends=1 in S&M.ini (off by default, pasting used to always add sends):
+//   wanted routings already present with the same params are left as is and a wanted routing
+//   matching an existing send with the same channels updates it
+// stats can be logged to the console with [Routing]/LogStats=1 in S&M.ini
+bool SNM_RoutingEngine::Apply()
+{
+	const double t0 = time_precise();
+
+	// plan: capture current sends and match wanted routings
+	for (int i=0; i<m_rmvSnds.GetSize(); i++)
+	{
+		WDL_PtrList<Send>* sends = GetSends(m_rmvSnds.Get(i));
+		for (int j=0; j<sends->GetSize(); j++)
+			sends->Get(j)->m_delete = true;
+	}
+	for (int i=0; i<m_rmvRcvs.GetSize(); i++)
+	{
+		MediaTrack* dest = m_rmvRcvs.Get(i);
+		const int cnt = GetTrackNumSends(dest, -1);
+		for (int j=0; j<cnt; j++)
+			if (MediaTrack* src = (MediaTrack*)GetSetTrackSendInfo(dest, -1, j, "P_SRCTRACK", NULL))
+			{
+				WDL_PtrList<Send>* sends = GetSends(src);
+				for (int k=0; k<sends->GetSize(); k++)
+					if (sends->Get(k)->m_dest == dest)
+						sends->Get(k)->m_delete = true;
+			}
+	}
+
+	const bool merge = g_SNM_RoutingMergeSends;
+	WDL_TypedBuf<int> creates; // wanted routings to create
+	for (int i=0; i<m_wanted.GetSize(); i++)
+	{
+		if (!merge)
+		{
+			creates.Add(i);
+			continue;
+		}
+
+		Wanted* w = m_wanted.Get()+i;
+		WDL_PtrList<Send>* sends = GetSends(w->m_src);
+		Send* match = NULL;
+		for (int j=0; !match && j<sends->GetSize(); j++)
+		{
+			Send* snd = sends->Get(j);
+			if (!snd->m_matched && !snd->m_delete && snd->m_dest==w->m_dest && snd->m_io.SameParams(w->m_io))
+				match = snd;
+		}
+		if (match)
+		{
+			match->m_matched = true;
+			m_unchanged++;
+			continue;
+		}
+		for (int j=0; !match && j<sends->GetSize(); j++)
+		{
+			Send* snd = sends->Get(j);
+			if (!snd->m_matched && !snd->m_delete && snd->m_dest==w->m_dest && 
+				snd->m_io.m_srcChan==w->m_io->m_srcChan && snd->m_io.m_destChan==w->m_io->m_destChan)
+				match = snd;
+		}
+		if (match)
+		{
+			match->m_matched = true;
+			match->m_update = i;
+		}
+		else
+			creates.Add(i);
+	}
+	const double t1 = time_precise();
+
+	// apply: updates and deletes (per track, last first so that indexes remain valid), then creates
+	PreventUIRefresh(1);
+	for (std::map<MediaTrack*,WDL_PtrList<Send>*>::iterator it=m_sends.begin(); it!=m_sends.end(); ++it)
+		for (int j=it->second->GetSize()-1; j>=0; j--)
+		{
+			Send* snd = it->second->Get(j);
+			if (snd->m_delete)
+			{
+				if (RemoveTrackSend(it->first, 0, snd->m_idx))
+					m_deleted++;
+			}
+			else if (snd->m_update>=0 && SetSendParams(it->first, snd->m_idx, &snd->m_io, m_wanted.Get()[snd->m_update].m_io))
+				m_updated++;
+		}
+	for (int i=0; i<creates.GetSize(); i++)
+	{
+		Wanted* w = m_wanted.Get()+creates.Get()[i];
+		int idx = CreateTrackSend(w->m_src, w->m_dest);
+		if (idx>=0)
+		{
+			SetSendParams(w->m_src, idx, NULL, w->m_io);
+			m_created++;
+		}
+	}
+	PreventUIRefresh(-1);
+
+	if (g_SNM_RoutingLogStats)
+	{
+		char msg[256];
+		snprintf(msg, sizeof(msg), "S&M routing: %d created, %d deleted, %d updated, %d unchanged (plan: %.2f ms, apply: %.2f ms)\n",
+			m_created, m_deleted, m_updated, m_unchanged, (t1-t0)*1000.0, (time_precise()-t1)*1000.0);
+		ShowConsoleMsg(msg);
+	}
+	return (m_created || m_deleted || m_updated);
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // Cut/copy/paste routings + track with routings
 // Note: these functions/actions ignore routing envelopes
@@ -161,6 +351,27 @@ bool PasteSendsReceives(WDL_PtrList<MediaTrack>* _trs,
 	return updated;
 }
 
+// paste through the routing engine (native API, only missing/different routings are created/updated)
+bool PasteSendsReceives(WDL_PtrList<MediaTrack>* _trs,
+		WDL_PtrList_DeleteOnDestroy<WDL_PtrList_DeleteOnDestroy<SNM_SndRcv> >* _snds, 
+		WDL_PtrList_DeleteOnDestroy<WDL_PtrList_DeleteOnDestroy<SNM_SndRcv> >* _rcvs, 
+		SNM_RoutingEngine* _engine)
+{
+	// same dispatching as the chunk-based version above
+	for (int i=0; i<_trs->GetSize(); i++)
+	{
+		const bool respectively = (!_snds || _trs->GetSize()==_snds->GetSize()) && (!_rcvs || _trs->GetSize()==_rcvs->GetSize());
+		for (int j=respectively?i:0; _snds && j<(respectively?i+1:_snds->GetSize()); j++)
+			for (int k=0; _snds->Get(j) && k<_snds->Get(j)->GetSize(); k++)
+				_engine->AddSendReceive(true, _trs->Get(i), _snds->Get(j)->Get(k));
+		for (int j=respectively?i:0; _rcvs && j<(respectively?i+1:_rcvs->GetSize()); j++)
+			for (int k=0; _rcvs->Get(j) && k<_rcvs->Get(j)->GetSize(); k++)
+				_engine->AddSendReceive(false, _trs->Get(i), _rcvs->Get(j)->Get(k));
+	}
+	return _engine->Apply();
+}
+
+
 void CopyWithIOs(COMMAND_T* _ct)
 {
 	WDL_PtrList<MediaTrack> trs;
@@ -194,12 +405,30 @@ void PasteWithIOs(COMMAND_T* _ct)
 		{
 			WDL_PtrList<MediaTrack> trs;
 			SNM_GetSelectedTracks(NULL, &trs, false);
-			PasteSendsReceives(&trs, &g_sndTrackClipboard, &g_rcvTrackClipboard, NULL); // false: we keep intra routings between pasted tracks, see above
+			SNM_RoutingEngine engine;
+			PasteSendsReceives(&trs, &g_sndTrackClipboard, &g_rcvTrackClipboard, &engine); // we keep intra routings between pasted tracks, see above
 		}
 		Undo_EndBlock2(NULL, SWS_CMD_SHORTNAME(_ct), UNDO_STATE_ALL);
 	}
 }
 
+// routing-only updates: single undo point, track configs only
+void ApplyRoutings(COMMAND_T* _ct, SNM_RoutingEngine* _engine)
+{
+	if (_engine->Apply())
+		Undo_OnStateChangeEx2(NULL, SWS_CMD_SHORTNAME(_ct), UNDO_STATE_TRACKCFG, -1);
+}
+
+// _flags: &1 sends, &2 receives
+void RemoveRoutings(WDL_PtrList<MediaTrack>* _trs, int _flags, SNM_RoutingEngine* _engine)
+{
+	for (int i=0; i < _trs->GetSize(); i++)
+	{
+		if (_flags&1) _engine->RemoveSends(_trs->Get(i));
+		if (_flags&2) _engine->RemoveReceives(_trs->Get(i));
+	}
+}
+
 // routing cut copy/paste
 void CopyRoutings(COMMAND_T* _ct)
 {
@@ -211,27 +440,24 @@ void CopyRoutings(COMMAND_T* _ct)
 
 void CutRoutings(COMMAND_T* _ct)
 {
-	bool updated = false;
 	WDL_PtrList<MediaTrack> trs;
 	SNM_GetSelectedTracks(NULL, &trs, false);
 	if (trs.GetSize())
 	{
-		WDL_PtrList<SNM_ChunkParserPatcher> ps;
+		SNM_RoutingEngine engine;
 		CopySendsReceives(false, &trs, &g_sndClipboard, &g_rcvClipboard);
-		updated |= RemoveSends(&trs, &ps);
-		updated |= RemoveReceives(&trs, &ps);
-		ps.Empty(true); // auto-commit, if needed
+		RemoveRoutings(&trs, 3, &engine);
+		ApplyRoutings(_ct, &engine);
 	}
-	if (updated)
-		Undo_OnStateChangeEx2(NULL, SWS_CMD_SHORTNAME(_ct), UNDO_STATE_ALL, -1);
 }
 
 void PasteRoutings(COMMAND_T* _ct)
 {
 	WDL_PtrList<MediaTrack> trs;
 	SNM_GetSelectedTracks(NULL, &trs, false);
-	if (trs.GetSize() && PasteSendsReceives(&trs, &g_sndClipboard, &g_rcvClipboard, NULL))
-		Undo_OnStateChangeEx2(NULL, SWS_CMD_SHORTNAME(_ct), UNDO_STATE_ALL, -1);
+	SNM_RoutingEngine engine;
+	if (trs.GetSize() && PasteSendsReceives(&trs, &g_sndClipboard, &g_rcvClipboard, &engine))
+		Undo_OnStateChangeEx2(NULL, SWS_CMD_SHORTNAME(_ct), UNDO_STATE_TRACKCFG, -1);
 }
 
 // sends cut copy/paste
@@ -245,23 +471,23 @@ void CopySends(COMMAND_T* _ct)
 
 void CutSends(COMMAND_T* _ct)
 {
-	bool updated = false;
 	WDL_PtrList<MediaTrack> trs;
 	SNM_GetSelectedTracks(NULL, &trs, false);
 	if (trs.GetSize()) {
+		SNM_RoutingEngine engine;
 		CopySendsReceives(false, &trs, &g_sndClipboard, NULL);
-		updated |= RemoveSends(&trs, NULL);
+		RemoveRoutings(&trs, 1, &engine);
+		ApplyRoutings(_ct, &engine);
 	}
-	if (updated)
-		Undo_OnStateChangeEx2(NULL, SWS_CMD_SHORTNAME(_ct), UNDO_STATE_ALL, -1);
 }
 
 void PasteSends(COMMAND_T* _ct)
 {
 	WDL_PtrList<MediaTrack> trs;
 	SNM_GetSelectedTracks(NULL, &trs, false);
-	if (trs.GetSize() && PasteSendsReceives(&trs, &g_sndClipboard, NULL, NULL))
-		Undo_OnStateChangeEx2(NULL, SWS_CMD_SHORTNAME(_ct), UNDO_STATE_ALL, -1);
+	SNM_RoutingEngine engine;
+	if (trs.GetSize() && PasteSendsReceives(&trs, &g_sndClipboard, NULL, &engine))
+		Undo_OnStateChangeEx2(NULL, SWS_CMD_SHORTNAME(_ct), UNDO_STATE_TRACKCFG, -1);
 }
 
 // receives cut copy/paste
@@ -275,23 +501,23 @@ void CopyReceives(COMMAND_T* _ct)
 
 void CutReceives(COMMAND_T* _ct)
 {
-	bool updated = false;
 	WDL_PtrList<MediaTrack> trs;
 	SNM_GetSelectedTracks(NULL, &trs, false);
 	if (trs.GetSize()) {
+		SNM_RoutingEngine engine;
 		CopySendsReceives(false, &trs, NULL, &g_rcvClipboard);
-		updated |= RemoveReceives(&trs, NULL);
+		RemoveRoutings(&trs, 2, &engine);
+		ApplyRoutings(_ct, &engine);
 	}
-	if (updated)
-		Undo_OnStateChangeEx2(NULL, SWS_CMD_SHORTNAME(_ct), UNDO_STATE_ALL, -1);
 }
 
 void PasteReceives(COMMAND_T* _ct)
 {
 	WDL_PtrList<MediaTrack> trs;
 	SNM_GetSelectedTracks(NULL, &trs, false);
-	if (trs.GetSize() && PasteSendsReceives(&trs, NULL, &g_rcvClipboard, NULL))
-		Undo_OnStateChangeEx2(NULL, SWS_CMD_SHORTNAME(_ct), UNDO_STATE_ALL, -1);
+	SNM_RoutingEngine engine;
+	if (trs.GetSize() && PasteSendsReceives(&trs, NULL, &g_rcvClipboard, &engine))
+		Undo_OnStateChangeEx2(NULL, SWS_CMD_SHORTNAME(_ct), UNDO_STATE_TRACKCFG, -1);
 }
 
 
@@ -299,84 +525,37 @@ void PasteReceives(COMMAND_T* _ct)
 // Remove routing
 ///////////////////////////////////////////////////////////////////////////////
 
-// primitive
-bool RemoveSends(WDL_PtrList<MediaTrack>* _trs, WDL_PtrList<SNM_ChunkParserPatcher>* _ps)
-{
-	bool updated = false;
-	WDL_PtrList<SNM_ChunkParserPatcher>* ps = (_ps ? _ps : new WDL_PtrList<SNM_ChunkParserPatcher>);
-	for (int j=1; j <= GetNumTracks(); j++) // skip master
-	{
-		if (MediaTrack* trSrc = CSurf_TrackFromID(j, false))
-		{
-			SNM_SendPatcher* p = (SNM_SendPatcher*)SNM_FindCPPbyObject(ps, trSrc);
-			if (!p) {
-				p = new SNM_SendPatcher(trSrc); 
-				ps->Add(p);
-			}
-			for (int i=0; i < _trs->GetSize(); i++)
-//				if (_trs->Get(i) != trSrc)
-					updated |= (p->RemoveReceivesFrom(_trs->Get(i)) > 0);
-		}
-	}
-	if (!_ps) ps->Empty(true); // auto-commit if needed
-	return updated;
-}
-
 void RemoveSends(COMMAND_T* _ct)
 {
-	bool updated = false;
 	WDL_PtrList<MediaTrack> trs;
 	SNM_GetSelectedTracks(NULL, &trs, false);
-	if (trs.GetSize())
-		updated = RemoveSends(&trs, NULL);
-	if (updated)
-		Undo_OnStateChangeEx2(NULL, SWS_CMD_SHORTNAME(_ct), UNDO_STATE_ALL, -1);
-}
-
-// primitive
-bool RemoveReceives(WDL_PtrList<MediaTrack>* _trs, WDL_PtrList<SNM_ChunkParserPatcher>* _ps)
-{
-	bool updated = false;
-	WDL_PtrList<SNM_ChunkParserPatcher>* ps = (_ps ? _ps : new WDL_PtrList<SNM_ChunkParserPatcher>);
-	for (int i=0; i < _trs->GetSize(); i++)
-		if (MediaTrack* tr = _trs->Get(i))
-		{
-			SNM_SendPatcher* p = (SNM_SendPatcher*)SNM_FindCPPbyObject(ps, tr);
-			if (!p) {
-				p = new SNM_SendPatcher(tr); 
-				ps->Add(p);
-			}
-			updated |= (p->RemoveReceives() > 0); 
-		}
-	if (!_ps) ps->Empty(true); // auto-commit if needed
-	return updated;
+	if (trs.GetSize()) {
+		SNM_RoutingEngine engine;
+		RemoveRoutings(&trs, 1, &engine);
+		ApplyRoutings(_ct, &engine);
+	}
 }
 
 void RemoveReceives(COMMAND_T* _ct)
 {
-	bool updated = false;
 	WDL_PtrList<MediaTrack> trs;
 	SNM_GetSelectedTracks(NULL, &trs, false);
-	if (trs.GetSize())
-		updated = RemoveReceives(&trs, NULL);
-	if (updated)
-		Undo_OnStateChangeEx2(NULL, SWS_CMD_SHORTNAME(_ct), UNDO_STATE_ALL, -1);
+	if (trs.GetSize()) {
+		SNM_RoutingEngine engine;
+		RemoveRoutings(&trs, 2, &engine);
+		ApplyRoutings(_ct, &engine);
+	}
 }
 
 void RemoveRoutings(COMMAND_T* _ct)
 {
-	bool updated = false;
 	WDL_PtrList<MediaTrack> trs;
 	SNM_GetSelectedTracks(NULL, &trs, false);
-	if (trs.GetSize())
-	{
-		WDL_PtrList<SNM_ChunkParserPatcher> ps;
-		updated |= RemoveSends(&trs, &ps);
-		updated |= RemoveReceives(&trs, &ps);
-		ps.Empty(true); // auto-commit, if needed
+	if (trs.GetSize()) {
+		SNM_RoutingEngine engine;
+		RemoveRoutings(&trs, 3, &engine);
+		ApplyRoutings(_ct, &engine);
 	}
-	if (updated)
-		Undo_OnStateChangeEx2(NULL, SWS_CMD_SHORTNAME(_ct), UNDO_STATE_ALL, -1); 
 }
 
 
@@ -57,15 +57,59 @@ public:
 		}
 		return false;
 	}
+	bool SameParams(SNM_SndRcv* _io) {
+		return m_mute==_io->m_mute && m_phase==_io->m_phase && m_mono==_io->m_mono && 
+			m_vol==_io->m_vol && m_pan==_io->m_pan && m_panl==_io->m_panl && m_mode==_io->m_mode && 
+			m_srcChan==_io->m_srcChan && m_destChan==_io->m_destChan && m_midi==_io->m_midi;
+	}
 	GUID m_src, m_dest;
 	bool m_mute;
 	int m_phase, m_mono, m_mode, m_srcChan, m_destChan, m_midi;
 	double m_vol, m_pan, m_panl;
 };
 
+// bulk routing updates through the native send API (no chunk patching)
+// the current sends of the involved tracks are captured in one pass, then
+// diffed against the wanted routings: only the needed sends are created, 
+// deleted or updated, see Apply()
+class SNM_RoutingEngine
+{
+public:
+	SNM_RoutingEngine() : m_created(0), m_deleted(0), m_updated(0), m_unchanged(0) {}
+	~SNM_RoutingEngine();
+	void AddSendReceive(bool _send, MediaTrack* _tr, SNM_SndRcv* _io);
+	void RemoveSends(MediaTrack* _src) { m_rmvSnds.Add(_src); }
+	void RemoveReceives(MediaTrack* _dest) { m_rmvRcvs.Add(_dest); }
+	bool Apply();
+	int m_created, m_deleted, m_updated, m_unchanged;
+private:
+	struct Send {
+		MediaTrack* m_dest;
+		int m_idx;
+		SNM_SndRcv m_io;
+		int m_update; // wanted routing index, if any
+		bool m_matched, m_delete;
+	};
+	struct Wanted {
+		MediaTrack* m_src;
+		MediaTrack* m_dest;
+		SNM_SndRcv* m_io;
+	};
+	WDL_PtrList<Send>* GetSends(MediaTrack* _src);
+	MediaTrack* GetTrack(const GUID* _g);
+	static bool SetSendParams(MediaTrack* _src, int _idx, SNM_SndRcv* _cur, SNM_SndRcv* _io);
+
+	std::map<MediaTrack*,WDL_PtrList<Send>*> m_sends;
+	std::map<GUID,MediaTrack*,GuidLess> m_tracks;
+	WDL_TypedBuf<Wanted> m_wanted;
+	WDL_PtrList<MediaTrack> m_rmvSnds, m_rmvRcvs;
+};
+
 
 void CopySendsReceives(bool _noIntra, WDL_PtrList<MediaTrack>* _trs, WDL_PtrList_DeleteOnDestroy<WDL_PtrList_DeleteOnDestroy<SNM_SndRcv> >* _snds, WDL_PtrList_DeleteOnDestroy<WDL_PtrList_DeleteOnDestroy<SNM_SndRcv> >* _rcvs);
 bool PasteSendsReceives(WDL_PtrList<MediaTrack>* _trs, WDL_PtrList_DeleteOnDestroy<WDL_PtrList_DeleteOnDestroy<SNM_SndRcv> >* _snds, WDL_PtrList_DeleteOnDestroy<WDL_PtrList_DeleteOnDestroy<SNM_SndRcv> >* _rcvs, WDL_PtrList<SNM_ChunkParserPatcher>* _ps);
+bool PasteSendsReceives(WDL_PtrList<MediaTrack>* _trs, WDL_PtrList_DeleteOnDestroy<WDL_PtrList_DeleteOnDestroy<SNM_SndRcv> >* _snds, WDL_PtrList_DeleteOnDestroy<WDL_PtrList_DeleteOnDestroy<SNM_SndRcv> >* _rcvs, SNM_RoutingEngine* _engine);
+void ApplyRoutings(COMMAND_T* _ct, SNM_RoutingEngine* _engine);
 void CopyWithIOs(COMMAND_T*);
 void CutWithIOs(COMMAND_T*);
 void PasteWithIOs(COMMAND_T*);
@@ -79,10 +123,9 @@ void CopyReceives(COMMAND_T*);
 void CutReceives(COMMAND_T*);
 void PasteReceives(COMMAND_T*);
 
-bool RemoveSends(WDL_PtrList<MediaTrack>* _trs, WDL_PtrList<SNM_ChunkParserPatcher>* _ps);
 void RemoveSends(COMMAND_T*);
-bool RemoveReceives(WDL_PtrList<MediaTrack>* _trs, WDL_PtrList<SNM_ChunkParserPatcher>* _ps);
 void RemoveReceives(COMMAND_T*);
+void RemoveRoutings(WDL_PtrList<MediaTrack>* _trs, int _flags, SNM_RoutingEngine* _engine);
 void RemoveRoutings(COMMAND_T*);
 
 // reascript export
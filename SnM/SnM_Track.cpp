@@ -1162,13 +1162,274 @@ void TrackPreviewLockUnlockMutex(preview_register_t* _prev, bool _lock) {
 #endif
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Preview source cache
+// Sources of finished previews are kept open (LRU) so that playing the same
+// files again doesn't re-open/re-parse them. The next file of a list can also
+// be prefetched: the source is opened in the main thread (like any other
+// PCM_source) and its head is read in a worker thread (first
+// MediaFilePreviewPrefetch seconds), which warms the decoder and the OS file
+// cache. The worker is the only user of the source until it is cached.
+// Sizes are set in S&M.ini, see IniFileInit().
+// Latencies can be logged to the console with [Preview]/LogStats=1 in S&M.ini
+///////////////////////////////////////////////////////////////////////////////
+
+#define SNM_PREVIEW_PREFETCH_BLOCK 4096 // samples
+
+class SNM_PreviewCache
+{
+public:
+	SNM_PreviewCache() : m_prefetchSrc(NULL), m_prefetchMtime(0), m_thread(NULL), m_running(false), m_exit(false), m_hits(0), m_misses(0), m_latencySum(0.0), m_latencyMax(0.0) {}
+
+	// returns a cached source (removed from the cache) or a new one, NULL on error
+	PCM_source* Get(const char* _fn, bool* _hit)
+	{
+		time_t mtime=0;
+		if (!GetFileModTime(_fn, &mtime))
+			return NULL;
+
+		{
+			SWS_SectionLock lock(&m_mutex);
+			for (int i=0; i < m_entries.GetSize(); i++)
+			{
+				Entry* e = m_entries.Get(i);
+				if (!_stricmp(e->m_fn.Get(), _fn))
+				{
+					m_entries.Delete(i, false);
+					if (e->m_mtime == mtime) // not modified since it was opened
+					{
+						PCM_source* src = e->m_src;
+						delete e;
+						m_owned.Add(src);
+						m_hits++;
+						if (_hit) *_hit = true;
+						return src;
+					}
+					delete e->m_src;
+					delete e;
+					break;
+				}
+			}
+			m_misses++;
+		}
+
+		if (_hit) *_hit = false;
+		PCM_source* src = PCM_Source_CreateFromFileEx(_fn, true); // "true" so that the src is not imported as in-project data
+		if (src && g_SNM_PreviewCacheSize)
+		{
+			SWS_SectionLock lock(&m_mutex);
+			m_owned.Add(src);
+		}
+		return src;
+	}
+
+	// takes ownership of _src: cached if it was returned by Get(), deleted otherwise
+	void Release(PCM_source* _src)
+	{
+		if (!_src)
+			return;
+
+		time_t mtime=0;
+		SWS_SectionLock lock(&m_mutex);
+		int idx = m_owned.Find(_src);
+		if (idx < 0 || m_exit || !g_SNM_PreviewCacheSize || !GetFileModTime(_src->GetFileName(), &mtime))
+		{
+			if (idx >= 0) m_owned.Delete(idx, false);
+			delete _src;
+			return;
+		}
+		m_owned.Delete(idx, false);
+		Add(_src, mtime);
+	}
+
+	// opens _fn and reads its head asynchronously, if not already cached
+	// main thread only
+	void Prefetch(const char* _fn)
+	{
+		if (!g_SNM_PreviewCacheSize || !g_SNM_PreviewPrefetchLen || !_fn || !*_fn)
+			return;
+
+		time_t mtime=0;
+		if (!GetFileModTime(_fn, &mtime))
+			return;
+
+		{
+			SWS_SectionLock lock(&m_mutex);
+			if (m_exit || (m_prefetchSrc && !_stricmp(m_prefetchSrc->GetFileName(), _fn)))
+				return;
+			for (int i=0; i < m_entries.GetSize(); i++)
+				if (!_stricmp(m_entries.Get(i)->m_fn.Get(), _fn))
+					return;
+		}
+
+		PCM_source* src = PCM_Source_CreateFromFileEx(_fn, true); // "true" so that the src is not imported as in-project data
+		if (!src)
+			return;
+
+		SWS_SectionLock lock(&m_mutex);
+		if (m_exit)
+		{
+			delete src;
+			return;
+		}
+		delete m_prefetchSrc; // latest request wins (not picked up by the worker yet)
+		m_prefetchSrc = src;
+		m_prefetchMtime = mtime;
+		if (!m_running)
+		{
+			if (m_thread) CloseHandle(m_thread);
+			m_running = true;
+			m_thread = (HANDLE)_beginthreadex(NULL, 0, PrefetchThread, (void*)this, 0, NULL);
+		}
+	}
+
+	void LogLatency(const char* _fn, bool _hit, double _openMs, double _startMs)
+	{
+		if (!g_SNM_PreviewLogStats)
+			return;
+
+		int hits, misses;
+		double avgMs, maxMs;
+		{
+			SWS_SectionLock lock(&m_mutex);
+			double ms = _openMs + _startMs;
+			m_latencySum += ms;
+			if (ms > m_latencyMax) m_latencyMax = ms;
+			hits = m_hits;
+			misses = m_misses;
+			avgMs = m_latencySum/(hits+misses>0 ? hits+misses : 1);
+			maxMs = m_latencyMax;
+		}
+
+		char msg[SNM_MAX_PATH+256];
+		snprintf(msg, sizeof(msg), "S&M preview: %s (%s) - open: %.2f ms, start: %.2f ms | hits: %d, misses: %d, avg: %.2f ms, max: %.2f ms\n",
+			GetFilenameWithExt(_fn), _hit ? "cached" : "opened", _openMs, _startMs, hits, misses, avgMs, maxMs);
+		ShowConsoleMsg(msg);
+	}
+
+	// waits for the worker thread, sources of playing previews are deleted when released
+	void Exit()
+	{
+		{
+			SWS_SectionLock lock(&m_mutex);
+			m_exit = true;
+		}
+		if (m_thread)
+		{
+			WaitForSingleObject(m_thread, INFINITE);
+			CloseHandle(m_thread);
+			m_thread = NULL;
+		}
+		SWS_SectionLock lock(&m_mutex);
+		DELETE_NULL(m_prefetchSrc);
+		for (int i=0; i < m_entries.GetSize(); i++)
+			delete m_entries.Get(i)->m_src;
+		m_entries.Empty(true);
+	}
+
+private:
+	struct Entry
+	{
+		Entry(const char* _fn, time_t _mtime, PCM_source* _src) : m_fn(_fn), m_mtime(_mtime), m_src(_src) {}
+		WDL_FastString m_fn;
+		time_t m_mtime;
+		PCM_source* m_src;
+	};
+
+	// lock must be held
+	void Add(PCM_source* _src, time_t _mtime)
+	{
+		m_entries.Insert(0, new Entry(_src->GetFileName(), _mtime, _src)); // most recently used first
+		while (m_entries.GetSize() > g_SNM_PreviewCacheSize)
+		{
+			Entry* e = m_entries.Get(m_entries.GetSize()-1);
+			delete e->m_src;
+			m_entries.Delete(m_entries.GetSize()-1, true);
+		}
+	}
+
+	bool IsExiting()
+	{
+		SWS_SectionLock lock(&m_mutex);
+		return m_exit;
+	}
+
+	static unsigned WINAPI PrefetchThread(void* _cache)
+	{
+		SNM_PreviewCache* cache = (SNM_PreviewCache*)_cache;
+		for (;;)
+		{
+			PCM_source* src;
+			time_t mtime;
+			{
+				SWS_SectionLock lock(&cache->m_mutex);
+				if (cache->m_exit || !cache->m_prefetchSrc)
+				{
+					cache->m_running = false;
+					return 0;
+				}
+				src = cache->m_prefetchSrc;
+				mtime = cache->m_prefetchMtime;
+				cache->m_prefetchSrc = NULL;
+			}
+
+			// read the head (MIDI sources are fully loaded when opened)
+			int nch = src->GetNumChannels();
+			double sr = src->GetSampleRate();
+			if (nch > 0 && sr > 0.0 && strncmp(src->GetType(), "MIDI", 4))
+			{
+				WDL_TypedBuf<ReaSample> buf;
+				PCM_source_transfer_t t;
+				memset(&t, 0, sizeof(PCM_source_transfer_t));
+				t.samplerate = sr;
+				t.nch = nch;
+				t.length = SNM_PREVIEW_PREFETCH_BLOCK;
+				t.samples = buf.Resize(SNM_PREVIEW_PREFETCH_BLOCK*nch, false);
+
+				double len = min((double)g_SNM_PreviewPrefetchLen, src->GetLength());
+				for (t.time_s=0.0; t.time_s < len && !cache->IsExiting(); t.time_s += SNM_PREVIEW_PREFETCH_BLOCK/sr)
+					src->GetSamples(&t);
+			}
+
+			SWS_SectionLock lock(&cache->m_mutex);
+			if (cache->m_exit) delete src;
+			else cache->Add(src, mtime);
+		}
+	}
+
+	SWS_Mutex m_mutex;
+	WDL_PtrList<Entry> m_entries; // most recently used first
+	WDL_PtrList<PCM_source> m_owned; // sources returned by Get(), in use by previews
+	PCM_source* m_prefetchSrc; // opened by Prefetch(), not picked up by the worker yet
+	time_t m_prefetchMtime;
+	HANDLE m_thread;
+	bool m_running, m_exit;
+	int m_hits, m_misses;
+	double m_latencySum, m_latencyMax;
+};
+
+// must be declared before g_playPreviews (which releases sources on destroy)
+SNM_PreviewCache g_previewCache;
+
+void SNM_PrefetchTrackPreview(const char* _fn) {
+	g_previewCache.Prefetch(_fn);
+}
+
+void TrackPreviewExit() {
+	g_previewCache.Exit();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
 void DeleteTrackPreview(void* _prev)
 {
 	if (_prev)
 	{
 		preview_register_t* prev = (preview_register_t*)_prev;
 		StopTrackPreview2(NULL, prev);
-		DELETE_NULL(prev->src);
+		g_previewCache.Release(prev->src);
+		prev->src = NULL;
 		TrackPreviewInitDeleteMutex(prev, false);
 		DELETE_NULL(prev);
 	}
@@ -1289,8 +1550,15 @@ bool SNM_PlayTrackPreview(MediaTrack* _tr, PCM_source* _src, bool _pause, bool _
 // primitive func: _fn must be a valid/existing file
 bool SNM_PlayTrackPreview(MediaTrack* _tr, const char* _fn, bool _pause, bool _loop, double _msi)
 {
-	if (PCM_source* src = PCM_Source_CreateFromFileEx(_fn, true)) // "true" so that the src is not imported as in-project data
-		return SNM_PlayTrackPreview(_tr, src, _pause, _loop, _msi);
+	bool hit = false;
+	double t0 = time_precise();
+	if (PCM_source* src = g_previewCache.Get(_fn, &hit))
+	{
+		double t1 = time_precise();
+		bool ok = SNM_PlayTrackPreview(_tr, src, _pause, _loop, _msi);
+		g_previewCache.LogLatency(_fn, hit, (t1-t0)*1000.0, (time_precise()-t1)*1000.0);
+		return ok;
+	}
 	return false;
 }
 
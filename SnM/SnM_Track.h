@@ -69,6 +69,8 @@ void SaveSelTrackTemplates(bool _delItems, bool _delEnvs, WDL_FastString* _chunk
 void SetMIDIInputChannel(COMMAND_T*);
 void RemapMIDIInputChannel(COMMAND_T*);
 
+void SNM_PrefetchTrackPreview(const char* _fn);
+void TrackPreviewExit();
 void StopTrackPreviewsRun();
 bool SNM_PlayTrackPreview(MediaTrack* _tr, PCM_source* _src, bool _pause, bool _loop, double _msi);
 bool SNM_PlayTrackPreview(MediaTrack* _tr, const char* _fn, bool _pause, bool _loop, double _msi);
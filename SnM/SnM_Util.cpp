@@ -30,6 +30,7 @@
 #include "SnM_Chunk.h"
 #include "SnM_Util.h"
 #include "../cfillion/cfillion.hpp" // CF_LocateInExplorer
+#include "../Utility/Base64.h"
 #include "../reaper/localize.h"
 #include <WDL/sha.h>
 #include <WDL/projectcontext.h>
@@ -135,6 +136,26 @@ bool FileOrDirExists(const char* _fn)
 	return false;
 }
 
+// returns false if _fn doesn't exist
+bool GetFileModTime(const char* _fn, time_t* _mtime, WDL_INT64* _size)
+{
+	if (_fn && *_fn)
+	{
+		struct stat s;
+#ifdef _WIN32
+		if (statUTF8(_fn, &s) == 0)
+#else
+		if (stat(_fn, &s) == 0)
+#endif
+		{
+			if (_mtime) *_mtime = s.st_mtime;
+			if (_size) *_size = (WDL_INT64)s.st_size;
+			return true;
+		}
+	}
+	return false;
+}
+
 // FileOrDirExists() and FileOrDirExistsErrMsg() are intentionally not merged
 // (would impact other project members' code...)
 bool FileOrDirExistsErrMsg(const char* _fn, bool _errMsg)
@@ -369,20 +390,13 @@ bool TranscodeFileToFile64(const char* _outFn, const char* _inFn)
 #endif
 
 // returns NULL if failed, otherwise it's up to the caller to free the returned buffer
+// (decoded straight from _str64, lines can be padded separately like in RPP files)
 WDL_HeapBuf* TranscodeStr64ToHeapBuf(const char* _str64)
 {
-	WDL_HeapBuf* hb = NULL;
-	long len = strlen(_str64);
-	WDL_HeapBuf hbTmp;
-	void* p = hbTmp.Resize(len, false);
-	if (p && hbTmp.GetSize() == len)
-	{
-		memcpy(p, _str64, len);
-		ProjectStateContext* ctx = ProjectCreateMemCtx(&hbTmp);
-		hb = new WDL_HeapBuf();
-		cfg_decode_binary(ctx, hb);
-		delete ctx;
-	}
+	WDL_HeapBuf* hb = new WDL_HeapBuf();
+	Base64Decoder b64(hb);
+	if (!b64.Write(_str64) || !b64.Finish())
+		DELETE_NULL(hb);
 	return hb;
 }
 
@@ -1151,14 +1165,6 @@ bool IsTakePolarityFlipped(MediaItem_Take* take)
 // Other util funcs
 ///////////////////////////////////////////////////////////////////////////////
 
-#ifdef _SNM_MISC
-
-#ifdef _WIN32
-#define FNV64_IV ((WDL_UINT64)(0xCBF29CE484222325i64))
-#else
-#define FNV64_IV ((WDL_UINT64)(0xCBF29CE484222325LL))
-#endif
-
 WDL_UINT64 FNV64(WDL_UINT64 h, const unsigned char* data, int sz)
 {
 	int i;
@@ -1174,6 +1180,8 @@ WDL_UINT64 FNV64(WDL_UINT64 h, const unsigned char* data, int sz)
 	return h;
 }
 
+#ifdef _SNM_MISC
+
 // _strOut[65] by definition..
 bool FNV64(const char* _strIn, char* _strOut)
 {
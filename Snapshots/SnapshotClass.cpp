@@ -89,20 +89,16 @@ FXSnapshot::~FXSnapshot()
 void FXSnapshot::GetChunk(WDL_FastString *chunk)
 {
 	chunk->AppendFormatted(SNM_MAX_CHUNK_LINE_LENGTH, "<FX \"%s\" %d\n", m_cName, m_iNumParams);
-	int iDoublesLeft = m_iNumParams;
-	int iLine = 0;
-	Base64 b64;
-	while (iDoublesLeft)
+	// Each line is encoded on its own (RestoreParams() decodes them one by one), straight into the chunk
+	Base64Encoder b64(chunk);
+	for (int iParam = 0; iParam < m_iNumParams; iParam += DOUBLES_PER_LINE)
 	{
-		int iDoubles = iDoublesLeft;
-		if (iDoublesLeft >= DOUBLES_PER_LINE)
+		int iDoubles = m_iNumParams - iParam;
+		if (iDoubles > DOUBLES_PER_LINE)
 			iDoubles = DOUBLES_PER_LINE;
-		chunk->AppendFormatted(SNM_MAX_CHUNK_LINE_LENGTH, "%s", b64.Encode((char*)(&m_dParams[iLine*DOUBLES_PER_LINE]), iDoubles * sizeof(double)));
+		b64.Write(&m_dParams[iParam], iDoubles * sizeof(double));
+		b64.Finish();
 		chunk->Append("\n");
-
-		iDoublesLeft -= iDoubles;
-		if (iDoublesLeft < 0)
-			iDoublesLeft = 0;
 	}
 	chunk->Append(">\n");
 }
@@ -31,6 +31,7 @@
 #include "SnapshotMerge.h"
 #include "../Prompt.h"
 #include "../reaper/localize.h"
+#include "../Utility/UndoStates.h"
 #include "WDL/projectcontext.h"
 #include "SnM/SnM.h" // dynamic actions
 
@@ -1243,6 +1244,7 @@ static void BeginLoadProjectState(bool isUndo, struct project_config_extension_t
 }
 
 static project_config_extension_t g_projectconfig = { ProcessExtensionLine, SaveExtensionConfig, BeginLoadProjectState, NULL };
+static SWS_UndoStates g_undoStates("SWSSNAPSHOT", &g_projectconfig); // unchanged states are referenced in undo points
 
 static void menuhook(const char* menustr, HMENU hMenu, int flag)
 {
@@ -1255,7 +1257,7 @@ static void menuhook(const char* menustr, HMENU hMenu, int flag)
 
 int SnapshotsInit()
 {
-	if (!plugin_register("projectconfig",&g_projectconfig))
+	if (!plugin_register("projectconfig", g_undoStates.GetProjectConfig()))
 		return 0;
 
 	SWSRegisterCommands(g_commandTable);
@@ -1294,7 +1296,7 @@ void RegisterSnapshotSlot(const int slot) // slot is a 1-based index
 
 void SnapshotsExit()
 {
-	plugin_register("-projectconfig",&g_projectconfig);
+	plugin_register("-projectconfig", g_undoStates.GetProjectConfig());
 	plugin_register("-hookcustommenu", (void*)menuhook);
 
 	// deletes the old setting key (see SnapshotsInit)
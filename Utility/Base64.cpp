@@ -30,12 +30,230 @@
 #include <string.h>
 #include "Base64.h"
 
-// This following Base64 code adapted from http://base64.sourceforge.net/b64.c
-// Copyright (c) 2001 Bob Trower, Trantor Standard Systems Inc.
-// Visit above link for full license info or to get original source.
-// Modified so that the '=' char returns zero for compat with other base64 systems.
+// SSSE3 versions of the encode/decode loops are compiled in for x86/x64 and picked at runtime
+// Based on "Base64 encoding/decoding with SIMD instructions" by Wojciech Muła and Daniel Lemire
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#  define BASE64_SSSE3
+#  include <tmmintrin.h>
+#  ifdef _MSC_VER
+#    include <intrin.h>
+#    define BASE64_SSSE3_FUNC
+#  else
+#    define BASE64_SSSE3_FUNC __attribute__((target("ssse3")))
+#  endif
+#endif
+
+#define BASE64_SPACE   0x40
+#define BASE64_PAD     0x41
+#define BASE64_INVALID 0x80
+#define BASE64_SLACK   4 // SSSE3 decoding stores 16 bytes for every 12 decoded ones
+
 static const char cb64[]="ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-static const char cd64[]="|$$$}rstuvwxyz{$$$>$$$>?@ABCDEFGHIJKLMNOPQRSTUVW$$$$$$XYZ[\\]^_`abcdefghijklmnopq";
+
+// 6-bit values of base64 chars, BASE64_SPACE for white space, BASE64_PAD for '=' and BASE64_INVALID for the rest
+static const unsigned char cd64[256] =
+{
+	0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x40,0x40,0x80,0x80,0x40,0x80,0x80,
+	0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,
+	0x40,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x3E,0x80,0x80,0x80,0x3F,
+	0x34,0x35,0x36,0x37,0x38,0x39,0x3A,0x3B,0x3C,0x3D,0x80,0x80,0x80,0x41,0x80,0x80,
+	0x80,0x00,0x01,0x02,0x03,0x04,0x05,0x06,0x07,0x08,0x09,0x0A,0x0B,0x0C,0x0D,0x0E,
+	0x0F,0x10,0x11,0x12,0x13,0x14,0x15,0x16,0x17,0x18,0x19,0x80,0x80,0x80,0x80,0x80,
+	0x80,0x1A,0x1B,0x1C,0x1D,0x1E,0x1F,0x20,0x21,0x22,0x23,0x24,0x25,0x26,0x27,0x28,
+	0x29,0x2A,0x2B,0x2C,0x2D,0x2E,0x2F,0x30,0x31,0x32,0x33,0x80,0x80,0x80,0x80,0x80,
+	0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,
+	0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,
+	0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,
+	0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,
+	0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,
+	0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,
+	0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,
+	0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,
+};
+
+//////////////////////////////////////////////////////////////////////
+// Encode/decode loops shared by all classes
+//////////////////////////////////////////////////////////////////////
+
+#ifdef BASE64_SSSE3
+static bool HasSSSE3()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 1);
+	return (info[2] & (1 << 9)) != 0;
+#else
+	__builtin_cpu_init(); // needed since we're called during static initialization
+	return __builtin_cpu_supports("ssse3") != 0;
+#endif
+}
+static const bool g_bSSSE3 = HasSSSE3();
+
+// 12 bytes into 16 chars per iteration, loads 16 bytes so stops 4 bytes before pEnd
+BASE64_SSSE3_FUNC static char* EncodeSSSE3(const unsigned char*& pIn, int& iGroups, const unsigned char* pEnd, char* pOut)
+{
+	const __m128i shuffle = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+	const __m128i shift   = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+	while (iGroups >= 4 && pEnd - pIn >= 16)
+	{
+		// Spread 3 bytes into 4 bytes holding 6-bit indices
+		__m128i in = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)pIn), shuffle);
+		__m128i t0 = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+		__m128i t1 = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+		__m128i indices = _mm_or_si128(t0, t1);
+
+		// Indices to chars by adding offset of their range (A-Z, a-z, 0-9, +, /)
+		__m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+		range = _mm_or_si128(range, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices), _mm_set1_epi8(13)));
+		_mm_storeu_si128((__m128i*)pOut, _mm_add_epi8(_mm_shuffle_epi8(shift, range), indices));
+
+		pIn     += 12;
+		pOut    += 16;
+		iGroups -= 4;
+	}
+	return pOut;
+}
+
+// 16 chars into 12 bytes per iteration (stores 16 bytes), stops at first block with chars other than base64 alphabet
+BASE64_SSSE3_FUNC static char* DecodeSSSE3(const unsigned char*& pIn, const unsigned char* pEnd, char* pOut)
+{
+	const __m128i lutLo   = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+	const __m128i lutHi   = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+	const __m128i lutRoll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+	const __m128i mask2F  = _mm_set1_epi8(0x2F);
+	const __m128i pack    = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+	while (pEnd - pIn >= 16)
+	{
+		__m128i in = _mm_loadu_si128((const __m128i*)pIn);
+		__m128i hiNibbles = _mm_and_si128(_mm_srli_epi32(in, 4), mask2F);
+		__m128i loNibbles = _mm_and_si128(in, mask2F);
+		__m128i lo = _mm_shuffle_epi8(lutLo, loNibbles);
+		__m128i hi = _mm_shuffle_epi8(lutHi, hiNibbles);
+		if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())))
+			break;
+
+		// Chars to 6-bit values, then pack 4 of them into 3 bytes
+		__m128i roll = _mm_shuffle_epi8(lutRoll, _mm_add_epi8(_mm_cmpeq_epi8(in, mask2F), hiNibbles));
+		__m128i values = _mm_add_epi8(in, roll);
+		__m128i merged = _mm_madd_epi16(_mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140)), _mm_set1_epi32(0x00011000));
+		_mm_storeu_si128((__m128i*)pOut, _mm_shuffle_epi8(merged, pack));
+
+		pIn  += 16;
+		pOut += 12;
+	}
+	return pOut;
+}
+#endif
+
+// Whole 3 byte groups, pEnd is the end of readable input (SSSE3 loop reads past the last group)
+static char* EncodeGroups(const unsigned char* pIn, int iGroups, const unsigned char* pEnd, char* pOut)
+{
+#ifdef BASE64_SSSE3
+	if (g_bSSSE3)
+		pOut = EncodeSSSE3(pIn, iGroups, pEnd, pOut);
+#endif
+	for (; iGroups > 0; --iGroups, pIn += 3)
+	{
+		*(pOut++) = cb64[pIn[0] >> 2];
+		*(pOut++) = cb64[((pIn[0] & 0x03) << 4) | (pIn[1] >> 4)];
+		*(pOut++) = cb64[((pIn[1] & 0x0F) << 2) | (pIn[2] >> 6)];
+		*(pOut++) = cb64[pIn[2] & 0x3F];
+	}
+	return pOut;
+}
+
+// Last 1 or 2 bytes
+static char* EncodeTail(const unsigned char* pIn, int iLen, char* pOut, bool bPad)
+{
+	if (iLen <= 0)
+		return pOut;
+
+	*(pOut++) = cb64[pIn[0] >> 2];
+	if (iLen == 1)
+	{
+		*(pOut++) = cb64[(pIn[0] & 0x03) << 4];
+		if (bPad)
+			*(pOut++) = '=';
+	}
+	else
+	{
+		*(pOut++) = cb64[((pIn[0] & 0x03) << 4) | (pIn[1] >> 4)];
+		*(pOut++) = cb64[(pIn[1] & 0x0F) << 2];
+	}
+	if (bPad)
+		*(pOut++) = '=';
+	return pOut;
+}
+
+// Writes bytes of unfinished group (2 or 3 chars), fails if there is just one char
+static char* FlushGroup(char* pOut, unsigned int& iBits, int& iChars)
+{
+	if (iChars == 1)
+		return NULL;
+	if (iChars == 2)
+		*(pOut++) = (char)(iBits >> 4);
+	else if (iChars == 3)
+	{
+		*(pOut++) = (char)(iBits >> 10);
+		*(pOut++) = (char)(iBits >> 2);
+	}
+	iBits = 0;
+	iChars = 0;
+	return pOut;
+}
+
+// Unfinished group is carried in iBits/iChars between calls, returns NULL on invalid char
+// pOut needs room for (iChars + input length) * 3/4 bytes + BASE64_SLACK
+static char* DecodeChars(const unsigned char* pIn, const unsigned char* pEnd, char* pOut, unsigned int& iBits, int& iChars)
+{
+	while (pIn < pEnd)
+	{
+		// Whole groups at once until white space or padding shows up
+		if (iChars == 0)
+		{
+#ifdef BASE64_SSSE3
+			if (g_bSSSE3)
+				pOut = DecodeSSSE3(pIn, pEnd, pOut);
+#endif
+			while (pEnd - pIn >= 4)
+			{
+				unsigned int a = cd64[pIn[0]], b = cd64[pIn[1]], c = cd64[pIn[2]], d = cd64[pIn[3]];
+				if ((a | b | c | d) & 0xC0)
+					break;
+
+				unsigned int bits = (a << 18) | (b << 12) | (c << 6) | d;
+				*(pOut++) = (char)(bits >> 16);
+				*(pOut++) = (char)(bits >> 8);
+				*(pOut++) = (char)bits;
+				pIn += 4;
+			}
+			if (pIn >= pEnd)
+				break;
+		}
+
+		unsigned int value = cd64[*(pIn++)];
+		if (value < 64)
+		{
+			iBits = (iBits << 6) | value;
+			if (++iChars == 4)
+			{
+				*(pOut++) = (char)(iBits >> 16);
+				*(pOut++) = (char)(iBits >> 8);
+				*(pOut++) = (char)iBits;
+				iBits = 0;
+				iChars = 0;
+			}
+		}
+		else if (value == BASE64_PAD)
+		{
+			if (!(pOut = FlushGroup(pOut, iBits, iChars)))
+				return NULL;
+		}
+		else if (value != BASE64_SPACE)
+			return NULL;
+	}
+	return pOut;
+}
 
 //////////////////////////////////////////////////////////////////////
 // Construction/Destruction
@@ -58,104 +276,262 @@ Base64::~Base64()
 //////////////////////////////////////////////////////////////////////
 char* Base64::Encode(const char* pInput, int iInputLen)
 {
-	int iLen = iInputLen;
-	int iEncodedLen;
-	
-	//calculate encoded buffer size
-	iEncodedLen = (int)(((iLen-1) * 4 / 3) + 3);  // an extra for the null terminator!
+	if (iInputLen < 0)
+		iInputLen = 0;
+
+	// 4 chars for every 3 bytes, up to 3 for the rest and the null terminator
+	delete [] m_pEncodedBuf;
+	m_pEncodedBuf = new char[iInputLen / 3 * 4 + 4];
+
+	const unsigned char* pIn = (const unsigned char*)pInput;
+	char* pOutput = EncodeGroups(pIn, iInputLen / 3, pIn + iInputLen, m_pEncodedBuf);
+	pOutput = EncodeTail(pIn + iInputLen / 3 * 3, iInputLen % 3, pOutput, false);
+	*pOutput = 0;
+
+	return m_pEncodedBuf;
+}
 
-	// allocate:
-	if (m_pEncodedBuf != NULL)
-		free (m_pEncodedBuf);
-	m_pEncodedBuf = new char[iEncodedLen];
-	char* pOutput = m_pEncodedBuf;
+// Decode a base64 string to a binary buffer
+// Encoded string must be null terminated
+char* Base64::Decode(const char* pEncodedBuf, int *iOutLen)
+{
+	if (iOutLen)
+		*iOutLen = 0;
 
-	//let's step through the buffer (in groups of three bytes) and encode it...
-	while (iLen >= 3)
+	delete [] m_pDecodedBuf;
+	m_pDecodedBuf = NULL;
+	if (!pEncodedBuf)
+		return NULL;
+
+	int iLen = (int)strlen(pEncodedBuf);
+	m_pDecodedBuf = new char[iLen / 4 * 3 + 3 + BASE64_SLACK];
+
+	unsigned int iBits = 0;
+	int iChars = 0;
+	const unsigned char* pIn = (const unsigned char*)pEncodedBuf;
+	char* pOutput = DecodeChars(pIn, pIn + iLen, m_pDecodedBuf, iBits, iChars);
+	if (pOutput)
+		pOutput = FlushGroup(pOutput, iBits, iChars);
+	if (!pOutput)
+		return NULL;
+
+	if (iOutLen)
+		*iOutLen = (int)(pOutput - m_pDecodedBuf);
+	return m_pDecodedBuf;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Base64Encoder
+//////////////////////////////////////////////////////////////////////
+
+Base64Encoder::Base64Encoder(WDL_FastString* pOut, int iLineLen, bool bPad)
+{
+	m_pOut = pOut;
+	m_iLineLen = (iLineLen >= 4) ? iLineLen - iLineLen % 4 : (iLineLen > 0 ? 4 : 0);
+	m_iLineCol = 0;
+	m_bPad = bPad;
+	m_iPending = 0;
+}
+
+// Grows output for iGroups of 4 chars (plus new lines between them) and iExtraChars, returns where to write
+char* Base64Encoder::Reserve(int iGroups, int iExtraChars)
+{
+	int iNewLines = 0;
+	if (m_iLineLen)
 	{
-		*(pOutput++) = cb64[(unsigned char)pInput[0] >> 2];
-		*(pOutput++) = cb64[(((unsigned char)pInput[0] & 0x03) << 4) | (((unsigned char)pInput[1] & 0xF0) >> 4)];
-		*(pOutput++) = cb64[(((unsigned char)pInput[1] & 0x0F) << 2) | (((unsigned char)pInput[2] & 0xC0) >> 6)];
-		*(pOutput++) = cb64[(unsigned char)pInput[2] & 0x3F];
-		iLen -= 3;
-		pInput += 3;
+		int iRoom = (m_iLineLen - m_iLineCol) / 4;
+		if (iGroups > iRoom)
+			iNewLines = 1 + (iGroups - iRoom - 1) / (m_iLineLen / 4);
 	}
 
-	//do we have some chars left?
-	if (iLen != 0)
+	int iStart = m_pOut->GetLength();
+	if (!m_pOut->SetLen(iStart + iGroups * 4 + iNewLines + iExtraChars, true))
+		return NULL;
+	return const_cast<char*>(m_pOut->Get()) + iStart;
+}
+
+void Base64Encoder::Write(const void* pData, int iLen)
+{
+	const unsigned char* pIn = (const unsigned char*)pData;
+	if (!m_pOut || !pIn || iLen <= 0)
+		return;
+
+	// Complete group left over from the last call first
+	if (m_iPending)
 	{
-		*(pOutput++) = cb64[(unsigned char)pInput[0] >> 2];
+		while (m_iPending < 3 && iLen > 0)
+		{
+			m_cPending[m_iPending++] = *(pIn++);
+			--iLen;
+		}
+		if (m_iPending < 3)
+			return;
+
+		m_iPending = 0;
+		Write(m_cPending, 3);
+	}
+
+	// Encode straight into output, breaking lines between groups
+	const unsigned char* pEnd = pIn + iLen;
+	int iGroups = iLen / 3;
+	char* pOut = Reserve(iGroups, 0);
+	if (!pOut)
+		return;
 
-		if (iLen == 1)
+	while (iGroups)
+	{
+		int iCount = iGroups;
+		if (m_iLineLen)
 		{
-			*(pOutput++) = cb64[((unsigned char)pInput[0] & 0x03) << 4];
+			if (m_iLineCol == m_iLineLen)
+			{
+				*(pOut++) = '\n';
+				m_iLineCol = 0;
+			}
+			iCount = (m_iLineLen - m_iLineCol) / 4;
+			if (iCount > iGroups)
+				iCount = iGroups;
+			m_iLineCol += iCount * 4;
 		}
-		else // iLen == 2
+
+		pOut = EncodeGroups(pIn, iCount, pEnd, pOut);
+		pIn += iCount * 3;
+		iGroups -= iCount;
+	}
+
+	for (; pIn < pEnd; ++pIn)
+		m_cPending[m_iPending++] = *pIn;
+}
+
+void Base64Encoder::Finish()
+{
+	if (m_pOut && m_iPending)
+	{
+		bool bNewLine = m_iLineLen && m_iLineCol == m_iLineLen;
+		if (char* pOut = Reserve(0, (m_bPad ? 4 : m_iPending + 1) + (bNewLine ? 1 : 0)))
 		{
-			*(pOutput++) = cb64[(((unsigned char)pInput[0] & 0x03) << 4) | (((unsigned char)pInput[1] & 0xF0) >> 4)];
-			*(pOutput++) = cb64[(((unsigned char)pInput[1] & 0x0F) << 2)];
+			if (bNewLine)
+				*(pOut++) = '\n';
+			EncodeTail(m_cPending, m_iPending, pOut, m_bPad);
 		}
 	}
-	// Null terminate
-	*pOutput = 0;
-	
-	return m_pEncodedBuf;
+	m_iPending = 0;
+	m_iLineCol = 0;
 }
 
-// Decode a base64 string to a binary buffer
-// Encoded string must be null terminated
-char* Base64::Decode(const char* pEncodedBuf, int *iOutLen)
+//////////////////////////////////////////////////////////////////////
+// Base64Decoder
+//////////////////////////////////////////////////////////////////////
+
+Base64Decoder::Base64Decoder(WDL_HeapBuf* pOut)
 {
-	int iDecodedLen;
-	int iLen, iBlock, i;
-	if (iOutLen)
-		*iOutLen = 0;
+	m_pOut = pOut;
+	m_iBits = 0;
+	m_iChars = 0;
+	m_bValid = (pOut != NULL);
+}
+
+bool Base64Decoder::Write(const char* pInput, int iLen)
+{
+	if (!m_bValid || !pInput)
+		return m_bValid;
+	if (iLen < 0)
+		iLen = (int)strlen(pInput);
 
-	// allocate buffer to hold the decoded string:
-	iDecodedLen = (int)((strlen(pEncodedBuf)-1)*3/4)+1;
-	if (m_pDecodedBuf != NULL)
-		free (m_pDecodedBuf);
-	m_pDecodedBuf = new char[iDecodedLen];
+	// Decode straight into output sized for the worst case, then trim it
+	int iSize = m_pOut->GetSize();
+	int iMaxSize = iSize + (m_iChars + iLen) / 4 * 3 + 3 + BASE64_SLACK;
+	char* pStart = (char*)m_pOut->Resize(iMaxSize, false);
+	if (!pStart || m_pOut->GetSize() != iMaxSize)
+		return (m_bValid = false);
+
+	const unsigned char* pIn = (const unsigned char*)pInput;
+	char* pOut = DecodeChars(pIn, pIn + iLen, pStart + iSize, m_iBits, m_iChars);
+	m_pOut->Resize(pOut ? (int)(pOut - pStart) : iSize, false);
+	return (m_bValid = (pOut != NULL));
+}
 
-	// allocate a local scratch buffer for decoding - work with BYTE's to avoid fatal sign extensions by compiler:
-	char* pInput = new char[strlen(pEncodedBuf)+1];
-	strcpy(pInput, pEncodedBuf);
+bool Base64Decoder::Finish()
+{
+	if (!m_bValid)
+		return false;
+
+	int iSize = m_pOut->GetSize();
+	char* pStart = (char*)m_pOut->Resize(iSize + 2, false);
+	if (!pStart || m_pOut->GetSize() != iSize + 2)
+		return (m_bValid = false);
+
+	char* pOut = FlushGroup(pStart + iSize, m_iBits, m_iChars);
+	m_pOut->Resize(pOut ? (int)(pOut - pStart) : iSize, false);
+	return (m_bValid = (pOut != NULL));
+}
 
-	// Loop for each byte of input:
-	iLen = iBlock = i = 0;
-	while (pInput[iBlock+i])
+#ifdef BR_DEBUG_PERFORMANCE_BENCHMARK
+// One-shot Base64 class vs. Base64Encoder/Base64Decoder fed in 64 KB chunks (with 128 char lines like RPP chunks) for payloads from 1 KB up to cfg.base64KB
+// Runs only when "Base64 payloads up to (KB)" is set in the benchmark dialog, throughput is payload size over the reported times
+static void BenchmarkBase64 (const BR_BenchmarkConfig& cfg, vector<BR_BenchmarkResult>& results)
+{
+	const int chunkSize = 65536;
+	for (int kb = 1; kb <= cfg.base64KB && kb <= 1024 * 1024; kb *= 4)
 	{
-		if ((unsigned char)pInput[iBlock+i] < 0x2B || (unsigned char)pInput[iBlock+i] > 0x7A)
-			return NULL;
-		pInput[iBlock+i] = cd64[(unsigned char)pInput[iBlock+i] - 0x2B];
-		if (pInput[iBlock+i] == '$')
-			return NULL;
-		pInput[iBlock+i] -= 0x3E;
+		WDL_HeapBuf payload;
+		const int size = kb * 1024;
+		unsigned char* data = (unsigned char*)payload.Resize(size, false);
+		if (!data || payload.GetSize() != size)
+			break;
+		unsigned int seed = 12345;
+		for (int i = 0; i < size; ++i)
+			data[i] = (unsigned char)((seed = seed * 1103515245 + 12345) >> 16);
+
+		BR_BenchmarkResult encode, decode, streamEncode, streamDecode;
+		encode.id.SetFormatted(256, "Base64/encode/%dKB", kb);
+		encode.name.SetFormatted(256, "Base64 encoding of %d KB", kb);
+		decode.id.SetFormatted(256, "Base64/decode/%dKB", kb);
+		decode.name.SetFormatted(256, "Base64 decoding of %d KB", kb);
+		streamEncode.id.SetFormatted(256, "Base64Encoder/%dKB", kb);
+		streamEncode.name.SetFormatted(256, "Base64 streaming encoding of %d KB (RPP lines)", kb);
+		streamDecode.id.SetFormatted(256, "Base64Decoder/%dKB", kb);
+		streamDecode.name.SetFormatted(256, "Base64 streaming decoding of %d KB (RPP lines)", kb);
 
-		switch(i++)
+		bool roundTrip = true;
+		for (int i = 0; i < cfg.iterations; ++i)
 		{
-			// case 0: no data to copy yet!
-		case 1:
-			m_pDecodedBuf[iLen++] = ((unsigned char)pInput[iBlock+0] << 2 | (unsigned char)pInput[iBlock+1] >> 4);
-			break;
-		case 2:
-			m_pDecodedBuf[iLen++] = ((unsigned char)pInput[iBlock+1] << 4 | (unsigned char)pInput[iBlock+2] >> 2);
-			break;
-		case 3:
-			m_pDecodedBuf[iLen++] = ((((unsigned char)pInput[iBlock+2] << 6) & 0xC0) | (unsigned char)pInput[iBlock+3]);
-			i = 0;
-			iBlock += 4;
-			break;
-		}
-	}
+			Base64 b64;
+			double start = time_precise();
+			const char* encoded = b64.Encode((const char*)data, size);
+			encode.AddTime(start);
 
-	// clean and check:
-	delete [] pInput;
-	if (iLen != iDecodedLen)
-		return NULL;
+			int decodedSize = 0;
+			start = time_precise();
+			const char* decoded = b64.Decode(encoded, &decodedSize);
+			decode.AddTime(start);
+			roundTrip &= decoded && decodedSize == size && !memcmp(decoded, data, size);
 
-	// done:
-	if (iOutLen)
-		*iOutLen = iLen;
-	return m_pDecodedBuf;
+			WDL_FastString encodedLines;
+			start = time_precise();
+			Base64Encoder encoder(&encodedLines, 128);
+			for (int j = 0; j < size; j += chunkSize)
+				encoder.Write(data + j, min(chunkSize, size - j));
+			encoder.Finish();
+			streamEncode.AddTime(start);
+
+			WDL_HeapBuf decodedLines;
+			start = time_precise();
+			Base64Decoder decoder(&decodedLines);
+			for (int j = 0; j < encodedLines.GetLength(); j += chunkSize)
+				decoder.Write(encodedLines.Get() + j, min(chunkSize, encodedLines.GetLength() - j));
+			roundTrip &= decoder.Finish();
+			streamDecode.AddTime(start);
+			roundTrip &= decodedLines.GetSize() == size && !memcmp(decodedLines.Get(), data, size);
+		}
+
+		if (!roundTrip)
+			streamDecode.failure.Set("decoded data differs from payload");
+		results.push_back(encode);
+		results.push_back(decode);
+		results.push_back(streamEncode);
+		results.push_back(streamDecode);
+	}
 }
+static BR_BenchmarkRegistration s_base64Benchmark(BenchmarkBase64);
+#endif
@@ -27,6 +27,8 @@
 
 #pragma once
 
+// One-shot codec, returned buffers are owned by the object and valid until the next call
+// Encoded output is never padded with '=' (kept like this for compat with existing data)
 class Base64
 {
 	public:
@@ -38,3 +40,43 @@ class Base64
 		char* m_pEncodedBuf;
 		char* m_pDecodedBuf;
 };
+
+// Incremental encoder, input can be fed in chunks of any size and gets encoded straight
+// into pOut (appended). If iLineLen > 0 (rounded down to a multiple of 4), a new line is
+// started every iLineLen chars like in RPP chunks (the last line is not terminated).
+// Finish() flushes the remaining 1-2 bytes, the object can be reused afterwards.
+class Base64Encoder
+{
+	public:
+		Base64Encoder(WDL_FastString* pOut, int iLineLen = 0, bool bPad = false);
+
+		void Write(const void* pData, int iLen);
+		void Finish();
+
+	private:
+		char* Reserve(int iGroups, int iExtraChars);
+
+		WDL_FastString* m_pOut;
+		int m_iLineLen, m_iLineCol;
+		bool m_bPad;
+		unsigned char m_cPending[3];
+		int m_iPending;
+};
+
+// Incremental decoder, decoded bytes are appended to pOut. White space (incl. new lines
+// of RPP chunks) is skipped and '=' ends the current group so separately padded lines
+// can be fed too. Write() and Finish() return false once invalid input was found.
+class Base64Decoder
+{
+	public:
+		Base64Decoder(WDL_HeapBuf* pOut);
+
+		bool Write(const char* pInput, int iLen = -1); // iLen -1: null terminated
+		bool Finish();                                 // fails if a group was left with a single char
+
+	private:
+		WDL_HeapBuf* m_pOut;
+		unsigned int m_iBits;
+		int m_iChars;
+		bool m_bValid;
+};
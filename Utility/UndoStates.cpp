@@ -0,0 +1,283 @@
+/******************************************************************************
+/ UndoStates.cpp
+/
+/ Copyright (c) 2026 and later SWS
+/
+/
+/ Permission is hereby granted, free of charge, to any person obtaining a copy
+/ of this software and associated documentation files (the "Software"), to deal
+/ in the Software without restriction, including without limitation the rights to
+/ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+/ of the Software, and to permit persons to whom the Software is furnished to
+/ do so, subject to the following conditions:
+/
+/ The above copyright notice and this permission notice shall be included in all
+/ copies or substantial portions of the Software.
+/
+/ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+/ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+/ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+/ HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+/ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/ OTHER DEALINGS IN THE SOFTWARE.
+/
+******************************************************************************/
+
+#include "stdafx.h"
+#include "UndoStates.h"
+
+#include "WDL/projectcontext.h"
+
+#define UNDOSTATE_TAG       "SWS_UNDOSTATE"
+#define UNDOSTATE_MIN_SIZE  4096             // smaller states are always written as-is
+#define UNDOSTATES_MAX_SIZE (32*1024*1024)   // per module, beyond that new states are written as-is to every undo point
+
+// module states kept in memory: null-terminated lines, no line length limit
+// (ProjectCreateMemCtx() truncates lines to the caller's buffer)
+class SWS_UndoStateCtx : public ProjectStateContext
+{
+public:
+	SWS_UndoStateCtx(WDL_HeapBuf* buf) : m_buf(buf), m_pos(0), m_tmpFlag(0) {}
+
+	void AddLine(const char* fmt, ...)
+	{
+		va_list va, va2;
+		va_start(va, fmt);
+		va_copy(va2, va);
+		int len = vsnprintf(NULL, 0, fmt, va);
+		va_end(va);
+		if (len >= 0)
+		{
+			int sz = m_buf->GetSize();
+			if (char* p = (char*)m_buf->Resize(sz+len+1, false))
+				vsnprintf(p+sz, len+1, fmt, va2);
+		}
+		va_end(va2);
+	}
+
+	int GetLine(char* buf, int buflen)
+	{
+		const char* line = GetLine();
+		if (!line)
+			return -1;
+		lstrcpyn(buf, line, buflen);
+		return 0;
+	}
+
+	// returns NULL at the end of the buffer
+	const char* GetLine()
+	{
+		if (m_pos >= m_buf->GetSize())
+			return NULL;
+		const char* line = (const char*)m_buf->Get() + m_pos;
+		m_pos += (int)strlen(line) + 1;
+		return line;
+	}
+
+	INT64 GetOutputSize() { return m_buf->GetSize(); }
+	int GetTempFlag() { return m_tmpFlag; }
+	void SetTempFlag(int flag) { m_tmpFlag = flag; }
+
+private:
+	WDL_HeapBuf* m_buf;
+	int m_pos, m_tmpFlag;
+};
+
+static WDL_UINT64 HashState(const WDL_HeapBuf* buf)
+{
+	// FNV-1a
+	WDL_UINT64 hash = WDL_UINT64_CONST(0xcbf29ce484222325);
+	const unsigned char* p = (const unsigned char*)buf->Get();
+	for (int i = 0; i < buf->GetSize(); i++)
+	{
+		hash ^= p[i];
+		hash *= WDL_UINT64_CONST(0x100000001b3);
+	}
+	return hash;
+}
+
+static bool SameState(const WDL_HeapBuf* a, const WDL_HeapBuf* b)
+{
+	return a->GetSize() == b->GetSize() && !memcmp(a->Get(), b->Get(), a->GetSize());
+}
+
+static void CopyStateLines(const WDL_HeapBuf* buf, ProjectStateContext* ctx)
+{
+	SWS_UndoStateCtx memCtx(const_cast<WDL_HeapBuf*>(buf));
+	while (const char* line = memCtx.GetLine())
+		ctx->AddLine("%s", line);
+}
+
+// references can only be resolved in the session that wrote them: when the undo history
+// may be saved with the project (RPP-UNDO), states are always written as-is
+static bool CanReferenceStates()
+{
+	return !ConfigVar<int>("saveundostatesproj").value_or(1);
+}
+
+SWS_UndoStates::SWS_UndoStates(const char* name, project_config_extension_t* module)
+:m_name(name), m_module(module), m_statesSize(0), m_lastState(NULL), m_hasRefs(false)
+{
+	m_reg.ProcessExtensionLine = ProcessExtensionLine;
+	m_reg.SaveExtensionConfig = SaveExtensionConfig;
+	m_reg.BeginLoadProjectState = BeginLoadProjectState;
+	m_reg.userData = this;
+}
+
+SWS_UndoStates::~SWS_UndoStates()
+{
+	for (std::map<WDL_UINT64,State*>::iterator it = m_states.begin(); it != m_states.end(); ++it)
+		delete it->second;
+}
+
+void SWS_UndoStates::SaveModuleState(WDL_HeapBuf* buf, bool isUndo)
+{
+	SWS_UndoStateCtx memCtx(buf);
+	m_module->SaveExtensionConfig(&memCtx, isUndo, m_module);
+}
+
+// feeds the module with a state saved in memory, as if it was read from the undo state
+void SWS_UndoStates::LoadModuleState(const WDL_HeapBuf* buf)
+{
+	SWS_UndoStateCtx memCtx(const_cast<WDL_HeapBuf*>(buf));
+	while (const char* line = memCtx.GetLine())
+		m_module->ProcessExtensionLine(line, &memCtx, true, m_module);
+}
+
+// returns NULL if the state can't be kept (referenced states are never dropped: undo points may still point to them)
+SWS_UndoStates::State* SWS_UndoStates::AddState(WDL_UINT64 hash, const WDL_HeapBuf* buf)
+{
+	State* state = NULL;
+	std::map<WDL_UINT64,State*>::iterator it = m_states.find(hash);
+	if (it != m_states.end())
+	{
+		if (it->second->m_referenced) // hash collision with a state in use, the new one is written as-is
+			return NULL;
+		state = it->second;
+		m_statesSize -= state->m_buf.GetSize();
+	}
+
+	// make room by dropping states no undo point refers to
+	for (it = m_states.begin(); m_statesSize + buf->GetSize() > UNDOSTATES_MAX_SIZE && it != m_states.end();)
+	{
+		if (it->second->m_referenced || it->second == state)
+		{
+			++it;
+			continue;
+		}
+		m_statesSize -= it->second->m_buf.GetSize();
+		if (m_lastState == it->second)
+			m_lastState = NULL;
+		delete it->second;
+		m_states.erase(it++);
+	}
+
+	if (m_statesSize + buf->GetSize() > UNDOSTATES_MAX_SIZE)
+	{
+		if (state)
+		{
+			if (m_lastState == state)
+				m_lastState = NULL;
+			delete state;
+			m_states.erase(hash);
+		}
+		return NULL;
+	}
+
+	if (!state)
+		state = m_states[hash] = new State;
+	memcpy(state->m_buf.Resize(buf->GetSize(), false), buf->Get(), buf->GetSize());
+	state->m_hash = hash;
+	state->m_referenced = false;
+	m_statesSize += buf->GetSize();
+	return state;
+}
+
+void SWS_UndoStates::Log(int bytesWritten, int stateSize, bool ref)
+{
+	static int s_log = -1;
+	if (s_log < 0)
+		s_log = GetPrivateProfileInt(SWS_INI, "UndoStatesLog", 0, get_ini_file());
+	if (s_log == 1)
+	{
+		char str[256];
+		snprintf(str, sizeof(str), "SWS undo state (%s): %d bytes written, state: %d bytes%s\n", m_name, bytesWritten, stateSize, ref ? " (unchanged, reference)" : "");
+		ShowConsoleMsg(str);
+	}
+}
+
+bool SWS_UndoStates::ProcessExtensionLine(const char* line, ProjectStateContext* ctx, bool isUndo, project_config_extension_t* reg)
+{
+	SWS_UndoStates* me = (SWS_UndoStates*)reg->userData;
+
+	LineParser lp(false);
+	if (strncmp(line, UNDOSTATE_TAG " ", sizeof(UNDOSTATE_TAG)) || lp.parse(line) || lp.getnumtokens() != 3 || strcmp(lp.gettoken_str(1), me->m_name))
+		return me->m_module->ProcessExtensionLine(line, ctx, isUndo, me->m_module);
+
+	WDL_UINT64 hash = (WDL_UINT64)strtoull(lp.gettoken_str(2), NULL, 16);
+	std::map<WDL_UINT64,State*>::iterator it = me->m_states.find(hash);
+	if (it != me->m_states.end())
+		me->LoadModuleState(&it->second->m_buf);
+	else // can't happen with references written by this session (see CanReferenceStates())
+		me->LoadModuleState(&me->m_preUndoState);
+	return true;
+}
+
+void SWS_UndoStates::SaveExtensionConfig(ProjectStateContext* ctx, bool isUndo, project_config_extension_t* reg)
+{
+	SWS_UndoStates* me = (SWS_UndoStates*)reg->userData;
+	if (!isUndo)
+	{
+		me->m_module->SaveExtensionConfig(ctx, isUndo, me->m_module);
+		return;
+	}
+
+	// the module state has to be serialized to be compared, but the common case (state unchanged since
+	// the previous undo point) is a plain memcmp: only new states are hashed
+	WDL_HeapBuf buf;
+	me->SaveModuleState(&buf, isUndo);
+	if (buf.GetSize() >= UNDOSTATE_MIN_SIZE && CanReferenceStates())
+	{
+		State* state = me->m_lastState;
+		if (!state || !SameState(&state->m_buf, &buf))
+		{
+			WDL_UINT64 hash = HashState(&buf);
+			std::map<WDL_UINT64,State*>::iterator it = me->m_states.find(hash);
+			state = (it != me->m_states.end() && SameState(&it->second->m_buf, &buf)) ? it->second : NULL;
+			if (!state)
+			{
+				// 1st undo point with this state: written as-is, referenced by the next ones
+				me->m_lastState = me->AddState(hash, &buf);
+				CopyStateLines(&buf, ctx);
+				me->Log(buf.GetSize(), buf.GetSize(), false);
+				return;
+			}
+		}
+
+		char line[128];
+		int len = snprintf(line, sizeof(line), UNDOSTATE_TAG " %s %08X%08X", me->m_name, (unsigned int)(state->m_hash>>32), (unsigned int)(state->m_hash&0xFFFFFFFF));
+		ctx->AddLine("%s", line);
+		state->m_referenced = true;
+		me->m_lastState = state;
+		me->m_hasRefs = true;
+		me->Log(len, buf.GetSize(), true);
+		return;
+	}
+	CopyStateLines(&buf, ctx);
+	me->Log(buf.GetSize(), buf.GetSize(), false);
+}
+
+void SWS_UndoStates::BeginLoadProjectState(bool isUndo, project_config_extension_t* reg)
+{
+	SWS_UndoStates* me = (SWS_UndoStates*)reg->userData;
+
+	// keep the current state in case the undo state refers to a state we don't have anymore
+	me->m_preUndoState.Resize(0, false);
+	if (isUndo && me->m_hasRefs)
+		me->SaveModuleState(&me->m_preUndoState, true);
+
+	if (me->m_module->BeginLoadProjectState)
+		me->m_module->BeginLoadProjectState(isUndo, me->m_module);
+}
@@ -0,0 +1,85 @@
+/******************************************************************************
+/ UndoStates.h
+/
+/ Copyright (c) 2026 and later SWS
+/
+/
+/ Permission is hereby granted, free of charge, to any person obtaining a copy
+/ of this software and associated documentation files (the "Software"), to deal
+/ in the Software without restriction, including without limitation the rights to
+/ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+/ of the Software, and to permit persons to whom the Software is furnished to
+/ do so, subject to the following conditions:
+/
+/ The above copyright notice and this permission notice shall be included in all
+/ copies or substantial portions of the Software.
+/
+/ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+/ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+/ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+/ HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+/ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/ OTHER DEALINGS IN THE SOFTWARE.
+/
+******************************************************************************/
+
+#pragma once
+
+// Copy-on-write undo states for project_config_extension_t modules
+//
+// Wraps a module's project config: on undo points, the module's state is saved
+// in memory first and, when that state was already saved in a previous undo
+// point, only a reference line is written to the undo state instead:
+//   SWS_UNDOSTATE <name> <hash>
+// States are content-addressed (no version to maintain in the module, and a
+// reference can't resolve to another state). References only resolve in the
+// session that wrote them: when the undo history may be saved with the
+// project (RPP-UNDO, "saveundostatesproj" in reaper.ini), states are always
+// written as-is. Small states are always written as-is too.
+//
+// Referenced states are kept for the session (undo points may point to them
+// until the undo history is cleared, which extensions aren't notified of):
+// once a module's states reach the size limit, new states are written as-is
+// to every undo point instead of being cached.
+// The module state is still serialized on every undo point to be compared with
+// the previous one, only new states are hashed.
+//
+// Bytes written per undo point can be logged to the console with
+// UndoStatesLog=1 in the [SWS] section of reaper.ini.
+class SWS_UndoStates
+{
+public:
+	SWS_UndoStates(const char* name, project_config_extension_t* module);
+	~SWS_UndoStates();
+
+	// to register with "projectconfig" instead of the module's one
+	project_config_extension_t* GetProjectConfig() { return &m_reg; }
+
+private:
+	struct State
+	{
+		WDL_HeapBuf m_buf;
+		WDL_UINT64 m_hash;
+		bool m_referenced; // by an undo point, can't be dropped anymore
+	};
+
+	static bool ProcessExtensionLine(const char* line, ProjectStateContext* ctx, bool isUndo, project_config_extension_t* reg);
+	static void SaveExtensionConfig(ProjectStateContext* ctx, bool isUndo, project_config_extension_t* reg);
+	static void BeginLoadProjectState(bool isUndo, project_config_extension_t* reg);
+
+	void SaveModuleState(WDL_HeapBuf* buf, bool isUndo);
+	void LoadModuleState(const WDL_HeapBuf* buf);
+	State* AddState(WDL_UINT64 hash, const WDL_HeapBuf* buf);
+	void Log(int bytesWritten, int stateSize, bool ref);
+
+	const char* m_name;
+	project_config_extension_t* m_module;
+	project_config_extension_t m_reg;
+	std::map<WDL_UINT64,State*> m_states;
+	int m_statesSize;
+	State* m_lastState; // saved in the previous undo point
+	WDL_HeapBuf m_preUndoState;
+	bool m_hasRefs;
+};
@@ -68,7 +68,9 @@ bool RestoreSelectedTracks()
 
 void SetTrackHeight(MediaTrack* track, int height, bool useChunk)
 {
-	if (!useChunk)
+	if (WOL_LayoutTransaction* transaction = WOL_LayoutTransaction::GetOpen())
+		transaction->SetTrackHeight(track, height, useChunk);
+	else if (!useChunk)
 	{
 		GetSetMediaTrackInfo(track, "I_HEIGHTOVERRIDE", &height);
 
@@ -238,6 +240,128 @@ void SetArrangeScrollTo(BR_Envelope* envelope, VerticalZoomCenter center)
 			SetArrangeScrollTo(tr, center);
 }
 
+static WOL_LayoutTransaction* g_layoutTransaction = NULL;
+
+WOL_LayoutTransaction::WOL_LayoutTransaction() :
+m_outer(g_layoutTransaction),
+m_scrollTrack(NULL),
+m_scrollEnvelope(NULL),
+m_scrollCheck(true),
+m_scrollCenter(CLIP_IN_ARRANGE),
+m_changed(false),
+m_committed(false)
+{
+	g_layoutTransaction = this;
+	PreventUIRefresh(1);
+}
+
+WOL_LayoutTransaction::~WOL_LayoutTransaction()
+{
+	Commit();
+}
+
+WOL_LayoutTransaction* WOL_LayoutTransaction::GetOpen()
+{
+	return g_layoutTransaction;
+}
+
+void WOL_LayoutTransaction::SetTrackHeight(MediaTrack* track, int height, bool useChunk)
+{
+	if (!track || m_committed)
+		return;
+
+	if (!useChunk)
+	{
+		if (*(int*)GetSetMediaTrackInfo(track, "I_HEIGHTOVERRIDE", NULL) == height)
+			return;
+		GetSetMediaTrackInfo(track, "I_HEIGHTOVERRIDE", &height);
+	}
+	else
+	{
+		// No API for this one, still costs a chunk round-trip per track
+		SNM_ChunkParserPatcher p(track);
+		char pTrackLine[BUFFER_SIZE] = "";
+
+		if (p.Parse(SNM_GET_CHUNK_CHAR, 1, "TRACK", "TRACKHEIGHT", 0, 1, pTrackLine))
+		{
+			snprintf(pTrackLine, BUFFER_SIZE, "%d", height);
+			p.ParsePatch(SNM_SET_CHUNK_CHAR, 1, "TRACK", "TRACKHEIGHT", 0, 1, pTrackLine);
+		}
+	}
+	m_changed = true;
+}
+
+void WOL_LayoutTransaction::SetEnvelopeLaneHeight(TrackEnvelope* envelope, int height)
+{
+	if (!envelope || m_committed)
+		return;
+
+	BR_Envelope brEnv(envelope);
+	SetEnvelopeLaneHeight(&brEnv, height);
+}
+
+void WOL_LayoutTransaction::SetEnvelopeLaneHeight(BR_Envelope* envelope, int height)
+{
+	if (!envelope || m_committed)
+		return;
+
+	envelope->SetLaneHeight(height);
+	if (envelope->Commit()) // only commits when something actually changed
+		m_changed = true;
+}
+
+void WOL_LayoutTransaction::ScrollTo(MediaTrack* track, VerticalZoomCenter center)
+{
+	m_scrollTrack = track;
+	m_scrollEnvelope = NULL;
+	m_scrollCenter = center;
+}
+
+void WOL_LayoutTransaction::ScrollTo(TrackEnvelope* envelope, bool check, VerticalZoomCenter center)
+{
+	m_scrollTrack = NULL;
+	m_scrollEnvelope = envelope;
+	m_scrollCheck = check;
+	m_scrollCenter = center;
+}
+
+void WOL_LayoutTransaction::Invalidate()
+{
+	m_changed = true;
+}
+
+void WOL_LayoutTransaction::Commit()
+{
+	if (m_committed)
+		return;
+	m_committed = true;
+	g_layoutTransaction = m_outer;
+
+	if (m_outer)
+	{
+		if (m_scrollTrack)
+			m_outer->ScrollTo(m_scrollTrack, m_scrollCenter);
+		else if (m_scrollEnvelope)
+			m_outer->ScrollTo(m_scrollEnvelope, m_scrollCheck, m_scrollCenter);
+		m_outer->m_changed |= m_changed;
+	}
+	else
+	{
+		if (m_changed)
+			TrackList_AdjustWindows(false);
+
+		if (m_scrollTrack)
+			SetArrangeScrollTo(m_scrollTrack, m_scrollCenter);
+		else if (m_scrollEnvelope)
+			SetArrangeScrollTo(m_scrollEnvelope, m_scrollCheck, m_scrollCenter);
+
+		if (m_changed)
+			UpdateTimeline();
+	}
+
+	PreventUIRefresh(-1);
+}
+
 
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
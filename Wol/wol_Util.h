@@ -38,7 +38,7 @@
 bool SaveSelectedTracks();
 bool RestoreSelectedTracks();
 
-/* refreshes UI too */
+/* refreshes UI too, unless a WOL_LayoutTransaction is open (relayout is then deferred to its Commit()) */
 void SetTrackHeight(MediaTrack* track, int height, bool useChunk = false);
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -63,6 +63,36 @@ inline void SetArrangeScrollTo(MediaItem_Take* take, VerticalZoomCenter center =
 void SetArrangeScrollTo(TrackEnvelope* envelope, bool check = true, VerticalZoomCenter center = CLIP_IN_ARRANGE);
 void SetArrangeScrollTo(BR_Envelope* envelope, VerticalZoomCenter center = CLIP_IN_ARRANGE);
 
+/* Batches track heights, envelope lane heights and a scroll target so that resizing many tracks costs
+   a single TCP/arrange relayout. Heights are written when set (UI refresh is held off meanwhile), Commit()
+   (or the destructor) relayouts once, scrolls to the target using the new layout and updates the timeline.
+   Transactions nest: an inner one hands its scroll target over to the outer one and never relayouts */
+class WOL_LayoutTransaction
+{
+public:
+	WOL_LayoutTransaction();
+	~WOL_LayoutTransaction();
+
+	void SetTrackHeight(MediaTrack* track, int height, bool useChunk = false);
+	void SetEnvelopeLaneHeight(TrackEnvelope* envelope, int height);
+	void SetEnvelopeLaneHeight(BR_Envelope* envelope, int height); // also commits any other pending change to envelope
+	void ScrollTo(MediaTrack* track, VerticalZoomCenter center = CLIP_IN_ARRANGE);
+	void ScrollTo(TrackEnvelope* envelope, bool check = true, VerticalZoomCenter center = CLIP_IN_ARRANGE);
+	void Invalidate(); // force relayout on commit, for changes made outside the transaction (vzoom2, etc.)
+	void Commit();
+
+	static WOL_LayoutTransaction* GetOpen();
+
+private:
+	WOL_LayoutTransaction* m_outer;
+	MediaTrack* m_scrollTrack;
+	TrackEnvelope* m_scrollEnvelope;
+	bool m_scrollCheck;
+	VerticalZoomCenter m_scrollCenter;
+	bool m_changed;
+	bool m_committed;
+};
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 /// Envelope
 ///////////////////////////////////////////////////////////////////////////////////////////////////
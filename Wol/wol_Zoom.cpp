@@ -45,7 +45,7 @@ void AdjustSelectedEnvelopeOrTrackHeight(COMMAND_T* ct, int val, int valhw, int
 {
 	if (relmode > 0)
 	{
-		PreventUIRefresh(1);
+		WOL_LayoutTransaction layout;
 
 		VerticalZoomCenter scrollCenter = static_cast<VerticalZoomCenter>((int)ct->user > 2 ? (int)ct->user - 3 : (int)ct->user);
 		int height = AdjustRelative(relmode, (valhw == -1) ? BOUNDED(val, 0, 127) : (int)BOUNDED(16384.0 - (valhw | val << 7), 0.0, 16383.0));
@@ -56,14 +56,13 @@ void AdjustSelectedEnvelopeOrTrackHeight(COMMAND_T* ct, int val, int valhw, int
 			{
 				if (brEnv.IsTakeEnvelope())
 				{
-					SetTrackHeight(brEnv.GetParent(), SetToBounds(height + GetTrackHeight(brEnv.GetParent(), NULL), GetTcpTrackMinHeight(), GetCurrentTcpMaxHeight()));
-					SetArrangeScrollTo(brEnv.GetParent(), scrollCenter);
+					layout.SetTrackHeight(brEnv.GetParent(), SetToBounds(height + GetTrackHeight(brEnv.GetParent(), NULL), GetTcpTrackMinHeight(), GetCurrentTcpMaxHeight()));
+					layout.ScrollTo(brEnv.GetParent(), scrollCenter);
 				}
 				else
 				{
-					brEnv.SetLaneHeight(SetToBounds(height + GetTrackEnvHeight(env, NULL, false), GetTcpEnvMinHeight(), GetCurrentTcpMaxHeight()));
-					brEnv.Commit();
-					SetArrangeScrollTo(env, false, scrollCenter);
+					layout.SetEnvelopeLaneHeight(&brEnv, SetToBounds(height + GetTrackEnvHeight(env, NULL, false), GetTcpEnvMinHeight(), GetCurrentTcpMaxHeight()));
+					layout.ScrollTo(env, false, scrollCenter);
 				}
 			}
 			else
@@ -72,20 +71,20 @@ void AdjustSelectedEnvelopeOrTrackHeight(COMMAND_T* ct, int val, int valhw, int
 				currentHeight = GetTrackHeight(brEnv.GetParent(), NULL, &trackGapTop, &trackGapBottom);
 				GetEnvelopeOverlapState(env, &laneCount, &envCount);
 				mul = g_EnvelopesExtendedZoom ? laneCount : 1;
-				SetTrackHeight(brEnv.GetParent(), SetToBounds(height * mul + currentHeight, GetTcpTrackMinHeight(), (g_EnvelopesExtendedZoom ? GetCurrentTcpMaxHeight() * envCount + trackGapTop + trackGapBottom : GetCurrentTcpMaxHeight())));
+				layout.SetTrackHeight(brEnv.GetParent(), SetToBounds(height * mul + currentHeight, GetTcpTrackMinHeight(), (g_EnvelopesExtendedZoom ? GetCurrentTcpMaxHeight() * envCount + trackGapTop + trackGapBottom : GetCurrentTcpMaxHeight())));
 				if (mul == 1)
-					SetArrangeScrollTo(brEnv.GetParent(), scrollCenter);
+					layout.ScrollTo(brEnv.GetParent(), scrollCenter);
 				else
-					SetArrangeScrollTo(env, false, scrollCenter);
+					layout.ScrollTo(env, false, scrollCenter);
 			}
 		}
 		else if (MediaTrack* tr = (int)ct->user > 2 ? GetLastTouchedTrack() : NULL)
 		{
-			SetTrackHeight(tr, SetToBounds(height + GetTrackHeight(tr, NULL), GetTcpTrackMinHeight(), GetCurrentTcpMaxHeight()));
-			SetArrangeScrollTo(tr, scrollCenter);
+			layout.SetTrackHeight(tr, SetToBounds(height + GetTrackHeight(tr, NULL), GetTcpTrackMinHeight(), GetCurrentTcpMaxHeight()));
+			layout.ScrollTo(tr, scrollCenter);
 		}
 
-		PreventUIRefresh(-1);
+		layout.Commit();
 	}
 }
 
@@ -93,7 +92,7 @@ void AdjustEnvelopeOrTrackHeightUnderMouse(COMMAND_T* ct, int val, int valhw, in
 {
 	if (relmode > 0)
 	{
-		PreventUIRefresh(1);
+		WOL_LayoutTransaction layout;
 
 		int height = AdjustRelative(relmode, (valhw == -1) ? BOUNDED(val, 0, 127) : (int)BOUNDED(16384.0 - (valhw | val << 7), 0.0, 16383.0));
 
@@ -125,32 +124,31 @@ void AdjustEnvelopeOrTrackHeightUnderMouse(COMMAND_T* ct, int val, int valhw, in
 			{
 				if (brEnv.IsTakeEnvelope())
 				{
-					SetTrackHeight(brEnv.GetParent(), SetToBounds(height + GetTrackHeight(brEnv.GetParent(), NULL), GetTcpTrackMinHeight(), GetCurrentTcpMaxHeight()), true);
-					SetArrangeScrollTo(brEnv.GetParent(), static_cast<VerticalZoomCenter>((int)ct->user));
+					layout.SetTrackHeight(brEnv.GetParent(), SetToBounds(height + GetTrackHeight(brEnv.GetParent(), NULL), GetTcpTrackMinHeight(), GetCurrentTcpMaxHeight()), true);
+					layout.ScrollTo(brEnv.GetParent(), static_cast<VerticalZoomCenter>((int)ct->user));
 				}
 				else
 				{
-					brEnv.SetLaneHeight(SetToBounds(height + GetTrackEnvHeight(env, NULL, false), GetTcpEnvMinHeight(), GetCurrentTcpMaxHeight()));
-					brEnv.Commit();
-					SetArrangeScrollTo(env, false, static_cast<VerticalZoomCenter>((int)ct->user));
+					layout.SetEnvelopeLaneHeight(&brEnv, SetToBounds(height + GetTrackEnvHeight(env, NULL, false), GetTcpEnvMinHeight(), GetCurrentTcpMaxHeight()));
+					layout.ScrollTo(env, false, static_cast<VerticalZoomCenter>((int)ct->user));
 				}
 			}
 			else
 			{
-				SetTrackHeight(brEnv.GetParent(), SetToBounds(height + GetTrackHeight(brEnv.GetParent(), NULL), GetTcpTrackMinHeight(), GetCurrentTcpMaxHeight()), true);
-				SetArrangeScrollTo(brEnv.GetParent(), static_cast<VerticalZoomCenter>((int)ct->user));
+				layout.SetTrackHeight(brEnv.GetParent(), SetToBounds(height + GetTrackHeight(brEnv.GetParent(), NULL), GetTcpTrackMinHeight(), GetCurrentTcpMaxHeight()), true);
+				layout.ScrollTo(brEnv.GetParent(), static_cast<VerticalZoomCenter>((int)ct->user));
 			}
 		}
 		else if (tr)
 		{
-			SetTrackHeight(tr, SetToBounds(height + GetTrackHeight(tr, NULL), GetTcpTrackMinHeight(), GetCurrentTcpMaxHeight()), true);
-			SetArrangeScrollTo(tr, static_cast<VerticalZoomCenter>((int)ct->user));
+			layout.SetTrackHeight(tr, SetToBounds(height + GetTrackHeight(tr, NULL), GetTcpTrackMinHeight(), GetCurrentTcpMaxHeight()), true);
+			layout.ScrollTo(tr, static_cast<VerticalZoomCenter>((int)ct->user));
 		}
 
+		layout.Commit();
+
 		if (sEnv != GetSelectedEnvelope(NULL))
 			SetCursorContext(2, sEnv);
-
-		PreventUIRefresh(-1);
 	}
 }
 
@@ -158,19 +156,19 @@ void SetVerticalZoomSelectedEnvelope(COMMAND_T* ct)
 {
 	if (TrackEnvelope* env = GetSelectedEnvelope(NULL))
 	{
+		WOL_LayoutTransaction layout;
 		BR_Envelope brEnv(env);
 		if (brEnv.IsInLane())
 		{
 			if (brEnv.IsTakeEnvelope())
 			{
-				SetTrackHeight(brEnv.GetParent(), ((int)ct->user == 0) ? 0 : ((int)ct->user == 1) ? GetTcpTrackMinHeight() : GetCurrentTcpMaxHeight());
-				SetArrangeScrollTo(brEnv.GetParent());
+				layout.SetTrackHeight(brEnv.GetParent(), ((int)ct->user == 0) ? 0 : ((int)ct->user == 1) ? GetTcpTrackMinHeight() : GetCurrentTcpMaxHeight());
+				layout.ScrollTo(brEnv.GetParent());
 			}
 			else
 			{
-				brEnv.SetLaneHeight(((int)ct->user == 0) ? 0 : ((int)ct->user == 1) ? GetTcpEnvMinHeight() : GetCurrentTcpMaxHeight());
-				brEnv.Commit();
-				SetArrangeScrollTo(env, false);
+				layout.SetEnvelopeLaneHeight(&brEnv, ((int)ct->user == 0) ? 0 : ((int)ct->user == 1) ? GetTcpEnvMinHeight() : GetCurrentTcpMaxHeight());
+				layout.ScrollTo(env, false);
 			}
 		}
 		else
@@ -220,11 +218,11 @@ void SetVerticalZoomSelectedEnvelope(COMMAND_T* ct)
 				height = 0;
 				ScrollToEnv = false;
 			}
-			SetTrackHeight(brEnv.GetParent(), height);
+			layout.SetTrackHeight(brEnv.GetParent(), height);
 			if (ScrollToEnv)
-				SetArrangeScrollTo(env, false);
+				layout.ScrollTo(env, false);
 			else
-				SetArrangeScrollTo(brEnv.GetParent());
+				layout.ScrollTo(brEnv.GetParent());
 		}
 	}
 }
@@ -314,6 +312,7 @@ void VerticalZoomSelectedEnvelopeLoUpHalf(COMMAND_T* ct)
 	if (TrackEnvelope* env = GetSelectedEnvelope(NULL))
 	{
 		VerticalZoomCenter zoomCenter = (int)ct->user == 0 ? UPPER_HALF : LOWER_HALF;
+		WOL_LayoutTransaction layout;
 		BR_Envelope brEnv(env);
 		if (brEnv.IsInLane())
 		{
@@ -337,8 +336,8 @@ void VerticalZoomSelectedEnvelopeLoUpHalf(COMMAND_T* ct)
 
 			height = 2 * GetCurrentTcpMaxHeight() * mul - 15;
 
-			SetTrackHeight(brEnv.GetParent(), height);
-			SetArrangeScrollTo(env, false, zoomCenter);
+			layout.SetTrackHeight(brEnv.GetParent(), height);
+			layout.ScrollTo(env, false, zoomCenter);
 		}
 	}
 }
@@ -399,6 +398,7 @@ void SaveApplyHeightSelectedEnvelopeSlot(COMMAND_T* ct)
 			int s = (int)ct->user - 8;
 			if (EnvH[s] == 0)
 				return;
+			WOL_LayoutTransaction layout;
 			BR_Envelope brEnv(env);
 			if (brEnv.IsInLane())
 			{
@@ -409,9 +409,8 @@ void SaveApplyHeightSelectedEnvelopeSlot(COMMAND_T* ct)
 				//}
 				//else
 				//{
-				brEnv.SetLaneHeight(EnvH[s]);
-				brEnv.Commit();
-				SetArrangeScrollTo(env);
+				layout.SetEnvelopeLaneHeight(&brEnv, EnvH[s]);
+				layout.ScrollTo(env);
 				//}
 			}
 			else
@@ -420,11 +419,11 @@ void SaveApplyHeightSelectedEnvelopeSlot(COMMAND_T* ct)
 				GetTrackHeight(brEnv.GetParent(), NULL, &trackGapTop, &trackGapBottom);
 				GetEnvelopeOverlapState(env, &laneCount, &envCount);
 				mul = g_EnvelopesExtendedZoom ? laneCount : 1;
-				SetTrackHeight(brEnv.GetParent(), SetToBounds(EnvH[s] * mul, GetTcpTrackMinHeight(), (g_EnvelopesExtendedZoom ? GetCurrentTcpMaxHeight() * envCount + trackGapTop + trackGapBottom : GetCurrentTcpMaxHeight())));
+				layout.SetTrackHeight(brEnv.GetParent(), SetToBounds(EnvH[s] * mul, GetTcpTrackMinHeight(), (g_EnvelopesExtendedZoom ? GetCurrentTcpMaxHeight() * envCount + trackGapTop + trackGapBottom : GetCurrentTcpMaxHeight())));
 				if (mul == 1)
-					SetArrangeScrollTo(brEnv.GetParent());
+					layout.ScrollTo(brEnv.GetParent());
 				else
-					SetArrangeScrollTo(env, false);
+					layout.ScrollTo(env, false);
 			}
 		}
 	}
@@ -218,34 +218,6 @@ void ExtractFileExtension(const char *FullFileName, char *FileExtension)
 		strcpy(FileExtension, pExt+1);
 }
 
-int ReplaceProjectMedia(char *OldFileName,char *NewFileName)
-{
-	MediaItem *CurItem;
-	MediaItem_Take *CurTake;
-	MediaTrack *CurTrack;
-	int i, j, k;
-	for (i=0;i<GetNumTracks();i++)
-	{
-		CurTrack=CSurf_TrackFromID(i+1,false);
-		for (j=0;j<GetTrackNumMediaItems(CurTrack);j++)
-		{
-			CurItem=GetTrackMediaItem(CurTrack,j);
-			for (k=0;k<GetMediaItemNumTakes(CurItem);k++)
-			{
-				CurTake=GetMediaItemTake(CurItem,k);
-				PCM_source *ThePCM=0;
-				ThePCM=(PCM_source*)GetSetMediaItemTakeInfo(CurTake,"P_SOURCE",NULL);
-				if (ThePCM!=0 && ThePCM->GetFileName())
-					if (strcmp(ThePCM->GetType(),"SECTION")!=0)
-						if (strcmp(ThePCM->GetFileName(),OldFileName)==0)
-							ThePCM->SetFileName(NewFileName);	
-			}
-		}
-	}
-	return -666;
-
-}
-
 void DoRenameTakeDlg(COMMAND_T*)
 {
 	vector<MediaItem_Take*> VecTakesToRename;
@@ -29,6 +29,7 @@
 #include "../SnM/SnM_Dlg.h"	
 #include "../reaper/localize.h"
 #include "../SnM/SnM_Util.h" // SNM_DeletePeakFile()
+#include "../Breeder/BR_MediaIndex.h"
 
 using namespace std;
 
@@ -115,8 +116,6 @@ void AddToRenameLog(string &oldfilename,string &newfilename)
 void DoRenameSourceFileDialog666(COMMAND_T* ct)
 {
 	vector<MediaItem_Take*> thetakes;
-	vector<MediaItem_Take*> alltakes;
-	XenGetProjectTakes(alltakes,false,false);
 	XenGetProjectTakes(thetakes,true,true);
 	if (thetakes.size()==0) return;
 	g_renameparams.takesToRename=(int)thetakes.size();
@@ -147,25 +146,22 @@ void DoRenameSourceFileDialog666(COMMAND_T* ct)
 				newfilename.append(fnsplit[2]);
 				MoveFile(oldname.c_str(),newfilename.c_str());
 				AddToRenameLog(oldname,newfilename);
+				vector<MediaItem_Take*> usingtakes=g_mediaIndex.GetTakes(oldname.c_str());
 				int j;
-				for (j=0;j<(int)alltakes.size();j++)
+				for (j=0;j<(int)usingtakes.size();j++)
 				{
-					PCM_source *thesrc=(PCM_source*)GetSetMediaItemTakeInfo(alltakes[j],"P_SOURCE",0);
-					if (thesrc && thesrc->GetFileName() && strcmp(thesrc->GetType(),"SECTION")!=0)
+					PCM_source *thesrc=(PCM_source*)GetSetMediaItemTakeInfo(usingtakes[j],"P_SOURCE",0);
+					if (thesrc && thesrc->GetFileName() && strcmp(thesrc->GetType(),"SECTION")!=0 && oldname.compare(thesrc->GetFileName())==0) // exact match, the index also matches other spellings of the path
 					{
-						string fname;
-						fname.assign(thesrc->GetFileName());
-						if (oldname.compare(fname)==0)
+						PCM_source *newsrc=PCM_Source_CreateFromFile(newfilename.c_str());
+						if (newsrc)
 						{
-							PCM_source *newsrc=PCM_Source_CreateFromFile(newfilename.c_str());
-							if (newsrc)
-							{
-								GetSetMediaItemTakeInfo(alltakes[j],"P_SOURCE",newsrc);
-								delete thesrc;
+							GetSetMediaItemTakeInfo(usingtakes[j],"P_SOURCE",newsrc);
+							g_mediaIndex.UpdateTake(usingtakes[j]);
+							delete thesrc;
 
-								// delete old .reapeaks file, #1140
-								SNM_DeletePeakFile(oldname.c_str(), true); // no delete check (peaks files can be absent) 
-							}
+							// delete old .reapeaks file, #1140
+							SNM_DeletePeakFile(oldname.c_str(), true); // no delete check (peaks files can be absent) 
 						}
 					}
 				}
@@ -184,8 +180,6 @@ void DoRenameSourceFileDialog666(COMMAND_T* ct)
 void DoRenameTakeAndSourceFileDialog(COMMAND_T* ct)
 {
 	vector<MediaItem_Take*> thetakes;
-	vector<MediaItem_Take*> alltakes;
-	XenGetProjectTakes(alltakes,false,false);
 	XenGetProjectTakes(thetakes,true,true);
 	if (thetakes.size()==0) return;
 	g_renameparams.takesToRename=(int)thetakes.size();
@@ -224,24 +218,21 @@ void DoRenameTakeAndSourceFileDialog(COMMAND_T* ct)
 					MoveFile(oldname.c_str(),newfilename.c_str());
 					AddToRenameLog(oldname,newfilename);
 
-					for (int j=0;j<(int)alltakes.size();j++)
+					vector<MediaItem_Take*> usingtakes=g_mediaIndex.GetTakes(oldname.c_str());
+					for (int j=0;j<(int)usingtakes.size();j++)
 					{
-						PCM_source *thesrc=(PCM_source*)GetSetMediaItemTakeInfo(alltakes[j],"P_SOURCE",0);
-						if (thesrc && thesrc->GetFileName() && strcmp(thesrc->GetType(),"SECTION")!=0)
+						PCM_source *thesrc=(PCM_source*)GetSetMediaItemTakeInfo(usingtakes[j],"P_SOURCE",0);
+						if (thesrc && thesrc->GetFileName() && strcmp(thesrc->GetType(),"SECTION")!=0 && oldname.compare(thesrc->GetFileName())==0)
 						{
-							string fname;
-							fname.assign(thesrc->GetFileName());
-							if (oldname.compare(fname)==0)
+							PCM_source *newsrc=PCM_Source_CreateFromFile(newfilename.c_str());
+							if (newsrc)
 							{
-								PCM_source *newsrc=PCM_Source_CreateFromFile(newfilename.c_str());
-								if (newsrc)
-								{
-									GetSetMediaItemTakeInfo(alltakes[j],"P_SOURCE",newsrc);
-									GetSetMediaItemTakeInfo(alltakes[j],"P_NAME",(char*)g_renameparams.NewName.c_str());
-									delete thesrc;
+								GetSetMediaItemTakeInfo(usingtakes[j],"P_SOURCE",newsrc);
+								GetSetMediaItemTakeInfo(usingtakes[j],"P_NAME",(char*)g_renameparams.NewName.c_str());
+								g_mediaIndex.UpdateTake(usingtakes[j]);
+								delete thesrc;
 
-									SNM_DeletePeakFile(oldname.c_str(), true); // no delete check (peaks files can be absent)
-								}
+								SNM_DeletePeakFile(oldname.c_str(), true); // no delete check (peaks files can be absent)
 							}
 						}
 					}
@@ -31,6 +31,7 @@
 #include "./SnM/SnM_Dlg.h"
 #include "./Breeder/BR_EnvelopeUtil.h"
 #include "./Breeder/BR_Util.h"
+#include "./Wol/wol_Util.h"
 
 
 #define VZOOM_RANGE 40
@@ -108,11 +109,13 @@ void VertZoomRange(int iFirst, int iNum, bool* bZoomed, bool bMinimizeOthers, bo
 	int iTotalHeight = rect.bottom;
 	int lastTrackId = iFirst + iNum - (includeEnvelopes ? 1 : 2);
 
+	// All heights below are applied with a single relayout, see WOL_LayoutTransaction
+	WOL_LayoutTransaction layout;
 	if (bMinimizeOthers)
 	{
 		*ConfigVar<int>("vzoom2") = 0;
 		for (int i = 0; i <= GetNumTracks(); i++)
-			GetSetMediaTrackInfo(CSurf_TrackFromID(i, false), "I_HEIGHTOVERRIDE", &g_i0);
+			layout.SetTrackHeight(CSurf_TrackFromID(i, false), 0);
 		Main_OnCommand(40112, 0); // Zoom out vert to minimize envelope lanes too (since vZoom is now 0) (calls refresh)
 		//TrackList_AdjustWindows(false);
 		//UpdateTimeline();
@@ -186,11 +189,10 @@ void VertZoomRange(int iFirst, int iNum, bool* bZoomed, bool bMinimizeOthers, bo
 			{
 				if (i + 1 == iNum)
 					iEachHeight +=leftOverHeight;
-				GetSetMediaTrackInfo(CSurf_TrackFromID(i+iFirst, false), "I_HEIGHTOVERRIDE", &iEachHeight);
+				layout.SetTrackHeight(CSurf_TrackFromID(i+iFirst, false), iEachHeight);
 			}
 		}
-		TrackList_AdjustWindows(false);
-		UpdateTimeline();
+		layout.Invalidate();
 	}
 	else
 	{
@@ -244,12 +246,11 @@ void VertZoomRange(int iFirst, int iNum, bool* bZoomed, bool bMinimizeOthers, bo
 
 		// Reset custom track sizes
 		for (int i = 0; i <= GetNumTracks(); i++)
-			GetSetMediaTrackInfo(CSurf_TrackFromID(i, false), "I_HEIGHTOVERRIDE", &g_i0);
+			layout.SetTrackHeight(CSurf_TrackFromID(i, false), 0);
 		*ConfigVar<int>("vzoom2") = iZoom;
-		TrackList_AdjustWindows(false);
-		UpdateTimeline();
+		layout.Invalidate();
 	}
-
+	layout.Commit();
 
 	SetVertPos(hTrackView, iFirst, false);
 }
@@ -505,6 +506,7 @@ public:
 		// Vert zoom
 		if (m_bVert)
 		{
+			WOL_LayoutTransaction layout;
 			*ConfigVar<int>("vzoom2") = iVZoom;
 			int iSaved = hbTrackHeights.GetSize();
 			int iEnvPtr = 0;
@@ -514,10 +516,10 @@ public:
 				if (i < iSaved)
 				{
 					SetTrackVis(tr, hbTrackVis.Get()[i]);
-					GetSetMediaTrackInfo(tr, "I_HEIGHTOVERRIDE", hbTrackHeights.Get()+i);
+					layout.SetTrackHeight(tr, hbTrackHeights.Get()[i]);
 				}
 				else
-					GetSetMediaTrackInfo(tr, "I_HEIGHTOVERRIDE", &g_i0);
+					layout.SetTrackHeight(tr, 0);
 
 				for (int j = 0; j < CountTrackEnvelopes(tr); j++)
 				{
@@ -525,17 +527,15 @@ public:
 					if (iEnvPtr < hbEnvHeights.GetSize())
 					{
 						envelope.SetVisible(hbEnvVis.Get()[iEnvPtr]);
-						envelope.SetLaneHeight(hbEnvHeights.Get()[iEnvPtr]);
+						layout.SetEnvelopeLaneHeight(&envelope, hbEnvHeights.Get()[iEnvPtr]);
 						iEnvPtr++;
 					}
 					else
-						envelope.SetLaneHeight(0);
-					envelope.Commit();
+						layout.SetEnvelopeLaneHeight(&envelope, 0);
 				}
 			}
-
-			TrackList_AdjustWindows(false);
-			UpdateTimeline();
+			layout.Invalidate();
+			layout.Commit();
 
 			SetVertPos(hTrackView, iYPos, true);
 		}
@@ -768,11 +768,11 @@ public:
 		*ConfigVar<int>("vzoom2") = m_iVZoom;
 
 		// Restore track heights, ignoring the fact that tracks could have been added/removed
+		WOL_LayoutTransaction layout;
 		for (int i = 0; i < m_iTrackHeights.GetSize() && i <= GetNumTracks(); i++)
-			GetSetMediaTrackInfo(CSurf_TrackFromID(i, false), "I_HEIGHTOVERRIDE", &(m_iTrackHeights.Get()[i]));
-
-		TrackList_AdjustWindows(false);
-		UpdateTimeline();
+			layout.SetTrackHeight(CSurf_TrackFromID(i, false), m_iTrackHeights.Get()[i]);
+		layout.Invalidate();
+		layout.Commit();
 
 		// Restore positions
 		int iTrack = CSurf_TrackToID(m_trVPos, false);
@@ -38,14 +38,8 @@
 #include "../SnM/SnM_Notes.h" // #755
 #include "../SnM/SnM_Project.h" // #974
 #include "../SnM/SnM_Chunk.h" // SNM_FXSummaryParser
-
-#ifdef USE_SYSTEM_TAGLIB
-#  include <taglib/id3v2tag.h>
-#  include <taglib/mpegfile.h>
-#else
-#  include <taglib/mpeg/id3v2/id3v2tag.h>
-#  include <taglib/mpeg/mpegfile.h>
-#endif
+#include "../SnM/SnM_Misc.h" // SNM_GetMediaFileTag
+#include "../Breeder/BR_Util.h" // NEGATIVE_INF
 
 // #781, peak/RMS
 double DoGetMediaItemMaxPeakAndMaxPeakPos(MediaItem* item, double* maxPeakPosOut) // maxPeakPosOut == NULL: peak only
@@ -280,6 +274,427 @@ double GetPosInItem(INT64 peakSample, double sampleRate) // relative to item sta
 		return peakSample / sampleRate; 
 }
 
+// Batch analysis of takes: peak/RMS analyses run on NF_ANALYSIS_THREADS worker threads (one
+// read of the take for all peak/RMS metrics), true peak/loudness analyses run in BR_LoudnessObject's
+// own threads (NF_ANALYSIS_THREADS at most at the same time). Sources and loudness objects are
+// created from the main thread when needed, see NF_AnalysisJob::Schedule()
+#define NF_ANALYSIS_THREADS 4
+#define NF_ANALYSIS_SOURCES 16 // max. nb of item sources opened at the same time (per job)
+
+enum { NF_ANALYZE_PEAK=1, NF_ANALYZE_RMS=2, NF_ANALYZE_TRUEPEAK=4, NF_ANALYZE_LOUDNESS=8 };
+enum { NF_PEAK=0, NF_PEAK_POS, NF_RMS_AVERAGE, NF_RMS_WINDOWED, NF_RMS_WINDOWED_POS, NF_TRUEPEAK, NF_TRUEPEAK_POS,
+       NF_LUFS_INTEGRATED, NF_LU_RANGE, NF_LUFS_SHORTTERM_MAX, NF_LUFS_MOMENTARY_MAX, NF_METRIC_COUNT };
+
+static bool AppendToReaperArray(void* reaperarray, double val)
+{
+	double* values = static_cast<double*>(reaperarray);
+	uint32_t& curSize = ((uint32_t*)(values))[0];
+	if (curSize >= ((uint32_t*)(values))[1]) // higher 32 bits in 1st entry: max alloc. size
+		return false;
+	values[++curSize] = val; // never write to [0] in reaperarrays!!!
+	return true;
+}
+
+class NF_AnalysisJob
+{
+public:
+	NF_AnalysisJob(int id, int flags, double windowSize) : m_id(id), m_flags(flags), m_windowSize(windowSize), m_prepared(0), m_started(false), m_allQueued(false), m_kill(false) {}
+
+	~NF_AnalysisJob()
+	{
+		{
+			SWS_SectionLock lock(&m_mutex);
+			m_kill = true; // polled by AnalyzePCM(), peak/RMS analyses in progress stop after their current block
+		}
+		for (int i = 0; i < m_threads.GetSize(); i++)
+		{
+			WaitForSingleObject(m_threads.Get()[i], INFINITE);
+			CloseHandle(m_threads.Get()[i]);
+		}
+		for (int i = 0; i < m_targets.GetSize(); i++)
+		{
+			delete m_targets.Get(i)->a.pcm;
+			delete m_targets.Get(i)->loudness; // aborts analysis if needed
+		}
+	}
+
+	int GetId() { return m_id; }
+
+	bool AddTake(MediaItem_Take* take)
+	{
+		if (m_started || !take || TakeIsMIDI(take))
+			return false;
+		m_targets.Add(new Target(take));
+		return true;
+	}
+
+	bool Start()
+	{
+		if (m_started || !m_targets.GetSize())
+			return false;
+		m_started = true;
+
+		if (m_windowSize <= 0.0)
+			NF_GetRMSOptions(NULL, &m_windowSize);
+
+		this->Schedule();
+
+		if (this->DoPCM())
+		{
+			for (int i = 0; i < min(NF_ANALYSIS_THREADS, m_targets.GetSize()); i++)
+				if (HANDLE h = (HANDLE)_beginthreadex(NULL, 0, AnalyzeThread, (void*)this, 0, NULL))
+					m_threads.Add(h);
+		}
+		return true;
+	}
+
+	// main thread only: releases analyzed sources and opens the next ones, starts pending loudness analyses
+	// returns false when there's nothing left to schedule
+	bool Schedule()
+	{
+		if (!m_started)
+			return false;
+
+		bool pending = false;
+		if (this->DoPCM())
+		{
+			int opened = 0;
+			for (int i = 0; i < m_prepared; i++)
+			{
+				Target* t = m_targets.Get(i);
+				if (t->a.pcm && this->IsPCMDone(t))
+				{
+					delete t->a.pcm;
+					t->a.pcm = NULL;
+				}
+				else if (t->a.pcm)
+					++opened;
+			}
+
+			while (m_prepared < m_targets.GetSize() && opened < NF_ANALYSIS_SOURCES)
+			{
+				Target* t = m_targets.Get(m_prepared++);
+				MediaItem* item = GetTargetItem(t);
+				t->a.pcm = item ? DuplicateItemForAnalysis(item, t->take) : NULL;
+				t->a.abort = &m_kill;
+				t->a.dWindowSize = (m_flags & NF_ANALYZE_RMS) ? m_windowSize : 0.0; // non-windowed is faster
+				t->sampleRate = t->a.pcm ? t->a.pcm->GetSampleRate() : 0.0;
+
+				SWS_SectionLock lock(&m_mutex);
+				if (t->a.pcm)
+				{
+					m_queue.Add(t);
+					++opened;
+				}
+				else
+					t->pcmDone = true;
+			}
+
+			SWS_SectionLock lock(&m_mutex);
+			m_allQueued = (m_prepared == m_targets.GetSize());
+			pending = (opened > 0 || !m_allQueued);
+		}
+
+		if (this->DoLoudness())
+		{
+			int running = 0;
+			for (int i = 0; i < m_targets.GetSize(); i++)
+			{
+				Target* t = m_targets.Get(i);
+				if (t->loudnessState == LOUDNESS_RUNNING)
+				{
+					if (t->loudness->IsRunning())
+						++running;
+					else
+						this->EndLoudness(t);
+				}
+			}
+
+			for (int i = 0; i < m_targets.GetSize() && running < NF_ANALYSIS_THREADS; i++)
+			{
+				Target* t = m_targets.Get(i);
+				if (t->loudnessState == LOUDNESS_PENDING)
+				{
+					if (!GetTargetItem(t))
+					{
+						t->loudnessState = LOUDNESS_FAILED;
+						continue;
+					}
+
+					t->loudness = new BR_LoudnessObject(t->take);
+					if (t->loudness->CheckTarget(t->take) && t->loudness->Analyze(!(m_flags & NF_ANALYZE_LOUDNESS), !!(m_flags & NF_ANALYZE_TRUEPEAK), !!IsHighPrecisionOptionEnabled(NULL)))
+					{
+						t->loudnessState = LOUDNESS_RUNNING;
+						++running;
+					}
+					else
+					{
+						delete t->loudness;
+						t->loudness = NULL;
+						t->loudnessState = LOUDNESS_FAILED;
+					}
+				}
+			}
+
+			pending |= (running > 0);
+			for (int i = 0; !pending && i < m_targets.GetSize(); i++)
+				pending = (m_targets.Get(i)->loudnessState == LOUDNESS_PENDING);
+		}
+		return pending;
+	}
+
+	double GetProgress()
+	{
+		if (!m_started)
+			return 0.0;
+
+		double progress = 0.0;
+		int parts = 0;
+		for (int i = 0; i < m_targets.GetSize(); i++)
+		{
+			Target* t = m_targets.Get(i);
+			if (this->DoPCM())
+			{
+				if (this->IsPCMDone(t)) progress += 1.0;
+				else if (t->a.pcm)      progress += min(t->a.dProgress, 0.99);
+				++parts;
+			}
+			if (this->DoLoudness())
+			{
+				if (t->loudnessState == LOUDNESS_DONE || t->loudnessState == LOUDNESS_FAILED) progress += 1.0;
+				else if (t->loudnessState == LOUDNESS_RUNNING)                               progress += min(t->loudness->GetProgress(), 0.99);
+				++parts;
+			}
+		}
+		return parts ? progress / parts : 1.0;
+	}
+
+	bool IsDone() { return m_started && this->GetProgress() >= 1.0; }
+
+	bool GetResults(int metric, void* reaperarray)
+	{
+		if (!reaperarray || metric < 0 || metric >= NF_METRIC_COUNT || !this->IsDone())
+			return false;
+
+		for (int i = 0; i < m_targets.GetSize(); i++)
+			if (!AppendToReaperArray(reaperarray, this->GetResult(m_targets.Get(i), metric)))
+				return false;
+		return true;
+	}
+
+	bool GetLoudnessCurve(int idx, bool shortTerm, void* reaperarray)
+	{
+		Target* t = m_targets.Get(idx);
+		if (!reaperarray || !t || t->loudnessState != LOUDNESS_DONE || !(m_flags & NF_ANALYZE_LOUDNESS) || !this->IsDone())
+			return false;
+
+		const vector<double>& values = shortTerm ? t->shortTermValues : t->momentaryValues;
+		for (size_t i = 0; i < values.size(); ++i)
+			if (!AppendToReaperArray(reaperarray, values[i]))
+				return false;
+		return true;
+	}
+
+private:
+	enum LoudnessState { LOUDNESS_PENDING, LOUDNESS_RUNNING, LOUDNESS_DONE, LOUDNESS_FAILED };
+
+	struct Target
+	{
+		Target(MediaItem_Take* take) :
+		take(take), sampleRate(0.0), pcmSuccess(false), pcmDone(false),
+		loudness(NULL), loudnessState(LOUDNESS_PENDING),
+		integrated(NEGATIVE_INF), range(0.0), truePeak(NEGATIVE_INF), truePeakPos(-1.0), shortTermMax(NEGATIVE_INF), momentaryMax(NEGATIVE_INF)
+		{
+			memset(&a, 0, sizeof(a));
+		}
+
+		MediaItem_Take* take;
+		ANALYZE_PCM a;
+		double sampleRate;
+		bool pcmSuccess, pcmDone;
+		BR_LoudnessObject* loudness; // only while running: it holds an audio accessor
+		LoudnessState loudnessState;
+		double integrated, range, truePeak, truePeakPos, shortTermMax, momentaryMax;
+		vector<double> shortTermValues, momentaryValues;
+	};
+
+	bool DoPCM()      { return !!(m_flags & (NF_ANALYZE_PEAK | NF_ANALYZE_RMS)); }
+	bool DoLoudness() { return !!(m_flags & (NF_ANALYZE_TRUEPEAK | NF_ANALYZE_LOUDNESS)); }
+
+	// the take may have been deleted since it was added (the job outlives script defer cycles)
+	MediaItem* GetTargetItem(Target* t)
+	{
+		if (!ValidatePtr2(NULL, t->take, "MediaItem_Take*"))
+			return NULL;
+		MediaItem* item = GetMediaItemTake_Item(t->take);
+		return ValidatePtr2(NULL, item, "MediaItem*") ? item : NULL;
+	}
+
+	bool IsPCMDone(Target* t)
+	{
+		SWS_SectionLock lock(&m_mutex);
+		return t->pcmDone;
+	}
+
+	void EndLoudness(Target* t)
+	{
+		bool curves = !!(m_flags & NF_ANALYZE_LOUDNESS);
+		t->loudness->GetAnalyzeData(&t->integrated, &t->range, &t->truePeak, &t->truePeakPos, &t->shortTermMax, &t->momentaryMax, curves ? &t->shortTermValues : NULL, curves ? &t->momentaryValues : NULL);
+		delete t->loudness;
+		t->loudness = NULL;
+		t->loudnessState = LOUDNESS_DONE;
+	}
+
+	double GetResult(Target* t, int metric)
+	{
+		switch (metric)
+		{
+			case NF_PEAK:
+			case NF_PEAK_POS:
+			case NF_RMS_AVERAGE:
+			case NF_RMS_WINDOWED:
+			case NF_RMS_WINDOWED_POS:
+			{
+				bool isPos = (metric == NF_PEAK_POS || metric == NF_RMS_WINDOWED_POS);
+				if (!t->pcmSuccess || !t->sampleRate || !(m_flags & ((metric == NF_PEAK || metric == NF_PEAK_POS) ? NF_ANALYZE_PEAK : NF_ANALYZE_RMS)))
+					return isPos ? -666 : -150.0;
+
+				if (metric == NF_PEAK)         return VAL2DB(t->a.dPeakVal);
+				if (metric == NF_PEAK_POS)     return GetPosInItem(t->a.peakSample, t->sampleRate);
+				if (metric == NF_RMS_AVERAGE)  return VAL2DB(t->a.dAvgRMS);
+				if (metric == NF_RMS_WINDOWED) return VAL2DB(t->a.dRMS); // = average RMS if the window is larger than the item
+				return GetPosInItem(t->a.peakRMSsample, t->sampleRate);
+			}
+
+			case NF_TRUEPEAK:           return (m_flags & NF_ANALYZE_TRUEPEAK) ? t->truePeak    : NEGATIVE_INF;
+			case NF_TRUEPEAK_POS:       return (m_flags & NF_ANALYZE_TRUEPEAK) ? t->truePeakPos : -1.0;
+			case NF_LUFS_INTEGRATED:    return t->integrated; // also analyzed with true peak only
+			case NF_LU_RANGE:           return (m_flags & NF_ANALYZE_LOUDNESS) ? t->range        : 0.0;
+			case NF_LUFS_SHORTTERM_MAX: return (m_flags & NF_ANALYZE_LOUDNESS) ? t->shortTermMax : NEGATIVE_INF;
+			case NF_LUFS_MOMENTARY_MAX: return (m_flags & NF_ANALYZE_LOUDNESS) ? t->momentaryMax : NEGATIVE_INF;
+		}
+		return 0.0;
+	}
+
+	static unsigned WINAPI AnalyzeThread(void* job)
+	{
+		NF_AnalysisJob* _this = static_cast<NF_AnalysisJob*>(job);
+		for (;;)
+		{
+			Target* t = NULL;
+			{
+				SWS_SectionLock lock(&_this->m_mutex);
+				if (_this->m_kill || (_this->m_allQueued && !_this->m_queue.GetSize()))
+					return 0;
+				if (_this->m_queue.GetSize())
+				{
+					t = _this->m_queue.Get(0);
+					_this->m_queue.Delete(0);
+				}
+			}
+
+			if (!t) // waiting for the main thread to open sources
+			{
+				Sleep(10);
+				continue;
+			}
+
+			bool success = AnalyzePCM(&t->a);
+
+			SWS_SectionLock lock(&_this->m_mutex);
+			t->pcmSuccess = success;
+			t->pcmDone = true;
+		}
+	}
+
+	int m_id, m_flags;
+	double m_windowSize;
+	WDL_PtrList_DeleteOnDestroy<Target> m_targets;
+	WDL_PtrList<Target> m_queue; // sources opened, waiting for a worker thread
+	WDL_TypedBuf<HANDLE> m_threads;
+	SWS_Mutex m_mutex;
+	int m_prepared; // nb of targets whose source got opened (main thread only)
+	bool m_started, m_allQueued;
+	volatile bool m_kill; // also read by AnalyzePCM() outside of m_mutex
+};
+
+static WDL_PtrList<NF_AnalysisJob> g_analysisJobs; // destroyed in NF_AnalysisJobsExit(): waits for worker threads
+
+static NF_AnalysisJob* FindAnalysisJob(int id)
+{
+	for (int i = 0; i < g_analysisJobs.GetSize(); i++)
+		if (g_analysisJobs.Get(i)->GetId() == id)
+			return g_analysisJobs.Get(i);
+	return NULL;
+}
+
+// keeps jobs going if scripts don't poll them
+static void AnalysisJobsTimer()
+{
+	bool pending = false;
+	for (int i = 0; i < g_analysisJobs.GetSize(); i++)
+		pending |= g_analysisJobs.Get(i)->Schedule();
+	if (!pending)
+		plugin_register("-timer", (void*)AnalysisJobsTimer);
+}
+
+int NF_AnalysisJob_Create(int flags, double windowSize)
+{
+	static int s_lastId = 0;
+	if (!(flags & (NF_ANALYZE_PEAK | NF_ANALYZE_RMS | NF_ANALYZE_TRUEPEAK | NF_ANALYZE_LOUDNESS)))
+		return 0;
+	g_analysisJobs.Add(new NF_AnalysisJob(++s_lastId, flags, windowSize));
+	return s_lastId;
+}
+
+bool NF_AnalysisJob_AddTake(int job, MediaItem_Take* take)
+{
+	NF_AnalysisJob* j = FindAnalysisJob(job);
+	return j && j->AddTake(take);
+}
+
+bool NF_AnalysisJob_Start(int job)
+{
+	NF_AnalysisJob* j = FindAnalysisJob(job);
+	if (!j || !j->Start())
+		return false;
+	plugin_register("timer", (void*)AnalysisJobsTimer);
+	return true;
+}
+
+double NF_AnalysisJob_GetProgress(int job)
+{
+	NF_AnalysisJob* j = FindAnalysisJob(job);
+	if (!j)
+		return -1.0;
+	j->Schedule();
+	return j->GetProgress();
+}
+
+bool NF_AnalysisJob_GetResults(int job, int metric, void* reaperarray_values)
+{
+	NF_AnalysisJob* j = FindAnalysisJob(job);
+	return j && j->GetResults(metric, reaperarray_values);
+}
+
+bool NF_AnalysisJob_GetLoudnessCurve(int job, int takeIdx, bool shortTerm, void* reaperarray_values)
+{
+	NF_AnalysisJob* j = FindAnalysisJob(job);
+	return j && j->GetLoudnessCurve(takeIdx, shortTerm, reaperarray_values);
+}
+
+void NF_AnalysisJob_Destroy(int job)
+{
+	if (NF_AnalysisJob* j = FindAnalysisJob(job))
+		g_analysisJobs.Delete(g_analysisJobs.Find(j), true);
+}
+
+void NF_AnalysisJobsExit()
+{
+	plugin_register("-timer", (void*)AnalysisJobsTimer);
+	g_analysisJobs.Empty(true);
+}
+
 // #880, Loudness
 bool NF_AnalyzeTakeLoudness_IntegratedOnly(MediaItem_Take * take, double* lufsIntegratedOut)
 {
@@ -312,6 +727,11 @@ const char* NF_GetSWSMarkerRegionSub(int mkrRgnIdx)
 	return NFDoGetSWSMarkerRegionSub(mkrRgnIdx);
 }
 
+const char* NF_GetSWSMarkerRegionSubAtPosition(double position, int flags, int* mkrRgnIdxOut)
+{
+	return NFDoGetSWSMarkerRegionSubAtPosition(position, flags, mkrRgnIdxOut);
+}
+
 bool NF_SetSWSMarkerRegionSub(const char* mkrRgnSub, int mkrRgnIdx)
 {
 	return NFDoSetSWSMarkerRegionSub(mkrRgnSub, mkrRgnIdx);
@@ -347,22 +767,11 @@ bool NF_ReadID3v2Tag(const char* fn, const char* tag, char* tagval, int tagval_s
 	if (stricmp(strrchr(fn, '\0') - 4, ".mp3")) return false;
 	*tagval = 0;
 
-	TagLib::MPEG::File f(win32::widen(fn).c_str(), false);
-
-	if (f.isValid() && !f.ID3v2Tag()->isEmpty())
-	{
-		TagLib::String s;
-		TagLib::ID3v2::FrameList l = f.ID3v2Tag()->frameListMap()[tag];
-		if (!l.isEmpty())
-			s = l.front()->toString();
-		
-		if (s.length())
-		{
-			const char* p = s.toCString(true);
-			lstrcpyn(tagval, p, tagval_sz);
-			tagval[tagval_sz - 1] = '\0'; // null-terminate in case of buffer overflow (probably unlikely)
-		}
-	}
+	// tags of the file are parsed once and cached, see SNM_ReadMediaFileTags()
+	WDL_FastString key, val;
+	key.SetFormatted(64, "ID3:%s", tag ? tag : "");
+	if (SNM_GetMediaFileTag(fn, key.Get(), &val))
+		lstrcpyn(tagval, val.Get(), tagval_sz);
 
 	return !!*tagval;
 }
@@ -38,6 +38,14 @@ double          NF_GetMediaItemPeakRMS_Windowed(MediaItem* item);
 bool            NF_AnalyzeMediaItemPeakAndRMS(MediaItem* item, double windowSize, void* reaperarray_peaks, void* reaperarray_peakpositions, void* reaperarray_RMSs, void* reaperarray_RMSpositions);
 void            NF_GetSWS_RMSoptions(double* targetOut, double* windowSizeOut);
 bool            NF_SetSWS_RMSoptions(double target, double windowSize);
+int             NF_AnalysisJob_Create(int flags, double windowSize);
+bool            NF_AnalysisJob_AddTake(int job, MediaItem_Take* take);
+bool            NF_AnalysisJob_Start(int job);
+double          NF_AnalysisJob_GetProgress(int job);
+bool            NF_AnalysisJob_GetResults(int job, int metric, void* reaperarray_values);
+bool            NF_AnalysisJob_GetLoudnessCurve(int job, int takeIdx, bool shortTerm, void* reaperarray_values);
+void            NF_AnalysisJob_Destroy(int job);
+void            NF_AnalysisJobsExit();
 
 // #880
 bool            NF_AnalyzeTakeLoudness_IntegratedOnly(MediaItem_Take* take, double* lufsIntegratedOut);
@@ -48,6 +56,7 @@ bool            NF_AnalyzeTakeLoudness2(MediaItem_Take* take, bool analyzeTruePe
 const char*    NF_GetSWSTrackNotes(MediaTrack* track);
 void           NF_SetSWSTrackNotes(MediaTrack* track, const char* buf);
 const char*    NF_GetSWSMarkerRegionSub(int mkrRgnIdx);
+const char*    NF_GetSWSMarkerRegionSubAtPosition(double position, int flags, int* mkrRgnIdxOut);
 bool           NF_SetSWSMarkerRegionSub(const char* mkrRgnSub, int mkrRgnIdx);
 void           NF_UpdateSWSMarkerRegionSubWindow();
 
@@ -35,6 +35,7 @@
 #include "../Breeder/BR_ReaScript.h" // BR_GetMouseCursorContext(), BR_ItemAtMouseCursor()
 #include "../Utility/configvar.h"
 #include "../Misc/Adam.h"
+#include "NF_ReaScript.h"
 
 //////////////////////////////////////////////////////////////////
 //                                                              //
@@ -446,6 +447,11 @@ int nofish_Init()
 	return 1;
 }
 
+void nofish_Exit()
+{
+	NF_AnalysisJobsExit();
+}
+
 
 //////////////////////////////////////////////////////////////////
 //                                                              //
@@ -37,3 +37,4 @@ void UpdateMIDIGridToolbar();
 
 // register actions
 int nofish_Init();
+void nofish_Exit();
@@ -65,6 +65,7 @@
 #include <string>
 #include <list>
 #include <map>
+#include <unordered_map>
 #include <set>
 #include <numeric>
 #include <ctime>
@@ -75,6 +75,13 @@ static WDL_IntKeyedArray<WDL_String*> g_cmdFiles(freeCmdFilesValue);
 #endif
 static WDL_IntKeyedArray<COMMAND_T*> g_commands; // no valdispose (cmds can be allocated in different ways)
 
+typedef struct SWS_ToggleStateCache {
+	int dirtyFlags; // SWS_TOGGLE_DIRTY_*
+	bool valid;
+	int state;
+} SWS_ToggleStateCache;
+static WDL_IntKeyedArray<SWS_ToggleStateCache> g_toggleStates;
+
 int g_iFirstCommand = 0;
 int g_iLastCommand = 0;
 
@@ -112,10 +119,14 @@ bool hookCommandProc(int iCmd, int flag)
 				sReentrantCmds.Add(cmd->id);
 				cmd->fakeToggle = !cmd->fakeToggle;
 #ifndef BR_DEBUG_PERFORMANCE_ACTIONS
-				cmd->doCommand(cmd);
+				if (g_actionProfiler)
+					ProfileCommand(cmd);
+				else
+					cmd->doCommand(cmd);
 #else
 				CommandTimer(cmd);
 #endif
+				SWSInvalidateToggleStates(SWS_TOGGLE_DIRTY_ALL);
 				sReentrantCmds.Delete(sReentrantCmds.Find(cmd->id));
 				return true;
 			}
@@ -161,10 +172,14 @@ bool hookCommandProc2(KbdSectionInfo* sec, int cmdId, int val, int valhw, int re
 					cmd->fakeToggle = !cmd->fakeToggle;
 
 #ifndef BR_DEBUG_PERFORMANCE_ACTIONS
-					cmd->onAction(cmd, val, valhw, relmode, hwnd);
+					if (g_actionProfiler)
+						ProfileCommand(cmd, val, valhw, relmode, hwnd, true);
+					else
+						cmd->onAction(cmd, val, valhw, relmode, hwnd);
 #else
 					CommandTimer(cmd, val, valhw, relmode, hwnd, true);
 #endif
+					SWSInvalidateToggleStates(SWS_TOGGLE_DIRTY_ALL);
 					sReentrantCmds.Delete(sReentrantCmds.Find(cmd->id));
 					return true;
 				}
@@ -201,11 +216,20 @@ int toggleActionHook(int iCmd)
 	{
 		if (cmd->accel.accel.cmd==iCmd && cmd->getEnabled)
 		{
+			SWS_ToggleStateCache* cache = g_toggleStates.GetSize() ? g_toggleStates.GetPtr(iCmd) : NULL;
+			if (cache && cache->valid)
+				return cache->state;
+
 			if (sReentrantCmds.Find(cmd->id) == -1)
 			{
 				sReentrantCmds.Add(cmd->id);
-				int state = cmd->getEnabled(cmd);
+				int state = g_actionProfiler ? ProfileToggleState(cmd) : cmd->getEnabled(cmd);
 				sReentrantCmds.Delete(sReentrantCmds.Find(cmd->id));
+				if (cache)
+				{
+					cache->state = state;
+					cache->valid = true;
+				}
 				return state;
 			}
 #ifdef _SWS_DEBUG
@@ -221,6 +245,45 @@ int toggleActionHook(int iCmd)
 	return -1;
 }
 
+// Note: notifications come from SWSTimeSlice below + toggleStatePostCommandProc(),
+// i.e. any performed action invalidates all cached toggle states
+void SWSCacheToggleState(int cmdId, int dirtyFlags)
+{
+	if (!SWSGetCommandByID(cmdId))
+		return;
+
+	if (dirtyFlags)
+	{
+		SWS_ToggleStateCache cache = { dirtyFlags, false, 0 };
+		g_toggleStates.Insert(cmdId, cache);
+	}
+	else
+		g_toggleStates.Delete(cmdId);
+}
+
+void SWSCacheToggleStates(int (*getEnabled)(COMMAND_T*), int dirtyFlags)
+{
+	for (int i=0; i<g_commands.GetSize(); i++)
+		if (COMMAND_T* cmd = g_commands.Enumerate(i, NULL, NULL))
+			if (getEnabled && cmd->getEnabled == getEnabled)
+				SWSCacheToggleState(cmd->accel.accel.cmd, dirtyFlags);
+}
+
+void SWSInvalidateToggleStates(int dirtyFlags)
+{
+	for (int i=0; i<g_toggleStates.GetSize(); i++)
+	{
+		SWS_ToggleStateCache* cache = g_toggleStates.EnumeratePtr(i);
+		if (cache && (cache->dirtyFlags & dirtyFlags))
+			cache->valid = false;
+	}
+}
+
+static void toggleStatePostCommandProc(int iCmd, int flag)
+{
+	SWSInvalidateToggleStates(SWS_TOGGLE_DIRTY_ALL);
+}
+
 // 1) Get command ID from Reaper
 // 2) Add keyboard accelerator (with localized action name) and add to the "action" list
 int SWSRegisterCmd(COMMAND_T* pCommand, const char* cFile, int cmdId, bool localize)
@@ -328,6 +391,7 @@ COMMAND_T* SWSUnregisterCmd(int id)
 			plugin_register("-custom_action", (void*)&s);
 		}
 		g_commands.Delete(id);
+		g_toggleStates.Delete(id);
 #ifdef ACTION_DEBUG
 		g_cmdFiles.Delete(id);
 #endif
@@ -454,7 +518,7 @@ static void swsMenuHook(const char* menustr, HMENU hMenu, int flag)
 				swsMenuHook(menustr, mi.hSubMenu, flag);
 			else if (mi.wID >= (UINT)g_iFirstCommand && mi.wID <= (UINT)g_iLastCommand) {
 				if (COMMAND_T* t = g_commands.Get(mi.wID, NULL))
-					CheckMenuItem(hMenu, i, MF_BYPOSITION | (t->getEnabled && t->getEnabled(t) ? MF_CHECKED : MF_UNCHECKED));
+					CheckMenuItem(hMenu, i, MF_BYPOSITION | (t->getEnabled && (g_actionProfiler ? ProfileToggleState(t) : t->getEnabled(t)) ? MF_CHECKED : MF_UNCHECKED));
 			}
 		}
 	}
@@ -495,6 +559,7 @@ public:
 
 	void SetPlayState(bool play, bool pause, bool rec)
 	{
+		SWSInvalidateToggleStates(SWS_TOGGLE_DIRTY_TRANSPORT);
 		SNM_CSurfSetPlayState(play, pause, rec);
 		AWDoAutoGroup(rec);
 		ItemPreviewPlayState(play, rec);
@@ -504,6 +569,7 @@ public:
 	// This is our only notification of active project tab change, so update everything
 	void SetTrackListChange()
 	{
+		SWSInvalidateToggleStates(SWS_TOGGLE_DIRTY_ALL);
 		m_bChanged = true;
 		AutoColorTrack(false);
 		AutoColorMarkerRegion(false);
@@ -515,6 +581,7 @@ public:
 	// However, we still need to trap track name changes with no track list change.
 	void SetTrackTitle(MediaTrack *tr, const char *c)
 	{
+		SWSInvalidateToggleStates(SWS_TOGGLE_DIRTY_TRACKS);
 		ScheduleTracklistUpdate();
 		if (!m_iACIgnore)
 		{
@@ -536,15 +603,43 @@ public:
 		//
 		// Besides these complications, it would also mean we would have to check all of these things a lot of times, thus clogging the Csurf just to execute one simple thing. So just leave it here and hope the
 		// OnTrackSelection() gets fixed at some point :)
+		SWSInvalidateToggleStates(SWS_TOGGLE_DIRTY_SELECTION);
 		BR_CSurf_OnTrackSelection(tr);
 	}
 
-	void SetSurfaceSelected(MediaTrack *tr, bool bSel)	{ ScheduleTracklistUpdate(); UpdateSnapshotsDialog(true); }
-	void SetSurfaceMute(MediaTrack *tr, bool mute)		{ ScheduleTracklistUpdate(); UpdateTrackMute(); }
-	void SetSurfaceSolo(MediaTrack *tr, bool solo)		{ ScheduleTracklistUpdate(); UpdateTrackSolo(); }
-	void SetSurfaceRecArm(MediaTrack *tr, bool arm)		{ ScheduleTracklistUpdate(); UpdateTrackArm(); }
+	void SetSurfaceSelected(MediaTrack *tr, bool bSel)	{ SWSInvalidateToggleStates(SWS_TOGGLE_DIRTY_SELECTION); ScheduleTracklistUpdate(); UpdateSnapshotsDialog(true); }
+	void SetSurfaceMute(MediaTrack *tr, bool mute)		{ SWSInvalidateToggleStates(SWS_TOGGLE_DIRTY_TRACKS); ScheduleTracklistUpdate(); UpdateTrackMute(); }
+	void SetSurfaceSolo(MediaTrack *tr, bool solo)		{ SWSInvalidateToggleStates(SWS_TOGGLE_DIRTY_TRACKS); ScheduleTracklistUpdate(); UpdateTrackSolo(); }
+	void SetSurfaceRecArm(MediaTrack *tr, bool arm)		{ SWSInvalidateToggleStates(SWS_TOGGLE_DIRTY_TRACKS); ScheduleTracklistUpdate(); UpdateTrackArm(); }
+	void SetRepeatState(bool rep)						{ SWSInvalidateToggleStates(SWS_TOGGLE_DIRTY_TRANSPORT); }
 	int Extended(int call, void *parm1, void *parm2, void *parm3)
 	{
+		switch (call)
+		{
+			case CSURF_EXT_RESET:
+				SWSInvalidateToggleStates(SWS_TOGGLE_DIRTY_ALL);
+				break;
+			case CSURF_EXT_SETLASTTOUCHEDTRACK:
+				SWSInvalidateToggleStates(SWS_TOGGLE_DIRTY_SELECTION);
+				break;
+			case CSURF_EXT_SETMETRONOME:
+			case CSURF_EXT_SETAUTORECARM:
+			case CSURF_EXT_SETRECMODE:
+			case CSURF_EXT_SETBPMANDPLAYRATE:
+				SWSInvalidateToggleStates(SWS_TOGGLE_DIRTY_TRANSPORT);
+				break;
+			case CSURF_EXT_SETFXENABLED:
+			case CSURF_EXT_SETFXOPEN:
+			case CSURF_EXT_SETFXCHANGE:
+			case CSURF_EXT_SETFOCUSEDFX:
+			case CSURF_EXT_SETLASTTOUCHEDFX:
+				SWSInvalidateToggleStates(SWS_TOGGLE_DIRTY_FX);
+				break;
+			case CSURF_EXT_SETPROJECTMARKERCHANGE:
+				SWSInvalidateToggleStates(SWS_TOGGLE_DIRTY_MARKERS);
+				break;
+		}
+
 		BR_CSurf_Extended(call, parm1, parm2, parm3);
 		SNM_CSurfExtended(call, parm1, parm2, parm3);
 		return 0;
@@ -638,6 +733,7 @@ error:
 				plugin_register("-hookcommand2", (void*)hookCommandProc2);
 				plugin_register("-hookcommand", (void*)hookCommandProc);
 //				plugin_register("-hookpostcommand", (void*)hookPostCommandProc);
+				plugin_register("-hookpostcommand", (void*)toggleStatePostCommandProc);
 				plugin_register("-toggleaction", (void*)toggleActionHook);
 				plugin_register("-hookcustommenu", (void*)swsMenuHook);
 				if (g_ts) { plugin_register("-csurf_inst", g_ts); DELETE_NULL(g_ts); }
@@ -662,6 +758,7 @@ error:
 				FNGExtensionExit();
 				PadreExit();
 				SNM_Exit();
+				nofish_Exit();
 				BR_Exit();
 			}
 			return 0; // makes REAPER unloading us
@@ -943,6 +1040,7 @@ error:
 		IMPAPI(MIDI_EnumSelTextSysexEvts);
 		IMPAPI(MIDI_eventlist_Create);
 		IMPAPI(MIDI_eventlist_Destroy);
+		IMPAPI(MIDI_GetAllEvts);
 		IMPAPI(MIDI_GetCC);
 		IMPAPI(MIDI_GetEvt);
 		IMPAPI(MIDI_GetGrid)
@@ -956,11 +1054,13 @@ error:
 		IMPAPI(MIDI_InsertEvt);
 		IMPAPI(MIDI_InsertNote);
 		IMPAPI(MIDI_InsertTextSysexEvt);
+		IMPAPI(MIDI_SetAllEvts);
 		IMPAPI(MIDI_SetCC);
 		IMPAPI(MIDI_SetEvt);
 		IMPAPI(MIDI_SetItemExtents); // v5.0pre (no data on exact build in whatsnew, but I'm pretty sure I never saw this in v4)
 		IMPAPI(MIDI_SetNote);
 		IMPAPI(MIDI_SetTextSysexEvt);
+		IMPAPI(MIDI_Sort);
 		IMPAPI(MIDIEditor_GetActive);
 		IMPAPI(MIDIEditor_GetMode);
 		IMPAPI(MIDIEditor_GetSetting_int);
@@ -1060,10 +1160,13 @@ error:
 		IMPAPI(StopTrackPreview);
 		IMPAPI(StopTrackPreview2);
 		IMPAPI(stringToGuid);
+		IMPAPI(TakeFX_CopyToTake); // v5.95+
+		IMPAPI(TakeFX_Delete); // v5.95+
 		IMPAPI(TakeFX_GetChainVisible);
 		IMPAPI(TakeFX_GetCount);
 		IMPAPI(TakeFX_GetFloatingWindow);
 		IMPAPI(TakeFX_GetOffline); // v5.95+
+		IMPAPI(TakeFX_SetEnabled);
 		IMPAPI(TakeFX_SetOffline); // v5.95+
 		IMPAPI(TakeFX_SetOpen);
 		IMPAPI(TakeFX_Show);
@@ -1082,6 +1185,9 @@ error:
 		IMPAPI(TimeMap2_timeToBeats);
 		IMPAPI(TimeMap2_timeToQN);
 		IMPAPI(TimeMap_curFrameRate);
+		IMPAPI(TrackFX_CopyToTake); // v5.95+
+		IMPAPI(TrackFX_CopyToTrack); // v5.95+
+		IMPAPI(TrackFX_Delete); // v5.95+
 		IMPAPI(TrackFX_FormatParamValue);
 		IMPAPI(TrackFX_GetByName);
 		IMPAPI(TrackFX_GetChainVisible);
@@ -1097,6 +1203,7 @@ error:
 		IMPAPI(TrackFX_GetParamName);
 		IMPAPI(TrackFX_GetPreset);
 		IMPAPI(TrackFX_GetPresetIndex);
+		IMPAPI(TrackFX_GetRecCount);
 		IMPAPI(TrackFX_GetUserPresetFilename); // v5.15pre1+
 		IMPAPI(TrackFX_NavigatePresets);
 		IMPAPI(TrackFX_GetOffline); // v5.95+
@@ -1124,6 +1231,7 @@ error:
 		IMPAPI(UpdateItemInProject);
 		IMPAPI(UpdateTimeline);
 		IMPAPI(ValidatePtr);
+		IMPAPI(ValidatePtr2); // v5.95+
 
 		if (errcnt)
 		{
@@ -1202,6 +1310,9 @@ error:
 		//if (!rec->Register("hookpostcommand", (void*)hookPostCommandProc))
 		//	ERR_RETURN("hookpostcommand error.")
 
+		if (!rec->Register("hookpostcommand", (void*)toggleStatePostCommandProc))
+			ERR_RETURN("hookpostcommand error.")
+
 		if (!rec->Register("toggleaction", (void*)toggleActionHook))
 			ERR_RETURN("Toggle action hook error.")
 
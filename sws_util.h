@@ -206,6 +206,20 @@ int SWSGetCommandID(void (*cmdFunc)(COMMAND_T*), INT_PTR user = 0, const char**
 COMMAND_T* SWSGetCommandByID(int cmdId);
 int IsSwsAction(const char* _actionName);
 
+// Toggle state cache, sws_extension.cpp
+// Opted-in commands get their toggle state evaluated once, the cached value is then returned
+// to REAPER until a change of one of their SWS_TOGGLE_DIRTY_* categories is notified (or any
+// action is performed). Only opt in commands whose toggle state depends on these changes only!
+#define SWS_TOGGLE_DIRTY_SELECTION 0x01 // track selection, last touched track
+#define SWS_TOGGLE_DIRTY_TRACKS    0x02 // track list, track names, mute/solo/rec arm
+#define SWS_TOGGLE_DIRTY_TRANSPORT 0x04 // play state, repeat, record mode, metronome, tempo/playrate
+#define SWS_TOGGLE_DIRTY_FX        0x08 // fx added/removed/moved, enabled, opened, focused
+#define SWS_TOGGLE_DIRTY_MARKERS   0x10 // project markers/regions
+#define SWS_TOGGLE_DIRTY_ALL       0xFF
+void SWSCacheToggleState(int cmdId, int dirtyFlags); // dirtyFlags == 0: opt out
+void SWSCacheToggleStates(int (*getEnabled)(COMMAND_T*), int dirtyFlags); // all registered commands using getEnabled
+void SWSInvalidateToggleStates(int dirtyFlags);
+
 HMENU SWSCreateMenuFromCommandTable(COMMAND_T pCommands[], HMENU hMenu = NULL, int* iIndex = NULL);;
 
 // Utility functions, sws_util.cpp
@@ -228,6 +242,7 @@ HWND GetRulerWnd();
 const GUID* TrackToGuid(MediaTrack* tr);
 MediaTrack* GuidToTrack(const GUID* guid);
 bool GuidsEqual(const GUID* g1, const GUID* g2);
+struct GuidLess { bool operator()(const GUID& g1, const GUID& g2) const { return memcmp(&g1, &g2, sizeof(GUID)) < 0; } }; // for std::map<GUID,...>
 bool TrackMatchesGuid(MediaTrack* tr, const GUID* g);
 const char *stristr(const char* a, const char* b);
 
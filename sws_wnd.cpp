@@ -1192,17 +1192,36 @@ void SWS_ListView::Update()
 		if (!items.GetSize())
 			ListView_DeleteAllItems(m_hwndList);
 
+		// Item list indexes, items matched with the listview are flagged "used" (no
+		// deletion from the item list, that would be quadratic with large lists)
+		std::unordered_map<SWS_ListItem*,int> itemIdx;
+		itemIdx.reserve(items.GetSize());
+		for (int i = 0; i < items.GetSize(); i++)
+			itemIdx[items.Get(i)] = i;
+		std::vector<bool> used(items.GetSize(), false);
+		int iNextItem = 0;                     // fast path: both lists usually share the same order
+		int iNewItem = items.GetSize() - 1;    // items left unused are new, added last first
+
 		// The list is sorted, use that to our advantage here:
 		int lvItemCount = ListView_GetItemCount(m_hwndList);
 		int newIndex = lvItemCount;
-		for (int i = 0; items.GetSize() || i < lvItemCount; i++)
+		for (int i = 0; ; i++)
 		{
 			bool bFound = false;
 			SWS_ListItem* pItem;
 			if (i < lvItemCount)
 			{	// First check items in the listview, match to item list
 				pItem = GetListItem(i);
-				int iIndex = items.Find(pItem);
+				int iIndex = -1;
+				if (iNextItem < items.GetSize() && items.Get(iNextItem) == pItem)
+					iIndex = iNextItem;
+				else
+				{
+					std::unordered_map<SWS_ListItem*,int>::iterator it = itemIdx.find(pItem);
+					if (it != itemIdx.end() && !used[it->second])
+						iIndex = it->second;
+				}
+
 				if (iIndex == -1)
 				{
 					// Delete items from listview that aren't in the item list
@@ -1214,14 +1233,18 @@ void SWS_ListView::Update()
 				}
 				else
 				{
-					// Delete item from item list to indicate "used"
-					items.Delete(iIndex);
+					used[iIndex] = true;
+					iNextItem = iIndex + 1;
 					bFound = true;
 				}
 			}
 			else
 			{	// Items left in the item list are new
-				pItem = items.Remove();
+				while (iNewItem >= 0 && used[iNewItem])
+					iNewItem--;
+				if (iNewItem < 0)
+					break;
+				pItem = items.Get(iNewItem--);
 			}
 
 			// We have an item pointer, and a listview index, add/edit the listview
@@ -1304,7 +1327,7 @@ void SWS_ListView::Update()
 
 			RECT r;
 			// Add tooltips after sort
-			for (int i = 0; i < ListView_GetItemCount(m_hwndList); i++)
+			for (int i = 0; HasItemTooltips() && i < ListView_GetItemCount(m_hwndList); i++)
 			{
 				// Get the rect of the line
 				ListView_GetItemRect(m_hwndList, i, &r, LVIR_BOUNDS);
@@ -115,6 +115,7 @@ protected:
 	virtual void SetItemText(SWS_ListItem* item, int iCol, const char* str) {}
 	virtual void GetItemText(SWS_ListItem* item, int iCol, char* str, int iStrMax) { str[0] = 0; }
 	virtual void GetItemTooltip(SWS_ListItem* item, char* str, int iStrMax) {}
+	virtual bool HasItemTooltips() { return true; } // only if the list view was created with tooltips, checked on each Update()
 	virtual void GetItemList(SWS_ListItemList* pList) { pList->Empty(); }
 	virtual int  GetItemState(SWS_ListItem* item) { return -1; } // Selection state: -1 == unchanged, 0 == false, 1 == selected
 	// These inform the derived class of user interaction